@@ -30,6 +30,9 @@
 #define LIGHTREC_LOCAL_BRANCH	(1 << 5)
 #define LIGHTREC_HW_IO		(1 << 6)
 #define LIGHTREC_MULT32		(1 << 7)
+#define LIGHTREC_NO_GTE_FLAGS	(1 << 8)
+#define LIGHTREC_GTE_PAIR	(1 << 9)
+#define LIGHTREC_GTE_PAIRED	(1 << 10)
 
 struct block;
 
@@ -1334,16 +1334,37 @@ static void rec_CP(const struct block *block, const struct opcode *op, u32 pc)
 {
 	struct regcache *reg_cache = block->state->reg_cache;
 	jit_state_t *_jit = block->_jit;
+	const struct opcode *next;
 	u8 tmp, tmp2;
 
+	/* Already executed along with the previous command */
+	if (op->flags & LIGHTREC_GTE_PAIRED)
+		return;
+
 	jit_name(__func__);
 	jit_note(__FILE__, __LINE__);
 
 	tmp = lightrec_alloc_reg(reg_cache, _jit, JIT_R0);
 	tmp2 = lightrec_alloc_reg_temp(reg_cache, _jit);
 
-	jit_ldxi(tmp2, LIGHTREC_REG_STATE,
-		 offsetof(struct lightrec_state, cp_func));
+	if (op->flags & LIGHTREC_GTE_PAIR) {
+		for (next = op->next; !(next->flags & LIGHTREC_GTE_PAIRED);
+		     next = next->next);
+
+		jit_movi(tmp, next->opcode);
+		jit_stxi_i(offsetof(struct lightrec_state, cp_pair_next_op),
+			   LIGHTREC_REG_STATE, tmp);
+		jit_movi(tmp, !!(next->flags & LIGHTREC_NO_GTE_FLAGS));
+		jit_stxi_i(offsetof(struct lightrec_state, cp_pair_next_nf),
+			   LIGHTREC_REG_STATE, tmp);
+		jit_ldxi(tmp2, LIGHTREC_REG_STATE,
+			 offsetof(struct lightrec_state, cp_pair_func));
+	} else if (op->flags & LIGHTREC_NO_GTE_FLAGS)
+		jit_ldxi(tmp2, LIGHTREC_REG_STATE,
+			 offsetof(struct lightrec_state, cp_nf_func));
+	else
+		jit_ldxi(tmp2, LIGHTREC_REG_STATE,
+			 offsetof(struct lightrec_state, cp_func));
 
 	jit_movi(tmp, op->opcode);
 	jit_callr(tmp2);
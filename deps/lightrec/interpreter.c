@@ -520,7 +520,10 @@ static u32 int_CP(struct interpreter *inter)
 	else
 		ops = &state->ops.cop0_ops;
 
-	(*ops->op)(state, (op->j.imm) & ~(1 << 25));
+	if (op->flags & LIGHTREC_NO_GTE_FLAGS)
+		(*ops->op_nf)(state, (op->j.imm) & ~(1 << 25));
+	else
+		(*ops->op)(state, (op->j.imm) & ~(1 << 25));
 
 	return jump_next(inter);
 }
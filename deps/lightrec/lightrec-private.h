@@ -104,9 +104,11 @@ struct lightrec_state {
 	u32 exit_flags;
 	struct block *dispatcher, *rw_wrapper, *rw_generic_wrapper,
 		     *mfc_wrapper, *mtc_wrapper, *rfe_wrapper, *cp_wrapper,
-		     *syscall_wrapper, *break_wrapper;
+		     *cp_nf_wrapper, *cp_pair_wrapper, *syscall_wrapper,
+		     *break_wrapper;
 	void *rw_func, *rw_generic_func, *mfc_func, *mtc_func, *rfe_func,
-	     *cp_func, *syscall_func, *break_func;
+	     *cp_func, *cp_nf_func, *cp_pair_func, *syscall_func, *break_func;
+	u32 cp_pair_next_op, cp_pair_next_nf;
 	struct jit_node *branches[512];
 	struct lightrec_branch local_branches[512];
 	struct lightrec_branch_target targets[512];
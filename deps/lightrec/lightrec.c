@@ -38,6 +38,14 @@
 #include <tinymm.h>
 #endif
 
+/* time spent compiling on the emulation thread, for the PCSX profiler */
+#ifdef PCNT
+#include "pcnt.h"
+#else
+#define pcnt_start(id)
+#define pcnt_end(id)
+#endif
+
 #define GENMASK(h, l) \
 	(((uintptr_t)-1 << (l)) & ((uintptr_t)-1 >> (__WORDSIZE - 1 - (h))))
 
@@ -415,6 +423,18 @@ static void lightrec_cp_cb(struct lightrec_state *state, union code op)
 	(*func)(state, op.opcode);
 }
 
+static void lightrec_cp_nf_cb(struct lightrec_state *state, union code op)
+{
+	(*state->ops.cop2_ops.op_nf)(state, op.opcode);
+}
+
+static void lightrec_cp_pair_cb(struct lightrec_state *state, union code op)
+{
+	(*state->ops.cop2_ops.op_pair)(state, op.opcode,
+				       state->cp_pair_next_op,
+				       state->cp_pair_next_nf);
+}
+
 static void lightrec_syscall_cb(struct lightrec_state *state, union code op)
 {
 	lightrec_set_exit_flags(state, LIGHTREC_EXIT_SYSCALL);
@@ -444,7 +464,9 @@ struct block * lightrec_get_block(struct lightrec_state *state, u32 pc)
 	}
 
 	if (!block) {
+		pcnt_start(PCNT_REC);
 		block = lightrec_precompile_block(state, pc);
+		pcnt_end(PCNT_REC);
 		if (!block) {
 			pr_err("Unable to recompile block at PC 0x%x\n", pc);
 			lightrec_set_exit_flags(state, LIGHTREC_EXIT_SEGFAULT);
@@ -481,10 +503,13 @@ static void * get_next_block_func(struct lightrec_state *state, u32 pc)
 
 			lightrec_unregister(MEM_FOR_CODE, block->code_size);
 
-			if (ENABLE_THREADED_COMPILER)
+			if (ENABLE_THREADED_COMPILER) {
 				lightrec_recompiler_add(state->rec, block);
-			else
+			} else {
+				pcnt_start(PCNT_REC);
 				lightrec_compile_block(block);
+				pcnt_end(PCNT_REC);
+			}
 		}
 
 		if (ENABLE_THREADED_COMPILER && likely(!should_recompile))
@@ -503,10 +528,13 @@ static void * get_next_block_func(struct lightrec_state *state, u32 pc)
 
 		if (likely(!(block->flags & BLOCK_NEVER_COMPILE))) {
 			/* Then compile it using the profiled data */
-			if (ENABLE_THREADED_COMPILER)
+			if (ENABLE_THREADED_COMPILER) {
 				lightrec_recompiler_add(state->rec, block);
-			else
+			} else {
+				pcnt_start(PCNT_REC);
 				lightrec_compile_block(block);
+				pcnt_end(PCNT_REC);
+			}
 		}
 
 		if (state->exit_flags != LIGHTREC_EXIT_NORMAL ||
@@ -1246,10 +1274,19 @@ struct lightrec_state * lightrec_init(char *argv0,
 	if (!state->cp_wrapper)
 		goto err_free_rfe_wrapper;
 
+	state->cp_nf_wrapper = generate_wrapper(state, lightrec_cp_nf_cb, false);
+	if (!state->cp_nf_wrapper)
+		goto err_free_cp_wrapper;
+
+	state->cp_pair_wrapper = generate_wrapper(state, lightrec_cp_pair_cb,
+						  false);
+	if (!state->cp_pair_wrapper)
+		goto err_free_cp_nf_wrapper;
+
 	state->syscall_wrapper = generate_wrapper(state, lightrec_syscall_cb,
 						  false);
 	if (!state->syscall_wrapper)
-		goto err_free_cp_wrapper;
+		goto err_free_cp_pair_wrapper;
 
 	state->break_wrapper = generate_wrapper(state, lightrec_break_cb,
 						false);
@@ -1262,6 +1299,8 @@ struct lightrec_state * lightrec_init(char *argv0,
 	state->mtc_func = state->mtc_wrapper->function;
 	state->rfe_func = state->rfe_wrapper->function;
 	state->cp_func = state->cp_wrapper->function;
+	state->cp_nf_func = state->cp_nf_wrapper->function;
+	state->cp_pair_func = state->cp_pair_wrapper->function;
 	state->syscall_func = state->syscall_wrapper->function;
 	state->break_func = state->break_wrapper->function;
 
@@ -1283,6 +1322,10 @@ struct lightrec_state * lightrec_init(char *argv0,
 
 err_free_syscall_wrapper:
 	lightrec_free_block(state->syscall_wrapper);
+err_free_cp_pair_wrapper:
+	lightrec_free_block(state->cp_pair_wrapper);
+err_free_cp_nf_wrapper:
+	lightrec_free_block(state->cp_nf_wrapper);
 err_free_cp_wrapper:
 	lightrec_free_block(state->cp_wrapper);
 err_free_rfe_wrapper:
@@ -1336,6 +1379,8 @@ void lightrec_destroy(struct lightrec_state *state)
 	lightrec_free_block(state->mtc_wrapper);
 	lightrec_free_block(state->rfe_wrapper);
 	lightrec_free_block(state->cp_wrapper);
+	lightrec_free_block(state->cp_nf_wrapper);
+	lightrec_free_block(state->cp_pair_wrapper);
 	lightrec_free_block(state->syscall_wrapper);
 	lightrec_free_block(state->break_wrapper);
 	finish_jit();
@@ -103,6 +103,15 @@ struct lightrec_cop_ops {
 	void (*mtc)(struct lightrec_state *state, u32 op, u8 reg, u32 value);
 	void (*ctc)(struct lightrec_state *state, u32 op, u8 reg, u32 value);
 	void (*op)(struct lightrec_state *state, u32 op);
+
+	/* Optional; called instead of op() for coprocessor commands whose
+	 * side effects on the FLAG register are proven to be unused */
+	void (*op_nf)(struct lightrec_state *state, u32 op);
+
+	/* Optional; executes two back-to-back coprocessor commands with a
+	 * single call. The FLAG register result of 'op' is never needed. */
+	void (*op_pair)(struct lightrec_state *state, u32 op,
+			u32 next_op, _Bool next_nf);
 };
 
 struct lightrec_ops {
@@ -997,6 +997,161 @@ static int lightrec_flag_mults(struct block *block)
 	return 0;
 }
 
+static bool is_gte_cmd(union code c)
+{
+	return c.i.op == OP_CP2 && c.r.op != OP_CP2_BASIC;
+}
+
+static bool reads_gte_flags(union code c)
+{
+	return c.i.op == OP_CP2 && c.r.op == OP_CP2_BASIC &&
+		c.r.rs == OP_CP2_BASIC_CFC2 && c.r.rd == 31;
+}
+
+static bool is_gte_flags_unneeded(const struct block *block,
+				  const struct opcode *op)
+{
+	const struct opcode *next, *last = NULL;
+	u32 offset;
+
+	for (op = op->next; op != last; op = op->next) {
+		/* Every GTE command starts by clearing the FLAG register,
+		 * and a CTC2 to $31 overwrites it too */
+		if (is_gte_cmd(op->c))
+			return true;
+		if (op->i.op == OP_CP2 && op->r.op == OP_CP2_BASIC &&
+		    op->r.rs == OP_CP2_BASIC_CTC2 && op->r.rd == 31)
+			return true;
+		if (reads_gte_flags(op->c))
+			return false;
+
+		if (!has_delay_slot(op->c)) {
+			if (op->i.op == OP_SPECIAL &&
+			    (op->r.op == OP_SPECIAL_SYSCALL ||
+			     op->r.op == OP_SPECIAL_BREAK))
+				return false;
+			continue;
+		}
+
+		/* Don't bother with GTE opcodes in delay slots */
+		if (!(op->flags & LIGHTREC_NO_DS) &&
+		    op->next && op->next->i.op == OP_CP2)
+			return false;
+
+		switch (op->i.op) {
+		case OP_BEQ:
+		case OP_BNE:
+		case OP_BLEZ:
+		case OP_BGTZ:
+		case OP_REGIMM:
+		case OP_META_BEQZ:
+		case OP_META_BNEZ:
+			/* TODO: handle backwards branches too */
+			if ((op->flags & LIGHTREC_LOCAL_BRANCH) &&
+			    (s16)op->c.i.imm >= 0) {
+				offset = op->offset + 1 + (s16)op->c.i.imm;
+
+				/* Stop one opcode before the target, as the
+				 * recursion starts after the opcode it gets,
+				 * and the target itself may read FLAG */
+				for (next = op; next->next->offset != offset;
+				     next = next->next);
+
+				if (!is_gte_flags_unneeded(block, next))
+					return false;
+
+				last = next->next;
+				continue;
+			}
+		default: /* fall-through */
+			/* The FLAG register may be read after we leave the
+			 * block, so assume it is needed */
+			return false;
+		}
+	}
+
+	return last != NULL;
+}
+
+static int lightrec_flag_gte_flags(struct block *block)
+{
+	struct opcode *list, *prev;
+
+	if (!block->state->ops.cop2_ops.op_nf)
+		return 0;
+
+	for (list = block->opcode_list, prev = NULL; list;
+	     prev = list, list = list->next) {
+		if (!is_gte_cmd(list->c))
+			continue;
+
+		if (prev && has_delay_slot(prev->c))
+			continue;
+
+		if (is_gte_flags_unneeded(block, list)) {
+			pr_debug("Mark GTE opcode at offset 0x%x as not"
+				 " requiring the FLAG register\n",
+				 list->offset << 2);
+			list->flags |= LIGHTREC_NO_GTE_FLAGS;
+		}
+	}
+
+	return 0;
+}
+
+static bool has_local_branch_target(const struct block *block,
+				    u16 start, u16 end)
+{
+	const struct opcode *op;
+	s32 offset;
+
+	for (op = block->opcode_list; op; op = op->next) {
+		if (!(op->flags & LIGHTREC_LOCAL_BRANCH))
+			continue;
+
+		offset = op->offset + 1 + (s16)op->c.i.imm;
+		if (offset >= start && offset <= end)
+			return true;
+	}
+
+	return false;
+}
+
+static int lightrec_pair_gte_cmds(struct block *block)
+{
+	struct opcode *list, *next, *prev;
+
+	if (!block->state->ops.cop2_ops.op_pair)
+		return 0;
+
+	for (list = block->opcode_list, prev = NULL; list;
+	     prev = list, list = list->next) {
+		if (!is_gte_cmd(list->c) || (list->flags & LIGHTREC_GTE_PAIRED))
+			continue;
+
+		if (prev && has_delay_slot(prev->c))
+			continue;
+
+		/* Games usually pad GTE commands with NOPs to let the
+		 * previous command complete; skip over them */
+		for (next = list->next; next && !next->opcode; next = next->next);
+
+		if (!next || !is_gte_cmd(next->c) ||
+		    has_local_branch_target(block, list->offset + 1,
+					    next->offset))
+			continue;
+
+		pr_debug("Pair GTE opcodes at offsets 0x%x and 0x%x\n",
+			 list->offset << 2, next->offset << 2);
+
+		/* The second command always overwrites the FLAG register */
+		list->flags |= LIGHTREC_GTE_PAIR | LIGHTREC_NO_GTE_FLAGS;
+		next->flags |= LIGHTREC_GTE_PAIRED;
+	}
+
+	return 0;
+}
+
 static int (*lightrec_optimizers[])(struct block *) = {
 	&lightrec_detect_impossible_branches,
 	&lightrec_transform_ops,
@@ -1004,6 +1159,8 @@ static int (*lightrec_optimizers[])(struct block *) = {
 	&lightrec_switch_delay_slots,
 	&lightrec_flag_stores,
 	&lightrec_flag_mults,
+	&lightrec_flag_gte_flags,
+	&lightrec_pair_gte_cmds,
 	&lightrec_early_unload,
 };
 
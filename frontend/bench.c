@@ -0,0 +1,411 @@
+/*
+ * headless benchmark frontend
+ *
+ * Runs a fixed number of frames of a CD image or PS-X EXE (optionally
+ * starting from a savestate) as fast as possible, without video or sound output, and
+ * reports frames/s. When built with PCNT=1 the time is also broken down
+ * by subsystem using the pcnt.h counters.
+ *
+ * build:  make -f Makefile.libretro PCNT=1 pcsx_bench
+ *
+ * This work is licensed under the terms of the GNU GPLv2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../libpcsxcore/misc.h"
+#include "../libpcsxcore/psxcounters.h"
+#include "../libpcsxcore/psxmem_map.h"
+#include "../libpcsxcore/cdrom.h"
+#include "../libpcsxcore/r3000a.h"
+#include "../plugins/dfsound/out.h"
+#include "../plugins/dfsound/spu_config.h"
+#include "../plugins/dfinput/externals.h"
+#include "main.h"
+#include "plugin.h"
+#include "plugin_lib.h"
+#include "pcnt.h"
+
+/* things the core and plugins expect a frontend to provide */
+int in_type[8];
+int in_analog_left[8][2] = { { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 } };
+int in_analog_right[8][2] = { { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 }, { 127, 127 } };
+unsigned short in_keystate[8];
+int in_mouse[8][2];
+int multitap1;
+int multitap2;
+int in_enable_vibration;
+
+extern int stop;
+
+static int bench_frames;
+
+static int vout_open(void)
+{
+	return 0;
+}
+
+static void vout_set_mode(int w, int h, int raw_w, int raw_h, int bpp)
+{
+}
+
+static void vout_flip(const void *vram, int stride, int bgr24, int w, int h)
+{
+	pl_rearmed_cbs.flip_cnt++;
+}
+
+static void vout_close(void)
+{
+}
+
+static void *pl_mmap(unsigned int size)
+{
+	return psxMap(0, size, 0, MAP_TAG_VRAM);
+}
+
+static void pl_munmap(void *ptr, unsigned int size)
+{
+	psxUnmap(ptr, size, MAP_TAG_VRAM);
+}
+
+struct rearmed_cbs pl_rearmed_cbs = {
+	.pl_vout_open     = vout_open,
+	.pl_vout_set_mode = vout_set_mode,
+	.pl_vout_flip     = vout_flip,
+	.pl_vout_close    = vout_close,
+	.mmap             = pl_mmap,
+	.munmap           = pl_munmap,
+	/* from psxcounters */
+	.gpu_hcnt         = &hSyncCount,
+	.gpu_frame_count  = &frame_counter,
+	.fskip_audio_fill = -1,
+};
+
+static double get_time(void);
+
+void pl_frame_limit(void)
+{
+	static double frame_start;
+	double now = get_time();
+
+	/* for adaptive frameskip; nothing waits here, so this is all work */
+	if (frame_start != 0)
+		pl_rearmed_cbs.fskip_host_us = (int)((now - frame_start) * 1000000.0);
+	frame_start = now;
+
+	/* called once per frame, make psxCpu->Execute() return */
+	bench_frames++;
+	stop = 1;
+	pcnt_frame_end();
+	pcnt_start(PCNT_ALL);
+}
+
+void pl_timing_prepare(int is_pal)
+{
+}
+
+void pl_update_gun(int *xn, int *yn, int *xres, int *yres, int *in)
+{
+}
+
+void plat_trigger_vibrate(int pad, int low, int high)
+{
+}
+
+/* sound goes nowhere, but the SPU still does all of its work */
+static int snd_init(void)
+{
+	return 0;
+}
+
+static void snd_finish(void)
+{
+}
+
+static int snd_busy(void)
+{
+	return 0;
+}
+
+static void snd_feed(void *buf, int bytes)
+{
+}
+
+void out_register_libretro(struct out_driver *drv)
+{
+	drv->name   = "bench";
+	drv->init   = snd_init;
+	drv->finish = snd_finish;
+	drv->busy   = snd_busy;
+	drv->feed   = snd_feed;
+}
+
+void SysPrintf(const char *fmt, ...)
+{
+	va_list list;
+
+	va_start(list, fmt);
+	vfprintf(stderr, fmt, list);
+	va_end(list);
+}
+
+void SysDLog(const char *fmt, ...)
+{
+}
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static void run_frames(int count)
+{
+	int target = bench_frames + count;
+
+	while (bench_frames < target) {
+		stop = 0;
+		psxCpu->Execute();
+	}
+}
+
+#ifdef PCNT
+static void print_breakdown(int frames)
+{
+	static const int order[] = { PCNT_GPU, PCNT_SPU, PCNT_CDR, PCNT_MDEC,
+		PCNT_GTE, PCNT_REC, PCNT_BLIT, PCNT_DMA, PCNT_HLE };
+	const unsigned long long *c = pcounter_sums;
+	unsigned long long total, rem;
+	int i;
+
+	// cpu is whatever is left after the other (non-nested) counters
+	rem = pcnt_remainder(c);
+	total = c[PCNT_ALL];
+	if (!total)
+		total++;
+
+	printf("%-6s %12s %10s %6s\n", "", "total", "per frame", "%");
+	printf("%-6s %12llu %10.1f %5.1f%%\n", "cpu", rem / PCNT_DIV,
+		(double)rem / PCNT_DIV / frames, rem * 100.0 / total);
+	for (i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+		unsigned long long v = c[order[i]];
+		printf("%-6s %12llu %10.1f %5.1f%%%s\n", pcnt_names[order[i]], v / PCNT_DIV,
+			(double)v / PCNT_DIV / frames, v * 100.0 / total,
+			PCNT_NESTED & (1 << order[i]) ? " (includes others)" : "");
+	}
+	printf("%-6s %12llu %10.1f\n", "all", total / PCNT_DIV,
+		(double)total / PCNT_DIV / frames);
+}
+#endif
+
+static void usage(const char *argv0)
+{
+	printf("PCSX-ReARMed headless benchmark\n"
+		" %s [options] <cd image>\n"
+		" %s [options] -exe FILE\n"
+		"\toptions:\n"
+		"\t-exe FILE\tRuns a PSX EXE file without a CD\n"
+		"\t-frames N\tframes to measure (default 3000)\n"
+		"\t-warmup N\tframes to run before measuring (default 0)\n"
+		"\t-state FILE\tload savestate FILE before running\n"
+		"\t-bios FILE\tuse BIOS FILE instead of HLE\n"
+		"\t-cpu interp|drc\tCPU core (default drc)\n"
+		"\t-gpu PLUGIN\tGPU plugin .so (default builtin_gpu)\n"
+		"\t-fskip N\tGPU frameskip setting (default 0, -2 adaptive)\n"
+		"\t-gputhread\tprocess GPU commands on a worker thread (gpulib)\n"
+		"\t-gpupipe\tlike -gputhread, drawing frames in parallel with\n"
+		"\t\t\temulating the next one\n"
+		"\t-gpumemo\tskip drawing frames that repeat a static one (gpulib)\n"
+		"\t-gpubands N\tdraw on N threads, -1 one per cpu (gpulib, neon gpu)\n"
+		"\t-csv FILE\twrite per-frame counters to FILE (PCNT=1 builds)\n"
+		"\t-capture FILE\trecord GPU commands of the measured frames to FILE\n"
+		"\t\t\tfor plugins/gpulib replay_* (gpulib plugins only)\n"
+		"\t-capframes N\tframes to capture (default all)\n", argv0, argv0);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *cdfile = NULL;
+	const char *exe = NULL;
+	const char *state = NULL;
+	const char *bios = NULL;
+	const char *gpu = NULL;
+	const char *csv = NULL;
+	const char *capture = NULL;
+	int capture_frames = 0;
+	int cpu = CPU_DYNAREC;
+	int frames = 3000;
+	int warmup = 0;
+	int fskip = 0;
+	int gpu_thread = 0;
+	int gpu_memo = 0;
+	int gpu_bands = 0;
+	unsigned int memo_stats[2] = { 0, 0 };
+	unsigned int fskip_stats[3] = { 0, 0, 0 };
+	double start, elapsed;
+	unsigned int flips;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		     if (!strcmp(argv[i], "-frames") && i+1 < argc) frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-warmup") && i+1 < argc) warmup = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-exe") && i+1 < argc) exe = argv[++i];
+		else if (!strcmp(argv[i], "-state") && i+1 < argc) state = argv[++i];
+		else if (!strcmp(argv[i], "-bios") && i+1 < argc) bios = argv[++i];
+		else if (!strcmp(argv[i], "-gpu") && i+1 < argc) gpu = argv[++i];
+		else if (!strcmp(argv[i], "-csv") && i+1 < argc) csv = argv[++i];
+		else if (!strcmp(argv[i], "-fskip") && i+1 < argc) fskip = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-gputhread")) gpu_thread = 1;
+		else if (!strcmp(argv[i], "-gpupipe")) gpu_thread = 2;
+		else if (!strcmp(argv[i], "-gpumemo")) gpu_memo = 1;
+		else if (!strcmp(argv[i], "-gpubands") && i+1 < argc) gpu_bands = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-capture") && i+1 < argc) capture = argv[++i];
+		else if (!strcmp(argv[i], "-capframes") && i+1 < argc) capture_frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-cpu") && i+1 < argc) {
+			i++;
+			if (!strcmp(argv[i], "interp"))
+				cpu = CPU_INTERPRETER;
+			else if (!strcmp(argv[i], "drc"))
+				cpu = CPU_DYNAREC;
+			else {
+				usage(argv[0]);
+				return 1;
+			}
+		}
+		else if (argv[i][0] == '-') {
+			usage(argv[0]);
+			return argv[i][1] == 'h' ? 0 : 1;
+		}
+		else
+			cdfile = argv[i];
+	}
+	if ((cdfile == NULL && exe == NULL) || frames <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	emu_core_preinit();
+	Config.Cpu = cpu;
+	if (bios != NULL) {
+		const char *p = strrchr(bios, '/');
+		if (p != NULL) {
+			snprintf(Config.BiosDir, sizeof(Config.BiosDir),
+				"%.*s", (int)(p - bios), bios);
+			bios = p + 1;
+		}
+		else
+			strcpy(Config.BiosDir, ".");
+		snprintf(Config.Bios, sizeof(Config.Bios), "%s", bios);
+	}
+	if (gpu != NULL)
+		snprintf(Config.Gpu, sizeof(Config.Gpu), "%s", gpu);
+
+	// the SPU thread would hide its cost from the measurements
+	spu_config.iUseThread = 0;
+	pl_rearmed_cbs.frameskip = fskip;
+	pl_rearmed_cbs.gpu_thread = gpu_thread;
+	pl_rearmed_cbs.gpu_memo = gpu_memo;
+	pl_rearmed_cbs.gpu_bands = gpu_bands;
+	pl_rearmed_cbs.gpu_memo_stats = memo_stats;
+	pl_rearmed_cbs.fskip_stats = fskip_stats;
+	in_type[0] = in_type[1] = PSE_PAD_TYPE_STANDARD;
+
+	if (emu_core_init() != 0)
+		return 1;
+
+	if (cdfile != NULL)
+		set_cd_image(cdfile);
+	if (LoadPlugins() == -1) {
+		SysPrintf("failed to load plugins\n");
+		return 1;
+	}
+	pcnt_hook_plugins();
+
+	if (OpenPlugins() == -1) {
+		SysPrintf("failed to open plugins\n");
+		return 1;
+	}
+	plugin_call_rearmed_cbs();
+	dfinput_activate();
+
+	if (CheckCdrom() == -1 && exe == NULL) {
+		SysPrintf("unsupported/invalid CD image: %s\n", cdfile);
+		return 1;
+	}
+	SysReset();
+	if (exe != NULL) {
+		if (Load(exe) == -1) {
+			SysPrintf("could not load EXE: %s\n", exe);
+			return 1;
+		}
+	}
+	else {
+		if (LoadCdrom() == -1) {
+			SysPrintf("could not load CD\n");
+			return 1;
+		}
+		emu_on_new_cd(0);
+	}
+
+	if (state != NULL && LoadState(state) != 0) {
+		SysPrintf("failed to load state file: %s\n", state);
+		return 1;
+	}
+
+	run_frames(warmup);
+
+	if (capture != NULL) {
+		// starts at the end of the next frame
+		pl_rearmed_cbs.gpu_capture = capture;
+		pl_rearmed_cbs.gpu_capture_frames = capture_frames ? capture_frames : frames;
+		plugin_call_rearmed_cbs();
+	}
+
+	pcnt_end(PCNT_ALL); // running since the warmup
+#ifdef PCNT
+	memset(pcounter_sums, 0, sizeof(pcounter_sums));
+	memset(pcounters, 0, sizeof(pcounters));
+#endif
+	if (csv != NULL && pcnt_csv_open(csv) != 0)
+		SysPrintf("per-frame csv output disabled\n");
+	pcnt_start(PCNT_ALL);
+	flips = pl_rearmed_cbs.flip_cnt;
+	memo_stats[0] = memo_stats[1] = 0;
+	fskip_stats[0] = fskip_stats[1] = 0;
+	start = get_time();
+
+	run_frames(frames);
+
+	elapsed = get_time() - start;
+	flips = pl_rearmed_cbs.flip_cnt - flips;
+
+	printf("%s: %s, cpu %s, gpu %s\n", exe ? exe : cdfile, CdromId,
+		cpu == CPU_INTERPRETER ? "interp" : "drc", Config.Gpu);
+	printf("%d frames (%u flips) in %.3f s: %.2f fps\n",
+		frames, flips, elapsed, frames / elapsed);
+	if (gpu_memo && memo_stats[0] != 0)
+		printf("gpu frame cache: %u of %u frames not drawn (%.1f%%)\n",
+			memo_stats[1], memo_stats[0], memo_stats[1] * 100.0 / memo_stats[0]);
+	if (fskip != 0 && fskip_stats[0] != 0)
+		printf("frameskip: %u of %u frames skipped (%.1f%%)%s\n",
+			fskip_stats[1], fskip_stats[0], fskip_stats[1] * 100.0 / fskip_stats[0],
+			fskip == -2 ? ", adaptive" : "");
+#ifdef PCNT
+	print_breakdown(frames);
+#else
+	printf("(build with PCNT=1 for a per-subsystem breakdown)\n");
+#endif
+
+	ClosePlugins();
+	SysClose();
+
+	return 0;
+}
@@ -34,6 +34,22 @@ void bgr555_to_rgb565(void *dst_, const void *src_, int bytes)
 
 #endif
 
+// for frontends that take 0RGB1555, only red and blue need swapping
+void bgr555_to_xrgb1555(void *dst_, const void *src_, int bytes)
+{
+	const unsigned int *src = src_;
+	unsigned int *dst = dst_;
+	unsigned int p;
+	int x;
+
+	for (x = 0; x < bytes / 4; x++) {
+		p = src[x];
+		p = ((p & 0x7c007c00) >> 10) | (p & 0x03e003e0)
+			| ((p & 0x001f001f) << 10);
+		dst[x] = p;
+	}
+}
+
 #ifdef __arm64__
 
 void bgr888_to_rgb565(void *dst_, const void *src_, int bytes)
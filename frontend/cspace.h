@@ -7,6 +7,7 @@ extern "C"
 #endif
 
 void bgr555_to_rgb565(void *dst, const void *src, int bytes);
+void bgr555_to_xrgb1555(void *dst, const void *src, int bytes);
 void bgr888_to_rgb888(void *dst, const void *src, int bytes);
 void bgr888_to_rgb565(void *dst, const void *src, int bytes);
 void rgb888_to_rgb565(void *dst, const void *src, int bytes);
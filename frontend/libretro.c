@@ -55,6 +55,16 @@
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
 
+#ifndef RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK
+// from newer libretro.h
+#define RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK 62
+typedef void (RETRO_CALLCONV *retro_audio_buffer_status_callback_t)(
+   bool active, unsigned occupancy, bool underrun_likely);
+struct retro_audio_buffer_status_callback {
+   retro_audio_buffer_status_callback_t callback;
+};
+#endif
+
 #define ISHEXDEC ((buf[cursor] >= '0') && (buf[cursor] <= '9')) || ((buf[cursor] >= 'a') && (buf[cursor] <= 'f')) || ((buf[cursor] >= 'A') && (buf[cursor] <= 'F'))
 
 #define INTERNAL_FPS_SAMPLE_PERIOD 64
@@ -77,17 +87,32 @@ static void *vout_buf;
 static void *vout_buf_ptr;
 static int vout_width, vout_height;
 static int vout_doffs_old, vout_fb_dirty;
+static int vout_last_w, vout_last_bgr24; // of the last flip to vout_buf
+static bool vout_buf_valid;
+// what the frontend agreed to, 0RGB1555 is the libretro default
+static enum retro_pixel_format vout_fmt = RETRO_PIXEL_FORMAT_0RGB1555;
+static unsigned int gpu_memo_stats[2];
+static unsigned int fskip_stats[3];
+static int audio_buffer_fill = -1;
+static bool audio_buffer_status_set;
+static struct retro_perf_callback perf_cb;
 static bool vout_can_dupe;
 static bool duping_enable;
 static bool found_bios;
 static bool display_internal_fps = false;
 static unsigned frame_count = 0;
+#ifdef GPU_NEON
+static struct gpu_neon_stats neon_stats_sum;
+static unsigned neon_stats_frames;
+#endif
 static bool libretro_supports_bitmasks = false;
 #ifdef GPU_PEOPS
 static int show_advanced_gpu_peops_settings = -1;
 #endif
 #ifdef GPU_UNAI
 static int show_advanced_gpu_unai_settings = -1;
+static struct gpu_unai_stats unai_stats_sum;
+static unsigned unai_stats_frames;
 #endif
 static int show_other_input_settings = -1;
 static float mouse_sensitivity = 1.0f;
@@ -205,7 +230,7 @@ static void set_vout_fb()
    fb.height         = vout_height;
    fb.access_flags   = RETRO_MEMORY_ACCESS_WRITE;
 
-   if (environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) && fb.format == RETRO_PIXEL_FORMAT_RGB565)
+   if (environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) && fb.format == vout_fmt)
       vout_buf_ptr = (uint16_t *)fb.data;
    else
       vout_buf_ptr = vout_buf;
@@ -215,6 +240,7 @@ static void vout_set_mode(int w, int h, int raw_w, int raw_h, int bpp)
 {
    vout_width = w;
    vout_height = h;
+   vout_buf_valid = false;
 
    if (previous_width != vout_width || previous_height != vout_height)
    {
@@ -229,7 +255,6 @@ static void vout_set_mode(int w, int h, int raw_w, int raw_h, int bpp)
    set_vout_fb();
 }
 
-#ifndef FRONTEND_SUPPORTS_RGB565
 static void convert(void *buf, size_t bytes)
 {
    unsigned int i, v, *p = buf;
@@ -240,15 +265,46 @@ static void convert(void *buf, size_t bytes)
       p[i] = (v & 0x001f001f) | ((v >> 1) & 0x7fe07fe0);
    }
 }
-#endif
+
+static void vout_convert_lines(unsigned short *dest, int dstride,
+   const unsigned short *src, int stride, int bgr24, int w, int h)
+{
+   if (bgr24)
+   {
+      // XXX: could we switch to RETRO_PIXEL_FORMAT_XRGB8888 here?
+      for (; h-- > 0; dest += dstride, src += stride)
+      {
+         bgr888_to_rgb565(dest, src, w * 3);
+         if (vout_fmt != RETRO_PIXEL_FORMAT_RGB565)
+            convert(dest, w * 2);
+      }
+   }
+   else if (vout_fmt != RETRO_PIXEL_FORMAT_RGB565)
+   {
+      // 0RGB1555 differs from psx vram only in the red/blue order,
+      // so go there directly and not through rgb565
+      for (; h-- > 0; dest += dstride, src += stride)
+      {
+         bgr555_to_xrgb1555(dest, src, w * 2);
+      }
+   }
+   else
+   {
+      for (; h-- > 0; dest += dstride, src += stride)
+      {
+         bgr555_to_rgb565(dest, src, w * 2);
+      }
+   }
+}
 
 static void vout_flip(const void *vram, int stride, int bgr24, int w, int h)
 {
    unsigned short *dest = vout_buf_ptr;
    const unsigned short *src = vram;
-   int dstride = vout_width, h1 = h;
+   int dstride = vout_width;
    int doffs;
 
+   vout_buf_valid = false;
    if (vram == NULL)
    {
       // blanking
@@ -266,26 +322,47 @@ static void vout_flip(const void *vram, int stride, int bgr24, int w, int h)
    }
    dest += doffs;
 
-   if (bgr24)
+   vout_convert_lines(dest, dstride, src, stride, bgr24, w, h);
+
+   // frontend provided buffers may not keep their contents
+   vout_buf_valid = vout_buf_ptr == vout_buf;
+   vout_last_w = w;
+   vout_last_bgr24 = bgr24;
+
+out:
+   vout_fb_dirty = 1;
+   pl_rearmed_cbs.flip_cnt++;
+}
+
+// only lines y1..y2-1 changed, the rest is still in vout_buf
+static void vout_flip_part(const void *vram, int stride, int bgr24,
+   int w, int h, int y1, int y2)
+{
+   unsigned short *dest = vout_buf_ptr;
+   const unsigned short *src = vram;
+   int dstride = vout_width;
+   int doffs;
+
+   doffs = (vout_height - h) * dstride;
+   doffs += (dstride - w) / 2 & ~1;
+   if (!vout_buf_valid || vout_buf_ptr != vout_buf || doffs != vout_doffs_old
+       || w != vout_last_w || bgr24 != vout_last_bgr24)
    {
-      // XXX: could we switch to RETRO_PIXEL_FORMAT_XRGB8888 here?
-      for (; h1-- > 0; dest += dstride, src += stride)
-      {
-         bgr888_to_rgb565(dest, src, w * 3);
-      }
+      vout_flip(vram, stride, bgr24, w, h);
+      return;
    }
-   else
+
+   // dirty lines all off screen, vout_buf already has this frame
+   if (y2 <= y1)
    {
-      for (; h1-- > 0; dest += dstride, src += stride)
-      {
-         bgr555_to_rgb565(dest, src, w * 2);
-      }
+      pl_rearmed_cbs.flip_cnt++;
+      return;
    }
 
-out:
-#ifndef FRONTEND_SUPPORTS_RGB565
-   convert(vout_buf_ptr, vout_width * vout_height * 2);
-#endif
+   dest += doffs + y1 * dstride;
+   src += y1 * stride;
+   vout_convert_lines(dest, dstride, src, stride, bgr24, w, y2 - y1);
+
    vout_fb_dirty = 1;
    pl_rearmed_cbs.flip_cnt++;
 }
@@ -466,11 +543,14 @@ struct rearmed_cbs pl_rearmed_cbs = {
    .pl_vout_set_mode = vout_set_mode,
    .pl_vout_flip     = vout_flip,
    .pl_vout_close    = vout_close,
+   .pl_vout_flip_part = vout_flip_part,
    .mmap             = pl_mmap,
    .munmap           = pl_munmap,
    /* from psxcounters */
    .gpu_hcnt         = &hSyncCount,
    .gpu_frame_count  = &frame_counter,
+   .fskip_audio_fill = -1,
+   .fskip_stats      = fskip_stats,
 };
 
 void pl_frame_limit(void)
@@ -501,6 +581,27 @@ void pl_update_gun(int *xn, int *yn, int *xres, int *yres, int *in)
 }
 
 /* sound calls */
+static void audio_buffer_status_cb(bool active, unsigned occupancy,
+   bool underrun_likely)
+{
+   audio_buffer_fill = !active ? -1 : underrun_likely ? 0 : (int)occupancy;
+}
+
+// only ask for the audio buffer level when adaptive frameskip uses it
+static void update_audio_buffer_status(void)
+{
+   struct retro_audio_buffer_status_callback cb = { audio_buffer_status_cb };
+   bool want = pl_rearmed_cbs.frameskip == -2;
+
+   if (want == audio_buffer_status_set)
+      return;
+   audio_buffer_fill = -1;
+   audio_buffer_status_set = want && environ_cb(
+      RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &cb);
+   if (!want)
+      environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+}
+
 static void snd_feed(void *buf, int bytes)
 {
    if (audio_batch_cb != NULL)
@@ -1300,6 +1401,7 @@ bool retro_load_game(const struct retro_game_info *info)
    if (environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
    {
       SysPrintf("RGB565 supported, using it\n");
+      vout_fmt = fmt;
    }
 #endif
 
@@ -1522,6 +1624,97 @@ static int GunconAdjustY = 0;
 static float GunconAdjustRatioX = 1;
 static float GunconAdjustRatioY = 1;
 
+#ifdef GPU_NEON
+// called by the renderer after each frame, logs averages over a few frames
+static void neon_stats_add(const struct gpu_neon_stats *s)
+{
+   struct gpu_neon_stats *t = &neon_stats_sum;
+   unsigned n;
+
+   t->triangles += s->triangles;
+   t->sprites += s->sprites;
+   t->lines += s->lines;
+   t->trivial_rejects += s->trivial_rejects;
+   t->span_pixels += s->span_pixels;
+   t->render_buffer_flushes += s->render_buffer_flushes;
+   t->state_changes += s->state_changes;
+   t->texture_cache_loads += s->texture_cache_loads;
+   t->texture_cache_bytes += s->texture_cache_bytes;
+   t->us_triangles += s->us_triangles;
+   t->us_sprites += s->us_sprites;
+   t->us_lines += s->us_lines;
+   t->us_fill_copy += s->us_fill_copy;
+   t->us_texture_cache += s->us_texture_cache;
+
+   if (++neon_stats_frames < INTERNAL_FPS_SAMPLE_PERIOD)
+      return;
+
+   n = neon_stats_frames;
+   if (log_cb)
+   {
+      log_cb(RETRO_LOG_INFO, "gpu_neon per frame: %u tris (%u rejected), "
+         "%u sprites, %u lines, %u pixels, %u flushes, %u state changes, "
+         "%u tex cache loads (%u bytes)\n", t->triangles / n,
+         t->trivial_rejects / n, t->sprites / n, t->lines / n,
+         t->span_pixels / n, t->render_buffer_flushes / n,
+         t->state_changes / n, t->texture_cache_loads / n,
+         t->texture_cache_bytes / n);
+      log_cb(RETRO_LOG_INFO, "gpu_neon us per frame: tris %u, sprites %u, "
+         "lines %u, fill/copy %u, tex cache %u\n", t->us_triangles / n,
+         t->us_sprites / n, t->us_lines / n, t->us_fill_copy / n,
+         t->us_texture_cache / n);
+   }
+   neon_stats_frames = 0;
+   memset(t, 0, sizeof(*t));
+}
+#endif
+
+#ifdef GPU_UNAI
+// called by gpu_unai after each frame, logs averages over a few frames
+static void unai_stats_add(const struct gpu_unai_stats *s)
+{
+   struct gpu_unai_stats *t = &unai_stats_sum;
+   unsigned n;
+
+   t->polys += s->polys;
+   t->sprites += s->sprites;
+   t->lines += s->lines;
+   t->fills += s->fills;
+   t->image_moves += s->image_moves;
+   t->px_polys += s->px_polys;
+   t->px_sprites += s->px_sprites;
+   t->px_lines += s->px_lines;
+   t->px_fills += s->px_fills;
+   t->px_image_moves += s->px_image_moves;
+   t->us_polys += s->us_polys;
+   t->us_sprites += s->us_sprites;
+   t->us_lines += s->us_lines;
+   t->us_fills += s->us_fills;
+   t->us_image_moves += s->us_image_moves;
+   t->us_other += s->us_other;
+
+   if (++unai_stats_frames < INTERNAL_FPS_SAMPLE_PERIOD)
+      return;
+
+   n = unai_stats_frames;
+   if (log_cb)
+   {
+      log_cb(RETRO_LOG_INFO, "gpu_unai per frame: %u polys (%u px), "
+         "%u sprites (%u px), %u lines (%u px), %u fills (%u px), "
+         "%u moves (%u px)\n", t->polys / n, t->px_polys / n,
+         t->sprites / n, t->px_sprites / n, t->lines / n, t->px_lines / n,
+         t->fills / n, t->px_fills / n, t->image_moves / n,
+         t->px_image_moves / n);
+      log_cb(RETRO_LOG_INFO, "gpu_unai us per frame: polys %u, sprites %u, "
+         "lines %u, fills %u, moves %u, other %u\n", t->us_polys / n,
+         t->us_sprites / n, t->us_lines / n, t->us_fills / n,
+         t->us_image_moves / n, t->us_other / n);
+   }
+   unai_stats_frames = 0;
+   memset(t, 0, sizeof(*t));
+}
+#endif
+
 static void update_variables(bool in_flight)
 {
    struct retro_variable var;
@@ -1533,7 +1726,19 @@ static void update_variables(bool in_flight)
    var.value = NULL;
    var.key = "pcsx_rearmed_frameskip";
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
-      pl_rearmed_cbs.frameskip = atoi(var.value);
+   {
+      if (strcmp(var.value, "adaptive") == 0)
+         pl_rearmed_cbs.frameskip = -2;
+      else
+         pl_rearmed_cbs.frameskip = atoi(var.value);
+   }
+
+   var.value = NULL;
+   var.key = "pcsx_rearmed_frameskip_max";
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      pl_rearmed_cbs.fskip_max = atoi(var.value);
+
+   update_audio_buffer_status();
 
    var.value = NULL;
    var.key = "pcsx_rearmed_region";
@@ -1660,6 +1865,32 @@ static void update_variables(bool in_flight)
       else if (strcmp(var.value, "enabled") == 0)
          pl_rearmed_cbs.gpu_neon.enhancement_no_main = 1;
    }
+
+   var.value = NULL;
+   var.key = "pcsx_rearmed_neon_bands";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_bands = 0;
+      else if (strcmp(var.value, "auto") == 0)
+         pl_rearmed_cbs.gpu_bands = -1;
+      else
+         pl_rearmed_cbs.gpu_bands = atoi(var.value);
+   }
+
+   var.value = NULL;
+   var.key = "pcsx_rearmed_neon_stats";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_neon.stats = NULL;
+      else if (strcmp(var.value, "enabled") == 0)
+         pl_rearmed_cbs.gpu_neon.stats = neon_stats_add;
+      neon_stats_frames = 0;
+      memset(&neon_stats_sum, 0, sizeof(neon_stats_sum));
+   }
 #endif
 
    var.value = NULL;
@@ -1673,6 +1904,31 @@ static void update_variables(bool in_flight)
          duping_enable = true;
    }
 
+   var.value = NULL;
+   var.key = "pcsx_rearmed_gpu_thread";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_thread = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         pl_rearmed_cbs.gpu_thread = 1;
+      else if (strcmp(var.value, "pipelined") == 0)
+         pl_rearmed_cbs.gpu_thread = 2;
+   }
+
+   var.value = NULL;
+   var.key = "pcsx_rearmed_gpu_memo";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_memo = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         pl_rearmed_cbs.gpu_memo = 1;
+      pl_rearmed_cbs.gpu_memo_stats = gpu_memo_stats;
+   }
+
    var.value = NULL;
    var.key = "pcsx_rearmed_display_internal_fps";
 
@@ -2010,6 +2266,32 @@ static void update_variables(bool in_flight)
          pl_rearmed_cbs.gpu_unai.scale_hires = 1;
    }
 
+#ifdef GPU_UNAI_JIT
+   var.key = "pcsx_rearmed_gpu_unai_jit";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_unai.jit = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         pl_rearmed_cbs.gpu_unai.jit = 1;
+   }
+#endif
+
+   var.key = "pcsx_rearmed_gpu_unai_stats";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         pl_rearmed_cbs.gpu_unai.stats = NULL;
+      else if (strcmp(var.value, "enabled") == 0)
+         pl_rearmed_cbs.gpu_unai.stats = unai_stats_add;
+      unai_stats_frames = 0;
+      memset(&unai_stats_sum, 0, sizeof(unai_stats_sum));
+   }
+
    var.key = "pcsx_rearmed_show_gpu_unai_settings";
    var.value = NULL;
 
@@ -2025,18 +2307,22 @@ static void update_variables(bool in_flight)
       {
          unsigned i;
          struct retro_core_option_display option_display;
-         char gpu_unai_option[6][40] = {
+         char gpu_unai_option[][40] = {
             "pcsx_rearmed_gpu_unai_blending",
             "pcsx_rearmed_gpu_unai_lighting",
             "pcsx_rearmed_gpu_unai_fast_lighting",
             "pcsx_rearmed_gpu_unai_ilace_force",
             "pcsx_rearmed_gpu_unai_pixel_skip",
-            "pcsx_rearmed_gpu_unai_scale_hires"
+            "pcsx_rearmed_gpu_unai_scale_hires",
+#ifdef GPU_UNAI_JIT
+            "pcsx_rearmed_gpu_unai_jit",
+#endif
+            "pcsx_rearmed_gpu_unai_stats",
          };
 
          option_display.visible = show_advanced_gpu_unai_settings;
 
-         for (i = 0; i < 6; i++)
+         for (i = 0; i < sizeof(gpu_unai_option) / sizeof(gpu_unai_option[0]); i++)
          {
             option_display.key = gpu_unai_option[i];
             environ_cb(RETRO_ENVIRONMENT_SET_CORE_OPTIONS_DISPLAY, &option_display);
@@ -2512,9 +2798,18 @@ static void print_internal_fps(void)
 
          str[0] = '\0';
 
-         snprintf(str, sizeof(str), "Internal FPS: %2d", internal_fps);
+         if (pl_rearmed_cbs.gpu_memo && gpu_memo_stats[0] != 0)
+            snprintf(str, sizeof(str), "Internal FPS: %2d, %u%% frames cached",
+               internal_fps, gpu_memo_stats[1] * 100 / gpu_memo_stats[0]);
+         else if (pl_rearmed_cbs.frameskip == -2 && fskip_stats[0] != 0)
+            snprintf(str, sizeof(str), "Internal FPS: %2d, %u%% skipped (level %u)",
+               internal_fps, fskip_stats[1] * 100 / fskip_stats[0], fskip_stats[2]);
+         else
+            snprintf(str, sizeof(str), "Internal FPS: %2d", internal_fps);
 
          pl_rearmed_cbs.flip_cnt = 0;
+         gpu_memo_stats[0] = gpu_memo_stats[1] = 0;
+         fskip_stats[0] = fskip_stats[1] = 0;
 
          if (msg_interface_version >= 1)
          {
@@ -2568,7 +2863,16 @@ void retro_run(void)
       update_variables(true);
 
    stop = 0;
-   psxCpu->Execute();
+   if (pl_rearmed_cbs.frameskip == -2)
+   {
+      retro_time_t start = perf_cb.get_time_usec ? perf_cb.get_time_usec() : 0;
+      psxCpu->Execute();
+      pl_rearmed_cbs.fskip_host_us = perf_cb.get_time_usec ?
+         (int)(perf_cb.get_time_usec() - start) : 0;
+      pl_rearmed_cbs.fskip_audio_fill = audio_buffer_fill;
+   }
+   else
+      psxCpu->Execute();
 
    video_cb((vout_fb_dirty || !vout_can_dupe || !duping_enable) ? vout_buf_ptr : NULL,
        vout_width, vout_height, vout_width * 2);
@@ -2817,6 +3121,8 @@ void retro_init(void)
    loadPSXBios();
 
    environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &vout_can_dupe);
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf_cb))
+      perf_cb.get_time_usec = NULL;
 
    disk_initial_index = 0;
    disk_initial_path[0] = '\0';
@@ -2854,6 +3160,11 @@ void retro_init(void)
 
 void retro_deinit(void)
 {
+   if (audio_buffer_status_set)
+   {
+      environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+      audio_buffer_status_set = false;
+   }
    if (plugins_opened)
    {
       ClosePlugins();
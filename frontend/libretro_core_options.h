@@ -53,16 +53,29 @@ struct retro_core_option_definition option_defs_us[] = {
    {
       "pcsx_rearmed_frameskip",
       "Frameskip",
-      "Choose how much frames should be skipped to improve performance at the expense of visual smoothness.",
+      "Choose how much frames should be skipped to improve performance at the expense of visual smoothness. 'Adaptive' skips only as much as needed to keep up, judging by the time each frame takes and the audio buffer level.",
       {
          { "0", NULL },
          { "1", NULL },
          { "2", NULL },
          { "3", NULL },
+         { "adaptive", "Adaptive" },
          { NULL, NULL },
       },
       "0",
    },
+   {
+      "pcsx_rearmed_frameskip_max",
+      "Frameskip Max (Adaptive)",
+      "Most frames that adaptive frameskip may skip in a row.",
+      {
+         { "1", NULL },
+         { "2", NULL },
+         { "3", NULL },
+         { NULL, NULL },
+      },
+      "3",
+   },
    {
       "pcsx_rearmed_bios",
       "Use BIOS",
@@ -754,6 +767,30 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      "pcsx_rearmed_neon_bands",
+      "Multi-threaded Rendering",
+      "Splits the screen into horizontal bands drawn by separate threads. 'auto' uses one per CPU core. Not used with interlacing. With Enhanced Resolution the native and the scaled image are drawn side by side instead, on multi-core systems even when this is disabled.",
+      {
+         { "disabled", NULL },
+         { "auto",     NULL },
+         { "2",        NULL },
+         { "4",        NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
+   {
+      "pcsx_rearmed_neon_stats",
+      "Renderer Statistics",
+      "Logs the primitives drawn and the time spent on each kind, averaged every 64 frames. For performance tuning, the timing itself has a small cost.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
 #endif /* GPU_NEON */
 
    {
@@ -778,6 +815,29 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      "pcsx_rearmed_gpu_thread",
+      "Threaded GPU Command Processing",
+      "Runs GPU commands on a separate thread, overlapping rendering with CPU emulation. 'pipelined' draws a whole frame while the next one is emulated, which overlaps more but adds a frame of latency and may break games that poll GPU status. Needs a multi-core host, has no effect with the OpenGL GPU plugin.",
+      {
+         { "disabled",  NULL },
+         { "enabled",   NULL },
+         { "pipelined", NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
+   {
+      "pcsx_rearmed_gpu_memo",
+      "Static Frame Cache",
+      "Skips drawing frames that repeat an unchanged previous frame exactly, as in menus and pause screens, and shows the previous output again. Costs some memory and time comparing frames in scenes that do change. Has no effect with the OpenGL GPU plugin.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
 
    /* GPU PEOPS OPTIONS */
 #ifdef GPU_PEOPS
@@ -972,6 +1032,30 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled",
    },
+#ifdef GPU_UNAI_JIT
+   {
+      "pcsx_rearmed_gpu_unai_jit",
+      "(GPU) Compile Span Renderers",
+      "When enabled, the inner drawing loops are compiled at runtime for the combinations a game uses. Faster on most systems.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
+#endif
+   {
+      "pcsx_rearmed_gpu_unai_stats",
+      "(GPU) Renderer Statistics",
+      "Logs the primitives drawn, the pixels they cover and the time spent on each kind, averaged every 64 frames. For performance tuning, the timing itself has a small cost.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
 #endif /* GPU UNAI Advanced Settings */
 
    {
@@ -203,8 +203,9 @@ do_state_slot:
 		pl_rearmed_cbs.fskip_advice = 0;
 		pl_rearmed_cbs.frameskip++;
 		if (pl_rearmed_cbs.frameskip > 1)
-			pl_rearmed_cbs.frameskip = -1;
+			pl_rearmed_cbs.frameskip = -2;
 		snprintf(hud_msg, sizeof(hud_msg), "FRAMESKIP: %s",
+			pl_rearmed_cbs.frameskip == -2 ? "ADAPTIVE" :
 			pl_rearmed_cbs.frameskip == -1 ? "AUTO" :
 			pl_rearmed_cbs.frameskip == 0 ? "OFF" : "1" );
 		plugin_call_rearmed_cbs();
@@ -550,6 +551,10 @@ int main(int argc, char *argv[])
 			if (i+1 >= argc) break;
 			loadst_f = argv[++i];
 		}
+		else if (!strcmp(argv[i], "-pcntcsv")) {
+			if (i+1 >= argc) break;
+			pcnt_csv_open(argv[++i]);
+		}
 		else if (!strcmp(argv[i], "-h") ||
 			 !strcmp(argv[i], "-help") ||
 			 !strcmp(argv[i], "--help")) {
@@ -561,6 +566,7 @@ int main(int argc, char *argv[])
 							"\t-cfg FILE\tLoads desired configuration file (default: ~/.pcsx/pcsx.cfg)\n"
 							"\t-psxout\t\tEnable PSX output\n"
 							"\t-load STATENUM\tLoads savestate STATENUM (1-5)\n"
+							"\t-pcntcsv FILE\tWrite per-frame profile counters to FILE (PCNT builds)\n"
 							"\t-h -help\tDisplay this message\n"
 							"\tfile\t\tLoads a PSX EXE file\n"));
 			 return 0;
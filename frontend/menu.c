@@ -320,7 +320,8 @@ static void menu_sync_config(void)
 	}
 
 	spu_config.iVolume = 768 + 128 * volume_boost;
-	pl_rearmed_cbs.frameskip = frameskip - 1;
+	// "Adaptive" came later, so it's last in the list
+	pl_rearmed_cbs.frameskip = frameskip == 5 ? -2 : frameskip - 1;
 	pl_timing_prepare(Config.PsxType);
 }
 
@@ -1554,6 +1555,8 @@ static int menu_loop_speed_hacks(int id, int keys)
 static const char h_cfg_cpul[]   = "Shows CPU usage in %";
 static const char h_cfg_spu[]    = "Shows active SPU channels\n"
 				   "(green: normal, red: fmod, blue: noise)";
+static const char h_cfg_gpus[]   = "Shows primitives drawn per frame and the time\n"
+				   "spent on each kind in us (NEON and Unai GPUs only)";
 static const char h_cfg_fl[]     = "Frame Limiter keeps the game from running too fast";
 static const char h_cfg_xa[]     = "Disables XA sound, which can sometimes improve performance";
 static const char h_cfg_cdda[]   = "Disable CD Audio for a performance boost\n"
@@ -1573,6 +1576,7 @@ static menu_entry e_menu_adv_options[] =
 {
 	mee_onoff_h   ("Show CPU load",          0, g_opts, OPT_SHOWCPU, h_cfg_cpul),
 	mee_onoff_h   ("Show SPU channels",      0, g_opts, OPT_SHOWSPU, h_cfg_spu),
+	mee_onoff_h   ("Show GPU stats",         0, g_opts, OPT_SHOWGPU, h_cfg_gpus),
 	mee_onoff_h   ("Disable Frame Limiter",  0, g_opts, OPT_NO_FRAMELIM, h_cfg_fl),
 	mee_onoff_h   ("Disable XA Decoding",    0, Config.Xa, 1, h_cfg_xa),
 	mee_onoff_h   ("Disable CD Audio",       0, Config.Cdda, 1, h_cfg_cdda),
@@ -1602,7 +1606,7 @@ static int mh_restore_defaults(int id, int keys)
 }
 
 static const char *men_region[]       = { "Auto", "NTSC", "PAL", NULL };
-static const char *men_frameskip[]    = { "Auto", "Off", "1", "2", "3", NULL };
+static const char *men_frameskip[]    = { "Auto", "Off", "1", "2", "3", "Adaptive", NULL };
 /*
 static const char *men_confirm_save[] = { "OFF", "writes", "loads", "both", NULL };
 static const char h_confirm_save[]    = "Ask for confirmation when overwriting save,\n"
@@ -1610,7 +1614,9 @@ static const char h_confirm_save[]    = "Ask for confirmation when overwriting s
 */
 static const char h_restore_def[]     = "Switches back to default / recommended\n"
 					"configuration";
-static const char h_frameskip[]       = "Warning: frameskip sometimes causes glitches\n";
+static const char h_frameskip[]       = "Warning: frameskip sometimes causes glitches\n"
+					"Adaptive skips only when the emulation\n"
+					"or the sound output falls behind";
 
 static menu_entry e_menu_options[] =
 {
@@ -271,15 +271,65 @@ void plugin_call_rearmed_cbs(void)
 /* basic profile stuff */
 #include "pcnt.h"
 
-unsigned int pcounters[PCNT_CNT];
-unsigned int pcounter_starts[PCNT_CNT];
+unsigned long long pcounters[PCNT_CNT];
+pcnt_t pcounter_starts[PCNT_CNT];
+unsigned int pcounter_depth[PCNT_CNT];
+unsigned long long pcounter_sums[PCNT_CNT];
+#if defined(__i386__) || defined(__x86_64__)
+unsigned int pcnt_tsc_div = 1;
+#endif
+
+static FILE *pcnt_csv;
+static unsigned int pcnt_csv_frame;
+
+int pcnt_csv_open(const char *fname)
+{
+	int i;
+
+	pcnt_csv = fopen(fname, "w");
+	if (pcnt_csv == NULL) {
+		perror(fname);
+		return -1;
+	}
+
+	fprintf(pcnt_csv, "frame,all");
+	for (i = 1; i < PCNT_CNT; i++)
+		fprintf(pcnt_csv, ",%s", pcnt_names[i]);
+	fprintf(pcnt_csv, ",rem\n");
+	return 0;
+}
+
+static void pcnt_csv_write(void)
+{
+	int i;
+
+	fprintf(pcnt_csv, "%u", pcnt_csv_frame++);
+	for (i = 0; i < PCNT_CNT; i++)
+		fprintf(pcnt_csv, ",%.1f", (double)pcounters[i] / PCNT_DIV);
+	fprintf(pcnt_csv, ",%.1f\n", (double)pcnt_remainder(pcounters) / PCNT_DIV);
+}
+
+// called by the frontend once per emulated frame
+void pcnt_frame_end(void)
+{
+	int i;
+
+	pcnt_end(PCNT_ALL);
+
+	if (pcnt_csv != NULL)
+		pcnt_csv_write();
+
+	for (i = 0; i < PCNT_CNT; i++)
+		pcounter_sums[i] += pcounters[i];
+	memset(pcounters, 0, sizeof(pcounters));
+}
 
 #define pc_hook_func(name, args, pargs, cnt) \
 extern void (*name) args; \
 static void (*o_##name) args; \
 static void w_##name args \
 { \
-	unsigned int pc_start = pcnt_get(); \
+	pcnt_t pc_start = pcnt_get(); \
 	o_##name pargs; \
 	pcounters[cnt] += pcnt_get() - pc_start; \
 }
@@ -290,7 +340,7 @@ static retn (*o_##name) args; \
 static retn w_##name args \
 { \
 	retn ret; \
-	unsigned int pc_start = pcnt_get(); \
+	pcnt_t pc_start = pcnt_get(); \
 	ret = o_##name pargs; \
 	pcounters[cnt] += pcnt_get() - pc_start; \
 	return ret; \
@@ -315,6 +365,11 @@ pc_hook_func              (SPU_playADPCMchannel, (void *a0), (a0), PCNT_SPU)
 pc_hook_func              (SPU_async, (uint32_t a0, uint32_t a1), (a0, a1), PCNT_SPU)
 pc_hook_func_ret(int,      SPU_playCDDAchannel, (short *a0, int a1), (a0, a1), PCNT_SPU)
 
+pc_hook_func_ret(long,     CDR_readTrack, (unsigned char *a0), (a0), PCNT_CDR)
+pc_hook_func_ret(unsigned char *,CDR_getBuffer, (void), (), PCNT_CDR)
+pc_hook_func_ret(unsigned char *,CDR_getBufferSub, (void), (), PCNT_CDR)
+pc_hook_func_ret(long,     CDR_readCDDA, (unsigned char a0, unsigned char a1, unsigned char a2, unsigned char *a3), (a0, a1, a2, a3), PCNT_CDR)
+
 #define hook_it(name) { \
 	o_##name = name; \
 	name = w_##name; \
@@ -341,6 +396,10 @@ void pcnt_hook_plugins(void)
 	hook_it(SPU_playADPCMchannel);
 	hook_it(SPU_async);
 	hook_it(SPU_playCDDAchannel);
+	hook_it(CDR_readTrack);
+	hook_it(CDR_getBuffer);
+	hook_it(CDR_getBufferSub);
+	hook_it(CDR_readCDDA);
 }
 
 // hooked into recompiler
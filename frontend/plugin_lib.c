@@ -33,6 +33,7 @@
 #include "../libpcsxcore/new_dynarec/new_dynarec.h"
 #include "../libpcsxcore/psxmem_map.h"
 #include "../plugins/dfinput/externals.h"
+#include "../plugins/dfsound/out.h"
 
 #define HUD_HEIGHT 10
 
@@ -55,6 +56,14 @@ static int psx_w, psx_h, psx_bpp;
 static int vsync_cnt;
 static int is_pal, frame_interval, frame_interval1024;
 static int vsync_usec_time;
+static unsigned int fskip_stats[3];
+// gpu_neon stats summed over the current second, averaged for the hud
+static struct gpu_neon_stats gpu_stats_sum, gpu_stats_hud;
+static unsigned int gpu_stats_frames;
+// same for gpu_unai, which has its own set
+static struct gpu_unai_stats unai_stats_sum, unai_stats_hud;
+static unsigned int unai_stats_frames;
+static int gpu_stats_unai;
 
 // platform hooks
 void (*pl_plat_clear)(void);
@@ -112,9 +121,102 @@ static void print_msg(int h, int border)
 
 static void print_fps(int h, int border)
 {
-	hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT,
-		"%2d %4.1f", pl_rearmed_cbs.flips_per_sec,
-		pl_rearmed_cbs.vsps_cur);
+	if (pl_rearmed_cbs.frameskip == -2)
+		hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT,
+			"%2d %4.1f s%u", pl_rearmed_cbs.flips_per_sec,
+			pl_rearmed_cbs.vsps_cur, fskip_stats[2]);
+	else
+		hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT,
+			"%2d %4.1f", pl_rearmed_cbs.flips_per_sec,
+			pl_rearmed_cbs.vsps_cur);
+}
+
+static void print_gpu_stats(int h, int border)
+{
+	const struct gpu_neon_stats *s = &gpu_stats_hud;
+	const struct gpu_unai_stats *u = &unai_stats_hud;
+
+	if (gpu_stats_unai) {
+		hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT * 3,
+			"pol %u/%uk spr %u/%uk lin %u fil %u mov %u", u->polys,
+			u->px_polys / 1000, u->sprites, u->px_sprites / 1000,
+			u->lines, u->fills, u->image_moves);
+		hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT * 2,
+			"us pol %u spr %u lin %u fil %u mov %u oth %u",
+			u->us_polys, u->us_sprites, u->us_lines, u->us_fills,
+			u->us_image_moves, u->us_other);
+		return;
+	}
+
+	hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT * 3,
+		"tri %u spr %u lin %u px %uk tc %u/%uk", s->triangles, s->sprites,
+		s->lines, s->span_pixels / 1000, s->texture_cache_loads,
+		s->texture_cache_bytes / 1024);
+	hud_printf(pl_vout_buf, pl_vout_w, border + 2, h - HUD_HEIGHT * 2,
+		"us tri %u spr %u lin %u fill %u tc %u", s->us_triangles,
+		s->us_sprites, s->us_lines, s->us_fill_copy, s->us_texture_cache);
+}
+
+static void pl_gpu_neon_stats(const struct gpu_neon_stats *s)
+{
+	struct gpu_neon_stats *t = &gpu_stats_sum;
+
+	t->triangles += s->triangles;
+	t->sprites += s->sprites;
+	t->lines += s->lines;
+	t->span_pixels += s->span_pixels;
+	t->texture_cache_loads += s->texture_cache_loads;
+	t->texture_cache_bytes += s->texture_cache_bytes;
+	t->us_triangles += s->us_triangles;
+	t->us_sprites += s->us_sprites;
+	t->us_lines += s->us_lines;
+	t->us_fill_copy += s->us_fill_copy;
+	t->us_texture_cache += s->us_texture_cache;
+	gpu_stats_frames++;
+}
+
+static void pl_gpu_unai_stats(const struct gpu_unai_stats *s)
+{
+	const unsigned int *src = (const unsigned int *)s;
+	unsigned int *dst = (unsigned int *)&unai_stats_sum;
+	size_t i;
+
+	for (i = 0; i < sizeof(*s) / sizeof(*src); i++)
+		dst[i] += src[i];
+	unai_stats_frames++;
+}
+
+static void gpu_stats_update_hud(void)
+{
+	const struct gpu_neon_stats *t = &gpu_stats_sum;
+	struct gpu_neon_stats *s = &gpu_stats_hud;
+	unsigned int n = gpu_stats_frames;
+	const unsigned int *usum = (const unsigned int *)&unai_stats_sum;
+	unsigned int *uhud = (unsigned int *)&unai_stats_hud;
+	size_t i;
+
+	gpu_stats_unai = unai_stats_frames != 0;
+	for (i = 0; i < sizeof(unai_stats_hud) / sizeof(*uhud); i++)
+		uhud[i] = gpu_stats_unai ? usum[i] / unai_stats_frames : 0;
+	memset(&unai_stats_sum, 0, sizeof(unai_stats_sum));
+	unai_stats_frames = 0;
+
+	memset(s, 0, sizeof(*s));
+	if (n != 0) {
+		s->triangles = t->triangles / n;
+		s->sprites = t->sprites / n;
+		s->lines = t->lines / n;
+		s->span_pixels = t->span_pixels / n;
+		s->texture_cache_loads = t->texture_cache_loads / n;
+		s->texture_cache_bytes = t->texture_cache_bytes / n;
+		s->us_triangles = t->us_triangles / n;
+		s->us_sprites = t->us_sprites / n;
+		s->us_lines = t->us_lines / n;
+		s->us_fill_copy = t->us_fill_copy / n;
+		s->us_texture_cache = t->us_texture_cache / n;
+	}
+	memset(&gpu_stats_sum, 0, sizeof(gpu_stats_sum));
+	gpu_stats_frames = 0;
 }
 
 static void print_cpu_usage(int w, int h, int border)
@@ -173,6 +275,9 @@ static void print_hud(int w, int h, int xborder)
 
 	if (g_opts & OPT_SHOWCPU)
 		print_cpu_usage(w, h, xborder);
+
+	if (g_opts & OPT_SHOWGPU)
+		print_gpu_stats(h, xborder);
 }
 
 /* update scaler target size according to user settings */
@@ -638,7 +743,7 @@ void pl_update_gun(int *xn, int *yn, int *xres, int *yres, int *in)
 /* called on every vsync */
 void pl_frame_limit(void)
 {
-	static struct timeval tv_old, tv_expect;
+	static struct timeval tv_old, tv_expect, tv_frame_start;
 	static int vsync_cnt_prev, drc_active_vsyncs;
 	struct timeval now;
 	int diff, usadj;
@@ -652,9 +757,16 @@ void pl_frame_limit(void)
 	 * thousands of times per frame for some reason */
 	update_input();
 
-	pcnt_end(PCNT_ALL);
+	pcnt_frame_end();
 	gettimeofday(&now, 0);
 
+	// time spent emulating and drawing, without the sleep below
+	diff = tvdiff(now, tv_frame_start);
+	pl_rearmed_cbs.fskip_host_us = (0 < diff && diff < 1000000) ? diff : 0;
+	pl_rearmed_cbs.fskip_audio_fill = -1;
+	if (out_current != NULL && out_current->fill != NULL)
+		pl_rearmed_cbs.fskip_audio_fill = out_current->fill();
+
 	if (now.tv_sec != tv_old.tv_sec) {
 		diff = tvdiff(now, tv_old);
 		pl_rearmed_cbs.vsps_cur = 0.0f;
@@ -667,6 +779,8 @@ void pl_frame_limit(void)
 		pl_rearmed_cbs.flip_cnt = 0;
 		if (g_opts & OPT_SHOWCPU)
 			pl_rearmed_cbs.cpu_usage = get_cpu_ticks();
+		if (g_opts & OPT_SHOWGPU)
+			gpu_stats_update_hud();
 
 		if (hud_new_msg > 0) {
 			hud_new_msg--;
@@ -726,12 +840,18 @@ void pl_frame_limit(void)
 		new_dynarec_did_compile = 0;
 	}
 
+	gettimeofday(&tv_frame_start, 0);
 	pcnt_start(PCNT_ALL);
 }
 
 void pl_timing_prepare(int is_pal_)
 {
 	pl_rearmed_cbs.fskip_advice = 0;
+	pl_rearmed_cbs.fskip_host_us = 0;
+	pl_rearmed_cbs.fskip_audio_fill = -1;
+	pl_rearmed_cbs.fskip_stats = fskip_stats;
+	pl_rearmed_cbs.gpu_neon.stats = (g_opts & OPT_SHOWGPU) ? pl_gpu_neon_stats : NULL;
+	pl_rearmed_cbs.gpu_unai.stats = (g_opts & OPT_SHOWGPU) ? pl_gpu_unai_stats : NULL;
 	pl_rearmed_cbs.flips_per_sec = 0;
 	pl_rearmed_cbs.cpu_usage = 0;
 
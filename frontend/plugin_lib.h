@@ -45,6 +45,41 @@ void  pl_switch_dispmode(void);
 void  pl_timing_prepare(int is_pal);
 void  pl_frame_limit(void);
 
+// what the gpu_neon renderer did during one frame, summed over all of its
+// instances (bands, enhanced pass), so a primitive may be counted twice
+struct gpu_neon_stats {
+	unsigned int triangles, sprites, lines;
+	unsigned int trivial_rejects;  // triangles dropped before any setup
+	unsigned int span_pixels;
+	unsigned int render_buffer_flushes;
+	unsigned int state_changes;
+	unsigned int texture_cache_loads;
+	unsigned int texture_cache_bytes;  // re-swizzled into the texture cache
+	// microseconds of cpu time spent on each primitive class
+	unsigned int us_triangles, us_sprites, us_lines;
+	unsigned int us_fill_copy, us_texture_cache;
+};
+
+// what gpu_unai drew during one frame, per primitive class
+struct gpu_unai_stats {
+	unsigned int polys, sprites, lines, fills, image_moves;
+	// pixels written by each class (before mask/blit skipping)
+	unsigned int px_polys, px_sprites, px_lines, px_fills, px_image_moves;
+	// microseconds of cpu time spent on each class, 'us_other' is the
+	// rest of command list processing (parsing, draw state changes)
+	unsigned int us_polys, us_sprites, us_lines, us_fills, us_image_moves;
+	unsigned int us_other;
+};
+
+// what the gpu-gles texture cache did during one frame
+struct gpu_peopsgl_stats {
+	unsigned int cache_hits;    // texture parts found in the cache, of these
+	unsigned int hash_hits;     // ones whose vram got written but hashed the same
+	unsigned int decodes;       // texture parts converted from vram
+	unsigned int uploads;       // glTexSubImage2D calls for them
+	unsigned int upload_bytes;
+};
+
 struct rearmed_cbs {
 	void  (*pl_get_layer_pos)(int *x, int *y, int *w, int *h);
 	int   (*pl_vout_open)(void);
@@ -57,6 +92,10 @@ struct rearmed_cbs {
 	// only used by some frontends
 	void  (*pl_vout_set_raw_vram)(void *vram);
 	void  (*pl_set_gpu_caps)(int caps);
+	// optional pl_vout_flip for when only lines y1..y2-1 of the
+	// image changed since the last flip (same mode and position)
+	void  (*pl_vout_flip_part)(const void *vram, int stride, int bgr24,
+			      int w, int h, int y1, int y2);
 	// some stats, for display by some plugins
 	int flips_per_sec, cpu_usage;
 	float vsps_cur; // currect vsync/s
@@ -64,17 +103,33 @@ struct rearmed_cbs {
 	unsigned int screen_w, screen_h;
 	void *gles_display, *gles_surface;
 	// gpu options
-	int   frameskip;
+	int   frameskip; // -2 adaptive, -1 auto (fskip_advice), 0 off, 1-3 fixed
 	int   fskip_advice;
+	// for adaptive frameskip, updated every frame
+	int   fskip_host_us; // host time spent on the last frame (emu + draw), 0 unknown
+	int   fskip_audio_fill; // audio output buffer fill in %, -1 unknown
+	int   fskip_max; // most frames to skip in a row, 1-3 (default 3)
+	unsigned int *fskip_stats; // if set: [0] frames, [1] frames skipped, [2] current level
 	unsigned int *gpu_frame_count;
 	unsigned int *gpu_hcnt;
 	unsigned int flip_cnt; // increment manually if not using pl_vout_flip
 	unsigned int only_16bpp; // platform is 16bpp-only
+	int   gpu_thread; // gpulib: 0 off, 1 worker thread, 2 pipelined (+1 frame latency)
+	// gpulib, if set: gpu_thread 1 runs its packets on the emu thread and checks
+	// the status it tracks against the gpu's: [0] checks, [1] mismatches
+	unsigned int *gpu_thread_check;
+	const char *gpu_capture; // gpulib: record commands to this file (see capture.h)
+	int   gpu_capture_frames; // 0 - until changed/closed
+	int   gpu_memo; // gpulib: don't redraw frames that repeat a static one
+	unsigned int *gpu_memo_stats; // if set: [0] frames, [1] frames not drawn
+	int   gpu_bands; // gpulib: draw on this many threads in parallel, -1 one per cpu
 	struct {
 		int   allow_interlace; // 0 off, 1 on, 2 guess
 		int   enhancement_enable;
 		int   enhancement_no_main;
 		int   allow_dithering;
+		// if set: called after each frame, also enables the timing
+		void (*stats)(const struct gpu_neon_stats *s);
 	} gpu_neon;
 	struct {
 		int   iUseDither;
@@ -89,6 +144,9 @@ struct rearmed_cbs {
 		int fast_lighting;
 		int blending;
 		int dithering;
+		int jit;          // GPU_UNAI_JIT builds: compile span functions
+		// if set: called after each frame, also enables the timing
+		void (*stats)(const struct gpu_unai_stats *s);
 		// old gpu_unai config for compatibility
 		int   abe_hack;
 		int   no_light, no_blend;
@@ -100,6 +158,8 @@ struct rearmed_cbs {
 		int   bDrawDither, iFilterType, iFrameTexType;
 		int   iUseMask, bOpaquePass, bAdvancedBlend, bUseFastMdec;
 		int   iVRamSize, iTexGarbageCollection;
+		// if set: called after each frame
+		void (*stats)(const struct gpu_peopsgl_stats *s);
 	} gpu_peopsgl;
 	// misc
 	int gpu_caps;
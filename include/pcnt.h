@@ -7,46 +7,89 @@ enum pcounters {
 	PCNT_SPU,
 	PCNT_BLIT,
 	PCNT_GTE,
+	PCNT_CDR,
+	PCNT_MDEC,
+	PCNT_DMA,
+	PCNT_HLE,
+	PCNT_REC,
 	PCNT_TEST,
 	PCNT_CNT
 };
 
+// these include time of other counters (dma -> gpu/spu/mdec, hle -> gpu..),
+// so they are not subtracted when computing the remainder (cpu) time
+#define PCNT_NESTED ((1 << PCNT_DMA) | (1 << PCNT_HLE))
+
 #ifdef PCNT
 
 #if defined(__ARM_ARCH_7A__) || defined(ARM1176)
 #define PCNT_DIV 1000
+typedef unsigned int pcnt_t;
+#elif defined(__i386__) || defined(__x86_64__)
+#include <time.h>
+// tsc ticks per usec, measured by pcnt_init()
+extern unsigned int pcnt_tsc_div;
+#define PCNT_DIV pcnt_tsc_div
+// the low 32 bits of the tsc wrap within a second or two
+typedef unsigned long long pcnt_t;
 #else
-#include <sys/time.h>
+#include <time.h>
 #define PCNT_DIV 1
+typedef unsigned int pcnt_t;
 #endif
 
-static const char *pcnt_names[PCNT_CNT] = { "", "gpu", "spu", "blit", "gte", "test" };
+static const char *pcnt_names[PCNT_CNT] = { "", "gpu", "spu", "blit", "gte",
+	"cdr", "mdec", "dma", "hle", "rec", "test" };
 
 #define PCNT_FRAMES 10
 
-extern unsigned int pcounters[PCNT_CNT];
-extern unsigned int pcounter_starts[PCNT_CNT];
+// current frame, moved to pcounter_sums by pcnt_frame_end()
+extern unsigned long long pcounters[PCNT_CNT];
+extern pcnt_t pcounter_starts[PCNT_CNT];
+extern unsigned int pcounter_depth[PCNT_CNT];
+// sums since the last pcnt_print()
+extern unsigned long long pcounter_sums[PCNT_CNT];
+
+// a counter started again before it ended (dma started from a dma
+// handler and such) keeps counting from the outermost start, an end
+// without a start is ignored
+#define pcnt_start(id) do { \
+	if (pcounter_depth[id]++ == 0) \
+		pcounter_starts[id] = pcnt_get(); \
+} while (0)
+
+#define pcnt_end(id) do { \
+	if (pcounter_depth[id] != 0 && --pcounter_depth[id] == 0) \
+		pcounters[id] += pcnt_get() - pcounter_starts[id]; \
+} while (0)
 
-#define pcnt_start(id) \
-	pcounter_starts[id] = pcnt_get()
+void pcnt_hook_plugins(void);
+void pcnt_frame_end(void);
+int  pcnt_csv_open(const char *fname);
 
-#define pcnt_end(id) \
-	pcounters[id] += pcnt_get() - pcounter_starts[id]
+static inline unsigned long long pcnt_remainder(const unsigned long long *c)
+{
+	unsigned long long rem = c[PCNT_ALL];
+	int i;
 
-void pcnt_hook_plugins(void);
+	for (i = 1; i < PCNT_CNT; i++)
+		if (!(PCNT_NESTED & (1 << i)))
+			rem -= c[i];
+	return rem;
+}
 
 static inline void pcnt_print(float fps)
 {
 	static int print_counter;
+	unsigned int vals[PCNT_CNT];
 	unsigned int total, rem;
 	int i;
 
 	for (i = 0; i < PCNT_CNT; i++)
-		pcounters[i] /= PCNT_DIV * PCNT_FRAMES;
+		vals[i] = pcounter_sums[i] / (PCNT_DIV * PCNT_FRAMES);
 
-	rem = total = pcounters[PCNT_ALL];
-	for (i = 1; i < PCNT_CNT; i++)
-		rem -= pcounters[i];
+	rem = pcnt_remainder(pcounter_sums) / (PCNT_DIV * PCNT_FRAMES);
+	total = vals[PCNT_ALL];
 	if (!total)
 		total++;
 
@@ -59,45 +102,34 @@ static inline void pcnt_print(float fps)
 	}
 
 	printf("%4.1f ", fps);
-#if 0
-	static float pcounters_all[PCNT_CNT+1];
-	static int pcounter_samples;
-	pcounter_samples++;
-
-	for (i = 1; i < PCNT_CNT; i++) {
-		pcounters_all[i] += pcounters[i];
-		printf("%5.0f ", pcounters_all[i] / pcounter_samples);
-	}
-	pcounters_all[i] += rem;
-	printf("%5.0f\n", pcounters_all[i] / pcounter_samples);
-#else
 	for (i = 1; i < PCNT_CNT; i++)
-		printf("%5u ", pcounters[i]);
+		printf("%5u ", vals[i]);
 	printf("%5u (", rem);
 	for (i = 1; i < PCNT_CNT; i++)
-		printf("%2u ", pcounters[i] * 100 / total);
+		printf("%2u ", vals[i] * 100 / total);
 	printf("%2u) %u\n", rem * 100 / total, total);
-#endif
-	memset(pcounters, 0, sizeof(pcounters));
+
+	memset(pcounter_sums, 0, sizeof(pcounter_sums));
 }
 
-static inline unsigned int pcnt_get(void)
+static inline pcnt_t pcnt_get(void)
 {
-	unsigned int val;
+	pcnt_t val;
 #ifdef __ARM_ARCH_7A__
 	__asm__ volatile("mrc p15, 0, %0, c9, c13, 0"
 			 : "=r"(val));
 #elif defined(ARM1176)
 	__asm__ volatile("mrc p15, 0, %0, c15, c12, 1"
 			 : "=r"(val));
+#elif defined(__i386__) || defined(__x86_64__)
+	unsigned int lo, hi;
+	__asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+	val = ((pcnt_t)hi << 32) | lo;
 #else
-	// all slow on ARM :(
-	//struct timespec tv;
-	//clock_gettime(CLOCK_MONOTONIC_RAW, &tv);
-	//val = tv.tv_sec * 1000000000 + tv.tv_nsec;
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
-	val = tv.tv_sec * 1000000 + tv.tv_usec;
+	// usecs, to match PCNT_DIV
+	struct timespec tv;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &tv);
+	val = tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
 #endif
 	return val;
 }
@@ -118,6 +150,24 @@ static inline void pcnt_init(void)
 	v |= 5; // master enable, ccnt reset
 	v &= ~8; // ccnt divider 0
 	asm volatile("mcr p15, 0, %0, c15, c12, 0" :: "r"(v));
+#elif defined(__i386__) || defined(__x86_64__)
+	// calibrate tsc against the raw monotonic clock for ~10ms
+	struct timespec ts0, ts1;
+	pcnt_t t0, t1;
+	long long ns;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts0);
+	t0 = pcnt_get();
+	do {
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts1);
+		ns = (ts1.tv_sec - ts0.tv_sec) * 1000000000ll
+			+ ts1.tv_nsec - ts0.tv_nsec;
+	} while (ns < 10000000);
+	t1 = pcnt_get();
+
+	pcnt_tsc_div = (t1 - t0) * 1000 / ns;
+	if (pcnt_tsc_div == 0)
+		pcnt_tsc_div = 1;
 #endif
 }
 
@@ -129,6 +179,8 @@ void pcnt_gte_end(int op);
 #define pcnt_start(id)
 #define pcnt_end(id)
 #define pcnt_hook_plugins()
+#define pcnt_frame_end()
+static inline int pcnt_csv_open(const char *fname) { return -1; }
 #define pcnt_print(fps)
 
 #endif
@@ -7,6 +7,9 @@
 #include "../cdrom.h"
 #include "../gpu.h"
 #include "../gte.h"
+#define FLAGLESS
+#include "../gte.h"
+#undef FLAGLESS
 #include "../mdec.h"
 #include "../psxdma.h"
 #include "../psxhw.h"
@@ -110,6 +113,31 @@ static void (*cp2_ops[])(struct psxCP2Regs *) = {
 	[OP_CP2_NCCT] = gteNCCT,
 };
 
+static void (*cp2_ops_nf[])(struct psxCP2Regs *) = {
+	[OP_CP2_RTPS] = gteRTPS_nf,
+	[OP_CP2_NCLIP] = gteNCLIP_nf,
+	[OP_CP2_OP] = gteOP_nf,
+	[OP_CP2_DPCS] = gteDPCS_nf,
+	[OP_CP2_INTPL] = gteINTPL_nf,
+	[OP_CP2_MVMVA] = gteMVMVA_nf,
+	[OP_CP2_NCDS] = gteNCDS_nf,
+	[OP_CP2_CDP] = gteCDP_nf,
+	[OP_CP2_NCDT] = gteNCDT_nf,
+	[OP_CP2_NCCS] = gteNCCS_nf,
+	[OP_CP2_CC] = gteCC_nf,
+	[OP_CP2_NCS] = gteNCS_nf,
+	[OP_CP2_NCT] = gteNCT_nf,
+	[OP_CP2_SQR] = gteSQR_nf,
+	[OP_CP2_DCPL] = gteDCPL_nf,
+	[OP_CP2_DPCT] = gteDPCT_nf,
+	[OP_CP2_AVSZ3] = gteAVSZ3_nf,
+	[OP_CP2_AVSZ4] = gteAVSZ4_nf,
+	[OP_CP2_RTPT] = gteRTPT_nf,
+	[OP_CP2_GPF] = gteGPF_nf,
+	[OP_CP2_GPL] = gteGPL_nf,
+	[OP_CP2_NCCT] = gteNCCT_nf,
+};
+
 static char cache_buf[64 * 1024];
 
 static u32 cop0_mfc(struct lightrec_state *state, u32 op, u8 reg)
@@ -212,6 +240,31 @@ static void cop2_op(struct lightrec_state *state, u32 func)
 		cp2_ops[func & 0x3f](&psxRegs.CP2);
 }
 
+/* Called by lightrec for GTE commands whose FLAG result is overwritten
+ * before anything can read it */
+static void cop2_op_nf(struct lightrec_state *state, u32 func)
+{
+	psxRegs.code = func;
+
+	if (unlikely(!cp2_ops_nf[func & 0x3f]))
+		fprintf(stderr, "Invalid CP2 function %u\n", func);
+	else
+		cp2_ops_nf[func & 0x3f](&psxRegs.CP2);
+}
+
+/* Called by lightrec for two GTE commands separated only by NOPs,
+ * typically RTPT followed by NCLIP, to save a trip through the wrapper */
+static void cop2_op_pair(struct lightrec_state *state, u32 func,
+			 u32 next_func, bool next_nf)
+{
+	cop2_op_nf(state, func);
+
+	if (next_nf)
+		cop2_op_nf(state, next_func);
+	else
+		cop2_op(state, next_func);
+}
+
 static void hw_write_byte(struct lightrec_state *state,
 			  u32 op, void *host, u32 mem, u8 val)
 {
@@ -380,6 +433,8 @@ static const struct lightrec_ops lightrec_ops = {
 		.mtc = cop2_mtc,
 		.ctc = cop2_ctc,
 		.op = cop2_op,
+		.op_nf = cop2_op_nf,
+		.op_pair = cop2_op_pair,
 	},
 };
 
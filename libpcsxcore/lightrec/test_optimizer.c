@@ -0,0 +1,141 @@
+/*
+ * Checks for the lightrec optimizer passes added for pcsx_rearmed, on hand
+ * written opcode lists. Build with: make -f Makefile.test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../deps/lightrec/optimizer.c"
+
+void *lightrec_malloc(struct lightrec_state *state,
+		      enum mem_type type, unsigned int len)
+{
+	return malloc(len);
+}
+
+void lightrec_free_opcode_list(struct lightrec_state *state,
+			       struct opcode *list)
+{
+}
+
+#define NOP	0x00000000
+#define RTPS	0x4a180001		/* GTE command, clears FLAG */
+#define CFC2_31	0x4842f800		/* cfc2 $2, $31 */
+#define CTC2_31	0x48c2f800		/* ctc2 $2, $31 */
+#define BNE(i)	(0x14220000 | (i))	/* bne $1, $2, i */
+
+static struct opcode ops[16];
+static struct lightrec_state state;
+static struct block block = { .state = &state };
+
+static void op_pair(struct lightrec_state *state, u32 op,
+		    u32 next_op, bool next_nf)
+{
+}
+
+static const struct opcode *make_list(const u32 *code, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		ops[i].opcode = code[i];
+		ops[i].offset = i;
+		ops[i].flags = 0;
+		if (ops[i].i.op == OP_BNE)
+			ops[i].flags |= LIGHTREC_LOCAL_BRANCH;
+		ops[i].next = i + 1 < count ? &ops[i + 1] : NULL;
+	}
+
+	block.opcode_list = ops;
+	return ops;
+}
+
+static int fails;
+
+#define CHECK_GTE_FLAGS(name, expect, ...) do { \
+	static const u32 code[] = { __VA_ARGS__ }; \
+	const struct opcode *list = make_list(code, ARRAY_SIZE(code)); \
+	bool got = is_gte_flags_unneeded(&block, list); \
+	if (got != (expect)) { \
+		printf("FAIL %s: flags %s, expected %s\n", name, \
+		       got ? "unneeded" : "needed", \
+		       (expect) ? "unneeded" : "needed"); \
+		fails++; \
+	} \
+} while (0)
+
+#define GTE_PAIR_FLAGS \
+	(LIGHTREC_GTE_PAIR | LIGHTREC_GTE_PAIRED | LIGHTREC_NO_GTE_FLAGS)
+
+/* first and second are the indexes of the paired commands, or -1 */
+#define CHECK_GTE_PAIR(name, first, second, ...) do { \
+	static const u32 code[] = { __VA_ARGS__ }; \
+	int i, n = ARRAY_SIZE(code); \
+	make_list(code, n); \
+	lightrec_pair_gte_cmds(&block); \
+	for (i = 0; i < n; i++) { \
+		u16 got = ops[i].flags & GTE_PAIR_FLAGS, expect = 0; \
+		if (i == (first)) \
+			expect = LIGHTREC_GTE_PAIR | LIGHTREC_NO_GTE_FLAGS; \
+		else if (i == (second)) \
+			expect = LIGHTREC_GTE_PAIRED; \
+		if (got != expect) { \
+			printf("FAIL %s: opcode %d flags 0x%x, expected 0x%x\n", \
+			       name, i, got, expect); \
+			fails++; \
+		} \
+	} \
+} while (0)
+
+int main(void)
+{
+	state.ops.cop2_ops.op_pair = op_pair;
+
+	CHECK_GTE_FLAGS("overwritten", true,
+			RTPS, NOP, RTPS);
+	CHECK_GTE_FLAGS("ctc2 overwrites", true,
+			RTPS, CTC2_31, NOP);
+	CHECK_GTE_FLAGS("read", false,
+			RTPS, NOP, CFC2_31, RTPS);
+	CHECK_GTE_FLAGS("block end", false,
+			RTPS, NOP, NOP);
+
+	/* both paths of a forward branch overwrite it */
+	CHECK_GTE_FLAGS("branch", true,
+			RTPS, BNE(2), NOP, RTPS, RTPS);
+	/* read on the fall-through path */
+	CHECK_GTE_FLAGS("branch, read before target", false,
+			RTPS, BNE(2), NOP, CFC2_31, RTPS);
+	/* read right at the branch target, the fall-through path
+	 * overwrites it */
+	CHECK_GTE_FLAGS("branch, read at target", false,
+			RTPS, BNE(2), NOP, RTPS, CFC2_31, RTPS);
+	/* branch to its own delay slot's successor with a read there */
+	CHECK_GTE_FLAGS("branch, read at next", false,
+			RTPS, BNE(0), NOP, CFC2_31, RTPS);
+
+	/* the first command of a pair is also marked as not needing FLAG */
+	CHECK_GTE_PAIR("pair", 0, 3,
+		       RTPS, NOP, NOP, RTPS);
+	CHECK_GTE_PAIR("pair, adjacent", 0, 1,
+		       RTPS, RTPS);
+	CHECK_GTE_PAIR("pair, not across other opcodes", -1, -1,
+		       RTPS, CFC2_31, RTPS);
+	/* the second command of a pair doesn't start another one */
+	CHECK_GTE_PAIR("pair, three commands", 0, 2,
+		       RTPS, NOP, RTPS, NOP, RTPS);
+	/* a local branch landing between the two commands, or on the
+	 * second one, would run it alone */
+	CHECK_GTE_PAIR("pair, branch target between", -1, -1,
+		       BNE(2), NOP, RTPS, NOP, RTPS);
+	CHECK_GTE_PAIR("pair, branch target at second", -1, -1,
+		       BNE(3), NOP, RTPS, NOP, RTPS);
+	CHECK_GTE_PAIR("pair, branch target at first", 2, 4,
+		       BNE(1), NOP, RTPS, NOP, RTPS);
+	/* a command in a delay slot isn't paired, the ones after it are */
+	CHECK_GTE_PAIR("pair, after delay slot", 3, 5,
+		       BNE(5), RTPS, NOP, RTPS, NOP, RTPS);
+
+	printf("%s\n", fails ? "FAILED" : "ok");
+	return fails != 0;
+}
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "mdec.h"
+#include "pcnt.h"
 
 /* memory speed is 1 byte per MDEC_BIAS psx clock
  * That mean (PSXCLK / MDEC_BIAS) B/s
@@ -561,6 +562,7 @@ void psxDma1(u32 adr, u32 bcr, u32 chcr) {
 		/* do not free the dma */
 	} else {
 
+	pcnt_start(PCNT_MDEC);
 	image = (u8 *)PSXM(adr);
 
 	if (mdec.reg0 & MDEC0_RGB24) {
@@ -621,7 +623,8 @@ void psxDma1(u32 adr, u32 bcr, u32 chcr) {
 			mdec.block_buffer_pos = mdec.block_buffer + size;
 		}
 	}
-	
+	pcnt_end(PCNT_MDEC);
+
 	/* define the power of mdec */
 	MDECOUTDMA_INT(words * MDEC_BIAS);
 	}
@@ -11,6 +11,7 @@
 #include "../../../mdec.h"
 #include "../../../gpu.h"
 #include "../../../psxmem_map.h"
+#include "pcnt.h"
 #include "emu_if.h"
 #include "pcsxmem.h"
 
@@ -196,7 +197,9 @@ static void io_write_chcr##n(u32 value) \
 { \
 	HW_DMA##n##_CHCR = value; \
 	if (value & 0x01000000 && HW_DMA_PCR & (8 << (n * 4))) { \
+		pcnt_start(PCNT_DMA); \
 		psxDma##n(HW_DMA##n##_MADR, HW_DMA##n##_BCR, value); \
+		pcnt_end(PCNT_DMA); \
 	} \
 }
 
@@ -37,6 +37,7 @@ int getVMBlock();
 
 #include "new_dynarec_config.h"
 #include "backends/psx/emu_if.h" //emulator interface
+#include "pcnt.h"
 
 //#define DISASM
 //#define assem_debug printf
@@ -423,7 +424,9 @@ void *get_addr(u_int vaddr)
     head=head->next;
   }
   //printf("TRACE: count=%d next=%d (get_addr no-match %x)\n",Count,next_interupt,vaddr);
+  pcnt_start(PCNT_REC);
   int r=new_recompile_block(vaddr);
+  pcnt_end(PCNT_REC);
   if(r==0)
     return get_addr(vaddr);
   // Execute in unmapped page, generate pagefault exception
@@ -182,6 +182,7 @@ void psxDma2(u32 madr, u32 bcr, u32 chcr) { // GPU
 #endif
 
 			size = GPU_dmaChain((u32 *)psxM, madr & 0x1fffff);
+			// for plugins that don't report the transfer time
 			if ((int)size <= 0)
 				size = gpuDmaChainSize(madr);
 			HW_GPU_STATUS &= ~PSXGPU_nBUSY;
@@ -22,6 +22,7 @@
 */
 
 #include "psxhle.h"
+#include "pcnt.h"
 
 #if 0
 #define PSXHLE_LOG SysPrintf
@@ -38,7 +39,9 @@ static void hleDummy() {
 static void hleA0() {
 	u32 call = psxRegs.GPR.n.t1 & 0xff;
 
+	pcnt_start(PCNT_HLE);
 	if (biosA0[call]) biosA0[call]();
+	pcnt_end(PCNT_HLE);
 
 	psxBranchTest();
 }
@@ -46,7 +49,9 @@ static void hleA0() {
 static void hleB0() {
 	u32 call = psxRegs.GPR.n.t1 & 0xff;
 
+	pcnt_start(PCNT_HLE);
 	if (biosB0[call]) biosB0[call]();
+	pcnt_end(PCNT_HLE);
 
 	psxBranchTest();
 }
@@ -54,7 +59,9 @@ static void hleB0() {
 static void hleC0() {
 	u32 call = psxRegs.GPR.n.t1 & 0xff;
 
+	pcnt_start(PCNT_HLE);
 	if (biosC0[call]) biosC0[call]();
+	pcnt_end(PCNT_HLE);
 
 	psxBranchTest();
 }
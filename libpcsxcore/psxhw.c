@@ -25,6 +25,7 @@
 #include "mdec.h"
 #include "cdrom.h"
 #include "gpu.h"
+#include "pcnt.h"
 
 //#undef PSXHW_LOG
 //#define PSXHW_LOG printf
@@ -513,7 +514,9 @@ void psxHwWrite16(u32 add, u16 value) {
 	HW_DMA##n##_CHCR = SWAPu32(value); \
 \
 	if (SWAPu32(HW_DMA##n##_CHCR) & 0x01000000 && SWAPu32(HW_DMA_PCR) & (8 << (n * 4))) { \
+		pcnt_start(PCNT_DMA); \
 		psxDma##n(SWAPu32(HW_DMA##n##_MADR), SWAPu32(HW_DMA##n##_BCR), SWAPu32(HW_DMA##n##_CHCR)); \
+		pcnt_end(PCNT_DMA); \
 	} \
 }
 
@@ -25,6 +25,7 @@
 #include "cdrom.h"
 #include "mdec.h"
 #include "gte.h"
+#include "pcnt.h"
 
 R3000Acpu *psxCpu = NULL;
 psxRegisters psxRegs;
@@ -111,7 +112,11 @@ void psxException(u32 code, u32 bd) {
 	psxRegs.CP0.n.Status = (psxRegs.CP0.n.Status &~0x3f) |
 						  ((psxRegs.CP0.n.Status & 0xf) << 2);
 
-	if (Config.HLE) psxBiosException();
+	if (Config.HLE) {
+		pcnt_start(PCNT_HLE);
+		psxBiosException();
+		pcnt_end(PCNT_HLE);
+	}
 }
 
 void psxBranchTest() {
@@ -182,6 +182,18 @@ static int alsa_busy(void)
  return l;
 }
 
+static int alsa_fill(void)
+{
+ snd_pcm_sframes_t l;
+
+ if (handle == NULL || buffer_size == 0)
+  return 0;
+ l = snd_pcm_avail(handle);
+ if (l < 0 || l > (snd_pcm_sframes_t)buffer_size)
+  return 0;                                          // xrun, nothing queued
+ return (buffer_size - l) * 100 / buffer_size;
+}
+
 // FEED SOUND DATA
 static void alsa_feed(void *pSound, int lBytes)
 {
@@ -218,5 +230,6 @@ void out_register_alsa(struct out_driver *drv)
 	drv->init = alsa_init;
 	drv->finish = alsa_finish;
 	drv->busy = alsa_busy;
+	drv->fill = alsa_fill;
 	drv->feed = alsa_feed;
 }
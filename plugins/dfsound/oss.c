@@ -149,6 +149,16 @@ static int oss_busy(void)
  return l;
 }
 
+static int oss_fill(void)
+{
+ audio_buf_info info;
+
+ if(oss_audio_fd == -1) return 0;
+ if(ioctl(oss_audio_fd,SNDCTL_DSP_GETOSPACE,&info)==-1 || info.fragstotal <= 0)
+  return 0;
+ return (info.fragstotal - info.fragments) * 100 / info.fragstotal;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // FEED SOUND DATA
 ////////////////////////////////////////////////////////////////////////
@@ -185,5 +195,6 @@ void out_register_oss(struct out_driver *drv)
 	drv->init = oss_init;
 	drv->finish = oss_finish;
 	drv->busy = oss_busy;
+	drv->fill = oss_fill;
 	drv->feed = oss_feed;
 }
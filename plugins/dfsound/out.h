@@ -6,6 +6,7 @@ struct out_driver {
 	int (*init)(void);
 	void (*finish)(void);
 	int (*busy)(void);
+	int (*fill)(void); // optional, how full the output buffer is, 0-100
 	void (*feed)(void *data, int bytes);
 };
 
@@ -116,6 +116,17 @@ static int sdl_busy(void) {
 	return 0;
 }
 
+static int sdl_fill(void) {
+	int size;
+
+	if (pSndBuffer == NULL) return 0;
+
+	size = iWritePos - iReadPos;
+	if (size < 0) size += iBufSize;
+
+	return size * 100 / iBufSize;
+}
+
 static void sdl_feed(void *pSound, int lBytes) {
 	short *p = (short *)pSound;
 
@@ -139,5 +150,6 @@ void out_register_sdl(struct out_driver *drv)
 	drv->init = sdl_init;
 	drv->finish = sdl_finish;
 	drv->busy = sdl_busy;
+	drv->fill = sdl_fill;
 	drv->feed = sdl_feed;
 }
@@ -996,6 +996,7 @@ ENDVRAM:
       {
        gpuDataC=gpuDataP=0;
        primFunc[gpuCommand]((unsigned char *)gpuDataM);
+       if(gpuCommand>=0x20 && gpuCommand<0x80) TCacheDrawn();
        if(dwActFixes&0x0400)      // hack for emulating "gpu busy" in some games
         iFakePrimBusy=4;
       }
@@ -1113,6 +1114,7 @@ long CALLBACK GPUfreeze(uint32_t ulGetFreezeData,GPUFreeze_t * pF)
  memcpy(psxVub,         pF->psxVRam,  1024*512*2);
 
 // RESET TEXTURE STORE HERE, IF YOU USE SOMETHING LIKE THAT
+ TCacheInvalidate(0,0,1024,512);
 
  PreviousPSXDisplay.Height = 0;
  GPUwriteStatus(ulStatusControl[0]);
@@ -332,6 +332,8 @@ int do_cmd_list(uint32_t *list, int list_len, int *last_cmd)
 #endif
 
     primTableJ[cmd]((void *)list);
+    if (cmd >= 0x20 && cmd < 0x80)
+      TCacheDrawn(); // primitives may have drawn anywhere in the area
 
     switch(cmd)
     {
@@ -416,6 +418,7 @@ void renderer_sync_ecmds(uint32_t *ecmds)
 
 void renderer_update_caches(int x, int y, int w, int h)
 {
+ TCacheInvalidate(x, y, w, h);
 }
 
 void renderer_flush_queues(void)
@@ -485,6 +485,8 @@ static void primLoadImage(unsigned char * baseAddr)
  VRAMWrite.ImagePtr = psxVuw + (VRAMWrite.y<<10) + VRAMWrite.x;
  VRAMWrite.RowsRemaining = VRAMWrite.Width;
  VRAMWrite.ColsRemaining = VRAMWrite.Height;
+
+ TCacheInvalidate(VRAMWrite.x,VRAMWrite.y,VRAMWrite.Width,VRAMWrite.Height);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -534,6 +536,7 @@ static void primBlkFill(unsigned char * baseAddr)
  sH+=sY;
 
  FillSoftwareArea(sX, sY, sW, sH, BGR24to16(GETLE32(&gpuData[0])));
+ TCacheInvalidate(sX, sY, sW-sX, sH-sY);
 
  bDoVSyncUpdate=TRUE;
 }
@@ -559,6 +562,8 @@ static void primMoveImage(unsigned char * baseAddr)
  if(imageSX<=0)  return;
  if(imageSY<=0)  return;
 
+ TCacheInvalidate(imageX1,imageY1,imageSX,imageSY);
+
  if((imageY0+imageSY)>512 ||
     (imageX0+imageSX)>1024       ||
     (imageY1+imageSY)>512 ||
@@ -26,6 +26,13 @@
 // psx blending mode 3 with 25% incoming color (instead 50% without the define)
 #define HALFBRIGHTMODE3
 
+// per pixel funcs get folded into the span funcs for each blend state
+#ifdef __GNUC__
+#define SOFT_INLINE static inline __attribute__((always_inline))
+#else
+#define SOFT_INLINE static inline
+#endif
+
 // color decode defines
 
 #define XCOL1(x)     (x & 0x1f)
@@ -145,33 +152,34 @@ static inline void Dither16(unsigned short * pdest,uint32_t r,uint32_t g,uint32_
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
 
-static inline void GetShadeTransCol_Dither(unsigned short * pdest, int32_t m1, int32_t m2, int32_t m3)
+SOFT_INLINE void ShadeTransCol_Dither(unsigned short * pdest, int32_t m1, int32_t m2, int32_t m3,
+ int semi, int abr, int mask, unsigned short smask)
 {
  int32_t r,g,b;
 
- if(bCheckMask && (*pdest & HOST2LE16(0x8000))) return;
+ if(mask && (*pdest & HOST2LE16(0x8000))) return;
 
- if(DrawSemiTrans)
+ if(semi)
   {
    r=((XCOL1D(GETLE16(pdest)))<<3);
    b=((XCOL2D(GETLE16(pdest)))<<3);
    g=((XCOL3D(GETLE16(pdest)))<<3);
 
-   if(GlobalTextABR==0)
+   if(abr==0)
     {
      r=(r>>1)+(m1>>1);
      b=(b>>1)+(m2>>1);
      g=(g>>1)+(m3>>1);
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
      r+=m1;
      b+=m2;
      g+=m3;
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      r-=m1;
      b-=m2;
@@ -204,33 +212,39 @@ static inline void GetShadeTransCol_Dither(unsigned short * pdest, int32_t m1, i
  if(b&0x7FFFFF00) b=0xff;
  if(g&0x7FFFFF00) g=0xff;
 
- Dither16(pdest,r,b,g,sSetMask);
+ Dither16(pdest,r,b,g,smask);
+}
+
+static inline void GetShadeTransCol_Dither(unsigned short * pdest, int32_t m1, int32_t m2, int32_t m3)
+{
+ ShadeTransCol_Dither(pdest,m1,m2,m3,DrawSemiTrans,GlobalTextABR,bCheckMask,sSetMask);
 }
 
 ////////////////////////////////////////////////////////////////////////
 
-static inline void GetShadeTransCol(unsigned short * pdest,unsigned short color)
+SOFT_INLINE void ShadeTransCol(unsigned short * pdest,unsigned short color,
+ int semi, int abr, int mask, unsigned short smask)
 {
- if(bCheckMask && (*pdest & HOST2LE16(0x8000))) return;
+ if(mask && (*pdest & HOST2LE16(0x8000))) return;
 
- if(DrawSemiTrans)
+ if(semi)
   {
    int32_t r,g,b;
  
-   if(GlobalTextABR==0)
+   if(abr==0)
     {
-     PUTLE16(pdest, (((GETLE16(pdest)&0x7bde)>>1)+(((color)&0x7bde)>>1))|sSetMask);//0x8000;
+     PUTLE16(pdest, (((GETLE16(pdest)&0x7bde)>>1)+(((color)&0x7bde)>>1))|smask);//0x8000;
      return;
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
      r=(XCOL1(GETLE16(pdest)))+((XCOL1(color)));
      b=(XCOL2(GETLE16(pdest)))+((XCOL2(color)));
      g=(XCOL3(GETLE16(pdest)))+((XCOL3(color)));
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      r=(XCOL1(GETLE16(pdest)))-((XCOL1(color)));
      b=(XCOL2(GETLE16(pdest)))-((XCOL2(color)));
@@ -256,24 +270,30 @@ static inline void GetShadeTransCol(unsigned short * pdest,unsigned short color)
    if(b&0x7FFFFC00) b=0x3e0;
    if(g&0x7FFF8000) g=0x7c00;
 
-   PUTLE16(pdest, (XPSXCOL(r,g,b))|sSetMask);//0x8000;
+   PUTLE16(pdest, (XPSXCOL(r,g,b))|smask);//0x8000;
   }
- else PUTLE16(pdest, color|sSetMask);
+ else PUTLE16(pdest, color|smask);
 }  
 
+static inline void GetShadeTransCol(unsigned short * pdest,unsigned short color)
+{
+ ShadeTransCol(pdest,color,DrawSemiTrans,GlobalTextABR,bCheckMask,sSetMask);
+}
+
 ////////////////////////////////////////////////////////////////////////
 
-static inline void GetShadeTransCol32(uint32_t * pdest,uint32_t color)
+SOFT_INLINE void ShadeTransCol32(uint32_t * pdest,uint32_t color,
+ int semi, int abr, int mask, uint32_t lmask)
 {
- if(DrawSemiTrans)
+ if(semi)
   {
    int32_t r,g,b;
  
-   if(GlobalTextABR==0)
+   if(abr==0)
     {
-     if(!bCheckMask)
+     if(!mask)
       {
-       PUTLE32(pdest, (((GETLE32(pdest)&0x7bde7bde)>>1)+(((color)&0x7bde7bde)>>1))|lSetMask);//0x80008000;
+       PUTLE32(pdest, (((GETLE32(pdest)&0x7bde7bde)>>1)+(((color)&0x7bde7bde)>>1))|lmask);//0x80008000;
        return;
       }
      r=(X32ACOL1(GETLE32(pdest))>>1)+((X32ACOL1(color))>>1);
@@ -281,14 +301,14 @@ static inline void GetShadeTransCol32(uint32_t * pdest,uint32_t color)
      g=(X32ACOL3(GETLE32(pdest))>>1)+((X32ACOL3(color))>>1);
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
      r=(X32COL1(GETLE32(pdest)))+((X32COL1(color)));
      b=(X32COL2(GETLE32(pdest)))+((X32COL2(color)));
      g=(X32COL3(GETLE32(pdest)))+((X32COL3(color)));
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      int32_t sr,sb,sg,src,sbc,sgc,c;
      src=XCOL1(color);sbc=XCOL2(color);sgc=XCOL3(color);
@@ -323,31 +343,36 @@ static inline void GetShadeTransCol32(uint32_t * pdest,uint32_t color)
    if(g&0x7FE00000) g=0x1f0000|(g&0xFFFF);
    if(g&0x7FE0)     g=0x1f    |(g&0xFFFF0000);
 
-   if(bCheckMask) 
+   if(mask) 
     {
      uint32_t ma=GETLE32(pdest);
-     PUTLE32(pdest, (X32PSXCOL(r,g,b))|lSetMask);//0x80008000;
+     PUTLE32(pdest, (X32PSXCOL(r,g,b))|lmask);//0x80008000;
      if(ma&0x80000000) PUTLE32(pdest, (ma&0xFFFF0000)|(*pdest&0xFFFF));
      if(ma&0x00008000) PUTLE32(pdest, (ma&0xFFFF)    |(*pdest&0xFFFF0000));
      return;
     }
-   PUTLE32(pdest, (X32PSXCOL(r,g,b))|lSetMask);//0x80008000;
+   PUTLE32(pdest, (X32PSXCOL(r,g,b))|lmask);//0x80008000;
   }
  else 
   {
-   if(bCheckMask) 
+   if(mask) 
     {
      uint32_t ma=GETLE32(pdest);
-     PUTLE32(pdest, color|lSetMask);//0x80008000;
+     PUTLE32(pdest, color|lmask);//0x80008000;
      if(ma&0x80000000) PUTLE32(pdest, (ma&0xFFFF0000)|(GETLE32(pdest)&0xFFFF));
      if(ma&0x00008000) PUTLE32(pdest, (ma&0xFFFF)    |(GETLE32(pdest)&0xFFFF0000));
      return;
     }
 
-   PUTLE32(pdest, color|lSetMask);//0x80008000;
+   PUTLE32(pdest, color|lmask);//0x80008000;
   }
 }  
 
+static inline void GetShadeTransCol32(uint32_t * pdest,uint32_t color)
+{
+ ShadeTransCol32(pdest,color,DrawSemiTrans,GlobalTextABR,bCheckMask,lSetMask);
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 static inline void GetTextureTransColG(unsigned short * pdest,unsigned short color)
@@ -505,44 +530,45 @@ static inline void GetTextureTransColG_SPR(unsigned short * pdest,unsigned short
 
 ////////////////////////////////////////////////////////////////////////
 
-static inline void GetTextureTransColG32(uint32_t * pdest,uint32_t color)
+SOFT_INLINE void TextureTransColG32(uint32_t * pdest,uint32_t color,int32_t m1,int32_t m2,int32_t m3,
+ int semi, int abr, int mask, uint32_t lmask)
 {
  int32_t r,g,b,l;
 
  if(color==0) return;
 
- l=lSetMask|(color&0x80008000);
+ l=lmask|(color&0x80008000);
 
- if(DrawSemiTrans && (color&0x80008000))
+ if(semi && (color&0x80008000))
   {
-   if(GlobalTextABR==0)
+   if(abr==0)
     {                 
-     r=((((X32TCOL1(GETLE32(pdest)))+((X32COL1(color)) * g_m1))&0xFF00FF00)>>8);
-     b=((((X32TCOL2(GETLE32(pdest)))+((X32COL2(color)) * g_m2))&0xFF00FF00)>>8);
-     g=((((X32TCOL3(GETLE32(pdest)))+((X32COL3(color)) * g_m3))&0xFF00FF00)>>8);
+     r=((((X32TCOL1(GETLE32(pdest)))+((X32COL1(color)) * m1))&0xFF00FF00)>>8);
+     b=((((X32TCOL2(GETLE32(pdest)))+((X32COL2(color)) * m2))&0xFF00FF00)>>8);
+     g=((((X32TCOL3(GETLE32(pdest)))+((X32COL3(color)) * m3))&0xFF00FF00)>>8);
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
-     r=(X32COL1(GETLE32(pdest)))+(((((X32COL1(color)))* g_m1)&0xFF80FF80)>>7);
-     b=(X32COL2(GETLE32(pdest)))+(((((X32COL2(color)))* g_m2)&0xFF80FF80)>>7);
-     g=(X32COL3(GETLE32(pdest)))+(((((X32COL3(color)))* g_m3)&0xFF80FF80)>>7);
+     r=(X32COL1(GETLE32(pdest)))+(((((X32COL1(color)))* m1)&0xFF80FF80)>>7);
+     b=(X32COL2(GETLE32(pdest)))+(((((X32COL2(color)))* m2)&0xFF80FF80)>>7);
+     g=(X32COL3(GETLE32(pdest)))+(((((X32COL3(color)))* m3)&0xFF80FF80)>>7);
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      int32_t t;
-     r=(((((X32COL1(color)))* g_m1)&0xFF80FF80)>>7);
+     r=(((((X32COL1(color)))* m1)&0xFF80FF80)>>7);
      t=(GETLE32(pdest)&0x001f0000)-(r&0x003f0000); if(t&0x80000000) t=0;
      r=(GETLE32(pdest)&0x0000001f)-(r&0x0000003f); if(r&0x80000000) r=0;
      r|=t;
 
-     b=(((((X32COL2(color)))* g_m2)&0xFF80FF80)>>7);
+     b=(((((X32COL2(color)))* m2)&0xFF80FF80)>>7);
      t=((GETLE32(pdest)>>5)&0x001f0000)-(b&0x003f0000); if(t&0x80000000) t=0;
      b=((GETLE32(pdest)>>5)&0x0000001f)-(b&0x0000003f); if(b&0x80000000) b=0;
      b|=t;
 
-     g=(((((X32COL3(color)))* g_m3)&0xFF80FF80)>>7);
+     g=(((((X32COL3(color)))* m3)&0xFF80FF80)>>7);
      t=((GETLE32(pdest)>>10)&0x001f0000)-(g&0x003f0000); if(t&0x80000000) t=0;
      g=((GETLE32(pdest)>>10)&0x0000001f)-(g&0x0000003f); if(g&0x80000000) g=0;
      g|=t;
@@ -550,35 +576,35 @@ static inline void GetTextureTransColG32(uint32_t * pdest,uint32_t color)
    else
     {
 #ifdef HALFBRIGHTMODE3
-     r=(X32COL1(GETLE32(pdest)))+(((((X32BCOL1(color))>>2)* g_m1)&0xFF80FF80)>>7);
-     b=(X32COL2(GETLE32(pdest)))+(((((X32BCOL2(color))>>2)* g_m2)&0xFF80FF80)>>7);
-     g=(X32COL3(GETLE32(pdest)))+(((((X32BCOL3(color))>>2)* g_m3)&0xFF80FF80)>>7);
+     r=(X32COL1(GETLE32(pdest)))+(((((X32BCOL1(color))>>2)* m1)&0xFF80FF80)>>7);
+     b=(X32COL2(GETLE32(pdest)))+(((((X32BCOL2(color))>>2)* m2)&0xFF80FF80)>>7);
+     g=(X32COL3(GETLE32(pdest)))+(((((X32BCOL3(color))>>2)* m3)&0xFF80FF80)>>7);
 #else
-     r=(X32COL1(GETLE32(pdest)))+(((((X32ACOL1(color))>>1)* g_m1)&0xFF80FF80)>>7);
-     b=(X32COL2(GETLE32(pdest)))+(((((X32ACOL2(color))>>1)* g_m2)&0xFF80FF80)>>7);
-     g=(X32COL3(GETLE32(pdest)))+(((((X32ACOL3(color))>>1)* g_m3)&0xFF80FF80)>>7);
+     r=(X32COL1(GETLE32(pdest)))+(((((X32ACOL1(color))>>1)* m1)&0xFF80FF80)>>7);
+     b=(X32COL2(GETLE32(pdest)))+(((((X32ACOL2(color))>>1)* m2)&0xFF80FF80)>>7);
+     g=(X32COL3(GETLE32(pdest)))+(((((X32ACOL3(color))>>1)* m3)&0xFF80FF80)>>7);
 #endif
     }
 
    if(!(color&0x8000))
     {
-     r=(r&0xffff0000)|((((X32COL1(color))* g_m1)&0x0000FF80)>>7);
-     b=(b&0xffff0000)|((((X32COL2(color))* g_m2)&0x0000FF80)>>7);
-     g=(g&0xffff0000)|((((X32COL3(color))* g_m3)&0x0000FF80)>>7);
+     r=(r&0xffff0000)|((((X32COL1(color))* m1)&0x0000FF80)>>7);
+     b=(b&0xffff0000)|((((X32COL2(color))* m2)&0x0000FF80)>>7);
+     g=(g&0xffff0000)|((((X32COL3(color))* m3)&0x0000FF80)>>7);
     }
    if(!(color&0x80000000))
     {
-     r=(r&0xffff)|((((X32COL1(color))* g_m1)&0xFF800000)>>7);
-     b=(b&0xffff)|((((X32COL2(color))* g_m2)&0xFF800000)>>7);
-     g=(g&0xffff)|((((X32COL3(color))* g_m3)&0xFF800000)>>7);
+     r=(r&0xffff)|((((X32COL1(color))* m1)&0xFF800000)>>7);
+     b=(b&0xffff)|((((X32COL2(color))* m2)&0xFF800000)>>7);
+     g=(g&0xffff)|((((X32COL3(color))* m3)&0xFF800000)>>7);
     }
 
   }
  else 
   {
-   r=(((X32COL1(color))* g_m1)&0xFF80FF80)>>7;
-   b=(((X32COL2(color))* g_m2)&0xFF80FF80)>>7;
-   g=(((X32COL3(color))* g_m3)&0xFF80FF80)>>7;
+   r=(((X32COL1(color))* m1)&0xFF80FF80)>>7;
+   b=(((X32COL2(color))* m2)&0xFF80FF80)>>7;
+   g=(((X32COL3(color))* m3)&0xFF80FF80)>>7;
   }
 
  if(r&0x7FE00000) r=0x1f0000|(r&0xFFFF);
@@ -588,7 +614,7 @@ static inline void GetTextureTransColG32(uint32_t * pdest,uint32_t color)
  if(g&0x7FE00000) g=0x1f0000|(g&0xFFFF);
  if(g&0x7FE0)     g=0x1f    |(g&0xFFFF0000);
          
- if(bCheckMask) 
+ if(mask) 
   {
    uint32_t ma=GETLE32(pdest);
 
@@ -607,6 +633,11 @@ static inline void GetTextureTransColG32(uint32_t * pdest,uint32_t color)
  PUTLE32(pdest, (X32PSXCOL(r,g,b))|l);
 }
 
+static inline void GetTextureTransColG32(uint32_t * pdest,uint32_t color)
+{
+ TextureTransColG32(pdest,color,g_m1,g_m2,g_m3,DrawSemiTrans,GlobalTextABR,bCheckMask,lSetMask);
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 static inline void GetTextureTransColG32_S(uint32_t * pdest,uint32_t color)
@@ -736,39 +767,40 @@ static inline void GetTextureTransColG32_SPR(uint32_t * pdest,uint32_t color)
 
 ////////////////////////////////////////////////////////////////////////
 
-static inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned short color,int32_t m1,int32_t m2,int32_t m3)
+SOFT_INLINE void TextureTransColGX_Dither(unsigned short * pdest,unsigned short color,int32_t m1,int32_t m2,int32_t m3,
+ int semi, int abr, int mask, unsigned short smask)
 {
  int32_t r,g,b;
 
  if(color==0) return;
  
- if(bCheckMask && (*pdest & HOST2LE16(0x8000))) return;
+ if(mask && (*pdest & HOST2LE16(0x8000))) return;
 
  m1=(((XCOL1D(color)))*m1)>>4;
  m2=(((XCOL2D(color)))*m2)>>4;
  m3=(((XCOL3D(color)))*m3)>>4;
 
- if(DrawSemiTrans && (color&0x8000))
+ if(semi && (color&0x8000))
   {
    r=((XCOL1D(GETLE16(pdest)))<<3);
    b=((XCOL2D(GETLE16(pdest)))<<3);
    g=((XCOL3D(GETLE16(pdest)))<<3);
 
-   if(GlobalTextABR==0)
+   if(abr==0)
     {
      r=(r>>1)+(m1>>1);
      b=(b>>1)+(m2>>1);
      g=(g>>1)+(m3>>1);
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
      r+=m1;
      b+=m2;
      g+=m3;
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      r-=m1;
      b-=m2;
@@ -801,25 +833,31 @@ static inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned s
  if(b&0x7FFFFF00) b=0xff;
  if(g&0x7FFFFF00) g=0xff;
 
- Dither16(pdest,r,b,g,sSetMask|(color&0x8000));
+ Dither16(pdest,r,b,g,smask|(color&0x8000));
+
+}
 
+static inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned short color,int32_t m1,int32_t m2,int32_t m3)
+{
+ TextureTransColGX_Dither(pdest,color,m1,m2,m3,DrawSemiTrans,GlobalTextABR,bCheckMask,sSetMask);
 }
 
 ////////////////////////////////////////////////////////////////////////
 
-static inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
+SOFT_INLINE void TextureTransColGX(unsigned short * pdest,unsigned short color,int32_t m1,int32_t m2,int32_t m3,
+ int semi, int abr, int mask, unsigned short smask)
 {
  int32_t r,g,b;unsigned short l;
 
  if(color==0) return;
  
- if(bCheckMask && (*pdest & HOST2LE16(0x8000))) return;
+ if(mask && (*pdest & HOST2LE16(0x8000))) return;
 
- l=sSetMask|(color&0x8000);
+ l=smask|(color&0x8000);
 
- if(DrawSemiTrans && (color&0x8000))
+ if(semi && (color&0x8000))
   {
-   if(GlobalTextABR==0)
+   if(abr==0)
     {
      unsigned short d;
      d     =(GETLE16(pdest)&0x7bde)>>1;
@@ -829,14 +867,14 @@ static inline void GetTextureTransColGX(unsigned short * pdest,unsigned short co
      g=(XCOL3(d))+((((XCOL3(color)))* m3)>>7);
     }
    else
-   if(GlobalTextABR==1)
+   if(abr==1)
     {
      r=(XCOL1(GETLE16(pdest)))+((((XCOL1(color)))* m1)>>7);
      b=(XCOL2(GETLE16(pdest)))+((((XCOL2(color)))* m2)>>7);
      g=(XCOL3(GETLE16(pdest)))+((((XCOL3(color)))* m3)>>7);
     }
    else
-   if(GlobalTextABR==2)
+   if(abr==2)
     {
      r=(XCOL1(GETLE16(pdest)))-((((XCOL1(color)))* m1)>>7);
      b=(XCOL2(GETLE16(pdest)))-((((XCOL2(color)))* m2)>>7);
@@ -872,6 +910,11 @@ static inline void GetTextureTransColGX(unsigned short * pdest,unsigned short co
  PUTLE16(pdest, (XPSXCOL(r,g,b))|l);
 }
 
+static inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
+{
+ TextureTransColGX(pdest,color,m1,m2,m3,DrawSemiTrans,GlobalTextABR,bCheckMask,sSetMask);
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 static inline void GetTextureTransColGX_S(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
@@ -916,6 +959,209 @@ static inline void GetTextureTransColGX32_S(uint32_t * pdest,uint32_t color,shor
  PUTLE32(pdest, (X32PSXCOL(r,g,b))|lSetMask|(color&0x80008000));
 }
 
+////////////////////////////////////////////////////////////////////////
+// SPAN FUNCS
+////////////////////////////////////////////////////////////////////////
+
+// The non-solid poly loops hand each row over to a span func. The span
+// funcs are instantiated per blend state (semi trans + abr, mask check)
+// and picked once per primitive, so the per pixel funcs see constants
+// instead of re-reading the globals after every vram store.
+// Textured spans get the texels of the row already fetched in 'tex'.
+
+#define SPAN_STATE() ((DrawSemiTrans ? 1 + GlobalTextABR : 0) * 2 + (bCheckMask ? 1 : 0))
+
+typedef void (*SpanF_t)(unsigned short *pdest, int n, unsigned short color);
+typedef void (*SpanG_t)(unsigned short *pdest, int n,
+                        int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB);
+typedef void (*SpanFT_t)(unsigned short *pdest, const unsigned short *tex, int n);
+typedef void (*SpanGT_t)(unsigned short *pdest, const unsigned short *tex, int n,
+                         int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB);
+
+SOFT_INLINE void SpanF(unsigned short *pdest, int n, unsigned short color,
+ int semi, int abr, int mask)
+{
+ uint32_t lmask=lSetMask;
+ unsigned short smask=sSetMask;
+ uint32_t lcolor=lmask|(((uint32_t)(color))<<16)|color;
+
+ for(;n>=2;n-=2,pdest+=2)
+  ShadeTransCol32((uint32_t *)pdest,lcolor,semi,abr,mask,lmask);
+ if(n>0)
+  ShadeTransCol(pdest,color,semi,abr,mask,smask);
+}
+
+#define GCOL(cR,cG,cB) ((((cR) >> 9)&0x7c00)|(((cG) >> 14)&0x03e0)|(((cB) >> 19)&0x001f))
+
+SOFT_INLINE void SpanG(unsigned short *pdest, int n,
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB,
+ int semi, int abr, int mask)
+{
+ uint32_t lmask=lSetMask;
+ unsigned short smask=sSetMask;
+
+ // 32 bit subtractive blending uses the low pixel's color for both
+ if(!(semi && abr==2))
+  for(;n>=2;n-=2,pdest+=2)
+   {
+    ShadeTransCol32((uint32_t *)pdest,
+     GCOL(cR,cG,cB)|((uint32_t)GCOL(cR+dR,cG+dG,cB+dB)<<16),
+     semi,abr,mask,lmask);
+    cR+=dR<<1;cG+=dG<<1;cB+=dB<<1;
+   }
+ for(;n>0;n--,pdest++)
+  {
+   ShadeTransCol(pdest,GCOL(cR,cG,cB),semi,abr,mask,smask);
+   cR+=dR;cG+=dG;cB+=dB;
+  }
+}
+
+SOFT_INLINE void SpanGD(unsigned short *pdest, int n,
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB,
+ int semi, int abr, int mask)
+{
+ unsigned short smask=sSetMask;
+
+ for(;n>0;n--,pdest++)
+  {
+   ShadeTransCol_Dither(pdest,cB>>16,cG>>16,cR>>16,semi,abr,mask,smask);
+   cR+=dR;cG+=dG;cB+=dB;
+  }
+}
+
+SOFT_INLINE void SpanFT(unsigned short *pdest, const unsigned short *tex, int n,
+ int semi, int abr, int mask)
+{
+ int32_t m1=g_m1,m2=g_m2,m3=g_m3;
+ uint32_t lmask=lSetMask;
+ unsigned short smask=sSetMask;
+
+ for(;n>=2;n-=2,pdest+=2,tex+=2)
+  TextureTransColG32((uint32_t *)pdest,tex[0]|((uint32_t)tex[1]<<16),
+   m1,m2,m3,semi,abr,mask,lmask);
+ if(n>0)
+  TextureTransColGX(pdest,tex[0],m1,m2,m3,semi,abr,mask,smask);
+}
+
+SOFT_INLINE void SpanGT(unsigned short *pdest, const unsigned short *tex, int n,
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB,
+ int semi, int abr, int mask)
+{
+ unsigned short smask=sSetMask;
+
+ for(;n>0;n--,pdest++,tex++)
+  {
+   TextureTransColGX(pdest,*tex,(short)(cB>>16),(short)(cG>>16),(short)(cR>>16),
+    semi,abr,mask,smask);
+   cR+=dR;cG+=dG;cB+=dB;
+  }
+}
+
+SOFT_INLINE void SpanGTD(unsigned short *pdest, const unsigned short *tex, int n,
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB,
+ int semi, int abr, int mask)
+{
+ unsigned short smask=sSetMask;
+
+ for(;n>0;n--,pdest++,tex++)
+  {
+   TextureTransColGX_Dither(pdest,*tex,cB>>16,cG>>16,cR>>16,
+    semi,abr,mask,smask);
+   cR+=dR;cG+=dG;cB+=dB;
+  }
+}
+
+static inline void PutTexel32(unsigned short *tex, uint32_t color)
+{
+ tex[0]=(unsigned short)color;
+ tex[1]=(unsigned short)(color>>16);
+}
+
+// A textured poly may draw over its own texels or clut. The per pixel loops
+// read each texel after the pixels before it got written, so rows which cover
+// anything the row reads hand pairs/single pixels to the span func instead of
+// a whole prefetched row. Without a texture window u/v are not wrapped to the
+// page, so the read area is taken from the row's u/v at both ends.
+
+static int spanTexShift,spanTexWin,spanClX0,spanClX1,spanClY;
+
+static inline void SetSpanTexArea(int shift, int win, short clX, short clY, int cw)
+{
+ spanTexShift=shift;spanTexWin=win;
+ spanClX0=clX;spanClX1=clX+cw-1;
+ spanClY=cw?clY:-1;
+}
+
+static inline int SpanSelfTex(int y, int x0, int x1,
+                              int32_t posX, int32_t posY, int32_t difX, int32_t difY)
+{
+ int tx0,tx1,ty0,ty1;
+
+ if(y==spanClY && x1>=spanClX0 && x0<=spanClX1) return 1;
+ if(spanClX1>1023 && y==spanClY+1 && x0<=spanClX1-1024) return 1;
+
+ if(spanTexWin)
+  {
+   tx0=TWin.Position.x0;tx1=tx0+TWin.xmask;
+   ty0=TWin.Position.y0;ty1=ty0+TWin.ymask;
+  }
+ else
+  {
+   int64_t u1=(int64_t)posX+(int64_t)difX*(x1-x0);
+   int64_t v1=(int64_t)posY+(int64_t)difY*(x1-x0);
+   if(u1!=(int32_t)u1 || v1!=(int32_t)v1) return 1;
+   tx0=posX>>16;tx1=(int32_t)u1>>16;
+   ty0=posY>>16;ty1=(int32_t)v1>>16;
+   if(tx0>tx1) {int t=tx0;tx0=tx1;tx1=t;}
+   if(ty0>ty1) {int t=ty0;ty0=ty1;ty1=t;}
+  }
+ tx0=GlobalTextAddrX+(tx0>>spanTexShift);
+ tx1=GlobalTextAddrX+(tx1>>spanTexShift);
+ ty0+=GlobalTextAddrY;ty1+=GlobalTextAddrY;
+ if(tx0<0 || tx1>1023)                                 // reads spill into the rows around
+  {tx0=0;tx1=1023;ty0--;ty1++;}
+
+ return y>=ty0 && y<=ty1 && x1>=tx0 && x0<=tx1;
+}
+
+#define SPAN_FUNCS(st, semi, abr, mask) \
+static void SpanF_##st(unsigned short *pdest, int n, unsigned short color) \
+{ SpanF(pdest, n, color, semi, abr, mask); } \
+static void SpanG_##st(unsigned short *pdest, int n, \
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB) \
+{ SpanG(pdest, n, cR, cG, cB, dR, dG, dB, semi, abr, mask); } \
+static void SpanGD_##st(unsigned short *pdest, int n, \
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB) \
+{ SpanGD(pdest, n, cR, cG, cB, dR, dG, dB, semi, abr, mask); } \
+static void SpanFT_##st(unsigned short *pdest, const unsigned short *tex, int n) \
+{ SpanFT(pdest, tex, n, semi, abr, mask); } \
+static void SpanGT_##st(unsigned short *pdest, const unsigned short *tex, int n, \
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB) \
+{ SpanGT(pdest, tex, n, cR, cG, cB, dR, dG, dB, semi, abr, mask); } \
+static void SpanGTD_##st(unsigned short *pdest, const unsigned short *tex, int n, \
+ int32_t cR, int32_t cG, int32_t cB, int32_t dR, int32_t dG, int32_t dB) \
+{ SpanGTD(pdest, tex, n, cR, cG, cB, dR, dG, dB, semi, abr, mask); }
+
+SPAN_FUNCS(0, 0, 0, 0)
+SPAN_FUNCS(1, 0, 0, 1)
+SPAN_FUNCS(2, 1, 0, 0)
+SPAN_FUNCS(3, 1, 0, 1)
+SPAN_FUNCS(4, 1, 1, 0)
+SPAN_FUNCS(5, 1, 1, 1)
+SPAN_FUNCS(6, 1, 2, 0)
+SPAN_FUNCS(7, 1, 2, 1)
+SPAN_FUNCS(8, 1, 3, 0)
+SPAN_FUNCS(9, 1, 3, 1)
+
+#define SPAN_TABLE(f) { f##_0, f##_1, f##_2, f##_3, f##_4, f##_5, f##_6, f##_7, f##_8, f##_9 }
+
+static const SpanF_t  SpanF_table[10]   = SPAN_TABLE(SpanF);
+static const SpanG_t  SpanG_table[10]   = SPAN_TABLE(SpanG);
+static const SpanG_t  SpanGD_table[10]  = SPAN_TABLE(SpanGD);
+static const SpanFT_t SpanFT_table[10]  = SPAN_TABLE(SpanFT);
+static const SpanGT_t SpanGT_table[10]  = SPAN_TABLE(SpanGT);
+static const SpanGT_t SpanGTD_table[10] = SPAN_TABLE(SpanGTD);
+
 ////////////////////////////////////////////////////////////////////////
 // FILL FUNCS
 ////////////////////////////////////////////////////////////////////////
@@ -2379,6 +2625,7 @@ static inline void drawPoly3Fi(short x1,short y1,short x2,short y2,short x3,shor
 {
  int i,j,xmin,xmax,ymin,ymax;
  unsigned short color;uint32_t lcolor;
+ SpanF_t spanF;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -2420,17 +2667,14 @@ static inline void drawPoly3Fi(short x1,short y1,short x2,short y2,short x3,shor
 
 #endif
 
+ spanF=SpanF_table[SPAN_STATE()];
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=left_x >> 16;      if(drawX>xmin) xmin=drawX;
    xmax=(right_x >> 16)-1; if(drawW<xmax) xmax=drawW;
 
-   for(j=xmin;j<xmax;j+=2) 
-    {
-     GetShadeTransCol32((uint32_t *)&psxVuw[(i<<10)+j],lcolor);
-    }
-   if(j==xmax)
-    GetShadeTransCol(&psxVuw[(i<<10)+j],color);
+   spanF(&psxVuw[(i<<10)+xmin],xmax-xmin+1,color);
 
    if(NextRow_F()) return;
   }
@@ -2459,6 +2703,7 @@ static void drawPoly4F(int32_t rgb)
 {
  int i,j,xmin,xmax,ymin,ymax;
  unsigned short color;uint32_t lcolor;
+ SpanF_t spanF;
  
  if(lx0>drawW && lx1>drawW && lx2>drawW && lx3>drawW) return;
  if(ly0>drawH && ly1>drawH && ly2>drawH && ly3>drawH) return;
@@ -2500,16 +2745,14 @@ static void drawPoly4F(int32_t rgb)
 
 #endif
 
+ spanF=SpanF_table[SPAN_STATE()];
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=left_x >> 16;      if(drawX>xmin) xmin=drawX;
    xmax=(right_x >> 16)-1; if(drawW<xmax) xmax=drawW;
 
-   for(j=xmin;j<xmax;j+=2) 
-    {
-     GetShadeTransCol32((uint32_t *)&psxVuw[(i<<10)+j],lcolor);
-    }
-   if(j==xmax) GetShadeTransCol(&psxVuw[(i<<10)+j],color);
+   spanF(&psxVuw[(i<<10)+xmin],xmax-xmin+1,color);
 
    if(NextRow_F4()) return;
   }
@@ -2533,6 +2776,9 @@ static void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, shor
  if(y1<drawY && y2<drawY && y3<drawY) return;
  if(drawY>=drawH) return;
  if(drawX>=drawW) return; 
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(!SetupSections_FT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3)) return;
 
@@ -2602,6 +2848,9 @@ static void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, shor
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(2,0,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -2616,6 +2865,7 @@ static void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, shor
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        XAdjust=(posX>>16);
@@ -2626,9 +2876,10 @@ static void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, shor
                     (XAdjust>>1)];
        tC2=(tC2>>((XAdjust&1)<<2))&0xf;
 
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
            GETLE16(&psxVuw[clutP+tC1])|
            ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
@@ -2639,8 +2890,10 @@ static void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, shor
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+
                     (XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -2665,6 +2918,9 @@ static void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
  if(y1<drawY && y2<drawY && y3<drawY) return;
  if(drawY>=drawH) return;
  if(drawX>=drawW) return; 
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(!SetupSections_FT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3)) return;
 
@@ -2738,6 +2994,9 @@ static void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(2,1,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -2752,6 +3011,7 @@ static void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        XAdjust=(posX>>16)&TWin.xmask;
@@ -2763,9 +3023,10 @@ static void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
                     YAdjust+(XAdjust>>1)];
        tC2=(tC2>>((XAdjust&1)<<2))&0xf;
 
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
            GETLE16(&psxVuw[clutP+tC1])|
            ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
@@ -2776,8 +3037,10 @@ static void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+(XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -2811,6 +3074,9 @@ static void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, shor
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -2888,6 +3154,9 @@ static void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, shor
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(2,0,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -2909,6 +3178,7 @@ static void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, shor
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        XAdjust=(posX>>16);
@@ -2919,9 +3189,10 @@ static void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, shor
                      (XAdjust>>1)];
        tC2=(tC2>>((XAdjust&1)<<2))&0xf;
 
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -2931,8 +3202,10 @@ static void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, shor
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+
                     (XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -2947,6 +3220,9 @@ static void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3025,6 +3301,9 @@ static void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(2,1,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3046,6 +3325,7 @@ static void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        XAdjust=(posX>>16)&TWin.xmask;
@@ -3057,9 +3337,10 @@ static void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
                     YAdjust+(XAdjust>>1)];
        tC2=(tC2>>((XAdjust&1)<<2))&0xf;
 
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3069,8 +3350,10 @@ static void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, s
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+(XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -3085,6 +3368,9 @@ static void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3,
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3163,6 +3449,9 @@ static void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3,
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(2,1,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3184,6 +3473,7 @@ static void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3,
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        XAdjust=(posX>>16)&TWin.xmask;
@@ -3195,9 +3485,10 @@ static void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3,
                     YAdjust+(XAdjust>>1)];
        tC2=(tC2>>((XAdjust&1)<<2))&0xf;
 
-       GetTextureTransColG32_SPR((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3207,8 +3498,10 @@ static void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3,
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+(XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       GetTextureTransColG_SPR(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -3223,6 +3516,9 @@ static void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, shor
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -3291,6 +3587,9 @@ static void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, shor
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(1,0,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3305,14 +3604,16 @@ static void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, shor
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(posX>>16)];
        tC2 = psxVub[(((posY+difY)>>5)&(int32_t)0xFFFFF800)+YAdjust+
                     ((posX+difX)>>16)];
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
            GETLE16(&psxVuw[clutP+tC1])|
            ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3320,9 +3621,11 @@ static void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, shor
      if(j==xmax)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(posX>>16)];
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
 
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -3339,6 +3642,9 @@ static void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -3412,6 +3718,9 @@ static void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(1,1,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3426,15 +3735,17 @@ static void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
        tC2 = psxVub[((((posY+difY)>>16)&TWin.ymask)<<11)+
                     YAdjust+(((posX+difX)>>16)&TWin.xmask)];
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
            GETLE16(&psxVuw[clutP+tC1])|
            ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3443,9 +3754,11 @@ static void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
       {
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
 
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -3480,6 +3793,9 @@ static void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, shor
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3548,6 +3864,9 @@ static void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, shor
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(1,0,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3569,22 +3888,26 @@ static void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, shor
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(posX>>16)];
        tC2 = psxVub[(((posY+difY)>>5)&(int32_t)0xFFFFF800)+YAdjust+
                      ((posX+difX)>>16)];
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(posX>>16)];
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -3599,6 +3922,9 @@ static void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3670,6 +3996,9 @@ static void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(1,1,clX,clY,256);
+
 
  for (i=ymin;i<=ymax;i++)
   {
@@ -3692,15 +4021,17 @@ static void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
        tC2 = psxVub[((((posY+difY)>>16)&TWin.ymask)<<11)+
                      YAdjust+(((posX+difX)>>16)&TWin.xmask)];
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3708,8 +4039,10 @@ static void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, s
       {
        tC1 = psxVub[((((posY+difY)>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
-       GetTextureTransColG(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -3724,6 +4057,9 @@ static void drawPoly4TEx8_TW_S(short x1, short y1, short x2, short y2, short x3,
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3795,6 +4131,9 @@ static void drawPoly4TEx8_TW_S(short x1, short y1, short x2, short y2, short x3,
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(1,1,clX,clY,256);
+
 
  for (i=ymin;i<=ymax;i++)
   {
@@ -3817,15 +4156,17 @@ static void drawPoly4TEx8_TW_S(short x1, short y1, short x2, short y2, short x3,
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
        tC2 = psxVub[((((posY+difY)>>16)&TWin.ymask)<<11)+
                      YAdjust+(((posX+difX)>>16)&TWin.xmask)];
-       GetTextureTransColG32_SPR((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             GETLE16(&psxVuw[clutP+tC1])|
             ((int32_t)GETLE16(&psxVuw[clutP+tC2]))<<16);
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
        posX+=difX2;
        posY+=difY2;
       }
@@ -3833,8 +4174,10 @@ static void drawPoly4TEx8_TW_S(short x1, short y1, short x2, short y2, short x3,
       {
        tC1 = psxVub[((((posY+difY)>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
-       GetTextureTransColG_SPR(&psxVuw[(i<<10)+j],GETLE16(&psxVuw[clutP+tC1]));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
       }
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -3849,6 +4192,9 @@ static void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short
  int i,j,xmin,xmax,ymin,ymax;
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -3908,6 +4254,9 @@ static void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(0,0,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -3922,18 +4271,21 @@ static void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             (((int32_t)GETLE16(&psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX]))<<16)|
             GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]));
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
-       GetTextureTransColG(&psxVuw[(i<<10)+j],
-           GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]));
+       tex[j-xmin]=GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -3949,6 +4301,9 @@ static void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, sho
  int i,j,xmin,xmax,ymin,ymax;
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -4011,6 +4366,9 @@ static void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(0,1,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4025,21 +4383,24 @@ static void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, sho
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             (((int32_t)GETLE16(&psxVuw[(((((posY+difY)>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
             (((posX+difX)>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]))<<16)|
             GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
                    (((posX)>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
-       GetTextureTransColG(&psxVuw[(i<<10)+j],
-           GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-                  ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+       tex[j-xmin]=GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
+                  ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]);
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT()) 
     {
@@ -4071,6 +4432,9 @@ static void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short
  int32_t i,j,xmin,xmax,ymin,ymax;
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -4131,6 +4495,9 @@ static void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(0,0,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4152,18 +4519,21 @@ static void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             (((int32_t)GETLE16(&psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX]))<<16)|
             GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]));
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
-      GetTextureTransColG(&psxVuw[(i<<10)+j],
-         GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]));
+      tex[j-xmin]=GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -4177,6 +4547,9 @@ static void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, sho
  int32_t i,j,xmin,xmax,ymin,ymax;
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -4240,6 +4613,9 @@ static void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(0,1,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4261,21 +4637,24 @@ static void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, sho
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
-       GetTextureTransColG32((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             (((int32_t)GETLE16(&psxVuw[(((((posY+difY)>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
                            (((posX+difX)>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]))<<16)|
             GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
                    ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
-      GetTextureTransColG(&psxVuw[(i<<10)+j],
-         GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-                ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+      tex[j-xmin]=GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
+                ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]);
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -4289,6 +4668,9 @@ static void drawPoly4TD_TW_S(short x1, short y1, short x2, short y2, short x3, s
  int32_t i,j,xmin,xmax,ymin,ymax;
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanFT_t spanFT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -4352,6 +4734,9 @@ static void drawPoly4TD_TW_S(short x1, short y1, short x2, short y2, short x3, s
 
 #endif
 
+ spanFT=SpanFT_table[SPAN_STATE()];
+ SetSpanTexArea(0,1,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4373,21 +4758,24 @@ static void drawPoly4TD_TW_S(short x1, short y1, short x2, short y2, short x3, s
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<xmax;j+=2)
       {
-       GetTextureTransColG32_SPR((uint32_t *)&psxVuw[(i<<10)+j],
+       PutTexel32(&tex[j-xmin],
             (((int32_t)GETLE16(&psxVuw[(((((posY+difY)>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
                            (((posX+difX)>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]))<<16)|
             GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
                    ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+       if(selfTex) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],2);
 
        posX+=difX2;
        posY+=difY2;
       }
      if(j==xmax)
-      GetTextureTransColG_SPR(&psxVuw[(i<<10)+j],
-         GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-                ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]));
+      tex[j-xmin]=GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
+                ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]);
+     if(!selfTex) spanFT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1);
+     else if(j==xmax) spanFT(&psxVuw[(i<<10)+j],&tex[j-xmin],1);
     }
    if(NextRow_FT4()) return;
   }
@@ -4402,6 +4790,7 @@ static inline void drawPoly3Gi(short x1,short y1,short x2,short y2,short x3,shor
  int i,j,xmin,xmax,ymin,ymax;
  int32_t cR1,cG1,cB1;
  int32_t difR,difB,difG,difR2,difB2,difG2;
+ SpanG_t spanG;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -4462,33 +4851,8 @@ static inline void drawPoly3Gi(short x1,short y1,short x2,short y2,short x3,shor
 
 #endif
 
- if(iDither==2)
- for (i=ymin;i<=ymax;i++)
-  {
-   xmin=(left_x >> 16);
-   xmax=(right_x >> 16)-1;if(drawW<xmax) xmax=drawW;
-
-   if(xmax>=xmin)
-    {
-     cR1=left_R;
-     cG1=left_G;
-     cB1=left_B;
+ spanG=(iDither==2)?SpanGD_table[SPAN_STATE()]:SpanG_table[SPAN_STATE()];
 
-     if(xmin<drawX)
-      {j=drawX-xmin;xmin=drawX;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
-
-     for(j=xmin;j<=xmax;j++) 
-      {
-       GetShadeTransCol_Dither(&psxVuw[(i<<10)+j],(cB1>>16),(cG1>>16),(cR1>>16));
-
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
-      }
-    }
-   if(NextRow_G()) return;
-  }
- else
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4503,18 +4867,10 @@ static inline void drawPoly3Gi(short x1,short y1,short x2,short y2,short x3,shor
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
-     for(j=xmin;j<=xmax;j++) 
-      {
-       GetShadeTransCol(&psxVuw[(i<<10)+j],((cR1 >> 9)&0x7c00)|((cG1 >> 14)&0x03e0)|((cB1 >> 19)&0x001f));
-
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
-      }
+     spanG(&psxVuw[(i<<10)+xmin],xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_G()) return;
   }
-
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -4546,6 +4902,9 @@ static void drawPoly3TGEx4(short x1, short y1, short x2, short y2, short x3, sho
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -4638,6 +4997,9 @@ static void drawPoly3TGEx4(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(2,0,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4655,25 +5017,22 @@ static void drawPoly3TGEx4(short x1, short y1, short x2, short y2, short x3, sho
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++) 
       {
        XAdjust=(posX>>16);
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -4692,6 +5051,9 @@ static void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3,
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -4786,6 +5148,9 @@ static void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3,
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(2,1,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4803,26 +5168,23 @@ static void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3,
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++) 
       {
        XAdjust=(posX>>16)&TWin.xmask;
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+(XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -4871,6 +5233,9 @@ static void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, sho
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP,XAdjust;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -4967,6 +5332,9 @@ static void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(2,0,clX,clY,16);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -4998,26 +5366,23 @@ static void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, sho
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
        XAdjust=(posX>>16);
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+
                     (XAdjust>>1)];
        tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-           GETLE16(&psxVuw[clutP+tC1]),
-           (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-           GETLE16(&psxVuw[clutP+tC1]),
-           (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT4()) return;
   }
@@ -5053,6 +5418,9 @@ static void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, sho
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -5137,6 +5505,9 @@ static void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(1,0,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5154,23 +5525,20 @@ static void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, sho
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+((posX>>16))];
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -5189,6 +5557,9 @@ static void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3,
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -5277,6 +5648,9 @@ static void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3,
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(1,1,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5294,24 +5668,21 @@ static void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3,
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
        tC1 = psxVub[(((posY>>16)&TWin.ymask)<<11)+
                     YAdjust+((posX>>16)&TWin.xmask)];
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-            (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -5355,6 +5726,9 @@ static void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, sho
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY,YAdjust,clutP;
  short tC1,tC2;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -5442,6 +5816,9 @@ static void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, sho
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(1,0,clX,clY,256);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5473,23 +5850,20 @@ static void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, sho
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
        tC1 = psxVub[((posY>>5)&(int32_t)0xFFFFF800)+YAdjust+(posX>>16)];
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-           (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j], 
-            GETLE16(&psxVuw[clutP+tC1]),
-           (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[clutP+tC1]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT4()) return;
   }
@@ -5523,6 +5897,9 @@ static void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short
  int32_t difR,difB,difG,difR2,difB2,difG2;
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -5597,6 +5974,9 @@ static void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(0,0,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5614,22 +5994,19 @@ static void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -5647,6 +6024,9 @@ static void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, sh
  int32_t difR,difB,difG,difR2,difB2,difG2;
  int32_t difX, difY,difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH) return;
@@ -5724,6 +6104,9 @@ static void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, sh
 
 #endif
 
+ spanGT=iDither?SpanGTD_table[SPAN_STATE()]:SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(0,1,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5741,24 +6124,20 @@ static void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, sh
      if(xmin<drawX)
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
-       if(iDither)
-        GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-                 ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-                 ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[((((posY>>16)&TWin.ymask)+GlobalTextAddrY+TWin.Position.y0)<<10)+
+                 ((posX>>16)&TWin.xmask)+GlobalTextAddrX+TWin.Position.x0]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT()) 
     {
@@ -5793,6 +6172,9 @@ static void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short
  int32_t difR,difB,difG,difR2,difB2,difG2;
  int32_t difX, difY, difX2, difY2;
  int32_t posX,posY;
+ unsigned short tex[1024];
+ int selfTex;
+ SpanGT_t spanGT;
 
  if(x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
  if(y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -5869,6 +6251,9 @@ static void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short
 
 #endif
 
+ spanGT=SpanGT_table[SPAN_STATE()];
+ SetSpanTexArea(0,0,0,0,0);
+
  for (i=ymin;i<=ymax;i++)
   {
    xmin=(left_x >> 16);
@@ -5900,22 +6285,19 @@ static void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short
       {j=drawX-xmin;xmin=drawX;posX+=j*difX;posY+=j*difY;cR1+=j*difR;cG1+=j*difG;cB1+=j*difB;}
      xmax--;if(drawW<xmax) xmax=drawW;
 
+     selfTex=SpanSelfTex(i,xmin,xmax,posX,posY,difX,difY);
      for(j=xmin;j<=xmax;j++)
       {
-       if(iDither)
-        GetTextureTransColGX(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
-       else
-        GetTextureTransColGX(&psxVuw[(i<<10)+j],
-          GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]),
-          (cB1>>16),(cG1>>16),(cR1>>16));
+       tex[j-xmin]=GETLE16(&psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+       if(selfTex)
+        {
+         spanGT(&psxVuw[(i<<10)+j],&tex[j-xmin],1,cR1,cG1,cB1,difR,difG,difB);
+         cR1+=difR;cG1+=difG;cB1+=difB;
+        }
        posX+=difX;
        posY+=difY;
-       cR1+=difR;
-       cG1+=difG;
-       cB1+=difB;
       }
+     if(!selfTex) spanGT(&psxVuw[(i<<10)+xmin],tex,xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
     }
    if(NextRow_GT4()) return;
   }
@@ -6212,6 +6594,189 @@ static void drawPoly4GT(unsigned char *baseAddr)
   }
 }
                 
+////////////////////////////////////////////////////////////////////////
+// TEXTURE PAGE CACHE
+////////////////////////////////////////////////////////////////////////
+
+// 4/8 bit texture pages, already looked up in their clut. Slots are keyed
+// by page, clut and mode, the rows get decoded on demand in chunks of 8
+// texels. A slot is dropped as soon as vram under its page or clut may
+// have changed: uploads, fills and moves pass their rect, primitives the
+// whole drawing area. Pages overlapping the drawing area are not cached.
+// When slots keep getting evicted before they paid for their decoding,
+// misses go the uncached way for a while.
+
+#define TCACHE_SLOTS    8
+#define TCACHE_BACKOFF  4096                            // missed lookups to skip
+
+typedef struct
+{
+ uint32_t       key;                                   // 0: free slot
+ short          tp,px,py,cx,cy;                        // mode, page and clut pos
+ int            decoded,drawn;                         // texels, since allocation
+ uint32_t       valid[256];                            // decoded chunks per row
+ unsigned short tex[256*256];
+} TCacheSlot_t;
+
+static TCacheSlot_t TCache[TCACHE_SLOTS];
+static int          iTCacheUsed=0;
+static int          iTCacheNext=0;
+static int          iTCacheThrash=0;
+static int          iTCacheSkip=0;
+
+static inline BOOL TCacheHit(TCacheSlot_t *s,int x,int y,int w,int h)
+{
+ int pw=s->tp?128:64, cw=s->tp?256:16;
+
+ if(x<s->px+pw && x+w>s->px && y<s->py+256 && y+h>s->py) return TRUE;
+ if(x<s->cx+cw && x+w>s->cx && y<=s->cy   && y+h>s->cy) return TRUE;
+ return FALSE;
+}
+
+static void TCacheInvalidate(int x,int y,int w,int h)
+{
+ int i;
+
+ if(!iTCacheUsed) return;
+
+ if(x+w>1024 || y+h>512)                               // wraps around, drop all
+  {x=0;y=0;w=1024;h=512;}
+
+ for(i=0;i<TCACHE_SLOTS;i++)
+  {
+   if(TCache[i].key && TCacheHit(&TCache[i],x,y,w,h))
+    {
+     TCache[i].key=0;
+     iTCacheUsed--;
+    }
+  }
+}
+
+static inline void TCacheDrawn(void)
+{
+ if(iTCacheUsed)
+  TCacheInvalidate(drawX,drawY,drawW-drawX+1,drawH-drawY+1);
+}
+
+static TCacheSlot_t *TCacheGet(int tp,int cx,int cy)
+{
+ int px=GlobalTextAddrX, py=GlobalTextAddrY;
+ int pw=tp?128:64, cw=tp?256:16;
+ TCacheSlot_t *s;
+ uint32_t key;
+ int i;
+
+ if(px+pw>1024 || cx+cw>1024) return NULL;             // lookups wrap into the next row
+
+ if(px<=drawW && px+pw>drawX && py<=drawH && py+256>drawY) return NULL;
+ if(cx<=drawW && cx+cw>drawX && cy<=drawH && cy>=drawY)    return NULL;
+
+ key=0x80000000|(tp<<30)|((px>>6)<<26)|((py>>8)<<25)|((cx>>4)<<19)|(cy<<10);
+
+ for(i=0;i<TCACHE_SLOTS;i++)
+  if(TCache[i].key==key) return &TCache[i];
+
+ if(iTCacheSkip) {iTCacheSkip--;return NULL;}
+
+ s=&TCache[iTCacheNext];
+ iTCacheNext=(iTCacheNext+1)%TCACHE_SLOTS;
+ if(!s->key) iTCacheUsed++;
+ else
+ if(s->drawn<2*s->decoded)
+  {
+   if(++iTCacheThrash>=TCACHE_SLOTS)
+    {iTCacheThrash=0;iTCacheSkip=TCACHE_BACKOFF;}
+  }
+ else iTCacheThrash=0;
+
+ s->key=key;
+ s->tp=tp;s->px=px;s->py=py;s->cx=cx;s->cy=cy;
+ s->decoded=s->drawn=0;
+ memset(s->valid,0,sizeof(s->valid));
+ return s;
+}
+
+// texels u..u+n-1 of row v, n>0
+static const unsigned short *TCacheRow(TCacheSlot_t *s,int v,int u,int n)
+{
+ uint32_t need=(0xffffffff<<(u>>3)) & (0xffffffff>>(31-((u+n-1)>>3)));
+ uint32_t miss=need&~s->valid[v];
+
+ s->drawn+=n;
+
+ if(miss)
+  {
+   unsigned char  *pb  =&psxVub[((s->py+v)<<11)+(s->px<<1)];
+   unsigned short *clut=&psxVuw[(s->cy<<10)+s->cx];
+   unsigned short *t   =&s->tex[v<<8];
+   int c,x;
+
+   s->valid[v]|=miss;
+
+   for(c=0;miss;c+=8,miss>>=1)
+    {
+     if(!(miss&1)) continue;
+     s->decoded+=8;
+     if(s->tp)
+      for(x=c;x<c+8;x++)
+       t[x]=GETLE16(&clut[pb[x]]);
+     else
+      for(x=c;x<c+8;x+=2)
+       {
+        t[x]  =GETLE16(&clut[pb[x>>1]&0xf]);
+        t[x+1]=GETLE16(&clut[pb[x>>1]>>4]);
+       }
+    }
+  }
+
+ return &s->tex[(v<<8)+u];
+}
+
+// 4/8 bit sprite from the cache; u/v are the texel pos inside the page
+static void DrawSoftwareSpriteCached(TCacheSlot_t *s,int32_t sprtX,int32_t sprtY,
+                                     int32_t sprtW,int32_t sprtH,int u,int v)
+{
+ int32_t sprCY,sprCX,lead;
+ const unsigned short *pT;
+ unsigned short *pD;
+
+ lead=(!s->tp && (u&1));                               // pairs start on a byte, like the uncached path
+
+#ifdef FASTSOLID
+
+ if(!bCheckMask && !DrawSemiTrans)
+  {
+   for(sprCY=0;sprCY<sprtH;sprCY++)
+    {
+     pT=TCacheRow(s,v+sprCY,u,sprtW);
+     pD=&psxVuw[((sprtY+sprCY)<<10)+sprtX];
+     sprCX=0;
+     if(lead) {GetTextureTransColG_S(pD,pT[0]);sprCX=1;}
+     for(;sprCX<sprtW-1;sprCX+=2)
+      GetTextureTransColG32_S((uint32_t *)&pD[sprCX],
+          pT[sprCX]|(((uint32_t)pT[sprCX+1])<<16));
+     if(sprCX<sprtW)
+      GetTextureTransColG_S(&pD[sprCX],pT[sprCX]);
+    }
+   return;
+  }
+
+#endif
+
+ for(sprCY=0;sprCY<sprtH;sprCY++)
+  {
+   pT=TCacheRow(s,v+sprCY,u,sprtW);
+   pD=&psxVuw[((sprtY+sprCY)<<10)+sprtX];
+   sprCX=0;
+   if(lead) {GetTextureTransColG_SPR(pD,pT[0]);sprCX=1;}
+   for(;sprCX<sprtW-1;sprCX+=2)
+    GetTextureTransColG32_SPR((uint32_t *)&pD[sprCX],
+        pT[sprCX]|(((uint32_t)pT[sprCX+1])<<16));
+   if(sprCX<sprtW)
+    GetTextureTransColG_SPR(&pD[sprCX],pT[sprCX]);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////
 // SPRITE FUNCS
 ////////////////////////////////////////////////////////////////////////
@@ -6364,6 +6929,7 @@ static void DrawSoftwareSprite(unsigned char * baseAddr,short w,short h,int32_t
  uint32_t *gpuData = (uint32_t *)baseAddr;
  unsigned char * pV;
  BOOL bWT,bWS;
+ TCacheSlot_t *pTC;
 
  sprtY = ly0;
  sprtX = lx0;
@@ -6410,6 +6976,13 @@ static void DrawSoftwareSprite(unsigned char * baseAddr,short w,short h,int32_t
  if((sprtY+sprtH)>drawH) sprtH=drawH-sprtY+1;
  if((sprtX+sprtW)>drawW) sprtW=drawW-sprtX+1;
 
+ if(GlobalTextTP<2 && sprtW>0 && sprtH>0 &&
+    textX0+sprtW<=256 && textY0-GlobalTextAddrY+sprtH<=256 &&
+    (pTC=TCacheGet(GlobalTextTP,clutX0,clutY0)))
+  {
+   DrawSoftwareSpriteCached(pTC,sprtX,sprtY,sprtW,sprtH,textX0,textY0-GlobalTextAddrY);
+   return;
+  }
 
  bWT=FALSE;
  bWS=FALSE;
@@ -111,7 +111,7 @@ BOOL           bCheckMask=FALSE;
 int            iUseMask=0;
 int            iSetMask=0;
 unsigned short sSetMask=0;
-unsigned long  lSetMask=0;
+uint32_t  lSetMask=0;
 
 // drawing/coord vars
 
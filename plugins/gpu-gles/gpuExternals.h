@@ -143,10 +143,10 @@ extern  void ( APIENTRY * glPixelStorei )(GLenum pname, GLint param);
 #define bool unsigned short
 #endif
 #define LOWORD(l)           ((unsigned short)(l))
-#define HIWORD(l)           ((unsigned short)(((unsigned long)(l) >> 16) & 0xFFFF))
+#define HIWORD(l)           ((unsigned short)(((uint32_t)(l) >> 16) & 0xFFFF))
 #define max(a,b)            (((a) > (b)) ? (a) : (b))
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
-#define DWORD unsigned long
+#define DWORD uint32_t
 
 typedef struct RECTTAG
 {
@@ -242,7 +242,7 @@ typedef struct OGLVertexTag
 COLTAG
   {
    unsigned char col[4];
-   unsigned long lcol;
+   uint32_t lcol;
   } c;
 
 } OGLVertex;
@@ -256,7 +256,7 @@ typedef union EXShortTag
 typedef union EXLongTag
 {
  unsigned char c[4];
- unsigned long l;
+ uint32_t l;
  EXShort       s[2];
 } EXLong;
 
@@ -299,7 +299,7 @@ extern int            iSetMask;
 extern int            iDepthFunc;
 extern BOOL           bCheckMask;
 extern unsigned short sSetMask;
-extern unsigned long  lSetMask;
+extern uint32_t  lSetMask;
 extern BOOL           bSetClip;
 extern GLuint         gTexScanName;
 
@@ -347,14 +347,14 @@ extern GLubyte       ubGloAlpha;
 extern short         sSprite_ux2;
 extern short         sSprite_vy2;
 extern BOOL          bRenderFrontBuffer;
-extern unsigned long ulOLDCOL;
-extern unsigned long ulClutID;
+extern uint32_t ulOLDCOL;
+extern uint32_t ulClutID;
 extern void (*primTableJ[256])(unsigned char *);
 extern void (*primTableSkip[256])(unsigned char *);
 extern unsigned short  usMirror;
-extern unsigned long dwCfgFixes;
-extern unsigned long dwActFixes;
-extern unsigned long dwEmuFixes;
+extern uint32_t dwCfgFixes;
+extern uint32_t dwActFixes;
+extern uint32_t dwEmuFixes;
 extern BOOL          bUseFixes;
 extern int           iSpriteTex;
 extern int           iDrawnSomething;
@@ -384,9 +384,9 @@ extern GLint          giWantedFMT;
 extern GLint          giWantedTYPE;
 extern void           (*LoadSubTexFn) (int,int,short,short);
 extern long           GlobalTexturePage;
-extern unsigned long  (*TCF[]) (unsigned long);
+extern uint32_t  (*TCF[]) (uint32_t);
 extern unsigned short (*PTCF[]) (unsigned short);
-extern unsigned long  (*PalTexturedColourFn) (unsigned long);
+extern uint32_t  (*PalTexturedColourFn) (uint32_t);
 extern BOOL           bUseFastMdec;
 extern BOOL           bUse15bitMdec;
 extern int            iFrameTexType;
@@ -401,6 +401,11 @@ extern int            iTexGarbageCollection;
 extern int            iFTexA;
 extern int            iFTexB;
 extern BOOL           bIgnoreNextTile;
+extern uint32_t       uiTexCacheHits;
+extern uint32_t       uiTexHashHits;
+extern uint32_t       uiTexDecodes;
+extern uint32_t       uiTexUploads;
+extern uint32_t       uiTexUploadBytes;
 
 
 #endif
@@ -420,7 +425,7 @@ extern char           szDispBuf[];
 extern char           szGPUKeys[];
 extern PSXDisplay_t   PSXDisplay;
 extern PSXDisplay_t   PreviousPSXDisplay;
-//extern unsigned long  ulKeybits;
+//extern uint32_t  ulKeybits;
 extern TWin_t         TWin;
 extern BOOL           bDisplayNotSet;
 extern long           lGPUstatusRet;
@@ -431,8 +436,8 @@ extern unsigned char  * psxVub;
 extern char    * psxVsb;
 extern unsigned short * psxVuw;
 extern signed short   * psxVsw;
-extern unsigned long  * psxVul;
-extern signed long    * psxVsl;
+extern uint32_t  * psxVul;
+extern int32_t    * psxVsl;
 extern GLfloat        gl_z;
 extern BOOL           bNeedRGB24Update;
 extern BOOL           bChangeWinMode;
@@ -445,7 +450,7 @@ extern int            iBlurBuffer;
 extern int            iLastRGB24;
 extern int            iRenderFVR;
 extern int            iNoScreenSaver;
-extern unsigned long  ulGPUInfoVals[];
+extern uint32_t  ulGPUInfoVals[];
 extern BOOL           bNeedInterlaceUpdate;
 extern BOOL           bNeedWriteUpload;
 extern BOOL           bSkipNextFrame;
@@ -461,7 +466,7 @@ extern int bFullScreen;
 
 #ifndef _IN_MENU
 
-//extern unsigned long  dwCoreFlags;
+//extern uint32_t  dwCoreFlags;
 extern GLuint         gTexPicName;
 //extern PSXPoint_t     ptCursorPoint[];
 //extern unsigned short usCursorActive;
@@ -539,7 +544,7 @@ typedef struct {
 
 #ifndef _IN_KEY
 
-//extern unsigned long  ulKeybits;
+//extern uint32_t  ulKeybits;
 
 #endif
 
@@ -547,7 +552,7 @@ typedef struct {
 
 #ifndef _IN_ZN
 
-extern unsigned long dwGPUVersion;
+extern uint32_t dwGPUVersion;
 extern int           iGPUHeight;
 extern int           iGPUHeightMask;
 extern int           GlobalTextIL;
@@ -622,7 +622,7 @@ void SetFrameRateConfig(void)
 #define TIMEBASE 100000
 
 // hehehe... using same func name as with win32 ;) wow, are we genius ;)
-unsigned long timeGetTime()
+uint32_t timeGetTime()
 {
  struct timeval tv;
  gettimeofday(&tv, 0);                                // well, maybe there are better ways
@@ -631,8 +631,8 @@ unsigned long timeGetTime()
 
 void FrameCap(void)
 {
- static unsigned long curticks, lastticks, _ticks_since_last_update;
- static unsigned long TicksToWait = 0;
+ static uint32_t curticks, lastticks, _ticks_since_last_update;
+ static uint32_t TicksToWait = 0;
  bool Waiting = TRUE;
 
   {
@@ -780,11 +780,11 @@ void FrameSkip(void)
  
 void calcfps(void) 
 { 
- static unsigned long curticks,_ticks_since_last_update,lastticks; 
+ static uint32_t curticks,_ticks_since_last_update,lastticks; 
  static long   fps_cnt = 0;
- static unsigned long  fps_tck = 1; 
+ static uint32_t  fps_tck = 1; 
  static long           fpsskip_cnt = 0;
- static unsigned long  fpsskip_tck = 1;
+ static uint32_t  fpsskip_tck = 1;
  
   { 
    curticks = timeGetTime(); 
@@ -827,8 +827,8 @@ void calcfps(void)
 
 void PCFrameCap (void) 
 {
- static unsigned long curticks, lastticks, _ticks_since_last_update;
- static unsigned long TicksToWait = 0;
+ static uint32_t curticks, lastticks, _ticks_since_last_update;
+ static uint32_t TicksToWait = 0;
  bool Waiting = TRUE; 
  
  while (Waiting) 
@@ -840,7 +840,7 @@ void PCFrameCap (void)
     { 
      Waiting = FALSE; 
      lastticks = curticks; 
-     TicksToWait = (TIMEBASE / (unsigned long)fFrameRateHz); 
+     TicksToWait = (TIMEBASE / (uint32_t)fFrameRateHz); 
     } 
   } 
 } 
@@ -849,7 +849,7 @@ void PCFrameCap (void)
  
 void PCcalcfps(void) 
 { 
- static unsigned long curticks,_ticks_since_last_update,lastticks; 
+ static uint32_t curticks,_ticks_since_last_update,lastticks; 
  static long  fps_cnt = 0; 
  static float fps_acc = 0;
  float CurrentFPS=0;     
@@ -880,7 +880,7 @@ void SetAutoFrameCap(void)
  if(iFrameLimit==1)
   {
    fFrameRateHz = fFrameRate;
-   dwFrameRateTicks=(TIMEBASE / (unsigned long)fFrameRateHz);
+   dwFrameRateTicks=(TIMEBASE / (uint32_t)fFrameRateHz);
    return;
   }
 
@@ -907,7 +907,7 @@ void SetAutoFrameCap(void)
       else fFrameRateHz=33868800.0f/566107.50f;        // 59.82750
     }
 
-   dwFrameRateTicks=(TIMEBASE / (unsigned long)fFrameRateHz);
+   dwFrameRateTicks=(TIMEBASE / (uint32_t)fFrameRateHz);
   }
 }
 
@@ -923,7 +923,7 @@ void SetFrameRateConfig(void)
    else               fFrameRateHz=fFrameRate;         // else set user framerate
   }
 
- dwFrameRateTicks=(TIMEBASE / (unsigned long)fFrameRateHz);
+ dwFrameRateTicks=(TIMEBASE / (uint32_t)fFrameRateHz);
 
  if(iFrameLimit==2) SetAutoFrameCap();
 }
@@ -973,7 +973,7 @@ void CheckFrameRate(void)                              // called in updatelace (
 
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUsetframelimit(unsigned long option)   // new EPSXE interface func: main emu can enable/disable fps limitation this way
+void CALLBACK GPUsetframelimit(uint32_t option)   // new EPSXE interface func: main emu can enable/disable fps limitation this way
 {
  bInitCap = TRUE;
 
@@ -55,7 +55,7 @@ void CheckFrameRate(void);
 void ReInitFrameCap(void);
 void SetAutoFrameCap(void);
 #ifndef _WINDOWS
-unsigned long timeGetTime();
+uint32_t timeGetTime();
 #endif
 
 #ifdef __cplusplus
@@ -53,7 +53,7 @@ short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coor
 long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
 long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
 
-unsigned long dwGPUVersion=0;
+uint32_t dwGPUVersion=0;
 int           iGPUHeight=512;
 int           iGPUHeightMask=511;
 int           GlobalTextIL=0;
@@ -69,8 +69,8 @@ signed   char  *psxVsb;
 unsigned short *psxVuw;
 unsigned short *psxVuw_eom;
 signed   short *psxVsw;
-unsigned long  *psxVul;
-signed   long  *psxVsl;
+uint32_t  *psxVul;
+int32_t        *psxVsl;
 
 // macro for easy access to packet information
 #define GPUCOMMAND(x) ((x>>24) & 0xff)
@@ -80,7 +80,7 @@ BOOL            bNeedInterlaceUpdate=FALSE;
 BOOL            bNeedRGB24Update=FALSE;
 BOOL            bChangeWinMode=FALSE;
 
-unsigned long   ulStatusControl[256];
+uint32_t   ulStatusControl[256];
 
 ////////////////////////////////////////////////////////////////////////
 // global GPU vars
@@ -90,7 +90,7 @@ static long     GPUdataRet;
 long            lGPUstatusRet;
 char            szDispBuf[64];
 
-static unsigned long gpuDataM[256];
+static uint32_t gpuDataM[256];
 static unsigned char gpuCommand = 0;
 static long          gpuDataC = 0;
 static long          gpuDataP = 0;
@@ -125,7 +125,7 @@ int             iBlurBuffer=0;
 int             iScanBlend=0;
 int             iRenderFVR=0;
 int             iNoScreenSaver=0;
-unsigned long   ulGPUInfoVals[16];
+uint32_t   ulGPUInfoVals[16];
 int             iFakePrimBusy = 0;
 int             iRumbleVal    = 0;
 int             iRumbleTime   = 0;
@@ -363,7 +363,7 @@ void CALLBACK GPUmakeSnapshot(void)
 
 long CALLBACK GPUinit()
 {
-memset(ulStatusControl,0,256*sizeof(unsigned long));
+memset(ulStatusControl,0,256*sizeof(uint32_t));
 
 bChangeRes=FALSE;
 bWindowMode=FALSE;
@@ -377,14 +377,14 @@ if(!psxVSecure) return -1;
 psxVub=psxVSecure+512*1024;                           // security offset into double sized psx vram!
 psxVsb=(signed char *)psxVub;
 psxVsw=(signed short *)psxVub;
-psxVsl=(signed long *)psxVub;
+psxVsl=(int32_t *)psxVub;
 psxVuw=(unsigned short *)psxVub;
-psxVul=(unsigned long *)psxVub;
+psxVul=(uint32_t *)psxVub;
 
 psxVuw_eom=psxVuw+1024*iGPUHeight;                    // pre-calc of end of vram
 
 memset(psxVSecure,0x00,(iGPUHeight*2)*1024 + (1024*1024));
-memset(ulGPUInfoVals,0x00,16*sizeof(unsigned long));
+memset(ulGPUInfoVals,0x00,16*sizeof(uint32_t));
 
 InitFrameCap();                                       // init frame rate stuff
 
@@ -1130,7 +1130,7 @@ else if(usFirstPos==1)                                // initial updates (after
 // process read request from GPU status register
 ////////////////////////////////////////////////////////////////////////
 
-unsigned long CALLBACK GPUreadStatus(void)
+uint32_t CALLBACK GPUreadStatus(void)
 {
 if(dwActFixes&0x1000)                                 // CC game fix
  {
@@ -1166,9 +1166,9 @@ return STATUSREG;
 // these are always single packet commands.
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUwriteStatus(unsigned long gdata)
+void CALLBACK GPUwriteStatus(uint32_t gdata)
 {
-unsigned long lCommand=(gdata>>24)&0xff;
+uint32_t lCommand=(gdata>>24)&0xff;
 
 if(bIsFirstFrame) GLinitialize(NULL, NULL);           // real ogl startup (needed by some emus)
 
@@ -1179,7 +1179,7 @@ switch(lCommand)
   //--------------------------------------------------//
   // reset gpu
   case 0x00:
-   memset(ulGPUInfoVals,0x00,16*sizeof(unsigned long));
+   memset(ulGPUInfoVals,0x00,16*sizeof(uint32_t));
    lGPUstatusRet=0x14802000;
    PSXDisplay.Disabled=1;
    iDataWriteMode=iDataReadMode=DR_NORMAL;
@@ -1774,7 +1774,7 @@ void CheckVRamRead(int x, int y, int dx, int dy, bool bFront)
 // core read from vram
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUreadDataMem(unsigned long * pMem, int iSize)
+void CALLBACK GPUreadDataMem(uint32_t * pMem, int iSize)
 {
 int i;
 
@@ -1805,7 +1805,7 @@ for(i=0;i<iSize;i++)
   if ((VRAMRead.ColsRemaining > 0) && (VRAMRead.RowsRemaining > 0))
    {
     // lower 16 bit
-    GPUdataRet=(unsigned long)*VRAMRead.ImagePtr;
+    GPUdataRet=(uint32_t)*VRAMRead.ImagePtr;
 
     VRAMRead.ImagePtr++;
     if(VRAMRead.ImagePtr>=psxVuw_eom) VRAMRead.ImagePtr-=iGPUHeight*1024;
@@ -1820,7 +1820,7 @@ for(i=0;i<iSize;i++)
      }
 
     // higher 16 bit (always, even if it's an odd width)
-    GPUdataRet|=(unsigned long)(*VRAMRead.ImagePtr)<<16;
+    GPUdataRet|=(uint32_t)(*VRAMRead.ImagePtr)<<16;
     *pMem++=GPUdataRet;
 
     if(VRAMRead.ColsRemaining <= 0)
@@ -1846,9 +1846,9 @@ ENDREAD:
 GPUIsIdle;
 }
 
-unsigned long CALLBACK GPUreadData(void)
+uint32_t CALLBACK GPUreadData(void)
 {
- unsigned long l;
+ uint32_t l;
  GPUreadDataMem(&l,1);
  return GPUdataRet;
 }
@@ -1931,10 +1931,10 @@ const unsigned char primTableCX[256] =
 // processes data send to GPU data register
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUwriteDataMem(unsigned long * pMem, int iSize)
+void CALLBACK GPUwriteDataMem(uint32_t * pMem, int iSize)
 {
 unsigned char command;
-unsigned long gdata=0;
+uint32_t gdata=0;
 int i=0;
 GPUIsBusy;
 GPUIsNotReadyForCommands;
@@ -1968,7 +1968,7 @@ if(iDataWriteMode==DR_VRAMTRANSFER)
         VRAMWrite.ColsRemaining--;
         if (VRAMWrite.ColsRemaining <= 0)             // last pixel is odd width
          {
-          gdata=(gdata&0xFFFF)|(((unsigned long)(*VRAMWrite.ImagePtr))<<16);
+          gdata=(gdata&0xFFFF)|(((uint32_t)(*VRAMWrite.ImagePtr))<<16);
           FinishedVRAMWrite();
           goto ENDVRAM;
          }
@@ -2050,7 +2050,7 @@ GPUIsIdle;
 
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUwriteData(unsigned long gdata)
+void CALLBACK GPUwriteData(uint32_t gdata)
 {
  GPUwriteDataMem(&gdata,1);
 }
@@ -2160,9 +2160,9 @@ void SetFixes(void)
 // Pete Special: make an 'intelligent' dma chain check (<-Tekken3)
 ////////////////////////////////////////////////////////////////////////
 
-unsigned long lUsedAddr[3];
+uint32_t lUsedAddr[3];
 
-__inline BOOL CheckForEndlessLoop(unsigned long laddr)
+__inline BOOL CheckForEndlessLoop(uint32_t laddr)
 {
 if(laddr==lUsedAddr[1]) return TRUE;
 if(laddr==lUsedAddr[2]) return TRUE;
@@ -2177,9 +2177,9 @@ return FALSE;
 // core gives a dma chain to gpu: same as the gpuwrite interface funcs
 ////////////////////////////////////////////////////////////////////////
 
-long CALLBACK GPUdmaChain(unsigned long * baseAddrL, unsigned long addr)
+long CALLBACK GPUdmaChain(uint32_t * baseAddrL, uint32_t addr)
 {
-unsigned long dmaMem;
+uint32_t dmaMem;
 unsigned char * baseAddrB;
 short count;unsigned int DMACommandCounter = 0;
 
@@ -2240,11 +2240,11 @@ long CALLBACK GPUtest(void)
 
 ////////////////////////////////////////////////////////////////////////
 
-long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
+long CALLBACK GPUfreeze(uint32_t ulGetFreezeData,GPUFreeze_t * pF)
 {
 if(ulGetFreezeData==2) 
  {
-  long lSlotNum=*((long *)pF);
+  int32_t lSlotNum=*((int32_t *)pF);
   if(lSlotNum<0) return 0;
   if(lSlotNum>8) return 0;
   lSelectedSlot=lSlotNum+1;
@@ -2257,7 +2257,7 @@ if(pF->ulFreezeVersion!=1) return 0;
 if(ulGetFreezeData==1)
  {
   pF->ulStatus=STATUSREG;
-  memcpy(pF->ulControl,ulStatusControl,256*sizeof(unsigned long));
+  memcpy(pF->ulControl,ulStatusControl,256*sizeof(uint32_t));
   memcpy(pF->psxVRam,  psxVub,         1024*iGPUHeight*2);
 
   return 1;
@@ -2266,7 +2266,7 @@ if(ulGetFreezeData==1)
 if(ulGetFreezeData!=0) return 0;
 
 STATUSREG=pF->ulStatus;
-memcpy(ulStatusControl,pF->ulControl,256*sizeof(unsigned long));
+memcpy(ulStatusControl,pF->ulControl,256*sizeof(uint32_t));
 memcpy(psxVub,         pF->psxVRam,  1024*iGPUHeight*2);
 
 ResetTextureArea(TRUE);
@@ -2615,14 +2615,14 @@ long CALLBACK GPUshowScreenPic(unsigned char * pMem)
 
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUsetfix(unsigned long dwFixBits)
+void CALLBACK GPUsetfix(uint32_t dwFixBits)
 {
  dwEmuFixes=dwFixBits;
 }
 
 ////////////////////////////////////////////////////////////////////////
  
-void CALLBACK GPUvisualVibration(unsigned long iSmall, unsigned long iBig)
+void CALLBACK GPUvisualVibration(uint32_t iSmall, uint32_t iBig)
 {
  int iVibVal;
 
@@ -2642,7 +2642,7 @@ void CALLBACK GPUvisualVibration(unsigned long iSmall, unsigned long iBig)
 // main emu can set display infos (A/M/G/D) 
 ////////////////////////////////////////////////////////////////////////
 
-void CALLBACK GPUdisplayFlags(unsigned long dwFlags)
+void CALLBACK GPUdisplayFlags(uint32_t dwFlags)
 {
 // dwCoreFlags=dwFlags;
 }
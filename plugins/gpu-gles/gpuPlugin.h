@@ -67,16 +67,16 @@ long CALLBACK GPUinit();
 long CALLBACK GPUshutdown();
 long CALLBACK GPUopen(int hwndGPU);
 long CALLBACK GPUclose();
-unsigned long CALLBACK GPUreadData(void);
-void CALLBACK GPUreadDataMem(unsigned long * pMem, int iSize);
-unsigned long CALLBACK GPUreadStatus(void);
-void CALLBACK GPUwriteData(unsigned long gdata);
-void CALLBACK GPUwriteDataMem(unsigned long * pMem, int iSize);
-void CALLBACK GPUwriteStatus(unsigned long gdata);
-long CALLBACK GPUdmaChain(unsigned long * baseAddrL, unsigned long addr);
+uint32_t CALLBACK GPUreadData(void);
+void CALLBACK GPUreadDataMem(uint32_t * pMem, int iSize);
+uint32_t CALLBACK GPUreadStatus(void);
+void CALLBACK GPUwriteData(uint32_t gdata);
+void CALLBACK GPUwriteDataMem(uint32_t * pMem, int iSize);
+void CALLBACK GPUwriteStatus(uint32_t gdata);
+long CALLBACK GPUdmaChain(uint32_t * baseAddrL, uint32_t addr);
 void CALLBACK GPUupdateLace(void);
 void CALLBACK GPUmakeSnapshot(void);
-long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF);
+long CALLBACK GPUfreeze(uint32_t ulGetFreezeData,GPUFreeze_t * pF);
 long CALLBACK GPUgetScreenPic(unsigned char * pMem);
 long CALLBACK GPUshowScreenPic(unsigned char * pMem);
 //void CALLBACK GPUkeypressed(int keycode);
@@ -59,6 +59,7 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <sys/time.h>
 #ifdef __NANOGL__
 #include <gl/gl.h>
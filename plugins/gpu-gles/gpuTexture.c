@@ -88,12 +88,12 @@ GLuint        gTexMovieName=0;
 GLuint        gTexBlurName=0;
 GLuint        gTexFrameName=0;
 int           iTexGarbageCollection=1;
-unsigned long dwTexPageComp=0;
+uint32_t dwTexPageComp=0;
 int           iVRamSize=0;
 int           iClampType=GL_CLAMP_TO_EDGE;
 int iFilter = GL_LINEAR;
 void               (*LoadSubTexFn) (int,int,short,short);
-unsigned long      (*PalTexturedColourFn)  (unsigned long);
+uint32_t      (*PalTexturedColourFn)  (uint32_t);
 
 ////////////////////////////////////////////////////////////////////////
 // defines
@@ -127,7 +127,7 @@ unsigned long      (*PalTexturedColourFn)  (unsigned long);
 
 ////////////////////////////////////////////////////////////////////////
 
-unsigned char * CheckTextureInSubSCache(long TextureMode,unsigned long GivenClutId,unsigned short * pCache);
+unsigned char * CheckTextureInSubSCache(long TextureMode,uint32_t GivenClutId,unsigned short * pCache);
 void            LoadSubTexturePageSort(int pageid, int mode, short cx, short cy);
 void            LoadPackedSubTexturePageSort(int pageid, int mode, short cx, short cy);
 void            DefineSubTextureSort(void);
@@ -147,7 +147,7 @@ BOOL  bUse15bitMdec=FALSE;
 int   iFrameTexType=0;
 int   iFrameReadType=0;
 
-unsigned long  (*TCF[2]) (unsigned long);
+uint32_t  (*TCF[2]) (uint32_t);
 unsigned short (*PTCF[2]) (unsigned short);
 
 ////////////////////////////////////////////////////////////////////////
@@ -158,7 +158,7 @@ unsigned short (*PTCF[2]) (unsigned short);
 
 typedef struct textureWndCacheEntryTag
 {
- unsigned long  ClutID;
+ uint32_t  ClutID;
  short          pageid;
  short          textureMode;
  short          Opaque;
@@ -167,18 +167,30 @@ typedef struct textureWndCacheEntryTag
  GLuint         texname;
 } textureWndCacheEntry;
 
-// "standard texture" cache entry (12 byte per entry, as small as possible... we need lots of them)
+// "standard texture" cache entry (16 byte per entry, as small as possible... we need lots of them)
 
 typedef struct textureSubCacheEntryTagS 
 {
- unsigned long   ClutID;
+ uint32_t        ClutID;
  EXLong          pos;
  unsigned char   posTX;
  unsigned char   posTY;
  unsigned char   cTexID;
- unsigned char   Opaque;
+ unsigned char   Opaque;                               // + TEXDIRTY: vram written since, check Hash
+ uint32_t        Hash;                                 // vram part + clut it was made from, 0: none
 } textureSubCacheEntryS;
 
+#define TEXDIRTY 0x80
+
+// part CompressTextureSpace has placed and still has to load
+
+typedef struct textureSubReloadTagS
+{
+ textureSubCacheEntryS * tsx;
+ unsigned char           pageid;
+ unsigned char           mode;
+} textureSubReloadS;
+
 
 //---------------------------------------------
 
@@ -199,10 +211,21 @@ int                      iTexWndTurn=0;
 int                      iTexWndLimit=MAXWNDTEXCACHE/2;
 
 GLubyte *                texturepart=NULL;
+GLubyte *                texturebatch=NULL;            // parts collected by CompressTextureSpace
+int                      iBatchTex=-1;                 // sort texture they go to, -1: no batch
+int                      iBatchY0,iBatchY1;            // rows covered so far
+textureSubReloadS *      pSubReload=NULL;              // parts to load after compressing
+int                      iSubReloadCnt=0,iSubReloadMax=0;
 GLubyte *                texturebuffer=NULL;
-unsigned long            g_x1,g_y1,g_x2,g_y2;
+uint32_t            g_x1,g_y1,g_x2,g_y2;
 unsigned char            ubOpaqueDraw=0;
 
+uint32_t                 uiTexCacheHits=0;             // stats, reset by gpulib_if.c
+uint32_t                 uiTexHashHits=0;
+uint32_t                 uiTexDecodes=0;
+uint32_t                 uiTexUploads=0;
+uint32_t                 uiTexUploadBytes=0;
+
 unsigned short MAXTPAGES     = 32;
 unsigned short CLUTMASK      = 0x7fff;
 unsigned short CLUTYMASK     = 0x1ff;
@@ -213,7 +236,7 @@ unsigned short MAXSORTTEX    = 196;
 // porting... and honestly: nowadays the speed gain would be pointless 
 ////////////////////////////////////////////////////////////////////////
 
-unsigned long XP8RGBA(unsigned long BGR)
+uint32_t XP8RGBA(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x50000000;
  if(DrawSemiTrans && !(BGR&0x8000)) 
@@ -221,7 +244,7 @@ unsigned long XP8RGBA(unsigned long BGR)
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8RGBAEx(unsigned long BGR)
+uint32_t XP8RGBAEx(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x03000000;
  if(DrawSemiTrans && !(BGR&0x8000)) 
@@ -229,9 +252,9 @@ unsigned long XP8RGBAEx(unsigned long BGR)
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long CP8RGBA(unsigned long BGR)
+uint32_t CP8RGBA(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
  if(!(BGR&0xffff)) return 0x50000000;
  if(DrawSemiTrans && !(BGR&0x8000)) 
   {ubOpaqueDraw=1;return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff);}
@@ -240,9 +263,9 @@ unsigned long CP8RGBA(unsigned long BGR)
  return l;
 }
 
-unsigned long CP8RGBAEx(unsigned long BGR)
+uint32_t CP8RGBAEx(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
  if(!(BGR&0xffff)) return 0x03000000;
  if(DrawSemiTrans && !(BGR&0x8000)) 
   {ubOpaqueDraw=1;return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff);}
@@ -251,33 +274,33 @@ unsigned long CP8RGBAEx(unsigned long BGR)
  return l;
 }
 
-unsigned long XP8RGBA_0(unsigned long BGR)
+uint32_t XP8RGBA_0(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x50000000;
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8RGBAEx_0(unsigned long BGR)
+uint32_t XP8RGBAEx_0(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x03000000;
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8BGRA_0(unsigned long BGR)
+uint32_t XP8BGRA_0(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x50000000;
  return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8BGRAEx_0(unsigned long BGR)
+uint32_t XP8BGRAEx_0(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x03000000;
  return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long CP8RGBA_0(unsigned long BGR)
+uint32_t CP8RGBA_0(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
 
  if(!(BGR&0xffff)) return 0x50000000;
  l=((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
@@ -285,9 +308,9 @@ unsigned long CP8RGBA_0(unsigned long BGR)
  return l;
 }
 
-unsigned long CP8RGBAEx_0(unsigned long BGR)
+uint32_t CP8RGBAEx_0(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
 
  if(!(BGR&0xffff)) return 0x03000000;
  l=((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
@@ -295,9 +318,9 @@ unsigned long CP8RGBAEx_0(unsigned long BGR)
  return l;
 }
 
-unsigned long CP8BGRA_0(unsigned long BGR)
+uint32_t CP8BGRA_0(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
 
  if(!(BGR&0xffff)) return 0x50000000;
  l=((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
@@ -305,9 +328,9 @@ unsigned long CP8BGRA_0(unsigned long BGR)
  return l;
 }
 
-unsigned long CP8BGRAEx_0(unsigned long BGR)
+uint32_t CP8BGRAEx_0(uint32_t BGR)
 {
- unsigned long l;
+ uint32_t l;
 
  if(!(BGR&0xffff)) return 0x03000000;
  l=((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
@@ -315,41 +338,41 @@ unsigned long CP8BGRAEx_0(unsigned long BGR)
  return l;
 }
 
-unsigned long XP8RGBA_1(unsigned long BGR)
+uint32_t XP8RGBA_1(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x50000000;
  if(!(BGR&0x8000)) {ubOpaqueDraw=1;return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff);}
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8RGBAEx_1(unsigned long BGR)
+uint32_t XP8RGBAEx_1(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x03000000;
  if(!(BGR&0x8000)) {ubOpaqueDraw=1;return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff);}
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8BGRA_1(unsigned long BGR)
+uint32_t XP8BGRA_1(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x50000000;
  if(!(BGR&0x8000)) {ubOpaqueDraw=1;return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff);}
  return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long XP8BGRAEx_1(unsigned long BGR)
+uint32_t XP8BGRAEx_1(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0x03000000;
  if(!(BGR&0x8000)) {ubOpaqueDraw=1;return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff);}
  return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long P8RGBA(unsigned long BGR)
+uint32_t P8RGBA(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0;
  return ((((BGR<<3)&0xf8)|((BGR<<6)&0xf800)|((BGR<<9)&0xf80000))&0xffffff)|0xff000000;
 }
 
-unsigned long P8BGRA(unsigned long BGR)
+uint32_t P8BGRA(uint32_t BGR)
 {
  if(!(BGR&0xffff)) return 0;
  return ((((BGR>>7)&0xf8)|((BGR<<6)&0xf800)|((BGR<<19)&0xf80000))&0xffffff)|0xff000000;
@@ -549,6 +572,8 @@ void InitializeTextureStore()
                         MAXWNDTEXCACHE);
  texturepart=(GLubyte *)malloc(256*256*4);
  memset(texturepart,0,256*256*4);
+ texturebatch=(GLubyte *)malloc(256*256*4);
+ memset(texturebatch,0,256*256*4);
 	 texturebuffer=NULL;
 
  for(i=0;i<3;i++)                                    // -> info for 32*3
@@ -578,6 +603,10 @@ void CleanupTextureStore()
  //----------------------------------------------------//
  free(texturepart);                                    // free tex part
  texturepart=0;
+ free(texturebatch);
+ texturebatch=0;
+ free(pSubReload);
+ pSubReload=0;iSubReloadCnt=iSubReloadMax=0;
  if(texturebuffer)
   {
    free(texturebuffer);
@@ -771,6 +800,65 @@ void MarkFree(textureSubCacheEntryS * tsx)
   }
 }
 
+////////////////////////////////////////////////////////////////////////
+// Games often upload the very same texture data again (each frame, or
+// on every scene change), so parts get a hash of the vram + clut they
+// were made from. Written parts are only marked, and are dropped on their
+// next use if the hash changed, or else used again as they are.
+////////////////////////////////////////////////////////////////////////
+
+uint32_t SubTextureHash(int pageid,int mode,uint32_t ClutID,EXLong pos)
+{
+ uint32_t h0=2166136261u,h1=0x01000193u;               // two fnv chains, so they can overlap
+ uint32_t *lSRCPtr;
+ int pmult=pageid/16,x1,x2,row,column;
+
+ switch(mode)
+  {
+   case 0:  x1=pos.c[3]>>3;x2=pos.c[2]>>3;break;       // 8 texels per 32 bit word
+   case 1:  x1=pos.c[3]>>2;x2=pos.c[2]>>2;break;       // 4 texels
+   default: x1=pos.c[3]>>1;x2=pos.c[2]>>1;break;       // 2 texels
+  }
+
+ lSRCPtr=(uint32_t *)(psxVuw+((pageid-16*pmult)<<6)+(pmult<<18)+(pos.c[1]<<10));
+ for(column=pos.c[1];column<=pos.c[0];column++,lSRCPtr+=512)
+  {
+   for(row=x1;row<x2;row+=2)
+    {
+     h0=(h0^lSRCPtr[row])*16777619u;
+     h1=(h1^lSRCPtr[row+1])*16777619u;
+    }
+   if(row==x2) h0=(h0^lSRCPtr[row])*16777619u;
+  }
+
+ if(mode!=2)
+  {
+   lSRCPtr=(uint32_t *)(psxVuw+((ClutID<<4)&0x3F0)+(((ClutID>>6)&CLUTYMASK)<<10));
+   for(row=mode?128:8;row;row-=2,lSRCPtr+=2)
+    {
+     h0=(h0^lSRCPtr[0])*16777619u;
+     h1=(h1^lSRCPtr[1])*16777619u;
+    }
+  }
+
+ h0^=h1*0x9e3779b1u;
+ return h0?h0:1;
+}
+
+void MarkDirty(textureSubCacheEntryS * tsx)
+{
+ if(tsx->Hash) tsx->Opaque|=TEXDIRTY;                  // check it on next use
+ else {tsx->ClutID=0;MarkFree(tsx);}                   // no hash? free it now
+}
+
+BOOL CheckDirty(textureSubCacheEntryS * tsx,int pageid,int mode)
+{
+ if(SubTextureHash(pageid,mode,tsx->ClutID,tsx->pos)==tsx->Hash)
+  {tsx->Opaque&=~TEXDIRTY;uiTexHashHits++;return TRUE;}
+ tsx->ClutID=0;MarkFree(tsx);
+ return FALSE;
+}
+
 void InvalidateSubSTextureArea(long X,long Y,long W, long H)
 {
  int i,j,k,iMax,px,py,px1,px2,py1,py2,iYM=1;
@@ -828,27 +916,27 @@ void InvalidateSubSTextureArea(long X,long Y,long W, long H)
         {
          tsb=pscSubtexStore[k][j]+SOFFA;iMax=tsb->pos.l;tsb++;
          for(i=0;i<iMax;i++,tsb++)
-          if(tsb->ClutID && XCHECK(tsb->pos,npos)) {tsb->ClutID=0;MarkFree(tsb);}
+          if(tsb->ClutID && XCHECK(tsb->pos,npos)) MarkDirty(tsb);
 
 //         if(npos.l & 0x00800000)
           {
            tsb=pscSubtexStore[k][j]+SOFFB;iMax=tsb->pos.l;tsb++;
            for(i=0;i<iMax;i++,tsb++)
-            if(tsb->ClutID && XCHECK(tsb->pos,npos)) {tsb->ClutID=0;MarkFree(tsb);}
+            if(tsb->ClutID && XCHECK(tsb->pos,npos)) MarkDirty(tsb);
           }
 
 //         if(npos.l & 0x00000080)
           {
            tsb=pscSubtexStore[k][j]+SOFFC;iMax=tsb->pos.l;tsb++;
            for(i=0;i<iMax;i++,tsb++)
-            if(tsb->ClutID && XCHECK(tsb->pos,npos)) {tsb->ClutID=0;MarkFree(tsb);}
+            if(tsb->ClutID && XCHECK(tsb->pos,npos)) MarkDirty(tsb);
           }
 
 //         if(npos.l & 0x00800080)
           {
            tsb=pscSubtexStore[k][j]+SOFFD;iMax=tsb->pos.l;tsb++;
            for(i=0;i<iMax;i++,tsb++)
-            if(tsb->ClutID && XCHECK(tsb->pos,npos)) {tsb->ClutID=0;MarkFree(tsb);}
+            if(tsb->ClutID && XCHECK(tsb->pos,npos)) MarkDirty(tsb);
           }
         }
       }
@@ -920,12 +1008,12 @@ void DefineTextureWnd(void)
 
 void LoadStretchPackedWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm,ldx,ldy,ldxo;
+ uint32_t start,row,column,j,sxh,sxm,ldx,ldy,ldxo;
  unsigned int   palstart;
  unsigned short *px,*pa,*ta;
  unsigned char  *cSRCPtr,*cOSRCPtr;
  unsigned short *wSRCPtr,*wOSRCPtr;
- unsigned long  LineOffset;unsigned short s;
+ uint32_t  LineOffset;unsigned short s;
  int pmult=pageid/16;
  unsigned short (*LPTCOL)(unsigned short);
 
@@ -1112,22 +1200,22 @@ void LoadStretchPackedWndTexturePage(int pageid, int mode, short cx, short cy)
 
 void LoadStretchWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm,ldx,ldy,ldxo,s;
+ uint32_t start,row,column,j,sxh,sxm,ldx,ldy,ldxo,s;
  unsigned int   palstart;
- unsigned long  *px,*pa,*ta;
+ uint32_t  *px,*pa,*ta;
  unsigned char  *cSRCPtr,*cOSRCPtr;
  unsigned short *wSRCPtr,*wOSRCPtr;
- unsigned long  LineOffset;
+ uint32_t  LineOffset;
  int pmult=pageid/16;
- unsigned long (*LTCOL)(unsigned long);
+ uint32_t (*LTCOL)(uint32_t);
  
  LTCOL=TCF[DrawSemiTrans];
 
  ldxo=TWin.Position.x1-TWin.OPosition.x1;
  ldy =TWin.Position.y1-TWin.OPosition.y1;
 
- pa=px=(unsigned long *)ubPaletteBuffer;
- ta=(unsigned long *)texturepart;
+ pa=px=(uint32_t *)ubPaletteBuffer;
+ ta=(uint32_t *)texturepart;
  palstart=cx+(cy*1024);
 
  ubOpaqueDraw=0;
@@ -1323,12 +1411,12 @@ void LoadStretchWndTexturePage(int pageid, int mode, short cx, short cy)
 
 void LoadPackedWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm;
+ uint32_t start,row,column,j,sxh,sxm;
  unsigned int   palstart;
  unsigned short *px,*pa,*ta;
  unsigned char  *cSRCPtr;
  unsigned short *wSRCPtr;
- unsigned long  LineOffset;
+ uint32_t  LineOffset;
  int pmult=pageid/16;
  unsigned short (*LPTCOL)(unsigned short);
 
@@ -1465,19 +1553,19 @@ void LoadPackedWndTexturePage(int pageid, int mode, short cx, short cy)
 
 void LoadWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm;
+ uint32_t start,row,column,j,sxh,sxm;
  unsigned int   palstart;
- unsigned long  *px,*pa,*ta;
+ uint32_t  *px,*pa,*ta;
  unsigned char  *cSRCPtr;
  unsigned short *wSRCPtr;
- unsigned long  LineOffset;
+ uint32_t  LineOffset;
  int pmult=pageid/16;
- unsigned long (*LTCOL)(unsigned long);
+ uint32_t (*LTCOL)(uint32_t);
  
  LTCOL=TCF[DrawSemiTrans];
 
- pa=px=(unsigned long *)ubPaletteBuffer;
- ta=(unsigned long *)texturepart;
+ pa=px=(uint32_t *)ubPaletteBuffer;
+ ta=(uint32_t *)texturepart;
  palstart=cx+(cy*1024);
 
  ubOpaqueDraw=0;
@@ -1627,7 +1715,7 @@ void UploadTexWndPal(int mode,short cx,short cy)
 {
  unsigned int i,iSize;
  unsigned short * wSrcPtr;
- unsigned long * ta=(unsigned long *)texturepart;
+ uint32_t * ta=(uint32_t *)texturepart;
 
  wSrcPtr=psxVuw+cx+(cy*1024);
  if(mode==0) i=4; else i=64;
@@ -1677,10 +1765,10 @@ void DefinePalTextureWnd(void)
 
 void LoadPalWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm;
+ uint32_t start,row,column,j,sxh,sxm;
  unsigned char  *ta;
  unsigned char  *cSRCPtr;
- unsigned long  LineOffset;
+ uint32_t  LineOffset;
  int pmult=pageid/16;
 
  ta=(unsigned char *)texturepart;
@@ -1737,10 +1825,10 @@ void LoadPalWndTexturePage(int pageid, int mode, short cx, short cy)
 
 void LoadStretchPalWndTexturePage(int pageid, int mode, short cx, short cy)
 {
- unsigned long start,row,column,j,sxh,sxm,ldx,ldy,ldxo;
+ uint32_t start,row,column,j,sxh,sxm,ldx,ldy,ldxo;
  unsigned char  *ta,s;
  unsigned char  *cSRCPtr,*cOSRCPtr;
- unsigned long  LineOffset;
+ uint32_t  LineOffset;
  int pmult=pageid/16;
 
  ldxo=TWin.Position.x1-TWin.OPosition.x1;
@@ -1815,7 +1903,7 @@ void LoadStretchPalWndTexturePage(int pageid, int mode, short cx, short cy)
 // tex window: main selecting, cache handler included
 ////////////////////////////////////////////////////////////////////////
 
-GLuint LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId)
+GLuint LoadTextureWnd(long pageid,long TextureMode,uint32_t GivenClutId)
 {
  textureWndCacheEntry * ts, * tsx=NULL;
  int i;short cx,cy;
@@ -1837,8 +1925,8 @@ GLuint LoadTextureWnd(long pageid,long TextureMode,unsigned long GivenClutId)
 
    // palette check sum
     {
-     unsigned long l=0,row;
-     unsigned long * lSRCPtr=(unsigned long *)(psxVuw+cx+(cy*1024));
+     uint32_t l=0,row;
+     uint32_t * lSRCPtr=(uint32_t *)(psxVuw+cx+(cy*1024));
      if(TextureMode==1) for(row=1;row<129;row++) l+=((*lSRCPtr++)-1)*row;
      else               for(row=1;row<9;row++)   l+=((*lSRCPtr++)-1)<<row;
      l=(l+HIWORD(l))&0x3fffL;
@@ -2014,7 +2102,7 @@ unsigned char * LoadDirectMovieFast(void)
  long row,column;
  unsigned int startxy;
 
- unsigned long * ta=(unsigned long *)texturepart;
+ uint32_t * ta=(uint32_t *)texturepart;
 
  if(PSXDisplay.RGB24)
   {
@@ -2027,14 +2115,14 @@ unsigned char * LoadDirectMovieFast(void)
      pD=(unsigned char *)&psxVuw[startxy];
      for(row=xrMovieArea.x0;row<xrMovieArea.x1;row++)
       {
-       *ta++=*((unsigned long *)pD)|0xff000000;
+       *ta++=*((uint32_t *)pD)|0xff000000;
        pD+=3;
       }
     }
   }
  else
   {
-   unsigned long (*LTCOL)(unsigned long);
+   uint32_t (*LTCOL)(uint32_t);
 
    LTCOL=XP8RGBA_0;//TCF[0];
 
@@ -2062,7 +2150,7 @@ GLuint LoadTextureMovieFast(void)
    if(PSXDisplay.RGB24)
     {
      unsigned char * pD;
-     unsigned long * ta=(unsigned long *)texturepart;
+     uint32_t * ta=(uint32_t *)texturepart;
 
      startxy=((1024)*xrMovieArea.y0)+xrMovieArea.x0;
 
@@ -2072,20 +2160,20 @@ GLuint LoadTextureMovieFast(void)
        pD=(unsigned char *)&psxVuw[startxy];
        for(row=xrMovieArea.x0;row<xrMovieArea.x1;row++)
         {
-         *ta++=*((unsigned long *)pD)|0xff000000;
+         *ta++=*((uint32_t *)pD)|0xff000000;
          pD+=3;
         }
       }
     }
    else
     {
-     unsigned long (*LTCOL)(unsigned long);
-     unsigned long *ta;
+     uint32_t (*LTCOL)(uint32_t);
+     uint32_t *ta;
 
      LTCOL=XP8RGBA_0;//TCF[0];
 
      ubOpaqueDraw=0;
-     ta=(unsigned long *)texturepart;
+     ta=(uint32_t *)texturepart;
 
      for(column=xrMovieArea.y0;column<xrMovieArea.y1;column++)
       {
@@ -2118,7 +2206,7 @@ GLuint LoadTextureMovie(void)
    if(PSXDisplay.RGB24)
     {
      unsigned char * pD;
-     unsigned long * ta=(unsigned long *)texturepart;
+     uint32_t * ta=(uint32_t *)texturepart;
 
      if(b_X)
       {
@@ -2128,7 +2216,7 @@ GLuint LoadTextureMovie(void)
          pD=(unsigned char *)&psxVuw[startxy];
          for(row=xrMovieArea.x0;row<xrMovieArea.x1;row++)
           {
-           *ta++=*((unsigned long *)pD)|0xff000000;
+           *ta++=*((uint32_t *)pD)|0xff000000;
            pD+=3;
           }
          *ta++=*(ta-1);
@@ -2149,7 +2237,7 @@ GLuint LoadTextureMovie(void)
          pD=(unsigned char *)&psxVuw[startxy];
          for(row=xrMovieArea.x0;row<xrMovieArea.x1;row++)
           {
-           *ta++=*((unsigned long *)pD)|0xff000000;
+           *ta++=*((uint32_t *)pD)|0xff000000;
            pD+=3;
           }
         }
@@ -2163,13 +2251,13 @@ GLuint LoadTextureMovie(void)
     }
    else
     {
-     unsigned long (*LTCOL)(unsigned long);
-     unsigned long *ta;
+     uint32_t (*LTCOL)(uint32_t);
+     uint32_t *ta;
 
      LTCOL=XP8RGBA_0;//TCF[0];
 
      ubOpaqueDraw=0;
-     ta=(unsigned long *)texturepart;
+     ta=(uint32_t *)texturepart;
 
      if(b_X)
       {
@@ -2254,7 +2342,7 @@ GLuint BlackFake15BitTexture(void)
      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, iFilter); glError();
  
      {
-       unsigned long * ta=(unsigned long *)texturepart;
+       uint32_t * ta=(uint32_t *)texturepart;
        for(y1=0;y1<=4;y1++)
         for(x1=0;x1<=4;x1++)
          *ta++=0xff000000;
@@ -2466,28 +2554,28 @@ GLuint Fake15BitTexture(void)
 
 void LoadSubTexturePageSort(int pageid, int mode, short cx, short cy)
 {
- unsigned long  start,row,column,j,sxh,sxm;
+ uint32_t  start,row,column,j,sxh,sxm;
  unsigned int   palstart;
- unsigned long  *px,*pa,*ta;
+ uint32_t  *px,*pa,*ta;
  unsigned char  *cSRCPtr;
  unsigned short *wSRCPtr;
- unsigned long  LineOffset;
- unsigned long  x2a,xalign=0;
- unsigned long  x1=gl_ux[7];
- unsigned long  x2=gl_ux[6];
- unsigned long  y1=gl_ux[5];
- unsigned long  y2=gl_ux[4];
- unsigned long  dx=x2-x1+1;
- unsigned long  dy=y2-y1+1;
+ uint32_t  LineOffset;
+ uint32_t  x2a,xalign=0;
+ uint32_t  x1=gl_ux[7];
+ uint32_t  x2=gl_ux[6];
+ uint32_t  y1=gl_ux[5];
+ uint32_t  y2=gl_ux[4];
+ uint32_t  dx=x2-x1+1;
+ uint32_t  dy=y2-y1+1;
  int pmult=pageid/16;
- unsigned long (*LTCOL)(unsigned long);
+ uint32_t (*LTCOL)(uint32_t);
  unsigned int a,r,g,b,cnt,h;
- unsigned long scol[8];
+ uint32_t scol[8];
  
  LTCOL=TCF[DrawSemiTrans];
 
- pa=px=(unsigned long *)ubPaletteBuffer;
- ta=(unsigned long *)texturepart;
+ pa=px=(uint32_t *)ubPaletteBuffer;
+ ta=(uint32_t *)texturepart;
  palstart=cx+(cy<<10);
 
  ubOpaqueDraw=0;
@@ -2674,10 +2762,10 @@ void LoadSubTexturePageSort(int pageid, int mode, short cx, short cy)
 
  if(YTexS)
   {
-   ta=(unsigned long *)texturepart;
-   pa=(unsigned long *)texturepart+x2a;
+   ta=(uint32_t *)texturepart;
+   pa=(uint32_t *)texturepart+x2a;
    row=x2a;do {*ta++=*pa++;row--;} while(row);        
-   pa=(unsigned long *)texturepart+dy*x2a;
+   pa=(uint32_t *)texturepart+dy*x2a;
    ta=pa+x2a;
    row=x2a;do {*ta++=*pa++;row--;} while(row);
    YTexS--;
@@ -2686,10 +2774,10 @@ void LoadSubTexturePageSort(int pageid, int mode, short cx, short cy)
 
  if(XTexS)
   {
-   ta=(unsigned long *)texturepart;
+   ta=(uint32_t *)texturepart;
    pa=ta+1;
    row=dy;do {*ta=*pa;ta+=x2a;pa+=x2a;row--;} while(row);
-   pa=(unsigned long *)texturepart+dx;
+   pa=(uint32_t *)texturepart+dx;
    ta=pa+1;
    row=dy;do {*ta=*pa;ta+=x2a;pa+=x2a;row--;} while(row);
    XTexS--;
@@ -2703,7 +2791,7 @@ void LoadSubTexturePageSort(int pageid, int mode, short cx, short cy)
  if((iFilterType==4 || iFilterType==6) && ly0==ly1 && ly2==ly3 && lx0==lx3 && lx1==lx2)
   {DefineSubTextureSort();return;}
 
- ta=(unsigned long *)texturepart;
+ ta=(uint32_t *)texturepart;
  x1=dx-1;
  y1=dy-1;
 
@@ -2794,19 +2882,19 @@ void LoadSubTexturePageSort(int pageid, int mode, short cx, short cy)
 
 void LoadPackedSubTexturePageSort(int pageid, int mode, short cx, short cy)
 {
- unsigned long  start,row,column,j,sxh,sxm;
+ uint32_t  start,row,column,j,sxh,sxm;
  unsigned int   palstart;
  unsigned short *px,*pa,*ta;
  unsigned char  *cSRCPtr;
  unsigned short *wSRCPtr;
- unsigned long  LineOffset;
- unsigned long  x2a,xalign=0;
- unsigned long  x1=gl_ux[7];
- unsigned long  x2=gl_ux[6];
- unsigned long  y1=gl_ux[5];
- unsigned long  y2=gl_ux[4];
- unsigned long  dx=x2-x1+1;
- unsigned long  dy=y2-y1+1;
+ uint32_t  LineOffset;
+ uint32_t  x2a,xalign=0;
+ uint32_t  x1=gl_ux[7];
+ uint32_t  x2=gl_ux[6];
+ uint32_t  y1=gl_ux[5];
+ uint32_t  y2=gl_ux[4];
+ uint32_t  dx=x2-x1+1;
+ uint32_t  dy=y2-y1+1;
  int pmult=pageid/16;
  unsigned short (*LPTCOL)(unsigned short);
  unsigned int a,r,g,b,cnt,h;
@@ -3460,14 +3548,15 @@ void DefineSubTextureSortHiRes(void)
  glTexSubImage2D(GL_TEXTURE_2D, 0, XTexS<<1, YTexS<<1,
                  DXTexS<<1, DYTexS<<1,
                  GL_RGBA, GL_UNSIGNED_BYTE, texturebuffer); glError();
+ uiTexUploads++;
+ uiTexUploadBytes+=DXTexS*DYTexS*16;
  //LOGE("DefineSubTextureSortHiRes x:%d y:%d",XTexS<<1,YTexS<<1);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-void DefineSubTextureSort(void)
+void BindSubTextureSort(GLubyte * pInit)
 {
-
  if(!gTexName)
   {
    glGenTextures(1, &gTexName); glError();
@@ -3486,13 +3575,33 @@ void DefineSubTextureSort(void)
      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, iFilter); glError();
      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, iFilter); glError();
     }
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0,GL_RGBA, GL_UNSIGNED_BYTE, texturepart); glError();
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0,GL_RGBA, GL_UNSIGNED_BYTE, pInit); glError();
   }
  else glBindTexture(GL_TEXTURE_2D, gTexName); glError();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DefineSubTextureSort(void)
+{
+ if(iBatchTex>=0)                                      // compressing? just collect it
+  {
+   int y;
+   for(y=0;y<DYTexS;y++)
+    memcpy(texturebatch+((YTexS+y)<<10)+(XTexS<<2),
+           texturepart+y*DXTexS*4,DXTexS*4);
+   if(YTexS<iBatchY0)          iBatchY0=YTexS;
+   if(YTexS+DYTexS-1>iBatchY1) iBatchY1=YTexS+DYTexS-1;
+   return;
+  }
+
+ BindSubTextureSort(texturepart);
 
  glTexSubImage2D(GL_TEXTURE_2D, 0, XTexS, YTexS,
                  DXTexS, DYTexS,
                  GL_RGBA, GL_UNSIGNED_BYTE, texturepart); glError();
+ uiTexUploads++;
+ uiTexUploadBytes+=DXTexS*DYTexS*4;
                                         //LOGE("DefineSubTextureSort x:%d y:%d w:%d h:%d",XTexS,YTexS,DXTexS,DYTexS);
 }
 
@@ -3554,17 +3663,17 @@ void DoTexGarbageCollection(void)
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
-unsigned char * CheckTextureInSubSCache(long TextureMode,unsigned long GivenClutId,unsigned short * pCache)
+unsigned char * CheckTextureInSubSCache(long TextureMode,uint32_t GivenClutId,unsigned short * pCache)
 {
  textureSubCacheEntryS * tsx, * tsb, *tsg;//, *tse=NULL;
  int i,iMax;EXLong npos;
  unsigned char cx,cy;
- int iC,j,k;unsigned long rx,ry,mx,my;
+ int iC,j,k;uint32_t rx,ry,mx,my;
  EXLong * ul=0, * uls;
  EXLong rfree;
  unsigned char cXAdj,cYAdj;
 
- npos.l=*((unsigned long *)&gl_ux[4]);
+ npos.l=*((uint32_t *)&gl_ux[4]);
 
  //--------------------------------------------------------------//
  // find matching texturepart first... speed up...
@@ -3581,7 +3690,8 @@ unsigned char * CheckTextureInSubSCache(long TextureMode,unsigned long GivenClut
    do
     {
      if(GivenClutId==tsb->ClutID &&
-        (INCHECK(tsb->pos,npos)))
+        (INCHECK(tsb->pos,npos)) &&
+        (!(tsb->Opaque&TEXDIRTY) || CheckDirty(tsb,GlobalTexturePage,TextureMode)))
       {
         {
          cx=tsb->pos.c[3]-tsb->posTX;
@@ -3598,6 +3708,7 @@ unsigned char * CheckTextureInSubSCache(long TextureMode,unsigned long GivenClut
 
          ubOpaqueDraw=tsb->Opaque;
          *pCache=tsb->cTexID;
+         uiTexCacheHits++;
          return NULL;
         }
       } 
@@ -3650,7 +3761,7 @@ unsigned char * CheckTextureInSubSCache(long TextureMode,unsigned long GivenClut
 
        if(tsx)                                         // 3. if one or more found, create a new rect with bigger size
         {
-         *((unsigned long *)&gl_ux[4])=npos.l=rfree.l;
+         *((uint32_t *)&gl_ux[4])=npos.l=rfree.l;
          rx=(int)rfree.c[2]-(int)rfree.c[3];
          ry=(int)rfree.c[0]-(int)rfree.c[1];
          DoTexGarbageCollection();
@@ -3833,6 +3944,7 @@ ENDLOOP:
  tsx->ClutID   = GivenClutId;
  tsx->posTX    = rfree.c[3];
  tsx->posTY    = rfree.c[1];
+ tsx->Hash     = GlobalTextIL?0:SubTextureHash(GlobalTexturePage,TextureMode,GivenClutId,npos);
 
  cx=gl_ux[7]-rfree.c[3];
  cy=gl_ux[5]-rfree.c[1];
@@ -3864,7 +3976,7 @@ ENDLOOP:
 
 BOOL GetCompressTexturePlace(textureSubCacheEntryS * tsx)
 {
- int i,j,k,iMax,iC;unsigned long rx,ry,mx,my;
+ int i,j,k,iMax,iC;uint32_t rx,ry,mx,my;
  EXLong * ul=0, * uls, rfree;
  unsigned char cXAdj=1,cYAdj=1;
 
@@ -3987,6 +4099,60 @@ TENDLOOP:
  return TRUE;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// upload batching: CompressTextureSpace places every part still in use first
+// and loads them sorted by sort texture afterwards, so each texture gets one
+// band of full rows (gles1 can't unpack a sub rect of a wider buffer).
+// Anything between the parts is free space at that point.
+/////////////////////////////////////////////////////////////////////////////
+
+void FlushSubTextureBatch(void)
+{
+ if(iBatchTex<0) return;
+
+ if(iBatchY0<=iBatchY1)
+  {
+   gTexName=uiStexturePage[iBatchTex];
+   BindSubTextureSort(texturebatch);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, iBatchY0,
+                   256, iBatchY1-iBatchY0+1,
+                   GL_RGBA, GL_UNSIGNED_BYTE, texturebatch+(iBatchY0<<10)); glError();
+   uiStexturePage[iBatchTex]=gTexName;
+   uiTexUploads++;
+   uiTexUploadBytes+=(iBatchY1-iBatchY0+1)<<10;
+  }
+
+ iBatchTex=-1;
+}
+
+void BatchSubTexture(int iTex)
+{
+ if(iTex==iBatchTex) return;
+ FlushSubTextureBatch();
+ iBatchTex=iTex;iBatchY0=256;iBatchY1=-1;
+}
+
+void AddSubReload(textureSubCacheEntryS * tsx,int pageid,int mode)
+{
+ if(iSubReloadCnt>=iSubReloadMax)
+  {
+   iSubReloadMax=iSubReloadMax?iSubReloadMax*2:1024;
+   pSubReload=(textureSubReloadS *)realloc(pSubReload,iSubReloadMax*sizeof(textureSubReloadS));
+  }
+ pSubReload[iSubReloadCnt].tsx=tsx;
+ pSubReload[iSubReloadCnt].pageid=pageid;
+ pSubReload[iSubReloadCnt].mode=mode;
+ iSubReloadCnt++;
+}
+
+int CompareSubReload(const void * a,const void * b)
+{
+ const textureSubReloadS * ra=(const textureSubReloadS *)a;
+ const textureSubReloadS * rb=(const textureSubReloadS *)b;
+ if(ra->tsx->cTexID!=rb->tsx->cTexID) return ra->tsx->cTexID-rb->tsx->cTexID;
+ return (ra->tsx<rb->tsx)?-1:(ra->tsx>rb->tsx);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -4003,15 +4169,16 @@ void CompressTextureSpace(void)
  int i,j,k,m,n,iMax;EXLong * ul, r,opos;
  short sOldDST=DrawSemiTrans,cx,cy;
  long  lOGTP=GlobalTexturePage;
- unsigned long l,row;
- unsigned long * lSRCPtr;
+ uint32_t l,row;
+ uint32_t * lSRCPtr;
 
- opos.l=*((unsigned long *)&gl_ux[4]);
+ opos.l=*((uint32_t *)&gl_ux[4]);
 
  // 1. mark all textures as free
  for(i=0;i<iSortTexCnt;i++)
   {ul=pxSsubtexLeft[i];ul->l=0;}
  usLRUTexPage=0;
+ iSubReloadCnt=0;
 
  // 2. compress
  for(j=0;j<3;j++)
@@ -4038,6 +4205,12 @@ void CompressTextureSpace(void)
         {
          if(tsx->ClutID)
           {
+           if((tsx->Opaque&TEXDIRTY) &&                // vram changed? drop it, like
+              SubTextureHash(k,j,tsx->ClutID,tsx->pos)!=tsx->Hash) // invalidating did
+            {
+             tsx->ClutID=0;continue;
+            }
+
            r.l=tsx->pos.l;
            for(n=i+1,tsb=tsx+1;n<iMax;n++,tsb++)
             {
@@ -4059,7 +4232,7 @@ void CompressTextureSpace(void)
              if(j!=2)
               {
                // palette check sum
-               l=0;lSRCPtr=(unsigned long *)(psxVuw+cx+(cy*1024));
+               l=0;lSRCPtr=(uint32_t *)(psxVuw+cx+(cy*1024));
                if(j==1) for(row=1;row<129;row++) l+=((*lSRCPtr++)-1)*row;
                else     for(row=1;row<9;row++)   l+=((*lSRCPtr++)-1)<<row;
                l=((l+HIWORD(l))&0x3fffL)<<16;
@@ -4086,20 +4259,14 @@ void CompressTextureSpace(void)
                usLRUTexPage=0;
                DrawSemiTrans=sOldDST;
                GlobalTexturePage=lOGTP;
-               *((unsigned long *)&gl_ux[4])=opos.l;
+               *((uint32_t *)&gl_ux[4])=opos.l;
                dwTexPageComp=0;
+               iSubReloadCnt=0;
 
                return;
               }
 
-             if(tsx->ClutID&(1<<30)) DrawSemiTrans=1;
-             else                    DrawSemiTrans=0;
-             *((unsigned long *)&gl_ux[4])=r.l;
-   
-             gTexName=uiStexturePage[tsx->cTexID];
-             LoadSubTexFn(k,j,cx,cy);
-             uiStexturePage[tsx->cTexID]=gTexName;
-             tsx->Opaque=ubOpaqueDraw;
+             AddSubReload(tsx,k,j);                    // loaded in 3.
             }
           }
         }
@@ -4115,9 +4282,39 @@ void CompressTextureSpace(void)
     }
   }
 
+ // 3. load the parts, one sort texture after the other
+
+ qsort(pSubReload,iSubReloadCnt,sizeof(textureSubReloadS),CompareSubReload);
+
+ for(i=0;i<iSubReloadCnt;i++)
+  {
+   tsx=pSubReload[i].tsx;
+   k=pSubReload[i].pageid;
+   j=pSubReload[i].mode;
+   cx=((tsx->ClutID << 4) & 0x3F0);
+   cy=((tsx->ClutID >> 6) & CLUTYMASK);
+
+   if(tsx->ClutID&(1<<30)) DrawSemiTrans=1;
+   else                    DrawSemiTrans=0;
+   *((uint32_t *)&gl_ux[4])=tsx->pos.l;
+   XTexS=tsx->posTX;
+   YTexS=tsx->posTY;
+
+   BatchSubTexture(tsx->cTexID);
+   gTexName=uiStexturePage[tsx->cTexID];
+   LoadSubTexFn(k,j,cx,cy);
+   uiStexturePage[tsx->cTexID]=gTexName;
+   tsx->Opaque=ubOpaqueDraw;
+   tsx->Hash=GlobalTextIL?0:SubTextureHash(k,j,tsx->ClutID,tsx->pos);
+   uiTexDecodes++;
+  }
+ iSubReloadCnt=0;
+
+ FlushSubTextureBatch();
+
  if(dwTexPageComp==0xffffffff) dwTexPageComp=0;
 
- *((unsigned long *)&gl_ux[4])=opos.l;
+ *((uint32_t *)&gl_ux[4])=opos.l;
  GlobalTexturePage=lOGTP;
  DrawSemiTrans=sOldDST;
 }
@@ -4132,7 +4329,7 @@ void CompressTextureSpace(void)
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
-GLuint SelectSubTextureS(long TextureMode, unsigned long GivenClutId) 
+GLuint SelectSubTextureS(long TextureMode, uint32_t GivenClutId) 
 {
  unsigned char * OPtr;unsigned short iCache;short cx,cy;
 
@@ -4174,9 +4371,9 @@ GLuint SelectSubTextureS(long TextureMode, unsigned long GivenClutId)
 
    // palette check sum.. removed MMX asm, this easy func works as well
     {
-     unsigned long l=0,row;
+     uint32_t l=0,row;
 
-     unsigned long * lSRCPtr=(unsigned long *)(psxVuw+cx+(cy*1024));
+     uint32_t * lSRCPtr=(uint32_t *)(psxVuw+cx+(cy*1024));
      if(TextureMode==1) for(row=1;row<129;row++) l+=((*lSRCPtr++)-1)*row;
      else               for(row=1;row<9;row++)   l+=((*lSRCPtr++)-1)<<row;
      l=(l+HIWORD(l))&0x3fffL;
@@ -4205,6 +4402,7 @@ GLuint SelectSubTextureS(long TextureMode, unsigned long GivenClutId)
  LoadSubTexFn(GlobalTexturePage,TextureMode,cx,cy);
  uiStexturePage[iCache]=gTexName;
  *OPtr=ubOpaqueDraw;
+ uiTexDecodes++;
  return (GLuint) gTexName;
 }
 
@@ -29,7 +29,7 @@ short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coor
 long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
 long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
 
-unsigned long dwGPUVersion;
+uint32_t dwGPUVersion;
 int           iGPUHeight=512;
 int           iGPUHeightMask=511;
 int           GlobalTextIL;
@@ -42,7 +42,7 @@ BOOL            bNeedInterlaceUpdate;
 BOOL            bNeedRGB24Update;
 BOOL            bChangeWinMode;
 long            lGPUstatusRet;
-unsigned long   ulGPUInfoVals[16];
+uint32_t   ulGPUInfoVals[16];
 VRAMLoad_t      VRAMWrite;
 VRAMLoad_t      VRAMRead;
 int             iDataWriteMode;
@@ -312,7 +312,7 @@ if(bUp) updateDisplay();                              // yeah, real update (swap
 }
 
 #define GPUwriteStatus_ext GPUwriteStatus_ext // for gpulib to see this
-void GPUwriteStatus_ext(unsigned long gdata)
+void GPUwriteStatus_ext(uint32_t gdata)
 {
 switch((gdata>>24)&0xff)
  {
@@ -475,6 +475,8 @@ switch((gdata>>24)&0xff)
 
 #include <stdint.h>
 
+// GL calls must stay on the thread that owns the context
+#define GPULIB_NO_THREAD
 #include "../gpulib/gpu.c"
 
 static int is_opened;
@@ -706,6 +708,24 @@ long GPUclose(void)
  return 0;
 }
 
+static void (*stats_cb)(const struct gpu_peopsgl_stats *s);
+
+static void stats_frame_end(void)
+{
+ struct gpu_peopsgl_stats s;
+
+ s.cache_hits   = uiTexCacheHits;
+ s.hash_hits    = uiTexHashHits;
+ s.decodes      = uiTexDecodes;
+ s.uploads      = uiTexUploads;
+ s.upload_bytes = uiTexUploadBytes;
+ uiTexCacheHits = uiTexHashHits = uiTexDecodes = 0;
+ uiTexUploads = uiTexUploadBytes = 0;
+
+ if (stats_cb)
+  stats_cb(&s);
+}
+
 /* acting as both renderer and vout handler here .. */
 void renderer_set_config(const struct rearmed_cbs *cbs_)
 {
@@ -727,6 +747,9 @@ void renderer_set_config(const struct rearmed_cbs *cbs_)
  iTexGarbageCollection = cbs->gpu_peopsgl.iTexGarbageCollection;
  iVRamSize = cbs->gpu_peopsgl.iVRamSize;
 
+ stats_cb = cbs->gpu_peopsgl.stats;
+ gpu.frame_end = stats_cb ? stats_frame_end : NULL;
+
  if (cbs->pl_set_gpu_caps)
   cbs->pl_set_gpu_caps(GPU_CAP_OWNS_DISPLAY);
 
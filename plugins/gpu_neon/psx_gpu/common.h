@@ -12,6 +12,7 @@ typedef unsigned long long int u64;
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/time.h>
 
@@ -15,41 +15,46 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "common.h"
 
-u32 span_pixels = 0;
-u32 span_pixel_blocks = 0;
-u32 spans = 0;
-u32 triangles = 0;
-u32 sprites = 0;
-u32 sprites_4bpp = 0;
-u32 sprites_8bpp = 0;
-u32 sprites_16bpp = 0;
-u32 sprite_blocks = 0;
-u32 sprites_untextured = 0;
-u32 lines = 0;
-u32 trivial_rejects = 0;
-u32 texels_4bpp = 0;
-u32 texels_8bpp = 0;
-u32 texels_16bpp = 0;
-u32 texel_blocks_4bpp = 0;
-u32 texel_blocks_8bpp = 0;
-u32 texel_blocks_16bpp = 0;
-u32 texel_blocks_untextured = 0;
-u32 blend_blocks = 0;
-u32 render_buffer_flushes = 0;
-u32 state_changes = 0;
-u32 left_split_triangles = 0;
-u32 flat_triangles = 0;
-u32 clipped_triangles = 0;
-u32 zero_block_spans = 0;
-u32 texture_cache_loads = 0;
-u32 false_modulated_blocks = 0;
-
 /* double size for enhancement */
 u32 reciprocal_table[512 * 2];
 
+static u64 stats_time_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+
+  return (tv.tv_sec * 1000000000ULL) + tv.tv_usec * 1000;
+#endif
+}
+
+// Accounts the time since the last switch to the class that was running and
+// makes time_class the current one, returns the previous class so that the
+// caller can switch back when it's done. Without stats_timing only the class
+// is tracked, that's cheap enough to be always left in.
+static inline u32 stats_time_switch(psx_gpu_struct *psx_gpu, u32 time_class)
+{
+  u32 previous_class = psx_gpu->stats_time_class;
+
+  if(psx_gpu->stats_timing && time_class != previous_class)
+  {
+    u64 now = stats_time_ns();
+    psx_gpu->stats.time_ns[previous_class] += now - psx_gpu->stats_time_start;
+    psx_gpu->stats_time_start = now;
+  }
+  psx_gpu->stats_time_class = time_class;
+  return previous_class;
+}
+
 
 typedef s32 fixed_type;
 
@@ -220,15 +225,102 @@ u32 texture_region_mask(s32 x1, s32 y1, s32 x2, s32 y2)
   return mask_up_left & mask_down_right;
 }
 
+// Uploads wrap around the vram edges.
+static u32 texture_region_mask_wrap(s32 x1, s32 y1, s32 x2, s32 y2)
+{
+  u32 mask = texture_region_mask(x1, y1, x2 > 1023 ? 1023 : x2,
+   y2 > 511 ? 511 : y2);
+
+  if(x2 > 1023)
+    mask |= texture_region_mask_wrap(0, y1, x2 - 1024, y2);
+  if(y2 > 511)
+    mask |= texture_region_mask_wrap(x1, 0, x2, y2 - 512);
+
+  return mask;
+}
+
+// Marks the 4x16 halfword tiles touching the given vram rectangle in all of
+// the dirty_tiles_* maps. The page bits are the caller's business.
+static void invalidate_texture_cache_tiles(psx_gpu_struct *psx_gpu, s32 x1,
+ s32 y1, s32 x2, s32 y2)
+{
+  u32 tile_row, page_x, page_x_end;
+  u32 tiles, first, last;
+  u16 *dirty;
+
+  if(x2 > 1023)
+  {
+    invalidate_texture_cache_tiles(psx_gpu, 0, y1, x2 - 1024, y2);
+    x2 = 1023;
+  }
+  if(y2 > 511)
+  {
+    invalidate_texture_cache_tiles(psx_gpu, x1, 0, x2, y2 - 512);
+    y2 = 511;
+  }
+  if(x1 < 0)
+    x1 = 0;
+  if(y1 < 0)
+    y1 = 0;
+
+  if((x1 > x2) || (y1 > y2))
+    return;
+
+  page_x_end = x2 >> 6;
+
+  for(tile_row = y1 >> 4; tile_row <= (u32)(y2 >> 4); tile_row++)
+  {
+    for(page_x = x1 >> 6; page_x <= page_x_end; page_x++)
+    {
+      first = (page_x == (u32)(x1 >> 6)) ? (x1 >> 2) & 0xF : 0;
+      last = (page_x == page_x_end) ? (x2 >> 2) & 0xF : 15;
+      tiles = (0xFFFF << first) & (0xFFFF >> (15 - last));
+
+      dirty = &psx_gpu->dirty_tiles_4bpp[(tile_row >> 4) * 16 + page_x][0];
+      dirty[tile_row & 0xF] |= tiles;
+      dirty = &psx_gpu->dirty_tiles_8bpp[0][(tile_row >> 4) * 16 + page_x][0];
+      dirty[tile_row & 0xF] |= tiles;
+      dirty = &psx_gpu->dirty_tiles_8bpp[1][(tile_row >> 4) * 16 + page_x][0];
+      dirty[tile_row & 0xF] |= tiles;
+    }
+  }
+}
+
+void invalidate_texture_cache_pages(psx_gpu_struct *psx_gpu, u32 mask)
+{
+  u32 texture_page;
+
+  psx_gpu->dirty_textures_4bpp_mask |= mask;
+  psx_gpu->dirty_textures_8bpp_mask |= mask;
+  psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
+
+  for(texture_page = 0; texture_page < 32; texture_page++)
+  {
+    if(mask & (1 << texture_page))
+    {
+      memset(psx_gpu->dirty_tiles_4bpp[texture_page], 0xFF,
+       sizeof(psx_gpu->dirty_tiles_4bpp[0]));
+      memset(psx_gpu->dirty_tiles_8bpp[0][texture_page], 0xFF,
+       sizeof(psx_gpu->dirty_tiles_8bpp[0][0]));
+      memset(psx_gpu->dirty_tiles_8bpp[1][texture_page], 0xFF,
+       sizeof(psx_gpu->dirty_tiles_8bpp[0][0]));
+    }
+  }
+}
+
 u32 invalidate_texture_cache_region(psx_gpu_struct *psx_gpu, u32 x1, u32 y1,
  u32 x2, u32 y2)
 {
   u32 mask = texture_region_mask(x1, y1, x2, y2);
 
+  psx_gpu->band_drawn_mask |= mask;
+
   psx_gpu->dirty_textures_4bpp_mask |= mask;
   psx_gpu->dirty_textures_8bpp_mask |= mask;
   psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
 
+  invalidate_texture_cache_tiles(psx_gpu, x1, y1, x2, y2);
+
   return mask;
 }
 
@@ -238,66 +330,118 @@ u32 invalidate_texture_cache_region_viewport(psx_gpu_struct *psx_gpu, u32 x1,
   u32 mask = texture_region_mask(x1, y1, x2, y2) &
    psx_gpu->viewport_mask;
 
+  psx_gpu->band_drawn_mask |= mask;
+
   psx_gpu->dirty_textures_4bpp_mask |= mask;
   psx_gpu->dirty_textures_8bpp_mask |= mask;
   psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
 
+  if(mask)
+  {
+    s32 tiles_x1 = (s32)x1, tiles_y1 = (s32)y1;
+    s32 tiles_x2 = (s32)x2, tiles_y2 = (s32)y2;
+
+    if(tiles_x1 < psx_gpu->viewport_start_x)
+      tiles_x1 = psx_gpu->viewport_start_x;
+    if(tiles_y1 < psx_gpu->viewport_start_y)
+      tiles_y1 = psx_gpu->viewport_start_y;
+    if(tiles_x2 > psx_gpu->viewport_end_x)
+      tiles_x2 = psx_gpu->viewport_end_x;
+    if(tiles_y2 > psx_gpu->viewport_end_y)
+      tiles_y2 = psx_gpu->viewport_end_y;
+
+    invalidate_texture_cache_tiles(psx_gpu, tiles_x1, tiles_y1, tiles_x2,
+     tiles_y2);
+
+    psx_gpu->last_drawn[0] = tiles_x1;
+    psx_gpu->last_drawn[1] = tiles_y1;
+    psx_gpu->last_drawn[2] = tiles_x2;
+    psx_gpu->last_drawn[3] = tiles_y2;
+
+    if(tiles_x1 < psx_gpu->pending_drawn[0])
+      psx_gpu->pending_drawn[0] = tiles_x1;
+    if(tiles_y1 < psx_gpu->pending_drawn[1])
+      psx_gpu->pending_drawn[1] = tiles_y1;
+    if(tiles_x2 > psx_gpu->pending_drawn[2])
+      psx_gpu->pending_drawn[2] = tiles_x2;
+    if(tiles_y2 > psx_gpu->pending_drawn[3])
+      psx_gpu->pending_drawn[3] = tiles_y2;
+  }
+
   return mask;
 }
 
-void update_texture_cache_region(psx_gpu_struct *psx_gpu, u32 x1, u32 y1,
- u32 x2, u32 y2)
+static void drawn_area_reset(s32 *area)
 {
-  u32 mask = texture_region_mask(x1, y1, x2, y2);
-  u32 texture_page;
-  u8 *texture_page_ptr;
-  u16 *vram_ptr;
+  area[0] = 1024;
+  area[1] = 512;
+  area[2] = -1;
+  area[3] = -1;
+}
+
+static void pending_drawn_reset(psx_gpu_struct *psx_gpu)
+{
+  drawn_area_reset(psx_gpu->pending_drawn);
+  drawn_area_reset(psx_gpu->last_drawn);
+  psx_gpu->texture_cache_refreshed = 0;
+}
+
+// One 16x16 texel tile of a 4bpp page, from the 4x16 halfwords under it.
+static void update_texture_4bpp_cache_tile(psx_gpu_struct *psx_gpu,
+ u32 texture_page, u32 tile_x, u32 tile_y)
+{
+  u8 *texture_page_ptr = psx_gpu->texture_4bpp_cache[texture_page];
+  u16 *vram_ptr = psx_gpu->vram_ptr;
   u32 texel_block;
   u32 sub_x, sub_y;
 
-  psx_gpu->dirty_textures_8bpp_mask |= mask;
-  psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
+  texture_page_ptr += tile_x * 16*16 + tile_y * 16*16*16;
+  vram_ptr += (texture_page >> 4) * 256 * 1024 + (texture_page & 0xF) * 64;
+  vram_ptr += tile_x * 4 + tile_y * 16 * 1024;
 
-  if ((psx_gpu->dirty_textures_4bpp_mask & mask) == 0 &&
-      (x1 & 3) == 0 && (y1 & 15) == 0 && x2 - x1 < 4 && y2 - y1 < 16)
+  for(sub_y = 0; sub_y < 16; sub_y++, vram_ptr += 1024)
   {
-    texture_page = ((x1 / 64) & 15) + (y1 / 256) * 16;
-    texture_page_ptr = psx_gpu->texture_4bpp_cache[texture_page];
-    texture_page_ptr += (x1 / 4 & 15) * 16*16 + (y1 / 16 & 15) * 16*16*16;
-    vram_ptr = psx_gpu->vram_ptr + x1 + y1 * 1024;
-    sub_x = 4;
-    sub_y = 16;
-
-    while(sub_y)
+    for(sub_x = 0; sub_x < 4; sub_x++)
     {
-      while(sub_x)
-      {
-        texel_block = *vram_ptr;
+      texel_block = vram_ptr[sub_x];
 
-        texture_page_ptr[0] = texel_block & 0xF;
-        texture_page_ptr[1] = (texel_block >> 4) & 0xF;
-        texture_page_ptr[2] = (texel_block >> 8) & 0xF;
-        texture_page_ptr[3] = texel_block >> 12;
-        
-        vram_ptr++;
-        texture_page_ptr += 4;
+      texture_page_ptr[0] = texel_block & 0xF;
+      texture_page_ptr[1] = (texel_block >> 4) & 0xF;
+      texture_page_ptr[2] = (texel_block >> 8) & 0xF;
+      texture_page_ptr[3] = texel_block >> 12;
 
-        sub_x--;          
-      }
+      texture_page_ptr += 4;
+    }
+  }
+}
+
+void update_texture_cache_region(psx_gpu_struct *psx_gpu, u32 x1, u32 y1,
+ u32 x2, u32 y2)
+{
+  u32 mask = texture_region_mask_wrap(x1, y1, x2, y2);
 
-      vram_ptr -= 4;
-      sub_x = 4;
+  psx_gpu->dirty_textures_8bpp_mask |= mask;
+  psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
 
-      sub_y--;
-      vram_ptr += 1024;
-    }
+  if ((psx_gpu->dirty_textures_4bpp_mask & mask) == 0 &&
+      (x1 & 3) == 0 && (y1 & 15) == 0 && x2 - x1 < 4 && y2 - y1 < 16)
+  {
+    update_texture_4bpp_cache_tile(psx_gpu,
+     ((x1 / 64) & 15) + (y1 / 256) * 16, x1 / 4 & 15, y1 / 16 & 15);
+
+    // still stale in the 8bpp layouts
+    invalidate_texture_cache_tiles(psx_gpu, x1, y1, x2, y2);
+    psx_gpu->dirty_tiles_4bpp[((x1 / 64) & 15) + (y1 / 256) * 16]
+     [y1 / 16 & 15] &= ~(1 << (x1 / 4 & 15));
   }
   else
   {
     psx_gpu->dirty_textures_4bpp_mask |= mask;
+    invalidate_texture_cache_tiles(psx_gpu, x1, y1, x2, y2);
   }
 }
 
+void update_texture_4bpp_cache(psx_gpu_struct *psx_gpu);
 void update_texture_8bpp_cache_slice(psx_gpu_struct *psx_gpu,
  u32 texture_page);
 
@@ -316,8 +460,6 @@ void update_texture_4bpp_cache(psx_gpu_struct *psx_gpu)
   vram_ptr += (current_texture_page >> 4) * 256 * 1024;
   vram_ptr += (current_texture_page & 0xF) * 64;
 
-  texture_cache_loads++;
-
   tile_y = 16;
   tile_x = 16;
   sub_x = 4;
@@ -377,8 +519,6 @@ void update_texture_8bpp_cache_slice(psx_gpu_struct *psx_gpu,
 
   vec_8x16u texels;
 
-  texture_cache_loads++;
-
   vram_ptr += (texture_page >> 4) * 256 * 1024;
   vram_ptr += (texture_page & 0xF) * 64;
 
@@ -426,17 +566,124 @@ void update_texture_8bpp_cache_slice(psx_gpu_struct *psx_gpu,
 #endif
 
 
+// Past this many dirty tiles the whole page (or 8bpp slice) is rebuilt,
+// which goes in one straight pass instead of tile by tile.
+#define TEXTURE_CACHE_TILES_4BPP_FULL  (16 * 16 / 2)
+#define TEXTURE_CACHE_TILES_8BPP_FULL  (8 * 16 / 2)
+
+void update_texture_4bpp_cache_tiles(psx_gpu_struct *psx_gpu)
+{
+  u32 current_texture_page = psx_gpu->current_texture_page;
+  u16 *dirty_tiles = psx_gpu->dirty_tiles_4bpp[current_texture_page];
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_TEXTURE_CACHE);
+  u32 num_tiles = 0;
+  u32 tiles, tile_y;
+
+  for(tile_y = 0; tile_y < 16; tile_y++)
+  {
+    for(tiles = dirty_tiles[tile_y]; tiles; tiles &= tiles - 1)
+      num_tiles++;
+  }
+
+  if(num_tiles > TEXTURE_CACHE_TILES_4BPP_FULL)
+  {
+    update_texture_4bpp_cache(psx_gpu);
+    num_tiles = 16 * 16;
+  }
+  else
+  {
+    for(tile_y = 0; tile_y < 16; tile_y++)
+    {
+      for(tiles = dirty_tiles[tile_y]; tiles; tiles &= tiles - 1)
+      {
+        update_texture_4bpp_cache_tile(psx_gpu, current_texture_page,
+         __builtin_ctz(tiles), tile_y);
+      }
+    }
+  }
+
+  memset(dirty_tiles, 0, sizeof(psx_gpu->dirty_tiles_4bpp[0]));
+  psx_gpu->dirty_textures_4bpp_mask &= ~(psx_gpu->current_texture_mask);
+  psx_gpu->texture_cache_refreshed = 1;
+
+  psx_gpu->stats.texture_cache_loads++;
+  psx_gpu->stats.texture_cache_bytes += num_tiles * 16 * 16;
+
+  stats_time_switch(psx_gpu, time_class);
+}
+
+// The 8bpp tiles are 16x16 texels too, so each is a pair of 4bpp tile bits.
+static void update_texture_8bpp_cache_slice_tiles(psx_gpu_struct *psx_gpu,
+ u32 texture_page)
+{
+  u16 *dirty_tiles =
+   psx_gpu->dirty_tiles_8bpp[psx_gpu->current_texture_page & 1][texture_page];
+  u32 num_tiles = 0;
+  u32 tiles, tile_x, tile_y;
+
+  for(tile_y = 0; tile_y < 16; tile_y++)
+  {
+    tiles = (dirty_tiles[tile_y] | (dirty_tiles[tile_y] >> 1)) & 0x5555;
+    for(; tiles; tiles &= tiles - 1)
+      num_tiles++;
+  }
+
+  if(num_tiles > TEXTURE_CACHE_TILES_8BPP_FULL)
+  {
+    update_texture_8bpp_cache_slice(psx_gpu, texture_page);
+    num_tiles = 8 * 16;
+  }
+  else
+  {
+    u16 *texture_page_ptr = psx_gpu->texture_page_base;
+    u16 *vram_ptr = psx_gpu->vram_ptr;
+    u16 *tile_ptr, *vram_tile_ptr;
+    u32 sub_y;
+
+    vram_ptr += (texture_page >> 4) * 256 * 1024;
+    vram_ptr += (texture_page & 0xF) * 64;
+
+    if((texture_page ^ psx_gpu->current_texture_page) & 0x1)
+      texture_page_ptr += (8 * 16) * 8;
+
+    for(tile_y = 0; tile_y < 16; tile_y++)
+    {
+      tiles = (dirty_tiles[tile_y] | (dirty_tiles[tile_y] >> 1)) & 0x5555;
+      for(; tiles; tiles &= tiles - 1)
+      {
+        tile_x = __builtin_ctz(tiles) / 2;
+        tile_ptr = texture_page_ptr + tile_y * (16 * 16 * 8) + tile_x * (8 * 16);
+        vram_tile_ptr = vram_ptr + tile_y * 16 * 1024 + tile_x * 8;
+
+        for(sub_y = 0; sub_y < 16; sub_y++)
+        {
+          memcpy(tile_ptr, vram_tile_ptr, 8 * 2);
+          tile_ptr += 8;
+          vram_tile_ptr += 1024;
+        }
+      }
+    }
+  }
+
+  memset(dirty_tiles, 0, sizeof(psx_gpu->dirty_tiles_8bpp[0][0]));
+
+  psx_gpu->stats.texture_cache_loads++;
+  psx_gpu->stats.texture_cache_bytes += num_tiles * 16 * 16;
+}
+
 void update_texture_8bpp_cache(psx_gpu_struct *psx_gpu)
 {
   u32 current_texture_page = psx_gpu->current_texture_page;
   u32 update_textures =
    psx_gpu->dirty_textures_8bpp_mask & psx_gpu->current_texture_mask;
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_TEXTURE_CACHE);
 
   psx_gpu->dirty_textures_8bpp_mask &= ~update_textures;
+  psx_gpu->texture_cache_refreshed = 1;
 
   if(update_textures & (1 << current_texture_page))
   {
-    update_texture_8bpp_cache_slice(psx_gpu, current_texture_page);
+    update_texture_8bpp_cache_slice_tiles(psx_gpu, current_texture_page);
     update_textures &= ~(1 << current_texture_page);
   }
 
@@ -445,12 +692,15 @@ void update_texture_8bpp_cache(psx_gpu_struct *psx_gpu)
     u32 adjacent_texture_page = ((current_texture_page + 1) & 0xF) |
      (current_texture_page & 0x10);
 
-    update_texture_8bpp_cache_slice(psx_gpu, adjacent_texture_page);
+    update_texture_8bpp_cache_slice_tiles(psx_gpu, adjacent_texture_page);
   }
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 void setup_blocks_shaded_untextured_undithered_unswizzled_indirect(
  psx_gpu_struct *psx_gpu);
+void texture_blocks_4bpp(psx_gpu_struct *psx_gpu);
 
 void flush_render_block_buffer(psx_gpu_struct *psx_gpu)
 {
@@ -500,18 +750,44 @@ void flush_render_block_buffer(psx_gpu_struct *psx_gpu)
   {
     render_block_handler_struct *render_block_handler =
      psx_gpu->render_block_handler;
+    u32 time_class = stats_time_switch(psx_gpu, psx_gpu->primitive_type);
+
+    // Done ahead of texture_blocks_4bpp, the NEON version of which can only
+    // rebuild the whole page as it keeps the CLUT in registers over the call.
+    if((render_block_handler->texture_blocks == texture_blocks_4bpp) &&
+     (psx_gpu->current_texture_mask & psx_gpu->dirty_textures_4bpp_mask))
+    {
+      update_texture_4bpp_cache_tiles(psx_gpu);
+    }
 
     render_block_handler->texture_blocks(psx_gpu);
     render_block_handler->shade_blocks(psx_gpu);
     render_block_handler->blend_blocks(psx_gpu);
 
-#ifdef PROFILE
-    span_pixel_blocks += psx_gpu->num_blocks;
-    render_buffer_flushes++;
-#endif
+    psx_gpu->stats.span_pixel_blocks += psx_gpu->num_blocks;
+    psx_gpu->stats.render_buffer_flushes++;
 
     psx_gpu->num_blocks = 0;
+    stats_time_switch(psx_gpu, time_class);
+  }
+
+  if(psx_gpu->texture_cache_refreshed &&
+   (psx_gpu->pending_drawn[0] <= psx_gpu->pending_drawn[2]))
+  {
+    s32 *area = psx_gpu->pending_drawn;
+    u32 mask = texture_region_mask(area[0], area[1], area[2], area[3]);
+
+    psx_gpu->dirty_textures_4bpp_mask |= mask;
+    psx_gpu->dirty_textures_8bpp_mask |= mask;
+    psx_gpu->dirty_textures_8bpp_alternate_mask |= mask;
+
+    invalidate_texture_cache_tiles(psx_gpu, area[0], area[1], area[2],
+     area[3]);
   }
+
+  memcpy(psx_gpu->pending_drawn, psx_gpu->last_drawn,
+   sizeof(psx_gpu->pending_drawn));
+  psx_gpu->texture_cache_refreshed = 0;
 }
 
 
@@ -791,7 +1067,7 @@ void compute_all_gradients(psx_gpu_struct *psx_gpu, vertex_struct *a,
   vec_2x64s alternate_x;                                                       \
   vec_2x64s alternate_dx_dy;                                                   \
   vec_4x32s alternate_x_32;                                                    \
-  vec_2x32s alternate_x_16;                                                    \
+  vec_4x16s alternate_x_16;                                                    \
                                                                                \
   vec_4x16u alternate_select;                                                  \
   vec_4x16s y_mid_point;                                                       \
@@ -925,10 +1201,10 @@ void compute_all_gradients(psx_gpu_struct *psx_gpu, vertex_struct *a,
 
 
 #define setup_spans_adjust_y_up()                                              \
-  sub_4x32b(y_x4, y_x4, c_0x04)                                                \
+  sub_4x16b(y_x4, y_x4, c_0x04)                                                \
 
 #define setup_spans_adjust_y_down()                                            \
-  add_4x32b(y_x4, y_x4, c_0x04)                                                \
+  add_4x16b(y_x4, y_x4, c_0x04)                                                \
 
 #define setup_spans_adjust_interpolants_up()                                   \
   sub_4x32b(uvrg, uvrg, uvrg_dy);                                              \
@@ -954,7 +1230,7 @@ void compute_all_gradients(psx_gpu_struct *psx_gpu, vertex_struct *a,
 
 #define setup_spans_clip(direction, alternate_active)                          \
 {                                                                              \
-  clipped_triangles++;                                                         \
+  psx_gpu->stats.clipped_triangles++;                                          \
   mla_scalar_long_2x32b(edges_xy, edges_dx_dy, (s64)clip);                     \
   setup_spans_clip_alternate_##alternate_active();                             \
   setup_spans_clip_interpolants_##direction();                                 \
@@ -1267,7 +1543,7 @@ void setup_spans_down_right(psx_gpu_struct *psx_gpu, vertex_struct *v_a,
 #define setup_spans_up_flat()                                                  \
   s32 height = y_a - y_c;                                                      \
                                                                                \
-  flat_triangles++;                                                            \
+  psx_gpu->stats.flat_triangles++;                                             \
   compute_edge_delta_x2();                                                     \
   setup_spans_up(index_left, index_right, none, no)                            \
 
@@ -1296,7 +1572,7 @@ void setup_spans_up_b(psx_gpu_struct *psx_gpu, vertex_struct *v_a,
 #define setup_spans_down_flat()                                                \
   s32 height = y_c - y_a;                                                      \
                                                                                \
-  flat_triangles++;                                                            \
+  psx_gpu->stats.flat_triangles++;                                             \
   compute_edge_delta_x2();                                                     \
   setup_spans_down(index_left, index_right, none, no)                          \
 
@@ -1440,7 +1716,7 @@ void setup_spans_up_down(psx_gpu_struct *psx_gpu, vertex_struct *v_a,
     }
   }
 
-  left_split_triangles++;
+  psx_gpu->stats.left_split_triangles++;
 }
 
 #endif
@@ -1867,8 +2143,8 @@ void setup_spans_up_down(psx_gpu_struct *psx_gpu, vertex_struct *v_a,
   }                                                                            \
 
 #define setup_blocks_add_blocks_direct()                                       \
-  texel_blocks_untextured += span_num_blocks;                                  \
-  span_pixel_blocks += span_num_blocks                                         \
+  psx_gpu->stats.texel_blocks_untextured += span_num_blocks;                   \
+  psx_gpu->stats.span_pixel_blocks += span_num_blocks                          \
 
 
 #define setup_blocks_builder(shading, texturing, dithering, sw, target)        \
@@ -1907,7 +2183,7 @@ void setup_blocks_##shading##_##texturing##_##dithering##_##sw##_##target(     \
                                                                                \
       s32 pixel_span = span_num_blocks * 8;                                    \
       pixel_span -= __builtin_popcount(span_edge_data->right_mask & 0xFF);     \
-      span_pixels += pixel_span;                                               \
+      psx_gpu->stats.span_pixels += pixel_span;                                \
                                                                                \
       span_num_blocks--;                                                       \
       while(span_num_blocks)                                                   \
@@ -1929,7 +2205,7 @@ void setup_blocks_##shading##_##texturing##_##dithering##_##sw##_##target(     \
     }                                                                          \
     else                                                                       \
     {                                                                          \
-      zero_block_spans++;                                                      \
+      psx_gpu->stats.zero_block_spans++;                                       \
     }                                                                          \
                                                                                \
     num_spans--;                                                               \
@@ -1996,14 +2272,14 @@ void texture_blocks_16bpp(psx_gpu_struct *psx_gpu);
 void texture_blocks_untextured(psx_gpu_struct *psx_gpu)
 {
   if(psx_gpu->primitive_type != PRIMITIVE_TYPE_SPRITE)
-    texel_blocks_untextured += psx_gpu->num_blocks;
+    psx_gpu->stats.texel_blocks_untextured += psx_gpu->num_blocks;
 }
 
 void texture_blocks_4bpp(psx_gpu_struct *psx_gpu)
 {
   block_struct *block = psx_gpu->blocks;
   u32 num_blocks = psx_gpu->num_blocks;
-  texel_blocks_4bpp += num_blocks;
+  psx_gpu->stats.texel_blocks_4bpp += num_blocks;
 
   vec_8x8u texels_low;
   vec_8x8u texels_high;
@@ -2024,7 +2300,7 @@ void texture_blocks_4bpp(psx_gpu_struct *psx_gpu)
   unzip_16x8b(clut_low, clut_high, clut_a, clut_b);
 
   if(psx_gpu->current_texture_mask & psx_gpu->dirty_textures_4bpp_mask)
-    update_texture_4bpp_cache(psx_gpu);
+    update_texture_4bpp_cache_tiles(psx_gpu);
 
   while(num_blocks)
   {
@@ -2055,7 +2331,7 @@ void texture_blocks_8bpp(psx_gpu_struct *psx_gpu)
   block_struct *block = psx_gpu->blocks;
   u32 num_blocks = psx_gpu->num_blocks;
 
-  texel_blocks_8bpp += num_blocks;
+  psx_gpu->stats.texel_blocks_8bpp += num_blocks;
 
   if(psx_gpu->current_texture_mask & psx_gpu->dirty_textures_8bpp_mask)
     update_texture_8bpp_cache(psx_gpu);
@@ -2089,7 +2365,7 @@ void texture_blocks_16bpp(psx_gpu_struct *psx_gpu)
   block_struct *block = psx_gpu->blocks;
   u32 num_blocks = psx_gpu->num_blocks;
 
-  texel_blocks_16bpp += num_blocks;
+  psx_gpu->stats.texel_blocks_16bpp += num_blocks;
 
   vec_8x16u texels;
 
@@ -2140,7 +2416,7 @@ void texture_blocks_16bpp(psx_gpu_struct *psx_gpu)
 #define shade_blocks_textured_false_modulated_check_dithered(target)           \
   if(psx_gpu->triangle_color == 0x808080)                                      \
   {                                                                            \
-    false_modulated_blocks += num_blocks;                                      \
+    psx_gpu->stats.false_modulated_blocks += num_blocks;                       \
   }                                                                            \
 
 #define shade_blocks_textured_false_modulated_check_undithered(target)         \
@@ -2148,7 +2424,7 @@ void texture_blocks_16bpp(psx_gpu_struct *psx_gpu)
   {                                                                            \
                                                                                \
     shade_blocks_textured_unmodulated_##target(psx_gpu);                       \
-    false_modulated_blocks += num_blocks;                                      \
+    psx_gpu->stats.false_modulated_blocks += num_blocks;                       \
     return;                                                                    \
   }                                                                            \
 
@@ -2596,7 +2872,7 @@ void                                                                           \
     bif_8x16b(framebuffer_pixels, blend_pixels, draw_mask);                    \
     store_8x16b(framebuffer_pixels, fb_ptr);                                   \
                                                                                \
-    blend_blocks++;                                                            \
+    psx_gpu->stats.blend_blocks++;                                             \
     num_blocks--;                                                              \
     block++;                                                                   \
   }                                                                            \
@@ -2944,15 +3220,11 @@ static int prepare_triangle(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
 
   triangle_area = triangle_signed_area_x2(a->x, a->y, b->x, b->y, c->x, c->y);
 
-#ifdef PROFILE
-  triangles++;
-#endif
+  psx_gpu->stats.triangles++;
 
   if(triangle_area == 0)
   {
-#ifdef PROFILE
-    trivial_rejects++;
-#endif
+    psx_gpu->stats.trivial_rejects++;
     return 0;
   }
 
@@ -2972,9 +3244,7 @@ static int prepare_triangle(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
 
   if((y_bottom - y_top) >= 512)
   {
-#ifdef PROFILE
-    trivial_rejects++;
-#endif
+    psx_gpu->stats.trivial_rejects++;
     return 0;
   }
 
@@ -2998,18 +3268,14 @@ static int prepare_triangle(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
 
   if((c->x - psx_gpu->offset_x) >= 1024 || (c->x - a->x) >= 1024)
   {
-#ifdef PROFILE
-    trivial_rejects++;
-#endif
+    psx_gpu->stats.trivial_rejects++;
     return 0;
   }
 
   if(invalidate_texture_cache_region_viewport(psx_gpu, a->x, y_top, c->x,
    y_bottom) == 0)
   {
-#ifdef PROFILE
-    trivial_rejects++;
-#endif
+    psx_gpu->stats.trivial_rejects++;
     return 0;
   }
 
@@ -3026,6 +3292,8 @@ static int prepare_triangle(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
 static void render_triangle_p(psx_gpu_struct *psx_gpu,
  vertex_struct *vertex_ptrs[3], u32 flags)
 {
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_TRIANGLE);
+
   psx_gpu->num_spans = 0;
 
   vertex_struct *a = vertex_ptrs[0];
@@ -3118,9 +3386,7 @@ static void render_triangle_p(psx_gpu_struct *psx_gpu,
       break;
   }
 
-#ifdef PROFILE
-  spans += psx_gpu->num_spans;
-#endif
+  psx_gpu->stats.spans += psx_gpu->num_spans;
 
   if(unlikely(psx_gpu->render_mode & RENDER_INTERLACE_ENABLED))
   {
@@ -3154,9 +3420,7 @@ static void render_triangle_p(psx_gpu_struct *psx_gpu,
   {
     psx_gpu->render_state = render_state;
     flush_render_block_buffer(psx_gpu);
-#ifdef PROFILE
-    state_changes++;
-#endif
+    psx_gpu->stats.state_changes++;
   }
 
   psx_gpu->primitive_type = PRIMITIVE_TYPE_TRIANGLE;
@@ -3165,6 +3429,8 @@ static void render_triangle_p(psx_gpu_struct *psx_gpu,
    &(render_triangle_block_handlers[render_state]);
   ((setup_blocks_function_type *)psx_gpu->render_block_handler->setup_blocks)
    (psx_gpu);
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 void render_triangle(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
@@ -3223,7 +3489,7 @@ void texture_sprite_blocks_8bpp(psx_gpu_struct *psx_gpu)
   setup_sprite_tiled_initialize_4bpp_clut();                                   \
                                                                                \
   if(psx_gpu->current_texture_mask & psx_gpu->dirty_textures_4bpp_mask)        \
-    update_texture_4bpp_cache(psx_gpu)                                         \
+    update_texture_4bpp_cache_tiles(psx_gpu)                                   \
 
 #define setup_sprite_tiled_initialize_8bpp()                                   \
   if(psx_gpu->current_texture_mask & psx_gpu->dirty_textures_8bpp_mask)        \
@@ -3239,7 +3505,7 @@ void texture_sprite_blocks_8bpp(psx_gpu_struct *psx_gpu)
 
 #define setup_sprite_tile_add_blocks(tile_num_blocks)                          \
   num_blocks += tile_num_blocks;                                               \
-  sprite_blocks += tile_num_blocks;                                            \
+  psx_gpu->stats.sprite_blocks += tile_num_blocks;                             \
                                                                                \
   if(num_blocks > MAX_BLOCKS)                                                  \
   {                                                                            \
@@ -3339,7 +3605,7 @@ void texture_sprite_blocks_8bpp(psx_gpu_struct *psx_gpu)
 
 #define setup_sprite_tile_half_8bpp(edge)                                      \
 {                                                                              \
-  setup_sprite_tile_add_blocks(sub_tile_height * 2);                           \
+  setup_sprite_tile_add_blocks(sub_tile_height);                               \
                                                                                \
   while(sub_tile_height)                                                       \
   {                                                                            \
@@ -3803,7 +4069,7 @@ void setup_sprite_##texture_mode##x4mode(psx_gpu_struct *psx_gpu, s32 x, s32 y,\
   control_mask |= setup_sprite_comapre_left_block_mask##x4mode() << 2;         \
   control_mask |= setup_sprite_comapre_right_block_mask##x4mode() << 3;        \
                                                                                \
-  sprites_##texture_mode++;                                                    \
+  psx_gpu->stats.sprites_##texture_mode++;                                     \
                                                                                \
   switch(control_mask)                                                         \
   {                                                                            \
@@ -3933,7 +4199,7 @@ void setup_sprite_16bpp(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
 
   texture_offset_base &= ~0x7;
 
-  sprites_16bpp++;
+  psx_gpu->stats.sprites_16bpp++;
 
   if(block_width == 1)
   {
@@ -3942,7 +4208,7 @@ void setup_sprite_16bpp(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
     while(height)
     {
       num_blocks++;
-      sprite_blocks++;
+      psx_gpu->stats.sprite_blocks++;
 
       if(num_blocks > MAX_BLOCKS)
       {
@@ -3975,7 +4241,7 @@ void setup_sprite_16bpp(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
     {
       blocks_remaining = block_width - 2;
       num_blocks += block_width;
-      sprite_blocks += block_width;
+      psx_gpu->stats.sprite_blocks += block_width;
 
       if(num_blocks > MAX_BLOCKS)
       {
@@ -4055,7 +4321,7 @@ void setup_sprite_untextured(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
   vec_8x16u test_mask = psx_gpu->test_mask;
   vec_8x16u zero_mask;
 
-  sprites_untextured++;
+  psx_gpu->stats.sprites_untextured++;
 
   color = (color_r >> 3) | ((color_g >> 3) << 5) | ((color_b >> 3) << 10);
 
@@ -4069,9 +4335,7 @@ void setup_sprite_untextured(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
     blocks_remaining = block_width - 1;
     num_blocks += block_width;
 
-#ifdef PROFILE
-    sprite_blocks += block_width;
-#endif
+    psx_gpu->stats.sprite_blocks += block_width;
 
     if(num_blocks > MAX_BLOCKS)
     {
@@ -4266,9 +4530,7 @@ void render_sprite(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   s32 x_right = x + width - 1;
   s32 y_bottom = y + height - 1;
 
-#ifdef PROFILE
-  sprites++;
-#endif
+  psx_gpu->stats.sprites++;
 
   if(invalidate_texture_cache_region_viewport(psx_gpu, x, y, x_right,
    y_bottom) == 0)
@@ -4301,10 +4563,10 @@ void render_sprite(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   if((width <= 0) || (height <= 0))
     return;
 
-#ifdef PROFILE
-  span_pixels += width * height;
-  spans += height;
-#endif
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_SPRITE);
+
+  psx_gpu->stats.span_pixels += width * height;
+  psx_gpu->stats.spans += height;
 
   u32 render_state = flags &
    (RENDER_FLAGS_MODULATE_TEXELS | RENDER_FLAGS_BLEND |
@@ -4317,9 +4579,7 @@ void render_sprite(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   {
     psx_gpu->render_state = render_state;
     flush_render_block_buffer(psx_gpu);
-#ifdef PROFILE
-    state_changes++;
-#endif
+    psx_gpu->stats.state_changes++;
   }
 
   psx_gpu->primitive_type = PRIMITIVE_TYPE_SPRITE;
@@ -4339,8 +4599,18 @@ void render_sprite(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
    &(render_sprite_block_handlers[render_state]);
   psx_gpu->render_block_handler = render_block_handler;
 
+  // see flush_render_block_buffer
+  if((render_state & RENDER_FLAGS_TEXTURE_MAP) &&
+   (((render_state >> 8) & 0x3) == TEXTURE_MODE_4BPP) &&
+   (psx_gpu->current_texture_mask & psx_gpu->dirty_textures_4bpp_mask))
+  {
+    update_texture_4bpp_cache_tiles(psx_gpu);
+  }
+
   ((setup_sprite_function_type *)render_block_handler->setup_blocks)
    (psx_gpu, x, y, u, v, width, height, color);
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 #define draw_pixel_line_mask_evaluate_yes()                                    \
@@ -4462,14 +4732,15 @@ void render_sprite(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
 #define draw_pixel_line_unblended(blend_mode)                                  \
 
 
+// shading steps on every pixel, clipped or masked ones included
 #define draw_pixel_line(_x, _y, shading, blending, dithering, mask_evaluate,   \
  blend_mode)                                                                   \
+  draw_pixel_line_##shading();                                                 \
   if((_x >= psx_gpu->viewport_start_x) && (_y >= psx_gpu->viewport_start_y) && \
    (_x <= psx_gpu->viewport_end_x) && (_y <= psx_gpu->viewport_end_y))         \
   {                                                                            \
     draw_pixel_line_mask_evaluate_##mask_evaluate()                            \
     {                                                                          \
-      draw_pixel_line_##shading();                                             \
       draw_pixel_line_##dithering(_x, _y);                                     \
                                                                                \
       color_r >>= 3;                                                           \
@@ -4644,9 +4915,7 @@ void render_line(psx_gpu_struct *psx_gpu, vertex_struct *vertexes, u32 flags,
 
   u32 control_mask;
 
-#ifdef PROFILE
-  lines++;
-#endif
+  psx_gpu->stats.lines++;
 
   if(vertex_a->x >= vertex_b->x)
   {
@@ -4665,6 +4934,8 @@ void render_line(psx_gpu_struct *psx_gpu, vertex_struct *vertexes, u32 flags,
   if(delta_x >= 1024 || delta_y >= 512 || delta_y <= -512)
     return;
 
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_LINE);
+
   if(double_resolution)
   {
     x_a *= 2;
@@ -4858,15 +5129,35 @@ void render_line(psx_gpu_struct *psx_gpu, vertex_struct *vertexes, u32 flags,
       render_line_body(shaded, blended, dithered, yes, add_fourth);
       break;
   }
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 
 void render_block_fill(psx_gpu_struct *psx_gpu, u32 color, u32 x, u32 y,
  u32 width, u32 height)
 {
+  if((s32)y < psx_gpu->band_start_y)
+  {
+    u32 clip = psx_gpu->band_start_y - y;
+    if(clip >= height)
+      return;
+    y += clip;
+    height -= clip;
+  }
+
+  if((s32)(y + height) > psx_gpu->band_end_y + 1)
+  {
+    if((s32)y > psx_gpu->band_end_y)
+      return;
+    height = psx_gpu->band_end_y + 1 - y;
+  }
+
   if((width == 0) || (height == 0))
     return;
 
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_FILL_COPY);
+
   invalidate_texture_cache_region(psx_gpu, x, y, x + width - 1, y + height - 1);
 
   u32 r = color & 0xFF;
@@ -4911,6 +5202,8 @@ void render_block_fill(psx_gpu_struct *psx_gpu, u32 color, u32 x, u32 y,
     vram_ptr += pitch;
     height--;
   }
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 void render_block_fill_enh(psx_gpu_struct *psx_gpu, u32 color, u32 x, u32 y,
@@ -4922,6 +5215,8 @@ void render_block_fill_enh(psx_gpu_struct *psx_gpu, u32 color, u32 x, u32 y,
   if(width > 1024)
     width = 1024;
 
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_FILL_COPY);
+
   u32 r = color & 0xFF;
   u32 g = (color >> 8) & 0xFF;
   u32 b = (color >> 16) & 0xFF;
@@ -4955,6 +5250,8 @@ void render_block_fill_enh(psx_gpu_struct *psx_gpu, u32 color, u32 x, u32 y,
     vram_ptr += pitch;
     height--;
   }
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 void render_block_copy(psx_gpu_struct *psx_gpu, u16 *source, u32 x, u32 y,
@@ -4968,8 +5265,18 @@ void render_block_copy(psx_gpu_struct *psx_gpu, u16 *source, u32 x, u32 y,
     return;
 
   flush_render_block_buffer(psx_gpu);
+
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_FILL_COPY);
+
   invalidate_texture_cache_region(psx_gpu, x, y, x + width - 1, y + height - 1);
 
+  // past the right edge this carries on at the start of the next line
+  if(x + width > 1024)
+  {
+    invalidate_texture_cache_region(psx_gpu, 0, y + 1, x + width - 1 - 1024,
+     y + height);
+  }
+
   for(draw_y = 0; draw_y < height; draw_y++)
   {
     for(draw_x = 0; draw_x < width; draw_x++)
@@ -4980,6 +5287,8 @@ void render_block_copy(psx_gpu_struct *psx_gpu, u16 *source, u32 x, u32 y,
     source += pitch;
     vram_ptr += 1024;
   }
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
 void render_block_move(psx_gpu_struct *psx_gpu, u32 source_x, u32 source_y,
@@ -5022,9 +5331,8 @@ void initialize_psx_gpu(psx_gpu_struct *psx_gpu, u16 *vram)
 
   psx_gpu->test_mask = test_mask;
 
-  psx_gpu->dirty_textures_4bpp_mask = 0xFFFFFFFF;
-  psx_gpu->dirty_textures_8bpp_mask = 0xFFFFFFFF;
-  psx_gpu->dirty_textures_8bpp_alternate_mask = 0xFFFFFFFF;
+  invalidate_texture_cache_pages(psx_gpu, 0xFFFFFFFF);
+  pending_drawn_reset(psx_gpu);
   psx_gpu->viewport_mask = 0;
   psx_gpu->current_texture_page = 0;
   psx_gpu->current_texture_mask = 0;
@@ -5077,6 +5385,16 @@ void initialize_psx_gpu(psx_gpu_struct *psx_gpu, u16 *vram)
   psx_gpu->primitive_type = PRIMITIVE_TYPE_UNKNOWN;
 
   psx_gpu->enhancement_x_threshold = 256;
+
+  psx_gpu->band_start_y = 0;
+  psx_gpu->band_end_y = 511;
+  psx_gpu->band_drawn_mask = 0;
+  psx_gpu->enhancement_only = 0;
+
+  memset(&psx_gpu->stats, 0, sizeof(psx_gpu->stats));
+  psx_gpu->stats_timing = 0;
+  psx_gpu->stats_time_class = STATS_TIME_NONE;
+  psx_gpu->stats_time_start = 0;
 }
 
 u64 get_us(void)
@@ -38,6 +38,54 @@ typedef enum
   BLEND_MODE_ADD_FOURTH = 3
 } blend_mode_enum;
 
+// what the renderer time is accounted to, the first ones match
+// primitive_type_enum so that block flushes can use that directly
+typedef enum
+{
+  STATS_TIME_TRIANGLE = 0,
+  STATS_TIME_SPRITE = 1,
+  STATS_TIME_LINE = 2,
+  STATS_TIME_NONE = 3,
+  STATS_TIME_FILL_COPY = 4,
+  STATS_TIME_TEXTURE_CACHE = 5,
+  STATS_TIME_COUNT
+} stats_time_enum;
+
+typedef struct
+{
+  u32 triangles;
+  u32 sprites;
+  u32 sprites_4bpp;
+  u32 sprites_8bpp;
+  u32 sprites_16bpp;
+  u32 sprites_untextured;
+  u32 lines;
+  u32 trivial_rejects;
+  u32 left_split_triangles;
+  u32 flat_triangles;
+  u32 clipped_triangles;
+
+  u32 spans;
+  u32 span_pixels;
+  u32 span_pixel_blocks;
+  u32 zero_block_spans;
+  u32 sprite_blocks;
+  u32 texel_blocks_4bpp;
+  u32 texel_blocks_8bpp;
+  u32 texel_blocks_16bpp;
+  u32 texel_blocks_untextured;
+  u32 blend_blocks;
+  u32 false_modulated_blocks;
+
+  u32 render_buffer_flushes;
+  u32 state_changes;
+  u32 texture_cache_loads;
+  u32 texture_cache_bytes;
+
+  // nanoseconds, only collected while psx_gpu->stats_timing is set
+  u64 time_ns[STATS_TIME_COUNT];
+} psx_gpu_stats_struct;
+
 typedef enum
 {
   RENDER_FLAGS_MODULATE_TEXELS = 0x1,
@@ -208,6 +256,37 @@ typedef struct
   u8 texture_8bpp_even_cache[16][256 * 256];
   u8 texture_8bpp_odd_cache[16][256 * 256];
   int use_dithering;
+
+  // when drawing in horizontal bands on several threads (see psx_gpu_if.c),
+  // lines outside band_start_y..band_end_y are left to other instances
+  s16 band_start_y;
+  s16 band_end_y;
+  u32 band_drawn_mask;
+
+  // only draw the enhanced copy, the native one is done by another instance
+  u32 enhancement_only;
+
+  // counted all the time, reset by whoever reads them
+  psx_gpu_stats_struct stats;
+  u32 stats_timing;
+  u32 stats_time_class;
+  u64 stats_time_start;
+
+  // What changed under the dirty_textures_* page bits, so that only that is
+  // redone. One bit per 16x16 texel 4bpp cache tile (4x16 in vram), indexed
+  // by texture page and tile row; an 8bpp tile is two of these. The 8bpp
+  // ones are per even/odd cache layout, not swapped like the page masks.
+  u16 dirty_tiles_4bpp[32][16];
+  u16 dirty_tiles_8bpp[2][32][16];
+
+  // Area (x1, y1, x2, y2) drawn by the blocks still in the render buffer.
+  // A primitive may texture from where it draws, so if the cache got
+  // refreshed before the blocks were written it's marked dirty again after
+  // the flush. The last primitive is always carried over, as it may get
+  // flushed before its blocks are set up (state change) or in parts.
+  s32 pending_drawn[4];
+  s32 last_drawn[4];
+  u32 texture_cache_refreshed;
 } psx_gpu_struct;
 
 typedef struct __attribute__((aligned(16)))
@@ -240,6 +319,7 @@ void render_line(psx_gpu_struct *gpu, vertex_struct *vertexes, u32 flags,
  u32 color, int double_resolution);
 
 u32 texture_region_mask(s32 x1, s32 y1, s32 x2, s32 y2);
+void invalidate_texture_cache_pages(psx_gpu_struct *psx_gpu, u32 mask);
 
 void flush_render_block_buffer(psx_gpu_struct *psx_gpu);
 
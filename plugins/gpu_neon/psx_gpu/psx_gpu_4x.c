@@ -30,7 +30,7 @@ void setup_sprite_16bpp_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
 
   texture_offset_base &= ~0x7;
 
-  sprites_16bpp++;
+  psx_gpu->stats.sprites_16bpp++;
 
   if(block_width == 1)
   {
@@ -44,7 +44,7 @@ void setup_sprite_16bpp_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
     while(height)
     {
       num_blocks += 4;
-      sprite_blocks += 4;
+      psx_gpu->stats.sprite_blocks += 4;
 
       if(num_blocks > MAX_BLOCKS)
       {
@@ -103,7 +103,7 @@ void setup_sprite_16bpp_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, s32 u,
     {
       blocks_remaining = block_width - 2;
       num_blocks += block_width * 4;
-      sprite_blocks += block_width * 4;
+      psx_gpu->stats.sprite_blocks += block_width * 4;
 
       if(num_blocks > MAX_BLOCKS)
       {
@@ -306,9 +306,7 @@ void render_sprite_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   s32 x_right = x + width - 1;
   s32 y_bottom = y + height - 1;
 
-#ifdef PROFILE
-  sprites++;
-#endif
+  psx_gpu->stats.sprites++;
 
   if(x < psx_gpu->viewport_start_x)
   {
@@ -340,10 +338,10 @@ void render_sprite_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   x *= 2;
   y *= 2;
 
-#ifdef PROFILE
-  span_pixels += width * height;
-  spans += height;
-#endif
+  u32 time_class = stats_time_switch(psx_gpu, STATS_TIME_SPRITE);
+
+  psx_gpu->stats.span_pixels += width * height;
+  psx_gpu->stats.spans += height;
 
   u32 render_state = flags &
    (RENDER_FLAGS_MODULATE_TEXELS | RENDER_FLAGS_BLEND |
@@ -356,9 +354,7 @@ void render_sprite_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
   {
     psx_gpu->render_state = render_state;
     flush_render_block_buffer(psx_gpu);
-#ifdef PROFILE
-    state_changes++;
-#endif
+    psx_gpu->stats.state_changes++;
   }
 
   psx_gpu->primitive_type = PRIMITIVE_TYPE_SPRITE;
@@ -378,7 +374,17 @@ void render_sprite_4x(psx_gpu_struct *psx_gpu, s32 x, s32 y, u32 u, u32 v,
    &(render_sprite_block_handlers_4x[render_state]);
   psx_gpu->render_block_handler = render_block_handler;
 
+  // see flush_render_block_buffer
+  if((render_state & RENDER_FLAGS_TEXTURE_MAP) &&
+   (((render_state >> 8) & 0x3) == TEXTURE_MODE_4BPP) &&
+   (psx_gpu->current_texture_mask & psx_gpu->dirty_textures_4bpp_mask))
+  {
+    update_texture_4bpp_cache_tiles(psx_gpu);
+  }
+
   ((setup_sprite_function_type *)render_block_handler->setup_blocks)
    (psx_gpu, x, y, u, v, width, height, color);
+
+  stats_time_switch(psx_gpu, time_class);
 }
 
@@ -18,35 +18,6 @@
 #include "SDL.h"
 #include "common.h"
 
-extern u32 span_pixels;
-extern u32 span_pixel_blocks;
-extern u32 spans;
-extern u32 triangles;
-extern u32 sprites;
-extern u32 sprites_4bpp;
-extern u32 sprites_8bpp;
-extern u32 sprites_16bpp;
-extern u32 sprites_untextured;
-extern u32 sprite_blocks;
-extern u32 lines;
-extern u32 texels_4bpp;
-extern u32 texels_8bpp;
-extern u32 texels_16bpp;
-extern u32 texel_blocks_4bpp;
-extern u32 texel_blocks_8bpp;
-extern u32 texel_blocks_16bpp;
-extern u32 texel_blocks_untextured;
-extern u32 blend_blocks;
-extern u32 render_buffer_flushes;
-extern u32 state_changes;
-extern u32 trivial_rejects;
-extern u32 left_split_triangles;
-extern u32 flat_triangles;
-extern u32 clipped_triangles;
-extern u32 zero_block_spans;
-extern u32 texture_cache_loads;
-extern u32 false_modulated_blocks;
-
 static u32 mismatches;
 
 typedef struct
@@ -64,36 +35,9 @@ u16 __attribute__((aligned(256))) _vram[(1024 * 512) + 1024];
 #define percent_of(numerator, denominator)                                     \
   ((((double)(numerator)) / (denominator)) * 100.0)                            \
 
-void clear_stats(void)
+void clear_stats(psx_gpu_struct *psx_gpu)
 {
-  triangles = 0;
-  sprites = 0;
-  sprites_4bpp = 0;
-  sprites_8bpp = 0;
-  sprites_16bpp = 0;
-  sprites_untextured = 0;
-  sprite_blocks = 0;
-  lines = 0;
-  span_pixels = 0;
-  span_pixel_blocks = 0;
-  spans = 0;
-  texels_4bpp = 0;
-  texels_8bpp = 0;
-  texels_16bpp = 0;
-  texel_blocks_untextured = 0;
-  texel_blocks_4bpp = 0;
-  texel_blocks_8bpp = 0;
-  texel_blocks_16bpp = 0;
-  blend_blocks = 0;
-  render_buffer_flushes = 0;
-  state_changes = 0;
-  trivial_rejects = 0;
-  left_split_triangles = 0;
-  flat_triangles = 0;
-  clipped_triangles = 0;
-  zero_block_spans = 0;
-  texture_cache_loads = 0;
-  false_modulated_blocks = 0;
+  memset(&psx_gpu->stats, 0, sizeof(psx_gpu->stats));
 }
 
 void update_screen(psx_gpu_struct *psx_gpu, SDL_Surface *screen)
@@ -207,7 +151,7 @@ int main(int argc, char *argv[])
 
   memcpy(psx_gpu->vram_ptr, state.vram, 1024 * 512 * 2);
 
-  clear_stats();
+  clear_stats(psx_gpu);
 
 #ifdef NEON_BUILD
   init_counter();
@@ -216,7 +160,7 @@ int main(int argc, char *argv[])
   gpu_parse(psx_gpu, list, size, NULL);
   flush_render_block_buffer(psx_gpu);
 
-  clear_stats();
+  clear_stats(psx_gpu);
 
 #ifdef NEON_BUILD
   u32 cycles = get_counter();
@@ -261,62 +205,65 @@ int main(int argc, char *argv[])
 #endif
 
 #if 0
+  psx_gpu_stats_struct *s = &psx_gpu->stats;
+
   printf("\n");
   printf("  %d pixels, %d pixel blocks, %d spans\n"
    "   (%lf pixels per block, %lf pixels per span),\n"
    "   %lf blocks per span (%lf per non-zero span), %lf overdraw)\n\n",
-   span_pixels, span_pixel_blocks, spans,
-   (double)span_pixels / span_pixel_blocks,
-   (double)span_pixels / spans,
-   (double)span_pixel_blocks / spans, 
-   (double)span_pixel_blocks / (spans - zero_block_spans),
-   (double)span_pixels / 
+   s->span_pixels, s->span_pixel_blocks, s->spans,
+   (double)s->span_pixels / s->span_pixel_blocks,
+   (double)s->span_pixels / s->spans,
+   (double)s->span_pixel_blocks / s->spans, 
+   (double)s->span_pixel_blocks / (s->spans - s->zero_block_spans),
+   (double)s->span_pixels / 
    ((psx_gpu->viewport_end_x - psx_gpu->viewport_start_x) * 
    (psx_gpu->viewport_end_y - psx_gpu->viewport_start_y)));
 
   printf("  %d triangles\n"
    "   (%d trivial rejects, %lf%% flat, %lf%% left split, %lf%% clipped)\n"
    "   (%lf pixels per triangle, %lf rows per triangle)\n\n",
-   triangles, trivial_rejects,
-   percent_of(flat_triangles, triangles),
-   percent_of(left_split_triangles, triangles),
-   percent_of(clipped_triangles, triangles),
-   (double)span_pixels / triangles,
-   (double)spans / triangles);
+   s->triangles, s->trivial_rejects,
+   percent_of(s->flat_triangles, s->triangles),
+   percent_of(s->left_split_triangles, s->triangles),
+   percent_of(s->clipped_triangles, s->triangles),
+   (double)s->span_pixels / s->triangles,
+   (double)s->spans / s->triangles);
 
   printf("  Block data:\n");
-  printf("   %7d 4bpp texel blocks  (%lf%%)\n", texel_blocks_4bpp,
-   percent_of(texel_blocks_4bpp, span_pixel_blocks));
-  printf("   %7d 8bpp texel blocks  (%lf%%)\n", texel_blocks_8bpp,
-   percent_of(texel_blocks_8bpp, span_pixel_blocks));
-  printf("   %7d 16bpp texel blocks (%lf%%)\n", texel_blocks_16bpp,
-   percent_of(texel_blocks_16bpp, span_pixel_blocks));
-  printf("   %7d untextured blocks  (%lf%%)\n", texel_blocks_untextured,
-   percent_of(texel_blocks_untextured, span_pixel_blocks));
-  printf("   %7d sprite blocks      (%lf%%)\n", sprite_blocks,  
-   percent_of(sprite_blocks, span_pixel_blocks));
-  printf("   %7d blended blocks     (%lf%%)\n", blend_blocks,
-   percent_of(blend_blocks, span_pixel_blocks));
-  printf("   %7d false-mod blocks   (%lf%%)\n", false_modulated_blocks,
-   percent_of(false_modulated_blocks, span_pixel_blocks));
+  printf("   %7d 4bpp texel blocks  (%lf%%)\n", s->texel_blocks_4bpp,
+   percent_of(s->texel_blocks_4bpp, s->span_pixel_blocks));
+  printf("   %7d 8bpp texel blocks  (%lf%%)\n", s->texel_blocks_8bpp,
+   percent_of(s->texel_blocks_8bpp, s->span_pixel_blocks));
+  printf("   %7d 16bpp texel blocks (%lf%%)\n", s->texel_blocks_16bpp,
+   percent_of(s->texel_blocks_16bpp, s->span_pixel_blocks));
+  printf("   %7d untextured blocks  (%lf%%)\n", s->texel_blocks_untextured,
+   percent_of(s->texel_blocks_untextured, s->span_pixel_blocks));
+  printf("   %7d sprite blocks      (%lf%%)\n", s->sprite_blocks,  
+   percent_of(s->sprite_blocks, s->span_pixel_blocks));
+  printf("   %7d blended blocks     (%lf%%)\n", s->blend_blocks,
+   percent_of(s->blend_blocks, s->span_pixel_blocks));
+  printf("   %7d false-mod blocks   (%lf%%)\n", s->false_modulated_blocks,
+   percent_of(s->false_modulated_blocks, s->span_pixel_blocks));
   printf("\n");
-  printf("  %lf blocks per render buffer flush\n", (double)span_pixel_blocks /
-   render_buffer_flushes);
-  printf("  %d zero block spans\n", zero_block_spans);
-  printf("  %d state changes, %d texture cache loads\n", state_changes,
-   texture_cache_loads);
-  if(sprites)
+  printf("  %lf blocks per render buffer flush\n",
+   (double)s->span_pixel_blocks / s->render_buffer_flushes);
+  printf("  %d zero block spans\n", s->zero_block_spans);
+  printf("  %d state changes, %d texture cache loads\n", s->state_changes,
+   s->texture_cache_loads);
+  if(s->sprites)
   {
     printf("  %d sprites\n"
      "    4bpp:       %lf%%\n"
      "    8bpp:       %lf%%\n"
      "    16bpp:      %lf%%\n"
      "    untextured: %lf%%\n",
-     sprites, percent_of(sprites_4bpp, sprites),
-     percent_of(sprites_8bpp, sprites), percent_of(sprites_16bpp, sprites),
-     percent_of(sprites_untextured, sprites));
+     s->sprites, percent_of(s->sprites_4bpp, s->sprites),
+     percent_of(s->sprites_8bpp, s->sprites),
+     percent_of(s->sprites_16bpp, s->sprites),
+     percent_of(s->sprites_untextured, s->sprites));
   }
-  printf("  %d lines\n", lines);
+  printf("  %d lines\n", s->lines);
   printf("\n");
   printf("  %d mismatches\n\n\n", mismatches);
 #endif
@@ -250,10 +250,9 @@ static void do_fill(psx_gpu_struct *psx_gpu, u32 x, u32 y,
 #define SET_Ex(r, v)
 #endif
 
-vertex_struct vertexes[4] __attribute__((aligned(32)));
-
 u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
 {
+  vertex_struct vertexes[4] __attribute__((aligned(32)));
   u32 current_command = 0, command_length;
 
   u32 *list_start = list;
@@ -619,6 +618,23 @@ u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
         if (sx == dx && sy == dy && psx_gpu->mask_msb == 0)
           break;
 
+        // band clipping, wrapping copies are never drawn in bands
+        if ((s32)dy < psx_gpu->band_start_y)
+        {
+          u32 clip = psx_gpu->band_start_y - dy;
+          if (clip >= h)
+            break;
+          sy += clip;
+          dy += clip;
+          h -= clip;
+        }
+        if ((s32)(dy + h) > psx_gpu->band_end_y + 1 && dy + h <= 512)
+        {
+          if ((s32)dy > psx_gpu->band_end_y)
+            break;
+          h = psx_gpu->band_end_y + 1 - dy;
+        }
+
         render_block_move(psx_gpu, sx, sy, dx, dy, w, h);
         break;
       } 
@@ -701,6 +717,10 @@ u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
         s16 viewport_start_x = list[0] & 0x3FF;
         s16 viewport_start_y = (list[0] >> 10) & 0x1FF;
 
+        SET_Ex(3, list[0]);
+        if(viewport_start_y < psx_gpu->band_start_y)
+          viewport_start_y = psx_gpu->band_start_y;
+
         if(viewport_start_x == psx_gpu->viewport_start_x &&
          viewport_start_y == psx_gpu->viewport_start_y)
         {
@@ -716,7 +736,6 @@ u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
          psx_gpu->viewport_start_y, psx_gpu->viewport_end_x,
          psx_gpu->viewport_end_y);
 #endif
-        SET_Ex(3, list[0]);
         break;
       }
 
@@ -725,6 +744,10 @@ u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
         s16 viewport_end_x = list[0] & 0x3FF;
         s16 viewport_end_y = (list[0] >> 10) & 0x1FF;
 
+        SET_Ex(4, list[0]);
+        if(viewport_end_y > psx_gpu->band_end_y)
+          viewport_end_y = psx_gpu->band_end_y;
+
         if(viewport_end_x == psx_gpu->viewport_end_x &&
          viewport_end_y == psx_gpu->viewport_end_y)
         {
@@ -740,7 +763,6 @@ u32 gpu_parse(psx_gpu_struct *psx_gpu, u32 *list, u32 size, u32 *last_command)
          psx_gpu->viewport_start_y, psx_gpu->viewport_end_x,
          psx_gpu->viewport_end_y);
 #endif
-        SET_Ex(4, list[0]);
         break;
       }
   
@@ -938,6 +960,9 @@ void scale2x_tiles8(void *dst, const void *src, int w8, int h)
 
 static int disable_main_render;
 
+#define main_render_enabled(psx_gpu) \
+  (!disable_main_render && !(psx_gpu)->enhancement_only)
+
 static void do_triangle_enhanced(psx_gpu_struct *psx_gpu,
  vertex_struct *vertexes, u32 current_command)
 {
@@ -946,7 +971,7 @@ static void do_triangle_enhanced(psx_gpu_struct *psx_gpu,
   if (!prepare_triangle(psx_gpu, vertexes, vertex_ptrs))
     return;
 
-  if (!disable_main_render)
+  if (main_render_enabled(psx_gpu))
     render_triangle_p(psx_gpu, vertex_ptrs, current_command);
 
   enhancement_enable();
@@ -961,7 +986,7 @@ static void do_quad_enhanced(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
   vertex_struct *vertex_ptrs[3];
 
   if (prepare_triangle(psx_gpu, vertexes, vertex_ptrs)) {
-    if (!disable_main_render)
+    if (main_render_enabled(psx_gpu))
       render_triangle_p(psx_gpu, vertex_ptrs, current_command);
 
     enhancement_enable();
@@ -972,7 +997,7 @@ static void do_quad_enhanced(psx_gpu_struct *psx_gpu, vertex_struct *vertexes,
   }
   enhancement_disable();
   if (prepare_triangle(psx_gpu, &vertexes[1], vertex_ptrs)) {
-    if (!disable_main_render)
+    if (main_render_enabled(psx_gpu))
       render_triangle_p(psx_gpu, vertex_ptrs, current_command);
 
     enhancement_enable();
@@ -1062,6 +1087,7 @@ static void do_sprite_enhanced(psx_gpu_struct *psx_gpu, int x, int y,
 u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
  u32 *last_command)
 {
+  vertex_struct vertexes[4] __attribute__((aligned(32)));
   u32 current_command = 0, command_length;
 
   u32 *list_start = list;
@@ -1101,7 +1127,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         x &= ~0xF;
         width = ((width + 0xF) & ~0xF);
 
-        do_fill(psx_gpu, x, y, width, height, color);
+        if (!psx_gpu->enhancement_only)
+          do_fill(psx_gpu, x, y, width, height, color);
 
         psx_gpu->vram_out_ptr = select_enhancement_buf_ptr(psx_gpu, x);
         x *= 2;
@@ -1230,7 +1257,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         vertexes[1].x = list_s16[4] + psx_gpu->offset_x;
         vertexes[1].y = list_s16[5] + psx_gpu->offset_y;
 
-        render_line(psx_gpu, vertexes, current_command, list[0], 0);
+        if (!psx_gpu->enhancement_only)
+          render_line(psx_gpu, vertexes, current_command, list[0], 0);
         enhancement_enable();
         render_line(psx_gpu, vertexes, current_command, list[0], 1);
         break;
@@ -1254,7 +1282,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
           vertexes[1].y = (xy >> 16) + psx_gpu->offset_y;
 
           enhancement_disable();
-          render_line(psx_gpu, vertexes, current_command, list[0], 0);
+          if (!psx_gpu->enhancement_only)
+            render_line(psx_gpu, vertexes, current_command, list[0], 0);
           enhancement_enable();
           render_line(psx_gpu, vertexes, current_command, list[0], 1);
 
@@ -1290,7 +1319,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         vertexes[1].x = list_s16[6] + psx_gpu->offset_x;
         vertexes[1].y = list_s16[7] + psx_gpu->offset_y;
 
-        render_line(psx_gpu, vertexes, current_command, 0, 0);
+        if (!psx_gpu->enhancement_only)
+          render_line(psx_gpu, vertexes, current_command, 0, 0);
         enhancement_enable();
         render_line(psx_gpu, vertexes, current_command, 0, 1);
         break;
@@ -1323,7 +1353,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
           vertexes[1].y = (xy >> 16) + psx_gpu->offset_y;
 
           enhancement_disable();
-          render_line(psx_gpu, vertexes, current_command, 0, 0);
+          if (!psx_gpu->enhancement_only)
+            render_line(psx_gpu, vertexes, current_command, 0, 0);
           enhancement_enable();
           render_line(psx_gpu, vertexes, current_command, 0, 1);
 
@@ -1352,7 +1383,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         u32 width = list_s16[4] & 0x3FF;
         u32 height = list_s16[5] & 0x1FF;
 
-        render_sprite(psx_gpu, x, y, 0, 0, width, height, current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, 0, 0, width, height, current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, 0, 0, width, height, list[0]);
         break;
       }
@@ -1368,8 +1400,9 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
 
         set_clut(psx_gpu, list_s16[5]);
 
-        render_sprite(psx_gpu, x, y, u, v, width, height,
-         current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, u, v, width, height,
+           current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, u, v, width, height, list[0]);
         break;
       }
@@ -1382,7 +1415,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         s32 x = sign_extend_11bit(list_s16[2] + psx_gpu->offset_x);
         s32 y = sign_extend_11bit(list_s16[3] + psx_gpu->offset_y);
 
-        render_sprite(psx_gpu, x, y, 0, 0, 1, 1, current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, 0, 0, 1, 1, current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, 0, 0, 1, 1, list[0]);
         break;
       }
@@ -1395,7 +1429,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         s32 x = sign_extend_11bit(list_s16[2] + psx_gpu->offset_x);
         s32 y = sign_extend_11bit(list_s16[3] + psx_gpu->offset_y);
 
-        render_sprite(psx_gpu, x, y, 0, 0, 8, 8, current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, 0, 0, 8, 8, current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, 0, 0, 8, 8, list[0]);
         break;
       }
@@ -1412,8 +1447,9 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
 
         set_clut(psx_gpu, list_s16[5]);
 
-        render_sprite(psx_gpu, x, y, u, v, 8, 8,
-         current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, u, v, 8, 8,
+           current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, u, v, 8, 8, list[0]);
         break;
       }
@@ -1426,7 +1462,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         s32 x = sign_extend_11bit(list_s16[2] + psx_gpu->offset_x);
         s32 y = sign_extend_11bit(list_s16[3] + psx_gpu->offset_y);
 
-        render_sprite(psx_gpu, x, y, 0, 0, 16, 16, current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, 0, 0, 16, 16, current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, 0, 0, 16, 16, list[0]);
         break;
       }
@@ -1443,7 +1480,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
 
         set_clut(psx_gpu, list_s16[5]);
 
-        render_sprite(psx_gpu, x, y, u, v, 16, 16, current_command, list[0]);
+        if (!psx_gpu->enhancement_only)
+          render_sprite(psx_gpu, x, y, u, v, 16, 16, current_command, list[0]);
         do_sprite_enhanced(psx_gpu, x, y, u, v, 16, 16, list[0]);
         break;
       }
@@ -1461,7 +1499,8 @@ u32 gpu_parse_enhanced(psx_gpu_struct *psx_gpu, u32 *list, u32 size,
         if (sx == dx && sy == dy && psx_gpu->mask_msb == 0)
           break;
 
-        render_block_move(psx_gpu, sx, sy, dx, dy, w, h);
+        if (!psx_gpu->enhancement_only)
+          render_block_move(psx_gpu, sx, sy, dx, dy, w, h);
         if (dy + h > 512)
           h = 512 - dy;
         sx = sx & ~7; // FIXME?
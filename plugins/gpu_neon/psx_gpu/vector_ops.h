@@ -603,4 +603,8 @@ build_vector_types(s);
   foreach_element(4, dest.e[_i] = ((source).e[_i] & mask.e[_i]) |              \
    ((dest).e[_i] & ~(mask.e[_i])))                                             \
 
+#if defined(__SSE2__) && !defined(NEON_BUILD)
+#include "vector_ops_sse2.h"
+#endif
+
 #endif
@@ -0,0 +1,427 @@
+/*
+ * SSE2 versions of the vector_ops.h operations used by the block
+ * pipeline, for x86 builds without the NEON assembly.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ */
+
+#ifndef VECTOR_OPS_SSE2
+#define VECTOR_OPS_SSE2
+
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+// Vectors stay the plain structs from vector_ops.h, each operation loads
+// its operands into xmm registers and stores the result back, as a block
+// statement like the generic ones. 64bit vectors use the low half of a
+// register. Results must match the generic versions bit for bit; where
+// those depend on the element signedness both cases are handled (the
+// type check is a constant, so it folds away).
+
+// Operands must be of the size and element size the operation name says,
+// which the generic versions don't enforce. A mismatch fails to compile.
+#define sse_check(vector, size, element_size)                                  \
+  (void)sizeof(char[(sizeof(vector) == (size) && ((element_size) == 0 ||       \
+   sizeof((vector).e[0]) == (element_size))) ? 1 : -1])                        \
+
+#define sse_load_64b(source, element_size)                                     \
+  (sse_check(source, 8, element_size),                                         \
+   _mm_loadl_epi64((const __m128i *)(source).e))                               \
+
+#define sse_load_128b(source, element_size)                                    \
+  (sse_check(source, 16, element_size),                                        \
+   _mm_loadu_si128((const __m128i *)(source).e))                               \
+
+#define sse_store_64b(dest, element_size, value)                               \
+{                                                                              \
+  sse_check(dest, 8, element_size);                                            \
+  _mm_storel_epi64((__m128i *)(dest).e, value);                                \
+}                                                                              \
+
+#define sse_store_128b(dest, element_size, value)                              \
+{                                                                              \
+  sse_check(dest, 16, element_size);                                           \
+  _mm_storeu_si128((__m128i *)(dest).e, value);                                \
+}                                                                              \
+
+#define sse_is_signed(vector)                                                  \
+  ((__typeof__((vector).e[0]))-1 < 0)                                          \
+
+#define sse_op_64b(dest, source_a, source_b, element_size, op)                 \
+  sse_store_64b(dest, element_size, op(sse_load_64b(source_a, element_size),   \
+   sse_load_64b(source_b, element_size)))                                      \
+
+#define sse_op_128b(dest, source_a, source_b, element_size, op)                \
+  sse_store_128b(dest, element_size, op(sse_load_128b(source_a,                \
+   element_size), sse_load_128b(source_b, element_size)))                      \
+
+// 8 bit elements to 16 bit, as the element type says
+#define sse_widen_8x8b(source)                                                 \
+  (sse_is_signed(source) ?                                                     \
+   _mm_srai_epi16(_mm_unpacklo_epi8(_mm_setzero_si128(),                       \
+    sse_load_64b(source, 1)), 8) :                                             \
+   _mm_unpacklo_epi8(sse_load_64b(source, 1), _mm_setzero_si128()))            \
+
+// keep the low 16 bits of each 32 bit element
+static inline __m128i sse_narrow_4x32b(__m128i value)
+{
+  value = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+  return _mm_packs_epi32(value, value);
+}
+
+// keep the low 8 bits of each 16 bit element
+static inline __m128i sse_narrow_8x16b(__m128i value)
+{
+  value = _mm_and_si128(value, _mm_set1_epi16(0xFF));
+  return _mm_packus_epi16(value, value);
+}
+
+
+#undef load_8x16b
+#define load_8x16b(dest, source)                                               \
+  sse_store_128b(dest, 2, _mm_loadu_si128((const __m128i *)(source)))          \
+
+#undef store_8x16b
+#define store_8x16b(source, dest)                                              \
+  { _mm_storeu_si128((__m128i *)(dest), sse_load_128b(source, 2)); }           \
+
+
+#undef dup_8x8b
+#define dup_8x8b(dest, value)                                                  \
+  sse_store_64b(dest, 1, _mm_set1_epi8((char)(value)))                         \
+
+#undef dup_16x8b
+#define dup_16x8b(dest, value)                                                 \
+  sse_store_128b(dest, 1, _mm_set1_epi8((char)(value)))                        \
+
+#undef dup_4x16b
+#define dup_4x16b(dest, value)                                                 \
+  sse_store_64b(dest, 2, _mm_set1_epi16((short)(value)))                       \
+
+#undef dup_8x16b
+#define dup_8x16b(dest, value)                                                 \
+  sse_store_128b(dest, 2, _mm_set1_epi16((short)(value)))                      \
+
+#undef dup_2x32b
+#define dup_2x32b(dest, value)                                                 \
+  sse_store_64b(dest, 4, _mm_set1_epi32((int)(value)))                         \
+
+#undef dup_4x32b
+#define dup_4x32b(dest, value)                                                 \
+  sse_store_128b(dest, 4, _mm_set1_epi32((int)(value)))                        \
+
+
+#undef and_8x8b
+#define and_8x8b(dest, source_a, source_b)                                     \
+  sse_op_64b(dest, source_a, source_b, 1, _mm_and_si128)                       \
+
+#undef and_4x16b
+#define and_4x16b(dest, source_a, source_b)                                    \
+  sse_op_64b(dest, source_a, source_b, 2, _mm_and_si128)                       \
+
+#undef and_16x8b
+#define and_16x8b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 1, _mm_and_si128)                      \
+
+#undef and_8x16b
+#define and_8x16b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 2, _mm_and_si128)                      \
+
+#undef and_4x32b
+#define and_4x32b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 4, _mm_and_si128)                      \
+
+#undef or_8x16b
+#define or_8x16b(dest, source_a, source_b)                                     \
+  sse_op_128b(dest, source_a, source_b, 2, _mm_or_si128)                       \
+
+#undef or_immediate_8x16b
+#define or_immediate_8x16b(dest, source_a, value)                              \
+  sse_store_128b(dest, 2, _mm_or_si128(sse_load_128b(source_a, 2),             \
+   _mm_set1_epi16((short)(value))))                                            \
+
+#undef eor_8x16b
+#define eor_8x16b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 2, _mm_xor_si128)                      \
+
+#undef eor_4x32b
+#define eor_4x32b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 4, _mm_xor_si128)                      \
+
+#undef bic_8x8b
+#define bic_8x8b(dest, source_a, source_b)                                     \
+  sse_store_64b(dest, 1, _mm_andnot_si128(sse_load_64b(source_b, 1),           \
+   sse_load_64b(source_a, 1)))                                                 \
+
+#undef bic_8x16b
+#define bic_8x16b(dest, source_a, source_b)                                    \
+  sse_store_128b(dest, 2, _mm_andnot_si128(sse_load_128b(source_b, 2),         \
+   sse_load_128b(source_a, 2)))                                                \
+
+#undef bic_immediate_8x16b
+#define bic_immediate_8x16b(dest, value)                                       \
+  sse_store_128b(dest, 2, _mm_andnot_si128(_mm_set1_epi16((short)(value)),     \
+   sse_load_128b(dest, 2)))                                                    \
+
+#undef bif_8x16b
+#define bif_8x16b(dest, source, mask)                                          \
+{                                                                              \
+  __m128i _mask = sse_load_128b(mask, 2);                                      \
+  sse_store_128b(dest, 2, _mm_or_si128(                                        \
+   _mm_andnot_si128(_mask, sse_load_128b(source, 2)),                          \
+   _mm_and_si128(sse_load_128b(dest, 2), _mask)));                             \
+}                                                                              \
+
+
+#undef add_8x8b
+#define add_8x8b(dest, source_a, source_b)                                     \
+  sse_op_64b(dest, source_a, source_b, 1, _mm_add_epi8)                        \
+
+#undef add_16x8b
+#define add_16x8b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 1, _mm_add_epi8)                       \
+
+#undef add_4x16b
+#define add_4x16b(dest, source_a, source_b)                                    \
+  sse_op_64b(dest, source_a, source_b, 2, _mm_add_epi16)                       \
+
+#undef sub_4x16b
+#define sub_4x16b(dest, source_a, source_b)                                    \
+  sse_op_64b(dest, source_a, source_b, 2, _mm_sub_epi16)                       \
+
+#undef add_8x16b
+#define add_8x16b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 2, _mm_add_epi16)                      \
+
+#undef sub_8x16b
+#define sub_8x16b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 2, _mm_sub_epi16)                      \
+
+#undef add_4x32b
+#define add_4x32b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 4, _mm_add_epi32)                      \
+
+#undef sub_4x32b
+#define sub_4x32b(dest, source_a, source_b)                                    \
+  sse_op_128b(dest, source_a, source_b, 4, _mm_sub_epi32)                      \
+
+#undef subs_16x8b
+#define subs_16x8b(dest, source_a, source_b)                                   \
+{                                                                              \
+  sse_check(dest, 16, 1);                                                      \
+  if(sse_is_signed(source_a) || sse_is_signed(source_b))                       \
+  {                                                                            \
+    foreach_element(16,                                                        \
+    {                                                                          \
+      u32 result = (source_a).e[_i] - (source_b).e[_i];                        \
+      if(result > 0xFF)                                                        \
+        result = 0;                                                            \
+      (dest).e[_i] = result;                                                   \
+    })                                                                         \
+  }                                                                            \
+  else                                                                         \
+  {                                                                            \
+    sse_op_128b(dest, source_a, source_b, 1, _mm_subs_epu8);                   \
+  }                                                                            \
+}                                                                              \
+
+#undef subs_8x16b
+#define subs_8x16b(dest, source_a, source_b)                                   \
+{                                                                              \
+  sse_check(dest, 16, 2);                                                      \
+  if(sse_is_signed(source_a) || sse_is_signed(source_b))                       \
+  {                                                                            \
+    foreach_element(8,                                                         \
+    {                                                                          \
+      s32 result = (source_a).e[_i] - (source_b).e[_i];                        \
+      if(result < 0)                                                           \
+        result = 0;                                                            \
+                                                                               \
+      (dest).e[_i] = result;                                                   \
+    })                                                                         \
+  }                                                                            \
+  else                                                                         \
+  {                                                                            \
+    sse_op_128b(dest, source_a, source_b, 2, _mm_subs_epu16);                  \
+  }                                                                            \
+}                                                                              \
+
+#undef min_16x8b
+#define min_16x8b(dest, source_a, source_b)                                    \
+{                                                                              \
+  sse_check(dest, 16, 1);                                                      \
+  if(sse_is_signed(source_a) || sse_is_signed(source_b))                       \
+  {                                                                            \
+    foreach_element(16,                                                        \
+    {                                                                          \
+      u32 result = (source_a).e[_i];                                           \
+      if((source_b).e[_i] < result)                                            \
+        result = (source_b).e[_i];                                             \
+      (dest).e[_i] = result;                                                   \
+    })                                                                         \
+  }                                                                            \
+  else                                                                         \
+  {                                                                            \
+    sse_op_128b(dest, source_a, source_b, 1, _mm_min_epu8);                    \
+  }                                                                            \
+}                                                                              \
+
+// a signed and an unsigned operand compare as ints in the generic version
+#define sse_minmax_8x16b(dest, source_a, source_b, op_signed, op_unsigned)     \
+{                                                                              \
+  __m128i _a = sse_load_128b(source_a, 2);                                     \
+  __m128i _b = sse_load_128b(source_b, 2);                                     \
+  sse_check(dest, 16, 2);                                                      \
+  if(sse_is_signed(source_a) != sse_is_signed(source_b))                       \
+  {                                                                            \
+    foreach_element(8,                                                         \
+    {                                                                          \
+      s32 result = (source_a).e[_i];                                           \
+      if(op_signed((source_b).e[_i], result))                                  \
+        result = (source_b).e[_i];                                             \
+      (dest).e[_i] = result;                                                   \
+    })                                                                         \
+  }                                                                            \
+  else if(sse_is_signed(source_a))                                             \
+  {                                                                            \
+    sse_store_128b(dest, 2, op_unsigned##_signed(_a, _b));                     \
+  }                                                                            \
+  else                                                                         \
+  {                                                                            \
+    sse_store_128b(dest, 2, op_unsigned(_a, _b));                              \
+  }                                                                            \
+}                                                                              \
+
+#define sse_lt(a, b) ((a) < (b))
+#define sse_gt(a, b) ((a) > (b))
+#define sse_min_epu16(a, b) _mm_sub_epi16(a, _mm_subs_epu16(a, b))
+#define sse_max_epu16(a, b) _mm_add_epi16(b, _mm_subs_epu16(a, b))
+#define sse_min_epu16_signed(a, b) _mm_min_epi16(a, b)
+#define sse_max_epu16_signed(a, b) _mm_max_epi16(a, b)
+
+#undef min_8x16b
+#define min_8x16b(dest, source_a, source_b)                                    \
+  sse_minmax_8x16b(dest, source_a, source_b, sse_lt, sse_min_epu16)            \
+
+#undef max_8x16b
+#define max_8x16b(dest, source_a, source_b)                                    \
+  sse_minmax_8x16b(dest, source_a, source_b, sse_gt, sse_max_epu16)            \
+
+// (a + b) >> 1 without the rounding pavgw does
+#undef average_8x16b
+#define average_8x16b(dest, source_a, source_b)                                \
+{                                                                              \
+  __m128i _a = sse_load_128b(source_a, 2);                                     \
+  __m128i _b = sse_load_128b(source_b, 2);                                     \
+  __m128i _half = _mm_xor_si128(_a, _b);                                       \
+  _half = sse_is_signed(source_a) ? _mm_srai_epi16(_half, 1) :                 \
+   _mm_srli_epi16(_half, 1);                                                   \
+  sse_store_128b(dest, 2, _mm_add_epi16(_mm_and_si128(_a, _b), _half));        \
+}                                                                              \
+
+
+#undef tst_8x16b
+#define tst_8x16b(dest, source_a, source_b)                                    \
+  sse_store_128b(dest, 2, _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(      \
+   sse_load_128b(source_a, 2), sse_load_128b(source_b, 2)),                    \
+   _mm_setzero_si128()), _mm_set1_epi32(-1)))                                  \
+
+#undef cmpeqz_8x16b
+#define cmpeqz_8x16b(dest, source)                                             \
+  sse_store_128b(dest, 2, _mm_cmpeq_epi16(sse_load_128b(source, 2),            \
+   _mm_setzero_si128()))                                                       \
+
+#undef cmpltz_8x16b
+#define cmpltz_8x16b(dest, source)                                             \
+  sse_store_128b(dest, 2, _mm_srai_epi16(sse_load_128b(source, 2), 15))        \
+
+
+#undef shr_8x8b
+#define shr_8x8b(dest, source, shift)                                          \
+  sse_store_64b(dest, 1, _mm_and_si128(_mm_srli_epi16(                         \
+   sse_load_64b(source, 1), shift), _mm_set1_epi8((char)(0xFF >> (shift)))))   \
+
+#undef shr_8x16b
+#define shr_8x16b(dest, source, shift)                                         \
+  sse_store_128b(dest, 2, _mm_srli_epi16(sse_load_128b(source, 2), shift))     \
+
+#undef mov_narrow_8x16b
+#define mov_narrow_8x16b(dest, source)                                         \
+  sse_store_64b(dest, 1, sse_narrow_8x16b(sse_load_128b(source, 2)))           \
+
+#undef shr_narrow_8x16b
+#define shr_narrow_8x16b(dest, source, shift)                                  \
+  sse_store_64b(dest, 1, sse_narrow_8x16b(                                     \
+   _mm_srli_epi16(sse_load_128b(source, 2), shift)))                           \
+
+#undef shrq_narrow_signed_8x16b
+#define shrq_narrow_signed_8x16b(dest, source, shift)                          \
+{                                                                              \
+  __m128i _value = _mm_srai_epi16(sse_load_128b(source, 2), shift);            \
+  sse_store_64b(dest, 1, _mm_packus_epi16(_value, _value));                    \
+}                                                                              \
+
+#undef mov_narrow_4x32b
+#define mov_narrow_4x32b(dest, source)                                         \
+  sse_store_64b(dest, 2, sse_narrow_4x32b(sse_load_128b(source, 4)))           \
+
+#undef shr_narrow_4x32b
+#define shr_narrow_4x32b(dest, source, shift)                                  \
+  sse_store_64b(dest, 2, sse_narrow_4x32b(                                     \
+   _mm_srli_epi32(sse_load_128b(source, 4), shift)))                           \
+
+#undef add_high_narrow_4x32b
+#define add_high_narrow_4x32b(dest, source_a, source_b)                        \
+  sse_store_64b(dest, 2, sse_narrow_4x32b(_mm_srli_epi32(_mm_add_epi32(        \
+   sse_load_128b(source_a, 4), sse_load_128b(source_b, 4)), 16)))              \
+
+#undef shl_long_8x8b
+#define shl_long_8x8b(dest, source, shift)                                     \
+  sse_store_128b(dest, 2, _mm_slli_epi16(sse_widen_8x8b(source), shift))       \
+
+#undef mul_long_8x8b
+#define mul_long_8x8b(dest, source_a, source_b)                                \
+  sse_store_128b(dest, 2, _mm_mullo_epi16(sse_widen_8x8b(source_a),            \
+   sse_widen_8x8b(source_b)))                                                  \
+
+#undef mla_long_8x8b
+#define mla_long_8x8b(dest, source_a, source_b)                                \
+  sse_store_128b(dest, 2, _mm_add_epi16(sse_load_128b(dest, 2),                \
+   _mm_mullo_epi16(sse_widen_8x8b(source_a), sse_widen_8x8b(source_b))))       \
+
+
+#undef zip_8x16b
+#define zip_8x16b(dest, source_a, source_b)                                    \
+  sse_store_128b(dest, 2, _mm_unpacklo_epi8(sse_load_64b(source_a, 1),         \
+   sse_load_64b(source_b, 1)))                                                 \
+
+#undef zip_4x32b
+#define zip_4x32b(dest, source_a, source_b)                                    \
+  sse_store_128b(dest, 4, _mm_unpacklo_epi16(sse_load_64b(source_a, 2),        \
+   sse_load_64b(source_b, 2)))                                                 \
+
+#ifdef __SSSE3__
+
+// pshufb only zeroes for indexes with bit 7 set, extend that to >= 16
+#undef tbl_16
+#define tbl_16(dest, indexes, table)                                           \
+{                                                                              \
+  __m128i _indexes = sse_load_64b(indexes, 1);                                 \
+  _indexes = _mm_or_si128(_indexes,                                            \
+   _mm_cmpgt_epi8(_indexes, _mm_set1_epi8(15)));                               \
+  sse_store_64b(dest, 1, _mm_shuffle_epi8(sse_load_128b(table, 1), _indexes)); \
+}                                                                              \
+
+#endif
+
+#endif
@@ -9,6 +9,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
 
 #ifdef _WIN32
 #include <mman.h>
@@ -23,15 +25,17 @@ static unsigned int *ex_regs;
 static int initialized;
 
 #define PCSX
+// only the main instance, band instances don't own any gpulib state
 #define SET_Ex(r, v) \
-  ex_regs[r] = v
+  if (psx_gpu == &egpu) ex_regs[r] = v
 
 #include "psx_gpu/psx_gpu.c"
-#include "psx_gpu/psx_gpu_parse.c"
-#include "../gpulib/gpu.h"
 
 static psx_gpu_struct egpu __attribute__((aligned(256)));
 
+#include "psx_gpu/psx_gpu_parse.c"
+#include "../gpulib/gpu.h"
+
 int do_cmd_list(uint32_t *list, int count, int *last_cmd)
 {
   int ret;
@@ -77,6 +81,171 @@ static void map_enhancement_buffer(void)
   }
 }
 
+/*
+ * Band-parallel drawing (gpulib calls these, see gpu.h). Band 0 is
+ * drawn by egpu itself on the calling thread, the others by extra
+ * instances with their own texture caches. Whatever an instance draws
+ * to is marked dirty in the caches of all the others when collected.
+ *
+ * With enhancement there are just two bands, split by pass instead of
+ * lines: egpu draws the native copy while band 1 draws the scaled one.
+ * gpulib only hands over segments that don't draw what they read, so
+ * neither pass can see the other's output early.
+ */
+static psx_gpu_struct *band_gpu[GPU_BANDS_MAX];
+static void *band_gpu_mem[GPU_BANDS_MAX];
+static int band_passes;
+
+static void band_collect(psx_gpu_struct *from)
+{
+  u32 mask = from->band_drawn_mask;
+  psx_gpu_struct *p;
+  int i;
+
+  if (mask == 0)
+    return;
+  from->band_drawn_mask = 0;
+
+  for (i = 0; i < GPU_BANDS_MAX; i++) {
+    p = i ? band_gpu[i] : &egpu;
+    if (p == NULL || p == from)
+      continue;
+    invalidate_texture_cache_pages(p, mask);
+  }
+}
+
+static psx_gpu_struct *band_gpu_alloc(int band)
+{
+  psx_gpu_struct *p;
+  void *mem;
+
+  mem = malloc(sizeof(*p) + 255);
+  if (mem == NULL)
+    return NULL;
+  p = (psx_gpu_struct *)(((uintptr_t)mem + 255) & ~(uintptr_t)255);
+
+  // not initialize_psx_gpu(), that clears vram; the drawing state is
+  // synced before each use anyway
+  flush_render_block_buffer(&egpu);
+  memcpy(p, &egpu, offsetof(psx_gpu_struct, blocks));
+  p->num_blocks = 0;
+  invalidate_texture_cache_pages(p, 0xFFFFFFFF);
+  pending_drawn_reset(p);
+  p->enhancement_buf_ptr = NULL;
+  p->enhancement_current_buf_ptr = NULL;
+  p->band_drawn_mask = 0;
+  memset(&p->stats, 0, sizeof(p->stats));
+  p->stats_time_class = STATS_TIME_NONE;
+  update_texture_ptr(p);
+
+  band_gpu_mem[band] = mem;
+  band_gpu[band] = p;
+  return p;
+}
+
+static void band_gpu_free(void)
+{
+  int i;
+
+  for (i = 1; i < GPU_BANDS_MAX; i++) {
+    free(band_gpu_mem[i]);
+    band_gpu_mem[i] = NULL;
+    band_gpu[i] = NULL;
+  }
+}
+
+static int band_begin(int count)
+{
+  psx_gpu_struct *p;
+  int i;
+
+  // interlaced line skipping isn't split, and without the main pass
+  // there's nothing to draw alongside the scaled one
+  band_passes = gpu.state.enhancement_active;
+  if ((egpu.render_mode & RENDER_INTERLACE_ENABLED)
+      || (band_passes && disable_main_render))
+    return 0;
+  if (band_passes)
+    count = 2;
+
+  for (i = 1; i < count; i++) {
+    p = band_gpu[i];
+    if (p == NULL && (p = band_gpu_alloc(i)) == NULL)
+      return 0;
+    memcpy(p->dither_table, egpu.dither_table, sizeof(p->dither_table));
+    p->use_dithering = egpu.use_dithering;
+    p->render_mode = egpu.render_mode;
+    p->stats_timing = egpu.stats_timing;
+  }
+
+  p = band_gpu[1];
+  p->enhancement_only = band_passes;
+  if (band_passes) {
+    p->enhancement_buf_ptr = egpu.enhancement_buf_ptr;
+    p->enhancement_x_threshold = egpu.enhancement_x_threshold;
+    memcpy(p->enhancement_buf_by_x16, egpu.enhancement_buf_by_x16,
+      sizeof(p->enhancement_buf_by_x16));
+  }
+
+  // blocks still queued from before are older than anything the other
+  // bands draw, so they must land first
+  flush_render_block_buffer(&egpu);
+
+  // pass on what was drawn without bands
+  band_collect(&egpu);
+  return count;
+}
+
+static void band_draw(int band, uint32_t *list, int count,
+ const uint32_t *ecmds, int y0, int y1)
+{
+  psx_gpu_struct *p = band ? band_gpu[band] : &egpu;
+  u32 cmd;
+
+  if (band_passes) {
+    y0 = 0;
+    y1 = 512;
+  }
+  p->band_start_y = y0;
+  p->band_end_y = y1 - 1;
+  if (band)
+    gpu_parse(p, (u32 *)ecmds + 1, 6 * 4, NULL);
+  else if (!band_passes)
+    gpu_parse(p, (u32 *)ecmds + 3, 2 * 4, NULL); // reclip drawing area
+
+  if (band_passes && band)
+    gpu_parse_enhanced(p, list, count * 4, &cmd);
+  else
+    gpu_parse(p, list, count * 4, &cmd);
+
+  if (band)
+    flush_render_block_buffer(p);
+  else {
+    ex_regs[1] &= ~0x1ff;
+    ex_regs[1] |= egpu.texture_settings & 0x1ff;
+  }
+}
+
+static void band_end(int count)
+{
+  int i;
+
+  flush_render_block_buffer(&egpu);
+  if (band_passes) {
+    // the scaled pass keeps track of which buffer each x goes to
+    memcpy(egpu.enhancement_buf_by_x16, band_gpu[1]->enhancement_buf_by_x16,
+      sizeof(egpu.enhancement_buf_by_x16));
+  }
+  else {
+    egpu.band_start_y = 0;
+    egpu.band_end_y = 511;
+    gpu_parse(&egpu, ex_regs + 3, 2 * 4, NULL);
+  }
+
+  for (i = 0; i < count; i++)
+    band_collect(i ? band_gpu[i] : &egpu);
+}
+
 int renderer_init(void)
 {
   if (gpu.vram != NULL) {
@@ -88,6 +257,9 @@ int renderer_init(void)
     map_enhancement_buffer();
 
   ex_regs = gpu.ex_regs;
+  gpu.band_begin = band_begin;
+  gpu.band_draw = band_draw;
+  gpu.band_end = band_end;
   return 0;
 }
 
@@ -99,6 +271,11 @@ void renderer_finish(void)
   }
   egpu.enhancement_buf_ptr = NULL;
   egpu.enhancement_current_buf_ptr = NULL;
+  band_gpu_free();
+  gpu.band_begin = NULL;
+  gpu.band_draw = NULL;
+  gpu.band_end = NULL;
+  gpu.frame_end = NULL;
   initialized = 0;
 }
 
@@ -137,7 +314,11 @@ void renderer_sync_ecmds(uint32_t *ecmds)
 
 void renderer_update_caches(int x, int y, int w, int h)
 {
+  int i;
+
   update_texture_cache_region(&egpu, x, y, x + w - 1, y + h - 1);
+  for (i = 1; i < GPU_BANDS_MAX && band_gpu[i] != NULL; i++)
+    update_texture_cache_region(band_gpu[i], x, y, x + w - 1, y + h - 1);
   if (gpu.state.enhancement_active && !gpu.status.rgb24)
     sync_enhancement_buffers(x, y, w, h);
 }
@@ -168,6 +349,40 @@ void renderer_notify_res_change(void)
 
 #include "../../frontend/plugin_lib.h"
 
+static void (*stats_cb)(const struct gpu_neon_stats *s);
+
+static void stats_frame_end(void)
+{
+  struct gpu_neon_stats s;
+  psx_gpu_stats_struct *st;
+  int i;
+
+  memset(&s, 0, sizeof(s));
+  for (i = 0; i < GPU_BANDS_MAX; i++) {
+    if (i && band_gpu[i] == NULL)
+      continue;
+    st = i ? &band_gpu[i]->stats : &egpu.stats;
+    s.triangles += st->triangles;
+    s.sprites += st->sprites;
+    s.lines += st->lines;
+    s.trivial_rejects += st->trivial_rejects;
+    s.span_pixels += st->span_pixels;
+    s.render_buffer_flushes += st->render_buffer_flushes;
+    s.state_changes += st->state_changes;
+    s.texture_cache_loads += st->texture_cache_loads;
+    s.texture_cache_bytes += st->texture_cache_bytes;
+    s.us_triangles += st->time_ns[STATS_TIME_TRIANGLE] / 1000;
+    s.us_sprites += st->time_ns[STATS_TIME_SPRITE] / 1000;
+    s.us_lines += st->time_ns[STATS_TIME_LINE] / 1000;
+    s.us_fill_copy += st->time_ns[STATS_TIME_FILL_COPY] / 1000;
+    s.us_texture_cache += st->time_ns[STATS_TIME_TEXTURE_CACHE] / 1000;
+    memset(st, 0, sizeof(*st));
+  }
+
+  if (stats_cb)
+    stats_cb(&s);
+}
+
 void renderer_set_config(const struct rearmed_cbs *cbs)
 {
   static int enhancement_was_on;
@@ -185,6 +400,10 @@ void renderer_set_config(const struct rearmed_cbs *cbs)
     initialized = 1;
   }
 
+  stats_cb = cbs->gpu_neon.stats;
+  egpu.stats_timing = stats_cb != NULL;
+  gpu.frame_end = stats_cb ? stats_frame_end : NULL;
+
   if (gpu.mmap != NULL && egpu.enhancement_buf_ptr == NULL)
     map_enhancement_buffer();
   if (cbs->pl_set_gpu_caps)
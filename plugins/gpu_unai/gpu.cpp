@@ -47,6 +47,10 @@
 //u16   GPU_FrameBuffer[(FRAME_BUFFER_SIZE+512*1024)/2] __attribute__((aligned(32)));
 static u16 GPU_FrameBuffer[(FRAME_BUFFER_SIZE*2 + 4096)/2] __attribute__((aligned(32)));
 
+///////////////////////////////////////////////////////////////////////////////
+// Per-primitive profiling hooks
+#include "profiler.h"
+
 ///////////////////////////////////////////////////////////////////////////////
 // GPU fixed point math
 #include "gpu_fixedpoint.h"
@@ -46,6 +46,9 @@ struct gpu_unai_config_t {
 	uint8_t fast_lighting:1;
 	uint8_t blending:1;
 	uint8_t dithering:1;
+	uint8_t jit:1;            // If 1, and built with GPU_UNAI_JIT, span
+	                          //  functions are compiled at runtime
+	                          //  (gpu_inner_jit.h).
 
 	//senquack Only PCSX Rearmed's version of gpu_unai had this, and I
 	// don't think it's necessary. It would require adding 'AH' flag to
@@ -73,6 +73,12 @@
 #define MSB_PRESERVED 0
 #endif
 
+// x86: most of each span is drawn 8 pixels at a time
+#if defined(__SSE2__) && !defined(GPU_UNAI_NO_SSE2)
+#define GPU_UNAI_USE_SSE2
+#include "gpu_inner_sse2.h"
+#endif
+
 
 // If defined, Gouraud colors are fixed-point 5.11, otherwise they are 8.16
 // This is only for debugging/verification of low-precision colors in C.
@@ -148,7 +154,17 @@ static u8* gpuPixelSpanFn(u8* pDst, uintptr_t data, ptrdiff_t incr, size_t len)
 		col = (u16)data;
 	}
 
+#ifdef GPU_UNAI_BANDS
+	// Lines are only clipped to the band here, pixel by pixel, so that
+	//  they come out the same however the drawing is split up
+	const uintptr_t band_start = (uintptr_t)&gpu_unai.vram[FRAME_OFFSET(0, gpu_unai.BandLines[0])];
+	const uintptr_t band_size = (uintptr_t)(gpu_unai.BandLines[1] - gpu_unai.BandLines[0]) * FRAME_BYTE_STRIDE;
+#endif
+
 	do {
+#ifdef GPU_UNAI_BANDS
+		if ((uintptr_t)pDst - band_start >= band_size) goto endpixel;
+#endif
 		if (!CF_GOURAUD)
 		{   // NO GOURAUD
 			if (!CF_MASKCHECK && !CF_BLEND) {
@@ -284,6 +300,15 @@ const PSD gpuPixelSpanDrivers[64] =
 template<int CF>
 static void gpuTileSpanFn(u16 *pDst, u32 count, u16 data)
 {
+#ifdef GPU_UNAI_USE_SSE2
+	{
+		const __m128i c = _mm_set1_epi16(data);
+		for (; count >= 8; count -= 8, pDst += 8)
+			gpuPixelsSSE2<CF>(pDst, c, c, c, c);
+		if (!count) return;
+	}
+#endif
+
 	if (!CF_MASKCHECK && !CF_BLEND) {
 		if (CF_MASKSET) { data = data | 0x8000; }
 		do { *pDst++ = data; } while (--count);
@@ -380,6 +405,29 @@ static void gpuSpriteSpanFn(u16 *pDst, u32 count, u8* pTxt, u32 u0)
 
 	const u16 *CBA_; if (CF_TEXTMODE!=3) CBA_ = gpu_unai.CBA;
 
+#ifdef GPU_UNAI_USE_SSE2
+	if (count >= 8 && !gpuSpanOverlapsTextureSSE2<CF_TEXTMODE>(pDst, count, gpu_unai.TBA, CBA_))
+	{
+		__m128i lr = _mm_setzero_si128(), lg = lr, lb = lr;
+		if (CF_LIGHT) {
+			lr = _mm_set1_epi16(r5);
+			lg = _mm_set1_epi16(g5);
+			lb = _mm_set1_epi16(b5);
+		}
+		do {
+			u16 tex[8];
+			for (int i = 0; i < 8; i++) {
+				tex[i] = gpuSpriteTexelSSE2<CF_TEXTMODE>(pTxt, CBA_, u0, u0_mask);
+				u0 += (CF_TEXTMODE==3) ? 2 : 1;
+			}
+			gpuPixelsSSE2<CF>(pDst, _mm_loadu_si128((const __m128i *)tex), lr, lg, lb);
+			pDst += 8;
+			count -= 8;
+		} while (count >= 8);
+		if (!count) return;
+	}
+#endif
+
 	do
 	{
 		if (CF_MASKCHECK || CF_BLEND) { uDst = *pDst; }
@@ -485,7 +533,7 @@ const PS gpuSpriteSpanDrivers[256] = {
 //             relevant blend/light headers.
 // (see README_senquack.txt)
 template<int CF>
-static void gpuPolySpanFn(const gpu_unai_t &gpu_unai, u16 *pDst, u32 count)
+static void gpuPolySpanFn(const gpu_unai_t &unai, u16 *pDst, u32 count)
 {
 	// Blend func can save an operation if it knows uSrc MSB is unset.
 	//  Untextured prims can always skip this (src color MSB is always 0).
@@ -493,14 +541,22 @@ static void gpuPolySpanFn(const gpu_unai_t &gpu_unai, u16 *pDst, u32 count)
 	const bool skip_uSrc_mask = MSB_PRESERVED ? (!CF_TEXTMODE) : (!CF_TEXTMODE) || CF_LIGHT;
 	bool should_blend;
 
-	u32 bMsk; if (CF_BLITMASK) bMsk = gpu_unai.blit_mask;
+	u32 bMsk; if (CF_BLITMASK) bMsk = unai.blit_mask;
 
 	if (!CF_TEXTMODE)
 	{
 		if (!CF_GOURAUD)
 		{
 			// UNTEXTURED, NO GOURAUD
-			const u16 pix15 = gpu_unai.PixelData;
+			const u16 pix15 = unai.PixelData;
+#ifdef GPU_UNAI_USE_SSE2
+			{
+				const __m128i c = _mm_set1_epi16(pix15);
+				for (; count >= 8; count -= 8, pDst += 8)
+					gpuPixelsSSE2<CF>(pDst, c, c, c, c);
+				if (!count) return;
+			}
+#endif
 			do {
 				uint_fast16_t uSrc, uDst;
 
@@ -527,8 +583,18 @@ endpolynotextnogou:
 		else
 		{
 			// UNTEXTURED, GOURAUD
-			u32 l_gCol = gpu_unai.gCol;
-			u32 l_gInc = gpu_unai.gInc;
+			u32 l_gCol = unai.gCol;
+			u32 l_gInc = unai.gInc;
+
+#ifdef GPU_UNAI_USE_SSE2
+			if (!CF_DITHER) {
+				for (; count >= 8; count -= 8, pDst += 8, l_gCol += l_gInc * 8) {
+					__m128i c = gpuLightingRGBSSE2(l_gCol, l_gInc);
+					gpuPixelsSSE2<CF>(pDst, c, c, c, c);
+				}
+				if (!count) return;
+			}
+#endif
 
 			do {
 				uint_fast16_t uDst, uSrc;
@@ -574,12 +640,12 @@ endpolynotextgou:
 		//senquack - note: original UNAI code had gpu_unai.{u4/v4} packed into
 		// one 32-bit unsigned int, but this proved to lose too much accuracy
 		// (pixel drouputs noticeable in NFS3 sky), so now are separate vars.
-		u32 l_u_msk = gpu_unai.u_msk;     u32 l_v_msk = gpu_unai.v_msk;
-		u32 l_u = gpu_unai.u & l_u_msk;   u32 l_v = gpu_unai.v & l_v_msk;
-		s32 l_u_inc = gpu_unai.u_inc;     s32 l_v_inc = gpu_unai.v_inc;
+		u32 l_u_msk = unai.u_msk;         u32 l_v_msk = unai.v_msk;
+		u32 l_u = unai.u & l_u_msk;       u32 l_v = unai.v & l_v_msk;
+		s32 l_u_inc = unai.u_inc;         s32 l_v_inc = unai.v_inc;
 
-		const u16* TBA_ = gpu_unai.TBA;
-		const u16* CBA_; if (CF_TEXTMODE!=3) CBA_ = gpu_unai.CBA;
+		const u16* TBA_ = unai.TBA;
+		const u16* CBA_; if (CF_TEXTMODE!=3) CBA_ = unai.CBA;
 
 		u8 r5, g5, b5;
 		u8 r8, g8, b8;
@@ -588,21 +654,50 @@ endpolynotextgou:
 
 		if (CF_LIGHT) {
 			if (CF_GOURAUD) {
-				l_gInc = gpu_unai.gInc;
-				l_gCol = gpu_unai.gCol;
+				l_gInc = unai.gInc;
+				l_gCol = unai.gCol;
 			} else {
 				if (CF_DITHER) {
-					r8 = gpu_unai.r8;
-					g8 = gpu_unai.g8;
-					b8 = gpu_unai.b8;
+					r8 = unai.r8;
+					g8 = unai.g8;
+					b8 = unai.b8;
 				} else {
-					r5 = gpu_unai.r5;
-					g5 = gpu_unai.g5;
-					b5 = gpu_unai.b5;
+					r5 = unai.r5;
+					g5 = unai.g5;
+					b5 = unai.b5;
 				}
 			}
 		}
 
+#ifdef GPU_UNAI_USE_SSE2
+		if (!(CF_DITHER && CF_LIGHT) && !CF_BLITMASK && count >= 8
+		    && !gpuSpanOverlapsTextureSSE2<CF_TEXTMODE>(pDst, count, TBA_, CBA_))
+		{
+			__m128i lr = _mm_setzero_si128(), lg = lr, lb = lr;
+			if (CF_LIGHT && !CF_GOURAUD) {
+				lr = _mm_set1_epi16(r5);
+				lg = _mm_set1_epi16(g5);
+				lb = _mm_set1_epi16(b5);
+			}
+			do {
+				u16 tex[8];
+				for (int i = 0; i < 8; i++) {
+					tex[i] = gpuPolyTexelSSE2<CF_TEXTMODE>(TBA_, CBA_, l_u, l_v);
+					l_u = (l_u + l_u_inc) & l_u_msk;
+					l_v = (l_v + l_v_inc) & l_v_msk;
+				}
+				if (CF_LIGHT && CF_GOURAUD) {
+					gpuGouraudLightSSE2(l_gCol, l_gInc, lr, lg, lb);
+					l_gCol += l_gInc * 8;
+				}
+				gpuPixelsSSE2<CF>(pDst, _mm_loadu_si128((const __m128i *)tex), lr, lg, lb);
+				pDst += 8;
+				count -= 8;
+			} while (count >= 8);
+			if (!count) return;
+		}
+#endif
+
 		do
 		{
 			if (CF_BLITMASK) { if ((bMsk>>((((uintptr_t)pDst)>>1)&7))&1) goto endpolytext; }
@@ -674,7 +769,7 @@ endpolytext:
 	}
 }
 
-static void PolyNULL(const gpu_unai_t &gpu_unai, u16 *pDst, u32 count)
+static void PolyNULL(const gpu_unai_t &unai, u16 *pDst, u32 count)
 {
 	#ifdef ENABLE_GPU_LOG_SUPPORT
 		fprintf(stdout,"PolyNULL()\n");
@@ -683,7 +778,7 @@ static void PolyNULL(const gpu_unai_t &gpu_unai, u16 *pDst, u32 count)
 
 ///////////////////////////////////////////////////////////////////////////////
 //  Polygon innerloops driver
-typedef void (*PP)(const gpu_unai_t &gpu_unai, u16 *pDst, u32 count);
+typedef void (*PP)(const gpu_unai_t &unai, u16 *pDst, u32 count);
 
 // Template instantiation helper macros
 #define TI(cf) gpuPolySpanFn<(cf)>
@@ -0,0 +1,673 @@
+/***************************************************************************
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or     *
+*   (at your option) any later version.                                   *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU General Public License     *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin Street, Fifth Floor, Boston, MA 02111-1307 USA.           *
+***************************************************************************/
+
+#ifndef __GPU_UNAI_GPU_INNER_JIT_H__
+#define __GPU_UNAI_GPU_INNER_JIT_H__
+
+///////////////////////////////////////////////////////////////////////////////
+//  Span inner loops compiled at runtime (GPU_UNAI_JIT, uses GNU lightning)
+//
+//  The templates in gpu_inner.h are instantiated for every combination of CF
+//  bits up front. With the 'jit' option, a span function is instead compiled
+//  the first time a combination is drawn, also specialized on the texture
+//  window, whose masks become immediates. Functions are kept in a small hash
+//  table for the rest of the session. Anything not handled here (dithered
+//  lighting/shading, blit_mask pixel skipping) or failing to compile keeps
+//  using the template, as does everything when the option is off.
+//
+//  The loops follow the generic (non-ARM) template code, including how the
+//  source MSB is carried through lighting and blending (Silent Hill fix),
+//  so both produce the same pixels.
+
+#ifdef GPU_UNAI_JIT
+
+extern "C" {
+#include <lightning.h>
+}
+
+enum {
+	GPU_JIT_POLY,
+	GPU_JIT_SPRITE,
+	GPU_JIT_TILE
+};
+
+#define GPU_JIT_CACHE_BITS 9
+#define GPU_JIT_CACHE_SIZE (1 << GPU_JIT_CACHE_BITS)
+
+struct gpu_jit_entry {
+	u32 key;              // 0: unused
+	void *fn;
+	jit_state_t *state;   // NULL if 'fn' is the template
+};
+
+static struct {
+	bool initialized;
+	int used;
+	gpu_jit_entry cache[GPU_JIT_CACHE_SIZE];
+
+	// Flat texture lighting for the r5,g5,b5 in 'light_key': LightLUT[]
+	//  rows for each component, already shifted into place. Spans check
+	//  the key on entry and have this refilled when the light changed.
+	u32 light_key;
+	u16 light_tab[3][32];
+} gpu_unai_jit;
+
+static void gpuJitSetupLight(u32 key)
+{
+	u32 r5 = key & 0x1f, g5 = (key >> 8) & 0x1f, b5 = (key >> 16) & 0x1f;
+
+	for (int i = 0; i < 32; ++i) {
+		gpu_unai_jit.light_tab[0][i] = gpu_unai.LightLUT[(i << 5) | r5];
+		gpu_unai_jit.light_tab[1][i] = gpu_unai.LightLUT[(i << 5) | g5] << 5;
+		gpu_unai_jit.light_tab[2][i] = gpu_unai.LightLUT[(i << 5) | b5] << 10;
+	}
+	gpu_unai_jit.light_key = key;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//  Span state lives in callee-saved registers while they last, the rest in
+//  the stack frame. Hot variables are allocated first.
+struct gpu_jit_var {
+	int reg;   // -1: in the frame at 'off'
+	int off;
+};
+
+static void gpuJitVarAlloc(jit_state_t *_jit, gpu_jit_var &var, int &next_v)
+{
+	if (next_v < JIT_V_NUM) {
+		var.reg = JIT_V(next_v++);
+	} else {
+		var.reg = -1;
+		var.off = jit_allocai(sizeof(jit_word_t));
+	}
+}
+
+// Returns the register holding 'var', loading it into 'tmp' if needed
+static int gpuJitVarGet(jit_state_t *_jit, const gpu_jit_var &var, int tmp)
+{
+	if (var.reg >= 0)
+		return var.reg;
+	jit_ldxi(tmp, JIT_FP, var.off);
+	return tmp;
+}
+
+static void gpuJitVarSet(jit_state_t *_jit, const gpu_jit_var &var, int reg)
+{
+	if (var.reg < 0)
+		jit_stxi(var.off, JIT_FP, reg);
+	else if (var.reg != reg)
+		jit_movr(var.reg, reg);
+}
+
+static void gpuJitVarAdd(jit_state_t *_jit, const gpu_jit_var &var, const gpu_jit_var &inc)
+{
+	int r = gpuJitVarGet(_jit, var, JIT_R0);
+	int i = gpuJitVarGet(_jit, inc, JIT_R1);
+	jit_addr(r, r, i);
+	gpuJitVarSet(_jit, var, r);
+}
+
+static void gpuJitVarAddi(jit_state_t *_jit, const gpu_jit_var &var, jit_word_t inc)
+{
+	int r = gpuJitVarGet(_jit, var, JIT_R0);
+	jit_addi(r, r, inc);
+	gpuJitVarSet(_jit, var, r);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// gpuBlendingGeneric(): uSrc in R0, uDst in R1, result in R0. R1,R2 trashed.
+static void gpuJitBlend(jit_state_t *_jit, int blend_mode, bool skip_src_mask)
+{
+	const int s = JIT_R0, d = JIT_R1, t = JIT_R2;
+
+	if (blend_mode == 0) {
+#ifdef GPU_UNAI_USE_ACCURATE_BLENDING
+		jit_andi(d, d, 0x7fff);
+		if (!skip_src_mask)
+			jit_andi(s, s, 0x7fff);
+		jit_xorr(t, s, d);
+		jit_andi(t, t, 0x0421);
+		jit_addr(s, s, d);
+		jit_subr(s, s, t);
+		jit_rshi_u(s, s, 1);
+#else
+		jit_andi(d, d, 0x7bde);
+		jit_andi(s, s, 0x7bde);
+		jit_addr(s, s, d);
+		jit_rshi_u(s, s, 1);
+#endif
+	} else if (blend_mode == 2) {
+		jit_andi(d, d, 0x7fff);
+		if (!skip_src_mask)
+			jit_andi(s, s, 0x7fff);
+		jit_xorr(t, d, s);
+		jit_andi(t, t, 0x8420);   // low_bits
+		jit_subr(d, d, s);
+		jit_addi(d, d, 0x8420);   // diff
+		jit_subr(s, d, t);
+		jit_andi(s, s, 0x8420);   // borrows
+		jit_subr(d, d, s);        // modulo
+		jit_rshi_u(t, s, 5);
+		jit_subr(s, s, t);        // clamp
+		jit_andr(s, s, d);
+	} else {
+		jit_andi(d, d, 0x7fff);
+		if (blend_mode == 3) {
+			jit_rshi_u(s, s, 2);
+			jit_andi(s, s, 0x1ce7);
+		} else if (!skip_src_mask) {
+			jit_andi(s, s, 0x7fff);
+		}
+		jit_xorr(t, s, d);
+		jit_andi(t, t, 0x0421);   // low_bits
+		jit_addr(s, s, d);        // sum
+		jit_subr(d, s, t);
+		jit_andi(d, d, 0x8420);   // carries
+		jit_subr(s, s, d);        // modulo
+		jit_rshi_u(t, d, 5);
+		jit_subr(d, d, t);        // clamp
+		jit_orr(s, s, d);
+	}
+}
+
+// gpuLightingTXTGeneric() with the tables of gpuJitSetupLight(): R0 in/out,
+//  R1,R2 trashed.
+static void gpuJitLightFlat(jit_state_t *_jit)
+{
+	jit_rshi_u(JIT_R1, JIT_R0, 10);
+	jit_andi(JIT_R1, JIT_R1, 0x1f);
+	jit_lshi(JIT_R1, JIT_R1, 1);
+	jit_ldxi_us(JIT_R2, JIT_R1, (jit_word_t)gpu_unai_jit.light_tab[2]);
+	jit_rshi_u(JIT_R1, JIT_R0, 5);
+	jit_andi(JIT_R1, JIT_R1, 0x1f);
+	jit_lshi(JIT_R1, JIT_R1, 1);
+	jit_ldxi_us(JIT_R1, JIT_R1, (jit_word_t)gpu_unai_jit.light_tab[1]);
+	jit_orr(JIT_R2, JIT_R2, JIT_R1);
+	jit_andi(JIT_R0, JIT_R0, 0x1f);
+	jit_lshi(JIT_R0, JIT_R0, 1);
+	jit_ldxi_us(JIT_R0, JIT_R0, (jit_word_t)gpu_unai_jit.light_tab[0]);
+	jit_orr(JIT_R0, JIT_R0, JIT_R2);
+}
+
+// gpuLightingTXTGouraudGeneric(): R0 in/out, R1,R2,'t3' trashed.
+//  gCol may carry garbage above bit 31 on 64-bit hosts, hence the masks.
+static void gpuJitLightGouraud(jit_state_t *_jit, const gpu_jit_var &gcol, int t3)
+{
+	static const int shift[3] = { 5, 16, 27 };
+	const jit_word_t lut = (jit_word_t)gpu_unai.LightLUT;
+	int g;
+
+	for (int i = 0; i < 3; ++i) {
+		int idx = i ? JIT_R2 : JIT_R1;
+		if (i == 0) {          // b
+			jit_andi(idx, JIT_R0, 0x7c00);
+			jit_rshi_u(idx, idx, 5);
+		} else if (i == 1) {   // g
+			jit_andi(idx, JIT_R0, 0x03e0);
+		} else {               // r
+			jit_andi(idx, JIT_R0, 0x001f);
+			jit_lshi(idx, idx, 5);
+		}
+		g = gpuJitVarGet(_jit, gcol, t3);
+		jit_rshi_u(t3, g, shift[i]);
+		jit_andi(t3, t3, 0x1f);
+		jit_orr(idx, idx, t3);
+		jit_ldxi_uc(idx, idx, lut);
+		if (i == 0) {
+			jit_lshi(JIT_R1, JIT_R1, 10);
+		} else if (i == 1) {
+			jit_lshi(JIT_R2, JIT_R2, 5);
+			jit_orr(JIT_R1, JIT_R1, JIT_R2);
+		} else {
+			jit_orr(JIT_R0, JIT_R2, JIT_R1);
+		}
+	}
+}
+
+static void gpuJitLight(jit_state_t *_jit, bool gouraud, const gpu_jit_var &gcol, int t3)
+{
+	if (gouraud)
+		gpuJitLightGouraud(_jit, gcol, t3);
+	else
+		gpuJitLightFlat(_jit);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//  Compiles the equivalent of gpuPolySpanFn<CF>, gpuSpriteSpanFn<CF> or
+//  gpuTileSpanFn<CF> for texture window masks 'tw_u','tw_v'. Returns NULL
+//  for what the templates have to do.
+static void *gpuJitCompileSpan(u32 kind, u32 CF, u32 tw_u, u32 tw_v, jit_state_t **state)
+{
+	const bool poly     = kind == GPU_JIT_POLY;
+	const bool sprite   = kind == GPU_JIT_SPRITE;
+	const u32 textmode  = poly || sprite ? CF_TEXTMODE : 0;
+	const bool textured = textmode != 0;
+	const bool gouraud  = poly && CF_GOURAUD;
+	const bool light    = textured && CF_LIGHT;
+
+	if (poly && CF_DITHER && (light || (!textured && gouraud)))
+		return NULL;
+	if (poly && textured && CF_BLITMASK)
+		return NULL;
+
+	jit_state_t *_jit = jit_new_state();
+	if (_jit == NULL)
+		return NULL;
+
+	gpu_jit_var dst = {}, end = {}, uv = {}, uv_inc = {}, tba = {}, cba = {};
+	gpu_jit_var gcol = {}, ginc = {}, col = {};
+#if __WORDSIZE != 64
+	gpu_jit_var v = {}, v_inc = {};
+#endif
+	jit_node_t *arg[4], *skip[2], *msb_clear, *done = NULL, *loop, *j;
+	int next_v = 0, nskip = 0, t3 = -1, r;
+
+	jit_prolog();
+	for (int i = 0; i < (sprite ? 4 : 3); ++i)
+		arg[i] = jit_arg();
+
+	if (light && gouraud)
+		t3 = JIT_V(next_v++);
+
+	gpuJitVarAlloc(_jit, dst, next_v);
+	if (poly && textured) {
+		gpuJitVarAlloc(_jit, uv, next_v);
+		gpuJitVarAlloc(_jit, uv_inc, next_v);
+#if __WORDSIZE != 64
+		gpuJitVarAlloc(_jit, v, next_v);
+		gpuJitVarAlloc(_jit, v_inc, next_v);
+#endif
+	}
+	if (sprite)
+		gpuJitVarAlloc(_jit, uv, next_v);      // u0
+	if (textured)
+		gpuJitVarAlloc(_jit, tba, next_v);     // pTxt for sprites
+	if (textmode == 1 || textmode == 2)
+		gpuJitVarAlloc(_jit, cba, next_v);
+	if (!textured && !gouraud)
+		gpuJitVarAlloc(_jit, col, next_v);
+	gpuJitVarAlloc(_jit, end, next_v);
+	if (gouraud && (light || !textured)) {
+		gpuJitVarAlloc(_jit, gcol, next_v);
+		gpuJitVarAlloc(_jit, ginc, next_v);
+	}
+
+	// Arguments, end of span
+	jit_getarg(JIT_R0, arg[poly ? 1 : 0]);
+	gpuJitVarSet(_jit, dst, JIT_R0);
+	jit_getarg_ui(JIT_R1, arg[poly ? 2 : 1]);
+	jit_lshi(JIT_R1, JIT_R1, 1);
+	jit_addr(JIT_R1, JIT_R0, JIT_R1);
+	gpuJitVarSet(_jit, end, JIT_R1);
+	if (sprite) {
+		jit_getarg(JIT_R0, arg[2]);
+		gpuJitVarSet(_jit, tba, JIT_R0);
+		jit_getarg_ui(JIT_R0, arg[3]);
+		gpuJitVarSet(_jit, uv, JIT_R0);
+	}
+	if (kind == GPU_JIT_TILE) {
+		jit_getarg_us(JIT_R0, arg[2]);
+		if (CF_MASKSET && !CF_BLEND)
+			jit_ori(JIT_R0, JIT_R0, 0x8000);
+		gpuJitVarSet(_jit, col, JIT_R0);
+	}
+
+	// Flat lighting tables, after the arguments as this calls out
+	if (light && !gouraud) {
+		jit_ldi_uc(JIT_R0, &gpu_unai.r5);
+		jit_ldi_uc(JIT_R1, &gpu_unai.g5);
+		jit_lshi(JIT_R1, JIT_R1, 8);
+		jit_orr(JIT_R0, JIT_R0, JIT_R1);
+		jit_ldi_uc(JIT_R1, &gpu_unai.b5);
+		jit_lshi(JIT_R1, JIT_R1, 16);
+		jit_orr(JIT_R0, JIT_R0, JIT_R1);
+		jit_ldi_ui(JIT_R1, &gpu_unai_jit.light_key);
+		j = jit_beqr(JIT_R0, JIT_R1);
+		jit_prepare();
+		jit_pushargr(JIT_R0);
+		jit_finishi((jit_pointer_t)gpuJitSetupLight);
+		jit_patch(j);
+	}
+
+	// Span state from gpu_unai
+	if (poly && textured) {
+		const u32 u_msk = (tw_u << 10) | 0x3ff, v_msk = (tw_v << 10) | 0x3ff;
+#if __WORDSIZE == 64
+		// u and v share a register, v in the upper half. Both are
+		//  masked to 18 bits after every step, so increments can be cut
+		//  to 18 bits too and never carry from u into v.
+		jit_ldi_ui(JIT_R0, &gpu_unai.u);
+		jit_andi(JIT_R0, JIT_R0, u_msk);
+		jit_ldi_ui(JIT_R1, &gpu_unai.v);
+		jit_andi(JIT_R1, JIT_R1, v_msk);
+		jit_lshi(JIT_R1, JIT_R1, 32);
+		jit_orr(JIT_R0, JIT_R0, JIT_R1);
+		gpuJitVarSet(_jit, uv, JIT_R0);
+		jit_ldi_i(JIT_R0, &gpu_unai.u_inc);
+		jit_andi(JIT_R0, JIT_R0, 0x3ffff);
+		jit_ldi_i(JIT_R1, &gpu_unai.v_inc);
+		jit_andi(JIT_R1, JIT_R1, 0x3ffff);
+		jit_lshi(JIT_R1, JIT_R1, 32);
+		jit_orr(JIT_R0, JIT_R0, JIT_R1);
+		gpuJitVarSet(_jit, uv_inc, JIT_R0);
+#else
+		jit_ldi_i(JIT_R0, &gpu_unai.u);
+		jit_andi(JIT_R0, JIT_R0, u_msk);
+		gpuJitVarSet(_jit, uv, JIT_R0);
+		jit_ldi_i(JIT_R0, &gpu_unai.v);
+		jit_andi(JIT_R0, JIT_R0, v_msk);
+		gpuJitVarSet(_jit, v, JIT_R0);
+		jit_ldi_i(JIT_R0, &gpu_unai.u_inc);
+		gpuJitVarSet(_jit, uv_inc, JIT_R0);
+		jit_ldi_i(JIT_R0, &gpu_unai.v_inc);
+		gpuJitVarSet(_jit, v_inc, JIT_R0);
+#endif
+		jit_ldi(JIT_R0, &gpu_unai.TBA);
+		gpuJitVarSet(_jit, tba, JIT_R0);
+	}
+	if (textmode == 1 || textmode == 2) {
+		jit_ldi(JIT_R0, &gpu_unai.CBA);
+		gpuJitVarSet(_jit, cba, JIT_R0);
+	}
+	if (poly && !textured && !gouraud) {
+		jit_ldi_us(JIT_R0, &gpu_unai.PixelData);
+		if (CF_MASKSET && !CF_BLEND)
+			jit_ori(JIT_R0, JIT_R0, 0x8000);
+		gpuJitVarSet(_jit, col, JIT_R0);
+	}
+	if (gouraud && (light || !textured)) {
+		jit_ldi_ui(JIT_R0, &gpu_unai.gCol);
+		gpuJitVarSet(_jit, gcol, JIT_R0);
+		jit_ldi_ui(JIT_R0, &gpu_unai.gInc);
+		gpuJitVarSet(_jit, ginc, JIT_R0);
+	}
+
+	loop = jit_label();
+
+	if (CF_MASKCHECK) {
+		r = gpuJitVarGet(_jit, dst, JIT_R1);
+		jit_ldr_us(JIT_R0, r);
+		skip[nskip++] = jit_bmsi(JIT_R0, 0x8000);
+	}
+
+	// Source color into R0
+	if (poly && textured) {
+		// tu into R1, tv (already scaled as in the template) into R2
+#if __WORDSIZE == 64
+		r = gpuJitVarGet(_jit, uv, JIT_R0);
+		jit_rshi_u(JIT_R1, r, 10);
+		jit_andi(JIT_R1, JIT_R1, 0xff);
+		if (textmode == 3) {
+			jit_rshi_u(JIT_R2, r, 32);
+			jit_andi(JIT_R2, JIT_R2, 0xff << 10);
+		} else {
+			jit_rshi_u(JIT_R2, r, 31);
+			jit_andi(JIT_R2, JIT_R2, 0xff << 11);
+		}
+#else
+		r = gpuJitVarGet(_jit, uv, JIT_R0);
+		jit_rshi_u(JIT_R1, r, 10);
+		r = gpuJitVarGet(_jit, v, JIT_R2);
+		if (textmode == 3) {
+			jit_andi(JIT_R2, r, 0xff << 10);
+		} else {
+			jit_lshi(JIT_R2, r, 1);
+			jit_andi(JIT_R2, JIT_R2, 0xff << 11);
+		}
+#endif
+		if (textmode == 1) {
+			jit_rshi_u(JIT_R0, JIT_R1, 1);
+			jit_addr(JIT_R2, JIT_R2, JIT_R0);
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_uc(JIT_R2, r, JIT_R2);
+			jit_andi(JIT_R1, JIT_R1, 1);
+			jit_lshi(JIT_R1, JIT_R1, 2);
+			jit_rshr_u(JIT_R2, JIT_R2, JIT_R1);
+			jit_andi(JIT_R2, JIT_R2, 0xf);
+			jit_lshi(JIT_R2, JIT_R2, 1);
+			r = gpuJitVarGet(_jit, cba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R2);
+		} else if (textmode == 2) {
+			jit_addr(JIT_R1, JIT_R1, JIT_R2);
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_uc(JIT_R1, r, JIT_R1);
+			jit_lshi(JIT_R1, JIT_R1, 1);
+			r = gpuJitVarGet(_jit, cba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R1);
+		} else {
+			jit_addr(JIT_R1, JIT_R1, JIT_R2);
+			jit_lshi(JIT_R1, JIT_R1, 1);
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R1);
+		}
+	} else if (sprite) {
+		const u32 u0_msk = textmode == 3 ? tw_u << 1 : tw_u;
+
+		r = gpuJitVarGet(_jit, uv, JIT_R1);
+		jit_andi(JIT_R1, r, u0_msk);
+		if (textmode == 1) {
+			jit_rshi_u(JIT_R2, JIT_R1, 1);
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_uc(JIT_R2, r, JIT_R2);
+			jit_andi(JIT_R1, JIT_R1, 1);
+			jit_lshi(JIT_R1, JIT_R1, 2);
+			jit_rshr_u(JIT_R2, JIT_R2, JIT_R1);
+			jit_andi(JIT_R2, JIT_R2, 0xf);
+			jit_lshi(JIT_R2, JIT_R2, 1);
+			r = gpuJitVarGet(_jit, cba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R2);
+		} else if (textmode == 2) {
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_uc(JIT_R1, r, JIT_R1);
+			jit_lshi(JIT_R1, JIT_R1, 1);
+			r = gpuJitVarGet(_jit, cba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R1);
+		} else {
+			r = gpuJitVarGet(_jit, tba, JIT_R0);
+			jit_ldxr_us(JIT_R0, r, JIT_R1);
+		}
+	} else if (gouraud) {
+		// gpuLightingRGBGeneric()
+		r = gpuJitVarGet(_jit, gcol, JIT_R1);
+		jit_lshi(JIT_R0, r, 5);
+		jit_andi(JIT_R0, JIT_R0, 0x7c00);
+		jit_rshi_u(JIT_R2, r, 11);
+		jit_andi(JIT_R2, JIT_R2, 0x03e0);
+		jit_orr(JIT_R0, JIT_R0, JIT_R2);
+		jit_rshi_u(JIT_R2, r, 27);
+		jit_andi(JIT_R2, JIT_R2, 0x1f);
+		jit_orr(JIT_R0, JIT_R0, JIT_R2);
+	} else {
+		r = gpuJitVarGet(_jit, col, JIT_R0);
+		if (r != JIT_R0)
+			jit_movr(JIT_R0, r);
+	}
+	if (textured)
+		skip[nskip++] = jit_beqi(JIT_R0, 0);
+
+	// Lighting and blending. Textured: only blend when the source MSB is
+	//  set, and keep it in the result. That splits the pixel in two paths.
+	if (textured && (CF_BLEND || light)) {
+		msb_clear = jit_bmci(JIT_R0, 0x8000);
+		if (light)
+			gpuJitLight(_jit, gouraud, gcol, t3);
+		if (CF_BLEND) {
+			r = gpuJitVarGet(_jit, dst, JIT_R2);
+			jit_ldr_us(JIT_R1, r);
+			gpuJitBlend(_jit, CF_BLENDMODE, light);
+		}
+		jit_ori(JIT_R0, JIT_R0, 0x8000);
+		r = gpuJitVarGet(_jit, dst, JIT_R1);
+		jit_str_s(r, JIT_R0);
+		done = jit_jmpi();
+		jit_patch(msb_clear);
+		if (light)
+			gpuJitLight(_jit, gouraud, gcol, t3);
+	} else if (CF_BLEND) {
+		r = gpuJitVarGet(_jit, dst, JIT_R2);
+		jit_ldr_us(JIT_R1, r);
+		gpuJitBlend(_jit, CF_BLENDMODE, true);
+	}
+	// Flat untextured colors already have the mask bit when not blending
+	if (CF_MASKSET && (textured || gouraud || CF_BLEND))
+		jit_ori(JIT_R0, JIT_R0, 0x8000);
+	r = gpuJitVarGet(_jit, dst, JIT_R1);
+	jit_str_s(r, JIT_R0);
+	if (done)
+		jit_patch(done);
+	for (int i = 0; i < nskip; ++i)
+		jit_patch(skip[i]);
+
+	// Next pixel
+	if (poly && textured) {
+#if __WORDSIZE == 64
+		const jit_word_t uv_msk = ((jit_word_t)((tw_v << 10) | 0x3ff) << 32)
+		                        | (tw_u << 10) | 0x3ff;
+		gpuJitVarAdd(_jit, uv, uv_inc);
+		r = gpuJitVarGet(_jit, uv, JIT_R0);
+		jit_andi(r, r, uv_msk);
+		gpuJitVarSet(_jit, uv, r);
+#else
+		gpuJitVarAdd(_jit, uv, uv_inc);
+		r = gpuJitVarGet(_jit, uv, JIT_R0);
+		jit_andi(r, r, (tw_u << 10) | 0x3ff);
+		gpuJitVarSet(_jit, uv, r);
+		gpuJitVarAdd(_jit, v, v_inc);
+		r = gpuJitVarGet(_jit, v, JIT_R0);
+		jit_andi(r, r, (tw_v << 10) | 0x3ff);
+		gpuJitVarSet(_jit, v, r);
+#endif
+	}
+	if (sprite)
+		gpuJitVarAddi(_jit, uv, textmode == 3 ? 2 : 1);
+	if (gouraud && (light || !textured))
+		gpuJitVarAdd(_jit, gcol, ginc);
+	gpuJitVarAddi(_jit, dst, 2);
+	r = gpuJitVarGet(_jit, dst, JIT_R0);
+	jit_patch_at(jit_bltr_u(r, gpuJitVarGet(_jit, end, JIT_R1)), loop);
+
+	jit_ret();
+	jit_epilog();
+
+	void *fn = jit_emit();
+	jit_clear_state();
+	if (fn == NULL) {
+		jit_destroy_state();
+		return NULL;
+	}
+	*state = _jit;
+	return fn;
+}
+
+// Span function for template table index 'idx', compiling it if needed.
+static void *gpuJitSpanDriver(u32 kind, u32 idx, void *fallback)
+{
+	u32 cf, tw = 0;
+
+	switch (kind) {
+	case GPU_JIT_POLY:
+		cf = idx;
+		if ((cf >> 5) & 3)
+			tw = gpu_unai.TextureWindow[2] | (gpu_unai.TextureWindow[3] << 8);
+		break;
+	case GPU_JIT_SPRITE:
+		cf = (idx & 0x7f) | ((idx & 0x80) << 1);
+		tw = gpu_unai.TextureWindow[2];
+		break;
+	default:
+		cf = ((idx & 0xf) << 1) | ((idx & 0x10) << 4);
+		break;
+	}
+
+	u32 key = (1u << 31) | (kind << 27) | (idx << 16) | tw;
+	u32 h = (key * 2654435761u) >> (32 - GPU_JIT_CACHE_BITS);
+	gpu_jit_entry *e;
+
+	for (;; h = (h + 1) & (GPU_JIT_CACHE_SIZE - 1)) {
+		e = &gpu_unai_jit.cache[h];
+		if (e->key == key)
+			return e->fn;
+		if (e->key == 0)
+			break;
+	}
+
+	// Table full enough, don't bother with new combinations
+	if (gpu_unai_jit.used >= GPU_JIT_CACHE_SIZE * 3 / 4)
+		return fallback;
+
+	if (!gpu_unai_jit.initialized) {
+		init_jit(NULL);
+		gpu_unai_jit.light_key = ~0u;
+		gpu_unai_jit.initialized = true;
+	}
+
+	e->key = key;
+	e->state = NULL;
+	e->fn = gpuJitCompileSpan(kind, cf, tw & 0xff, tw >> 8, &e->state);
+	if (e->fn == NULL)
+		e->fn = fallback;
+	gpu_unai_jit.used++;
+	return e->fn;
+}
+
+static void gpuJitFinish(void)
+{
+	if (!gpu_unai_jit.initialized)
+		return;
+
+	for (int i = 0; i < GPU_JIT_CACHE_SIZE; ++i) {
+		jit_state_t *_jit = gpu_unai_jit.cache[i].state;
+		if (_jit)
+			jit_destroy_state();
+	}
+	finish_jit();
+	memset(&gpu_unai_jit, 0, sizeof(gpu_unai_jit));
+}
+
+#endif // GPU_UNAI_JIT
+
+///////////////////////////////////////////////////////////////////////////////
+//  Span driver selection, compiled functions if enabled
+
+static inline PP gpuGetPolySpanDriver(u32 idx)
+{
+#ifdef GPU_UNAI_JIT
+	if (gpu_unai.config.jit && gpuPolySpanDrivers[idx] != PolyNULL)
+		return (PP)gpuJitSpanDriver(GPU_JIT_POLY, idx, (void *)gpuPolySpanDrivers[idx]);
+#endif
+	return gpuPolySpanDrivers[idx];
+}
+
+static inline PS gpuGetSpriteSpanDriver(u32 idx)
+{
+#ifdef GPU_UNAI_JIT
+	if (gpu_unai.config.jit && gpuSpriteSpanDrivers[idx] != SpriteNULL)
+		return (PS)gpuJitSpanDriver(GPU_JIT_SPRITE, idx, (void *)gpuSpriteSpanDrivers[idx]);
+#endif
+	return gpuSpriteSpanDrivers[idx];
+}
+
+static inline PT gpuGetTileSpanDriver(u32 idx)
+{
+#ifdef GPU_UNAI_JIT
+	if (gpu_unai.config.jit && gpuTileSpanDrivers[idx] != TileNULL)
+		return (PT)gpuJitSpanDriver(GPU_JIT_TILE, idx, (void *)gpuTileSpanDrivers[idx]);
+#endif
+	return gpuTileSpanDrivers[idx];
+}
+
+#endif /* __GPU_UNAI_GPU_INNER_JIT_H__ */
@@ -0,0 +1,244 @@
+/***************************************************************************
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or     *
+*   (at your option) any later version.                                   *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU General Public License     *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin Street, Fifth Floor, Boston, MA 02111-1307 USA.           *
+***************************************************************************/
+
+#ifndef __GPU_UNAI_GPU_INNER_SSE2_H__
+#define __GPU_UNAI_GPU_INNER_SSE2_H__
+
+///////////////////////////////////////////////////////////////////////////////
+//  SSE2 span helpers, 8 pixels per iteration
+//
+//  Used by the span functions in gpu_inner.h for all but the last count%8
+//  pixels of a span. Everything here is the 16-bit lane version of the
+//  Generic blend/light functions, giving the same pixels. Texels are still
+//  fetched one at a time: with 16-bit CLUT entries and wrapping texture
+//  window coords, there is nothing to gather them with in SSE2.
+//  Dithering and blit_mask spans are left to the scalar loops.
+
+#include <emmintrin.h>
+
+#define GPU_SSE2_SELECT(m, a, b) \
+	_mm_or_si128(_mm_and_si128((m), (a)), _mm_andnot_si128((m), (b)))
+
+////////////////////////////////////////////////////////////////////////////////
+// gpuBlendingGeneric() for 8 pixels. All of its intermediate values fit in
+//  16 bits or only have their low 16 bits used, so 16-bit lanes do it.
+template <int BLENDMODE, bool SKIP_USRC_MSB_MASK>
+GPU_INLINE __m128i gpuBlendingSSE2(__m128i uSrc, __m128i uDst)
+{
+	const __m128i m7fff = _mm_set1_epi16(0x7fff);
+	const __m128i m0421 = _mm_set1_epi16(0x0421);
+	const __m128i m8420 = _mm_set1_epi16((short)0x8420);
+	__m128i mix;
+
+	if (BLENDMODE==0) {
+#ifdef GPU_UNAI_USE_ACCURATE_BLENDING
+		uDst = _mm_and_si128(uDst, m7fff);
+		if (!SKIP_USRC_MSB_MASK)
+			uSrc = _mm_and_si128(uSrc, m7fff);
+		mix = _mm_sub_epi16(_mm_add_epi16(uSrc, uDst),
+			_mm_and_si128(_mm_xor_si128(uSrc, uDst), m0421));
+		mix = _mm_srli_epi16(mix, 1);
+#else
+		const __m128i m7bde = _mm_set1_epi16(0x7bde);
+		mix = _mm_add_epi16(_mm_and_si128(uDst, m7bde), _mm_and_si128(uSrc, m7bde));
+		mix = _mm_srli_epi16(mix, 1);
+#endif
+	}
+
+	if (BLENDMODE==1 || BLENDMODE==3) {
+		uDst = _mm_and_si128(uDst, m7fff);
+		if (BLENDMODE==3)
+			uSrc = _mm_and_si128(_mm_srli_epi16(uSrc, 2), _mm_set1_epi16(0x1ce7));
+		else if (!SKIP_USRC_MSB_MASK)
+			uSrc = _mm_and_si128(uSrc, m7fff);
+		__m128i sum      = _mm_add_epi16(uSrc, uDst);
+		__m128i low_bits = _mm_and_si128(_mm_xor_si128(uSrc, uDst), m0421);
+		__m128i carries  = _mm_and_si128(_mm_sub_epi16(sum, low_bits), m8420);
+		__m128i modulo   = _mm_sub_epi16(sum, carries);
+		__m128i clamp    = _mm_sub_epi16(carries, _mm_srli_epi16(carries, 5));
+		mix = _mm_or_si128(modulo, clamp);
+	}
+
+	if (BLENDMODE==2) {
+		uDst = _mm_and_si128(uDst, m7fff);
+		if (!SKIP_USRC_MSB_MASK)
+			uSrc = _mm_and_si128(uSrc, m7fff);
+		__m128i diff     = _mm_add_epi16(_mm_sub_epi16(uDst, uSrc), m8420);
+		__m128i low_bits = _mm_and_si128(_mm_xor_si128(uDst, uSrc), m8420);
+		__m128i borrows  = _mm_and_si128(_mm_sub_epi16(diff, low_bits), m8420);
+		__m128i modulo   = _mm_sub_epi16(diff, borrows);
+		__m128i clamp    = _mm_sub_epi16(borrows, _mm_srli_epi16(borrows, 5));
+		mix = _mm_and_si128(modulo, clamp);
+	}
+
+	return mix;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// gpuLightingTXTGeneric()/gpuLightingTXTGouraudGeneric() for 8 pixels, with
+//  5-bit light values per lane. Computes LightLUT[] entries directly, they
+//  are min(c * l / 16, 31) (see SetupLightLUT()).
+GPU_INLINE __m128i gpuLightingTXTSSE2(__m128i uSrc, __m128i r5, __m128i g5, __m128i b5)
+{
+	const __m128i m1f = _mm_set1_epi16(0x1f);
+	__m128i r, g, b;
+
+	r = _mm_and_si128(uSrc, m1f);
+	g = _mm_and_si128(_mm_srli_epi16(uSrc, 5), m1f);
+	b = _mm_and_si128(_mm_srli_epi16(uSrc, 10), m1f);
+	r = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(r, r5), 4), m1f);
+	g = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(g, g5), 4), m1f);
+	b = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(b, b5), 4), m1f);
+	return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)), _mm_slli_epi16(b, 10));
+}
+
+// Packed Gouraud colors 'gCol' + n * 'gInc' for n = 0..7, in two halves
+GPU_INLINE void gpuGouraudColsSSE2(u32 gCol, u32 gInc, __m128i &lo, __m128i &hi)
+{
+	lo = _mm_set_epi32(gCol + gInc * 3, gCol + gInc * 2, gCol + gInc, gCol);
+	hi = _mm_add_epi32(lo, _mm_set1_epi32(gInc * 4));
+}
+
+// gpuLightingRGBGeneric() for 8 pixels
+GPU_INLINE __m128i gpuLightingRGBSSE2(u32 gCol, u32 gInc)
+{
+	__m128i lo, hi, c[2];
+
+	gpuGouraudColsSSE2(gCol, gInc, lo, hi);
+	for (int i = 0; i < 2; i++) {
+		__m128i g = i ? hi : lo;
+		c[i] = _mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(g, 5), _mm_set1_epi32(0x7c00)),
+			_mm_and_si128(_mm_srli_epi32(g, 11), _mm_set1_epi32(0x03e0)));
+		c[i] = _mm_or_si128(c[i], _mm_srli_epi32(g, 27));
+	}
+	// all values are < 0x8000, so the signed saturation never kicks in
+	return _mm_packs_epi32(c[0], c[1]);
+}
+
+// 5-bit light values of gpuLightingTXTGouraudGeneric() for 8 pixels
+GPU_INLINE void gpuGouraudLightSSE2(u32 gCol, u32 gInc, __m128i &r5, __m128i &g5, __m128i &b5)
+{
+	const __m128i m1f = _mm_set1_epi32(0x1f);
+	__m128i lo, hi;
+
+	gpuGouraudColsSSE2(gCol, gInc, lo, hi);
+	r5 = _mm_packs_epi32(_mm_srli_epi32(lo, 27), _mm_srli_epi32(hi, 27));
+	g5 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), m1f),
+	                     _mm_and_si128(_mm_srli_epi32(hi, 16), m1f));
+	b5 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 5), m1f),
+	                     _mm_and_si128(_mm_srli_epi32(hi, 5), m1f));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Texel of gpuPolySpanFn() at 22.10 coords 'u','v'
+template<int TEXTMODE>
+GPU_INLINE u16 gpuPolyTexelSSE2(const u16 *TBA_, const u16 *CBA_, u32 u, u32 v)
+{
+	if (TEXTMODE==1) {
+		u32 tu = u >> 10, tv = (v << 1) & (0xff << 11);
+		u8 rgb = ((const u8 *)TBA_)[tv + (tu >> 1)];
+		return CBA_[(rgb >> ((tu & 1) << 2)) & 0xf];
+	}
+	if (TEXTMODE==2)
+		return CBA_[((const u8 *)TBA_)[(u >> 10) + ((v << 1) & (0xff << 11))]];
+	return TBA_[(u >> 10) + (v & (0xff << 10))];
+}
+
+// Texel of gpuSpriteSpanFn() at byte offset 'u0'
+template<int TEXTMODE>
+GPU_INLINE u16 gpuSpriteTexelSSE2(const u8 *pTxt, const u16 *CBA_, u32 u0, u32 u0_mask)
+{
+	if (TEXTMODE==1) {
+		u8 rgb = pTxt[(u0 & u0_mask) >> 1];
+		return CBA_[(rgb >> ((u0 & 1) << 2)) & 0xf];
+	}
+	if (TEXTMODE==2)
+		return CBA_[pTxt[u0 & u0_mask]];
+	return *(const u16 *)(&pTxt[u0 & u0_mask]);
+}
+
+// True if a span of 'count' pixels at 'pDst' may draw over the texture
+//  page at 'TBA_' or the CLUT at 'CBA_'. The scalar loops then see texels
+//  written earlier in the same span, fetching 8 at a time wouldn't.
+template<int TEXTMODE>
+GPU_INLINE bool gpuSpanOverlapsTextureSSE2(const u16 *pDst, u32 count,
+		const u16 *TBA_, const u16 *CBA_)
+{
+	u32 d = pDst - gpu_unai.vram, dx = d & 1023;
+	u32 t = TBA_ - gpu_unai.vram, tx = t & 1023;
+	u32 tw = TEXTMODE==1 ? 64 : TEXTMODE==2 ? 128 : 256;
+	if ((d >> 10) - (t >> 10) < 256 && dx < tx + tw && tx < dx + count)
+		return true;
+	if (TEXTMODE!=3) {
+		u32 c = CBA_ - gpu_unai.vram, cx = c & 1023;
+		u32 cw = TEXTMODE==1 ? 16 : 256;
+		if ((d >> 10) == (c >> 10) && dx < cx + cw && cx < dx + count)
+			return true;
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Draws 8 pixels of color 'uSrc' at 'pDst' like the scalar span loops do:
+//  mask bit check, texture transparency, lighting (textured only, with the
+//  light in 'r5','g5','b5'), blending and mask bit set. Pixels that are
+//  skipped are written back unchanged.
+template<int CF>
+GPU_INLINE void gpuPixelsSSE2(u16 *pDst, __m128i uSrc, __m128i r5, __m128i g5, __m128i b5)
+{
+	// Same as the scalar loops, see gpuPolySpanFn()
+	const bool skip_uSrc_mask = (!CF_TEXTMODE) || CF_LIGHT;
+	const __m128i msb = _mm_set1_epi16((short)0x8000);
+	__m128i uDst, skip, srcMSB;
+
+	if (!CF_TEXTMODE && !CF_MASKCHECK && !CF_BLEND) {
+		if (CF_MASKSET) uSrc = _mm_or_si128(uSrc, msb);
+		_mm_storeu_si128((__m128i *)pDst, uSrc);
+		return;
+	}
+
+	uDst = _mm_loadu_si128((const __m128i *)pDst);
+	skip = _mm_setzero_si128();
+	if (CF_MASKCHECK)
+		skip = _mm_srai_epi16(uDst, 15);
+	if (CF_TEXTMODE)
+		skip = _mm_or_si128(skip, _mm_cmpeq_epi16(uSrc, _mm_setzero_si128()));
+
+	if (CF_TEXTMODE && (CF_BLEND || CF_LIGHT))
+		srcMSB = _mm_and_si128(uSrc, msb);
+
+	if (CF_TEXTMODE && CF_LIGHT)
+		uSrc = gpuLightingTXTSSE2(uSrc, r5, g5, b5);
+
+	if (CF_BLEND) {
+		__m128i mix = gpuBlendingSSE2<CF_BLENDMODE, skip_uSrc_mask>(uSrc, uDst);
+		if (CF_TEXTMODE)
+			uSrc = GPU_SSE2_SELECT(_mm_srai_epi16(srcMSB, 15), mix, uSrc);
+		else
+			uSrc = mix;
+	}
+
+	if (CF_MASKSET)
+		uSrc = _mm_or_si128(uSrc, msb);
+	else if (CF_TEXTMODE && (CF_BLEND || CF_LIGHT))
+		uSrc = _mm_or_si128(uSrc, srcMSB);
+
+	_mm_storeu_si128((__m128i *)pDst, GPU_SSE2_SELECT(skip, uDst, uSrc));
+}
+
+#endif /* __GPU_UNAI_GPU_INNER_SSE2_H__ */
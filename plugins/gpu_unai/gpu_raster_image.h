@@ -87,6 +87,21 @@ void gpuMoveImage(PtrUnion packet)
 
 	if( (x0==x1) && (y0==y1) ) return;
 	if ((w0<=0) || (h0<=0)) return;
+
+#ifdef GPU_UNAI_BANDS
+	// Only copy to the lines of the band being drawn (gpulib never draws
+	//  copies wrapping around vram in bands)
+	if (y1 + h0 <= 512) {
+		if ((s32)y1 < gpu_unai.BandLines[0]) {
+			s32 skip = gpu_unai.BandLines[0] - y1;
+			y0 += skip;  y1 += skip;  h0 -= skip;
+		}
+		if ((s32)(y1 + h0) > gpu_unai.BandLines[1]) h0 = gpu_unai.BandLines[1] - y1;
+		if (h0 <= 0) return;
+	}
+#endif
+
+	pcsx4all_prof_pixels(PCSX4ALL_PROF_IMAGE, w0 * h0);
 	
 	#ifdef ENABLE_GPU_LOG_SUPPORT
 		fprintf(stdout,"gpuMoveImage(x0=%u,y0=%u,x1=%u,y1=%u,w0=%d,h0=%d)\n",x0,y0,x1,y1,w0,h0);
@@ -170,9 +185,15 @@ void gpuClearImage(PtrUnion packet)
 	h0 += y0;
 	if (y0 < 0) y0 = 0;
 	if (h0 > FRAME_HEIGHT) h0 = FRAME_HEIGHT;
+#ifdef GPU_UNAI_BANDS
+	if (y0 < gpu_unai.BandLines[0]) y0 = gpu_unai.BandLines[0];
+	if (h0 > gpu_unai.BandLines[1]) h0 = gpu_unai.BandLines[1];
+#endif
 	h0 -= y0;
 	if (h0 <= 0) return;
 
+	pcsx4all_prof_pixels(PCSX4ALL_PROF_FILL, w0 * h0);
+
 	#ifdef ENABLE_GPU_LOG_SUPPORT
 		fprintf(stdout,"gpuClearImage(x0=%d,y0=%d,w0=%d,h0=%d)\n",x0,y0,w0,h0);
 	#endif
@@ -169,6 +169,8 @@ void gpuDrawLineF(PtrUnion packet, const PSD gpuPixelSpanDriver)
 
 	// IMPORTANT: dx,dy should now contain their absolute values
 
+	pcsx4all_prof_pixels(PCSX4ALL_PROF_LINE, (dx > dy ? dx : dy) + 1);
+
 	int min_length,    // Minimum length of a pixel run
 	    start_length,  // Length of first run
 	    end_length,    // Length of last run
@@ -507,6 +509,8 @@ void gpuDrawLineG(PtrUnion packet, const PSD gpuPixelSpanDriver)
 
 	// IMPORTANT: dx,dy should now contain their absolute values
 
+	pcsx4all_prof_pixels(PCSX4ALL_PROF_LINE, (dx > dy ? dx : dy) + 1);
+
 	int min_length,    // Minimum length of a pixel run
 	    start_length,  // Length of first run
 	    end_length,    // Length of last run
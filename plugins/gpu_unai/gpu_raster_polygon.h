@@ -329,6 +329,9 @@ void gpuDrawPolyF(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_quad
 			s32 xmin, xmax, ymin, ymax;
 			xmin = gpu_unai.DrawingArea[0];  xmax = gpu_unai.DrawingArea[2];
 			ymin = gpu_unai.DrawingArea[1];  ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+			ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);  ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 			if ((ymin - ya) > 0) {
 				x3 += (dx3 * (ymin - ya));
@@ -356,8 +359,10 @@ void gpuDrawPolyF(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_quad
 				xa = FixedCeilToInt(x3);  xb = FixedCeilToInt(x4);
 				if ((xmin - xa) > 0) xa = xmin;
 				if (xb > xmax) xb = xmax;
-				if ((xb - xa) > 0)
+				if ((xb - xa) > 0) {
+					pcsx4all_prof_pixels(PCSX4ALL_PROF_POLY, xb - xa);
 					gpuPolySpanDriver(gpu_unai, PixelBase + xa, (xb - xa));
+				}
 			}
 		}
 	} while (++cur_pass < total_passes);
@@ -637,6 +642,9 @@ void gpuDrawPolyFT(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_qua
 			s32 xmin, xmax, ymin, ymax;
 			xmin = gpu_unai.DrawingArea[0];  xmax = gpu_unai.DrawingArea[2];
 			ymin = gpu_unai.DrawingArea[1];  ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+			ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);  ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 			if ((ymin - ya) > 0) {
 				x3 += dx3 * (ymin - ya);
@@ -689,8 +697,10 @@ void gpuDrawPolyFT(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_qua
 				gpu_unai.v = v4;
 
 				if (xb > xmax) xb = xmax;
-				if ((xb - xa) > 0)
+				if ((xb - xa) > 0) {
+					pcsx4all_prof_pixels(PCSX4ALL_PROF_POLY, xb - xa);
 					gpuPolySpanDriver(gpu_unai, PixelBase + xa, (xb - xa));
+				}
 			}
 		}
 	} while (++cur_pass < total_passes);
@@ -981,6 +991,9 @@ void gpuDrawPolyG(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_quad
 			s32 xmin, xmax, ymin, ymax;
 			xmin = gpu_unai.DrawingArea[0];  xmax = gpu_unai.DrawingArea[2];
 			ymin = gpu_unai.DrawingArea[1];  ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+			ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);  ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 			if ((ymin - ya) > 0) {
 				x3 += (dx3 * (ymin - ya));
@@ -1037,8 +1050,10 @@ void gpuDrawPolyG(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_quad
 				gpu_unai.gCol = gpuPackGouraudCol(r4, g4, b4);
 
 				if (xb > xmax) xb = xmax;
-				if ((xb - xa) > 0)
+				if ((xb - xa) > 0) {
+					pcsx4all_prof_pixels(PCSX4ALL_PROF_POLY, xb - xa);
 					gpuPolySpanDriver(gpu_unai, PixelBase + xa, (xb - xa));
+				}
 			}
 		}
 	} while (++cur_pass < total_passes);
@@ -1374,6 +1389,9 @@ void gpuDrawPolyGT(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_qua
 			s32 xmin, xmax, ymin, ymax;
 			xmin = gpu_unai.DrawingArea[0];  xmax = gpu_unai.DrawingArea[2];
 			ymin = gpu_unai.DrawingArea[1];  ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+			ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);  ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 			if ((ymin - ya) > 0) {
 				x3 += (dx3 * (ymin - ya));
@@ -1443,8 +1461,10 @@ void gpuDrawPolyGT(const PtrUnion packet, const PP gpuPolySpanDriver, u32 is_qua
 				gpu_unai.gCol = gpuPackGouraudCol(r4, g4, b4);
 
 				if (xb > xmax) xb = xmax;
-				if ((xb - xa) > 0)
+				if ((xb - xa) > 0) {
+					pcsx4all_prof_pixels(PCSX4ALL_PROF_POLY, xb - xa);
 					gpuPolySpanDriver(gpu_unai, PixelBase + xa, (xb - xa));
+				}
 			}
 		}
 	} while (++cur_pass < total_passes);
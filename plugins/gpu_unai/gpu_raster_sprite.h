@@ -43,6 +43,9 @@ void gpuDrawS(PtrUnion packet, const PS gpuSpriteSpanDriver)
 	s32 xmin, xmax, ymin, ymax;
 	xmin = gpu_unai.DrawingArea[0];	xmax = gpu_unai.DrawingArea[2];
 	ymin = gpu_unai.DrawingArea[1];	ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+	ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);	ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 	u0 = packet.U1[8];
 	v0 = packet.U1[9];
@@ -76,8 +79,10 @@ void gpuDrawS(PtrUnion packet, const PS gpuSpriteSpanDriver)
 
 	for (; y0<y1; ++y0) {
 		u8* pTxt = pTxt_base + ((v0 & v0_mask) * 2048);
-		if (!(y0&li) && (y0&pi)!=pif)
+		if (!(y0&li) && (y0&pi)!=pif) {
+			pcsx4all_prof_pixels(PCSX4ALL_PROF_SPRITE, x1);
 			gpuSpriteSpanDriver(Pixel, x1, pTxt, u0);
+		}
 		Pixel += FRAME_WIDTH;
 		v0++;
 	}
@@ -103,6 +108,9 @@ void gpuDrawS16(PtrUnion packet)
 
 	xmin = gpu_unai.DrawingArea[0];	xmax = gpu_unai.DrawingArea[2];
 	ymin = gpu_unai.DrawingArea[1];	ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+	ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);	ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 	u0 = packet.U1[8];
 	v0 = packet.U1[9];
 
@@ -121,9 +129,10 @@ void gpuDrawS16(PtrUnion packet)
 		v0 += ymin - y0;
 		y0 = ymin;
 	}
-	else if (ymax - y0 < 16)
+	if (ymax - y0 < (s32)h)
 		h = ymax - y0;
 
+	pcsx4all_prof_pixels(PCSX4ALL_PROF_SPRITE, 16 * h);
 	draw_spr16_full(&gpu_unai.vram[FRAME_OFFSET(x0, y0)], &gpu_unai.TBA[FRAME_OFFSET(u0/4, v0)], gpu_unai.CBA, h);
 }
 #endif // __arm__
@@ -144,6 +153,9 @@ void gpuDrawT(PtrUnion packet, const PT gpuTileSpanDriver)
 	s32 xmin, xmax, ymin, ymax;
 	xmin = gpu_unai.DrawingArea[0];	xmax = gpu_unai.DrawingArea[2];
 	ymin = gpu_unai.DrawingArea[1];	ymax = gpu_unai.DrawingArea[3];
+#ifdef GPU_UNAI_BANDS
+	ymin = Max2(ymin, (s32)gpu_unai.BandLines[0]);	ymax = Min2(ymax, (s32)gpu_unai.BandLines[1]);
+#endif
 
 	if (y0 < ymin) y0 = ymin;
 	if (y1 > ymax) y1 = ymax;
@@ -161,8 +173,10 @@ void gpuDrawT(PtrUnion packet, const PT gpuTileSpanDriver)
 	const int pif=(ProgressiveInterlaceEnabled()?(gpu_unai.prog_ilace_flag?(gpu_unai.ilace_mask+1):0):1);
 
 	for (; y0<y1; ++y0) {
-		if (!(y0&li) && (y0&pi)!=pif)
+		if (!(y0&li) && (y0&pi)!=pif) {
+			pcsx4all_prof_pixels(PCSX4ALL_PROF_SPRITE, x1);
 			gpuTileSpanDriver(Pixel,x1,Data);
+		}
 		Pixel += FRAME_WIDTH;
 	}
 }
@@ -42,6 +42,13 @@
 //#define GPU_UNAI_USE_INT_DIV_MULTINV   // If GPU_UNAI_USE_FLOATMATH is *not*
                                          //  defined, use old inaccurate division
 
+// Draw in horizontal bands on gpulib's band threads (gpulib_if.cpp), where
+//  gpulib has threads
+#if defined(USE_GPULIB) && !defined(_WIN32) && !defined(NO_OS) && \
+    !defined(GPULIB_NO_THREAD)
+#define GPU_UNAI_BANDS
+#endif
+
 
 #define GPU_INLINE static inline __attribute__((always_inline))
 #define INLINE     static inline __attribute__((always_inline))
@@ -197,6 +204,11 @@ struct gpu_unai_t {
 	s16 DrawingOffset[2];  // [0] : Drawing offset X (signed)
 	                       // [1] : Drawing offset Y (signed)
 
+	u16 BandLines[2];      // [0] : First line this state may draw to
+	                       // [1] : Last line + 1. Only narrower than the
+	                       //  whole of VRAM when drawing in bands, on top
+	                       //  of DrawingArea (see gpulib_if.cpp)
+
 	u16* TBA;              // Ptr to current texture in VRAM
 	u16* CBA;              // Ptr to current CLUT in VRAM
 
@@ -255,7 +267,16 @@ struct gpu_unai_t {
 	u32 DitherMatrix[64];   // Matrix of dither coefficients
 };
 
+#ifdef GPU_UNAI_BANDS
+// Each band thread draws with a copy of its own, everything else uses
+//  gpu_unai_main
+static gpu_unai_t gpu_unai_main;
+static __thread gpu_unai_t *gpu_unai_cur
+	__attribute__((tls_model("initial-exec"))) = &gpu_unai_main;
+#define gpu_unai (*gpu_unai_cur)
+#else
 static gpu_unai_t gpu_unai;
+#endif
 
 // Global config that frontend can alter.. Values are read in GPU_init().
 // TODO: if frontend menu modifies a setting, add a function that can notify
@@ -25,15 +25,31 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../gpulib/gpu.h"
+#include "../../frontend/plugin_lib.h"
+
+// Frontend settings for gpu_unai. Taken out before including gpu_unai.h,
+//  which may make gpu_unai stand for the drawing state in use
+typedef decltype(rearmed_cbs::gpu_unai) gpu_unai_cbs_t;
+static inline const gpu_unai_cbs_t *gpu_unai_cbs(const struct rearmed_cbs *cbs)
+{
+  return &cbs->gpu_unai;
+}
+
 //#include "port.h"
 #include "gpu_unai.h"
 
+// Per-primitive profiling hooks
+#include "profiler.h"
+
 // GPU fixed point math
 #include "gpu_fixedpoint.h"
 
 // Inner loop driver instantiation file
 #include "gpu_inner.h"
 
+// GPU runtime-compiled span functions, span driver selection
+#include "gpu_inner_jit.h"
+
 // GPU internal image drawing functions
 #include "gpu_raster_image.h"
 
@@ -203,10 +219,81 @@ static void unmap_downscale_buffer(void)
   gpu.get_downscale_buffer = NULL;
 }
 
+#ifdef GPU_UNAI_BANDS
+/*
+ * Band-parallel drawing (gpulib calls these, see gpu.h). Band 0 is drawn
+ * by gpu_unai_main on the calling thread, the others by copies of it that
+ * their threads switch gpu_unai to. Each clips what it draws to its own
+ * lines with BandLines.
+ */
+static gpu_unai_t *band_unai[GPU_BANDS_MAX];
+
+static void band_unai_free(void)
+{
+  int i;
+
+  for (i = 1; i < GPU_BANDS_MAX; i++) {
+    free(band_unai[i]);
+    band_unai[i] = NULL;
+  }
+}
+
+static int band_begin(int count)
+{
+  gpu_unai_t *p;
+  int i;
+
+  // spans compiled by the jit address gpu_unai_main directly, and the
+  //  profiler counters aren't shared safely
+#ifdef GPU_UNAI_JIT
+  if (gpu_unai.config.jit)
+    return 0;
+#endif
+  if (gpu_unai_prof.timing)
+    return 0;
+
+  for (i = 1; i < count; i++) {
+    p = band_unai[i];
+    if (p == NULL) {
+      p = (gpu_unai_t *)malloc(sizeof(*p));
+      if (p == NULL)
+        return 0;
+      memcpy((void*)p, &gpu_unai_main, sizeof(*p));
+      band_unai[i] = p;
+    }
+    // the lookup tables at the end never change after init
+    memcpy((void*)p, &gpu_unai_main, offsetof(gpu_unai_t, LightLUT));
+  }
+  return count;
+}
+
+static void band_draw(int band, uint32_t *list, int count,
+ const uint32_t *ecmds, int y0, int y1)
+{
+  int dummy;
+
+  // band copies start from what gpu_unai_main had in band_begin, which
+  //  is what ecmds hold
+  if (band)
+    gpu_unai_cur = band_unai[band];
+  gpu_unai.BandLines[0] = y0;
+  gpu_unai.BandLines[1] = y1 < 512 ? y1 : 1024; // as far as serially
+  do_cmd_list(list, count, &dummy);
+}
+
+static void band_end(int count)
+{
+  gpu_unai_main.BandLines[0] = 0;
+  gpu_unai_main.BandLines[1] = 1024;
+}
+#endif
+
 int renderer_init(void)
 {
   memset((void*)&gpu_unai, 0, sizeof(gpu_unai));
   gpu_unai.vram = (u16*)gpu.vram;
+  gpu_unai.BandLines[0] = 0;
+  gpu_unai.BandLines[1] = 1024;
 
   // Original standalone gpu_unai initialized TextureWindow[]. I added the
   //  same behavior here, since it seems unsafe to leave [2],[3] unset when
@@ -250,12 +337,29 @@ int renderer_init(void)
     map_downscale_buffer();
   }
 
+#ifdef GPU_UNAI_BANDS
+  band_unai_free();
+  gpu.band_begin = band_begin;
+  gpu.band_draw = band_draw;
+  gpu.band_end = band_end;
+#endif
+
   return 0;
 }
 
 void renderer_finish(void)
 {
   unmap_downscale_buffer();
+#ifdef GPU_UNAI_JIT
+  gpuJitFinish();
+#endif
+  gpu.frame_end = NULL;
+#ifdef GPU_UNAI_BANDS
+  gpu.band_begin = NULL;
+  gpu.band_draw = NULL;
+  gpu.band_end = NULL;
+  band_unai_free();
+#endif
 }
 
 void renderer_notify_res_change(void)
@@ -301,12 +405,20 @@ void renderer_notify_res_change(void)
 }
 
 #ifdef USE_GPULIB
+// Only the main state keeps gpulib's registers, not the band copies
+#ifdef GPU_UNAI_BANDS
+#define gpuOwnsGpulibState() (gpu_unai_cur == &gpu_unai_main)
+#else
+#define gpuOwnsGpulibState() true
+#endif
+
 // Handles GP0 draw settings commands 0xE1...0xE6
-static void gpuGP0Cmd_0xEx(gpu_unai_t &gpu_unai, u32 cmd_word)
+static void gpuGP0Cmd_0xEx(u32 cmd_word)
 {
   // Assume incoming GP0 command is 0xE1..0xE6, convert to 1..6
   u8 num = (cmd_word >> 24) & 7;
-  gpu.ex_regs[num] = cmd_word; // Update gpulib register
+  if (gpuOwnsGpulibState())
+    gpu.ex_regs[num] = cmd_word; // Update gpulib register
   switch (num) {
     case 1: {
       // GP0(E1h) - Draw Mode setting (aka "Texpage")
@@ -371,11 +483,27 @@ static void gpuGP0Cmd_0xEx(gpu_unai_t &gpu_unai, u32 cmd_word)
 
 extern const unsigned char cmd_lengths[256];
 
+// Primitive class a command is profiled as, see profiler.h
+static inline int gpuProfClass(u32 cmd)
+{
+  switch (cmd >> 5) {
+    case 0: return cmd == 0x02 ? PCSX4ALL_PROF_FILL : PCSX4ALL_PROF_GPU;
+    case 1: return PCSX4ALL_PROF_POLY;
+    case 2: return PCSX4ALL_PROF_LINE;
+    case 3: return PCSX4ALL_PROF_SPRITE;
+    case 4: return cmd == 0x80 ? PCSX4ALL_PROF_IMAGE : PCSX4ALL_PROF_GPU;
+    default: return PCSX4ALL_PROF_GPU;
+  }
+}
+
 int do_cmd_list(u32 *list, int list_len, int *last_cmd)
 {
   u32 cmd = 0, len, i;
   u32 *list_start = list;
   u32 *list_end = list + list_len;
+  int prof = PCSX4ALL_PROF_GPU;
+
+  pcsx4all_prof_resume(PCSX4ALL_PROF_GPU);
 
   //TODO: set ilace_mask when resolution changes instead of every time,
   // eliminate #ifdef below.
@@ -404,6 +532,10 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
 
     PtrUnion packet = { .ptr = (void*)&gpu_unai.PacketBuffer };
 
+    prof = gpuProfClass(cmd);
+    if (prof != PCSX4ALL_PROF_GPU)
+      pcsx4all_prof_start_with_pause(prof, PCSX4ALL_PROF_GPU);
+
     switch (cmd)
     {
       case 0x02:
@@ -414,11 +546,11 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x21:
       case 0x22:
       case 0x23: {          // Monochrome 3-pt poly
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Blending_Mode |
           gpu_unai.Masking | Blending | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyF(packet, driver, false);
       } break;
 
@@ -442,7 +574,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
             driver_idx |= Lighting;
         }
 
-        PP driver = gpuPolySpanDrivers[driver_idx];
+        PP driver = gpuGetPolySpanDriver(driver_idx);
         gpuDrawPolyFT(packet, driver, false);
       } break;
 
@@ -450,11 +582,11 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x29:
       case 0x2A:
       case 0x2B: {          // Monochrome 4-pt poly
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Blending_Mode |
           gpu_unai.Masking | Blending | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyF(packet, driver, true); // is_quad = true
       } break;
 
@@ -478,7 +610,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
             driver_idx |= Lighting;
         }
 
-        PP driver = gpuPolySpanDrivers[driver_idx];
+        PP driver = gpuGetPolySpanDriver(driver_idx);
         gpuDrawPolyFT(packet, driver, true); // is_quad = true
       } break;
 
@@ -490,12 +622,12 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
         // this is an untextured poly, so CF_LIGHT (texture blend)
         // shouldn't apply. Until the original array of template
         // instantiation ptrs is fixed, we're stuck with this. (TODO)
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Dithering |
           Blending_Mode |
           gpu_unai.Masking | Blending | 129 | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyG(packet, driver, false);
       } break;
 
@@ -505,12 +637,12 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x37: {          // Gouraud-shaded, textured 3-pt poly
         gpuSetCLUT    (gpu_unai.PacketBuffer.U4[2] >> 16);
         gpuSetTexture (gpu_unai.PacketBuffer.U4[5] >> 16);
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Dithering |
           Blending_Mode | gpu_unai.TEXT_MODE |
           gpu_unai.Masking | Blending | ((Lighting)?129:0) | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyGT(packet, driver, false);
       } break;
 
@@ -519,12 +651,12 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x3A:
       case 0x3B: {          // Gouraud-shaded 4-pt poly
         // See notes regarding '129' for 0x30..0x33 further above -senquack
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Dithering |
           Blending_Mode |
           gpu_unai.Masking | Blending | 129 | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyG(packet, driver, true); // is_quad = true
       } break;
 
@@ -534,12 +666,12 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x3F: {          // Gouraud-shaded, textured 4-pt poly
         gpuSetCLUT    (gpu_unai.PacketBuffer.U4[2] >> 16);
         gpuSetTexture (gpu_unai.PacketBuffer.U4[5] >> 16);
-        PP driver = gpuPolySpanDrivers[
+        PP driver = gpuGetPolySpanDriver(
           (gpu_unai.blit_mask?1024:0) |
           Dithering |
           Blending_Mode | gpu_unai.TEXT_MODE |
           gpu_unai.Masking | Blending | ((Lighting)?129:0) | gpu_unai.PixelMSB
-        ];
+        );
         gpuDrawPolyGT(packet, driver, true); // is_quad = true
       } break;
 
@@ -627,7 +759,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x61:
       case 0x62:
       case 0x63: {          // Monochrome rectangle (variable size)
-        PT driver = gpuTileSpanDrivers[(Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1];
+        PT driver = gpuGetTileSpanDriver((Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1);
         gpuDrawT(packet, driver);
       } break;
 
@@ -654,7 +786,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
         // Strip lower 3 bits of each color and determine if lighting should be used:
         if ((gpu_unai.PacketBuffer.U4[0] & 0xF8F8F8) != 0x808080)
           driver_idx |= Lighting;
-        PS driver = gpuSpriteSpanDrivers[driver_idx];
+        PS driver = gpuGetSpriteSpanDriver(driver_idx);
         gpuDrawS(packet, driver);
       } break;
 
@@ -663,7 +795,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x6A:
       case 0x6B: {          // Monochrome rectangle (1x1 dot)
         gpu_unai.PacketBuffer.U4[2] = 0x00010001;
-        PT driver = gpuTileSpanDrivers[(Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1];
+        PT driver = gpuGetTileSpanDriver((Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1);
         gpuDrawT(packet, driver);
       } break;
 
@@ -672,7 +804,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x72:
       case 0x73: {          // Monochrome rectangle (8x8)
         gpu_unai.PacketBuffer.U4[2] = 0x00080008;
-        PT driver = gpuTileSpanDrivers[(Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1];
+        PT driver = gpuGetTileSpanDriver((Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1);
         gpuDrawT(packet, driver);
       } break;
 
@@ -689,7 +821,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
         // Strip lower 3 bits of each color and determine if lighting should be used:
         if ((gpu_unai.PacketBuffer.U4[0] & 0xF8F8F8) != 0x808080)
           driver_idx |= Lighting;
-        PS driver = gpuSpriteSpanDrivers[driver_idx];
+        PS driver = gpuGetSpriteSpanDriver(driver_idx);
         gpuDrawS(packet, driver);
       } break;
 
@@ -698,7 +830,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
       case 0x7A:
       case 0x7B: {          // Monochrome rectangle (16x16)
         gpu_unai.PacketBuffer.U4[2] = 0x00100010;
-        PT driver = gpuTileSpanDrivers[(Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1];
+        PT driver = gpuGetTileSpanDriver((Blending_Mode | gpu_unai.Masking | Blending | (gpu_unai.PixelMSB>>3)) >> 1);
         gpuDrawT(packet, driver);
       } break;
 
@@ -723,7 +855,7 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
         // Strip lower 3 bits of each color and determine if lighting should be used:
         if ((gpu_unai.PacketBuffer.U4[0] & 0xF8F8F8) != 0x808080)
           driver_idx |= Lighting;
-        PS driver = gpuSpriteSpanDrivers[driver_idx];
+        PS driver = gpuGetSpriteSpanDriver(driver_idx);
         gpuDrawS(packet, driver);
       } break;
 
@@ -750,14 +882,24 @@ int do_cmd_list(u32 *list, int list_len, int *last_cmd)
         goto breakloop;
 #endif
       case 0xE1 ... 0xE6: { // Draw settings
-        gpuGP0Cmd_0xEx(gpu_unai, gpu_unai.PacketBuffer.U4[0]);
+        gpuGP0Cmd_0xEx(gpu_unai.PacketBuffer.U4[0]);
       } break;
     }
+
+    if (prof != PCSX4ALL_PROF_GPU) {
+      pcsx4all_prof_end_with_resume(prof, PCSX4ALL_PROF_GPU);
+      prof = PCSX4ALL_PROF_GPU;
+    }
   }
 
 breakloop:
-  gpu.ex_regs[1] &= ~0x1ff;
-  gpu.ex_regs[1] |= gpu_unai.GPU_GP1 & 0x1ff;
+  // a line strip running off the end of the list may still be timed
+  pcsx4all_prof_pause(prof);
+
+  if (gpuOwnsGpulibState()) {
+    gpu.ex_regs[1] &= ~0x1ff;
+    gpu.ex_regs[1] |= gpu_unai.GPU_GP1 & 0x1ff;
+  }
 
   *last_cmd = cmd;
   return list - list_start;
@@ -781,18 +923,57 @@ void renderer_set_interlace(int enable, int is_odd)
 {
 }
 
-#include "../../frontend/plugin_lib.h"
+static void (*stats_cb)(const struct gpu_unai_stats *s);
+
+static void stats_frame_end(void)
+{
+  struct gpu_unai_stats s;
+  const u32 *c = gpu_unai_prof.calls, *px = gpu_unai_prof.pixels;
+  const uint64_t *t = gpu_unai_prof.time_ns;
+
+  s.polys       = c[PCSX4ALL_PROF_POLY];
+  s.sprites     = c[PCSX4ALL_PROF_SPRITE];
+  s.lines       = c[PCSX4ALL_PROF_LINE];
+  s.fills       = c[PCSX4ALL_PROF_FILL];
+  s.image_moves = c[PCSX4ALL_PROF_IMAGE];
+  s.px_polys       = px[PCSX4ALL_PROF_POLY];
+  s.px_sprites     = px[PCSX4ALL_PROF_SPRITE];
+  s.px_lines       = px[PCSX4ALL_PROF_LINE];
+  s.px_fills       = px[PCSX4ALL_PROF_FILL];
+  s.px_image_moves = px[PCSX4ALL_PROF_IMAGE];
+  s.us_polys       = t[PCSX4ALL_PROF_POLY] / 1000;
+  s.us_sprites     = t[PCSX4ALL_PROF_SPRITE] / 1000;
+  s.us_lines       = t[PCSX4ALL_PROF_LINE] / 1000;
+  s.us_fills       = t[PCSX4ALL_PROF_FILL] / 1000;
+  s.us_image_moves = t[PCSX4ALL_PROF_IMAGE] / 1000;
+  s.us_other       = t[PCSX4ALL_PROF_GPU] / 1000;
+
+  memset(gpu_unai_prof.calls, 0, sizeof(gpu_unai_prof.calls));
+  memset(gpu_unai_prof.pixels, 0, sizeof(gpu_unai_prof.pixels));
+  memset(gpu_unai_prof.time_ns, 0, sizeof(gpu_unai_prof.time_ns));
+
+  if (stats_cb)
+    stats_cb(&s);
+}
+
 // Handle any gpulib settings applicable to gpu_unai:
 void renderer_set_config(const struct rearmed_cbs *cbs)
 {
+  const gpu_unai_cbs_t *c = gpu_unai_cbs(cbs);
+
   gpu_unai.vram = (u16*)gpu.vram;
-  gpu_unai.config.ilace_force   = cbs->gpu_unai.ilace_force;
-  gpu_unai.config.pixel_skip    = cbs->gpu_unai.pixel_skip;
-  gpu_unai.config.lighting      = cbs->gpu_unai.lighting;
-  gpu_unai.config.fast_lighting = cbs->gpu_unai.fast_lighting;
-  gpu_unai.config.blending      = cbs->gpu_unai.blending;
-  gpu_unai.config.dithering     = cbs->gpu_unai.dithering;
-  gpu_unai.config.scale_hires   = cbs->gpu_unai.scale_hires;
+  gpu_unai.config.ilace_force   = c->ilace_force;
+  gpu_unai.config.pixel_skip    = c->pixel_skip;
+  gpu_unai.config.lighting      = c->lighting;
+  gpu_unai.config.fast_lighting = c->fast_lighting;
+  gpu_unai.config.blending      = c->blending;
+  gpu_unai.config.dithering     = c->dithering;
+  gpu_unai.config.jit           = c->jit;
+  gpu_unai.config.scale_hires   = c->scale_hires;
+
+  stats_cb = c->stats;
+  gpu_unai_prof.timing = stats_cb != NULL;
+  gpu.frame_end = stats_cb ? stats_frame_end : NULL;
 
   gpu.state.downscale_enable    = gpu_unai.config.scale_hires;
   if (gpu_unai.config.scale_hires) {
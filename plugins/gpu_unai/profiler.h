@@ -1,9 +1,75 @@
 #ifndef __GPU_UNAI_GPU_PROFILER_H__
 #define __GPU_UNAI_GPU_PROFILER_H__
 
-#define pcsx4all_prof_pause(...)
-#define pcsx4all_prof_start_with_pause(...)
-#define pcsx4all_prof_end_with_resume(...)
-#define pcsx4all_prof_resume(...)
+///////////////////////////////////////////////////////////////////////////////
+//  Per-primitive profiling
+//
+//  The pcsx4all_prof_* hooks count the commands of each primitive class and
+//  the pixels they draw, and take host time, when 'timing' is set, which
+//  gpulib_if.cpp does when the frontend wants the stats (and then doesn't
+//  draw in bands, nothing here is thread safe). Classes nest: time
+//  is accounted to the innermost started one, the outer one is paused
+//  meanwhile. PCSX4ALL_PROF_GPU is what's left of command list processing.
+
+#include <stdint.h>
+#include <time.h>
+
+enum {
+	PCSX4ALL_PROF_GPU,
+	PCSX4ALL_PROF_POLY,
+	PCSX4ALL_PROF_SPRITE,     // rectangles, textured or not
+	PCSX4ALL_PROF_LINE,
+	PCSX4ALL_PROF_FILL,       // GP0(02h)
+	PCSX4ALL_PROF_IMAGE,      // GP0(80h) VRAM copies
+	PCSX4ALL_PROF_COUNT
+};
+
+struct gpu_unai_prof_t {
+	u32 calls[PCSX4ALL_PROF_COUNT];
+	u32 pixels[PCSX4ALL_PROF_COUNT];
+	uint64_t time_ns[PCSX4ALL_PROF_COUNT];
+	uint64_t start_ns[PCSX4ALL_PROF_COUNT];
+	bool timing;
+};
+
+static gpu_unai_prof_t gpu_unai_prof;
+
+static inline uint64_t gpu_unai_prof_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static inline void gpu_unai_prof_switch(int from, int to)
+{
+	uint64_t now = gpu_unai_prof_ns();
+	gpu_unai_prof.time_ns[from] += now - gpu_unai_prof.start_ns[from];
+	gpu_unai_prof.start_ns[to] = now;
+}
+
+#define pcsx4all_prof_pause(id) \
+	do { if (gpu_unai_prof.timing) \
+		gpu_unai_prof.time_ns[id] += gpu_unai_prof_ns() - gpu_unai_prof.start_ns[id]; \
+	} while (0)
+
+#define pcsx4all_prof_resume(id) \
+	do { if (gpu_unai_prof.timing) \
+		gpu_unai_prof.start_ns[id] = gpu_unai_prof_ns(); \
+	} while (0)
+
+#define pcsx4all_prof_start_with_pause(id, paused_id) \
+	do { if (gpu_unai_prof.timing) { \
+		gpu_unai_prof.calls[id]++; \
+		gpu_unai_prof_switch(paused_id, id); \
+	} } while (0)
+
+#define pcsx4all_prof_end_with_resume(id, resumed_id) \
+	do { if (gpu_unai_prof.timing) gpu_unai_prof_switch(id, resumed_id); \
+	} while (0)
+
+#define pcsx4all_prof_pixels(id, n) \
+	do { if (gpu_unai_prof.timing) gpu_unai_prof.pixels[id] += (n); \
+	} while (0)
 
 #endif /* __GPU_UNAI_GPU_PROFILER_H__ */
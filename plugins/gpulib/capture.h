@@ -0,0 +1,45 @@
+/*
+ * gpulib command capture format
+ *
+ * A capture starts with struct capture_header, followed by the VRAM
+ * (1024*512 16bit pixels) at the start of the first captured frame,
+ * then records until EOF. A record is a (type << 24) | len word
+ * followed by len payload words. Everything is in host byte order.
+ *
+ * This work is licensed under the terms of any of these licenses
+ * (at your option):
+ *  - GNU GPL, version 2 or later.
+ *  - GNU LGPL, version 2.1 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef __GPULIB_CAPTURE_H__
+#define __GPULIB_CAPTURE_H__
+
+#include <stdint.h>
+
+#define CAPTURE_MAGIC   0x43555047 // "GPUC"
+#define CAPTURE_VERSION 1
+
+struct capture_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t status;
+  uint32_t regs[16];    // GP1 (control) registers
+  uint32_t ex_regs[8];  // GP0 0xe0-0xe7 draw settings
+};
+
+enum capture_record {
+  CAP_GP0 = 1,  // GPUwriteData words
+  CAP_DMA,      // GPUwriteDataMem
+  CAP_CHAIN,    // GPUdmaChain, its nodes follow as CAP_LIST records
+  CAP_LIST,     // one GPUdmaChain node (only those with len > 0)
+  CAP_GP1,      // GPUwriteStatus
+  CAP_READ,     // GPUreadData
+  CAP_READ_MEM, // GPUreadDataMem, payload is the word count
+  CAP_STATUS,   // GPUreadStatus, only recorded if GP0 words were pending
+  CAP_VBLANK,   // GPUvBlank, payload is lcf
+  CAP_FRAME,    // GPUupdateLace
+};
+
+#endif /* __GPULIB_CAPTURE_H__ */
@@ -13,6 +13,14 @@
 #include <stdlib.h> /* for calloc */
 
 #include "gpu.h"
+#include "capture.h"
+
+#if !defined(_WIN32) && !defined(NO_OS) && !defined(GPULIB_NO_THREAD)
+#define GPULIB_THREAD 1
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #ifdef __GNUC__
@@ -37,6 +45,9 @@ struct psx_gpu gpu;
 
 static noinline int do_cmd_buffer(uint32_t *data, int count);
 static void finish_vram_transfer(int is_read);
+static void caches_flush(void);
+static void memo_gp1(uint32_t cmd);
+static void memo_enable(int enable);
 
 static noinline void do_cmd_reset(void)
 {
@@ -87,6 +98,160 @@ static noinline void update_height(void)
   gpu.screen.h = sh;
 }
 
+/*
+ * Only changes to the displayed part of vram need a flip. fb_dirty is
+ * set when something may have touched it, dirty_y1..dirty_y2 are the
+ * vram lines affected since the last flip.
+ */
+static void mark_fb_dirty_all(void)
+{
+  gpu.state.fb_dirty = 1;
+  gpu.state.dirty_y1 = 0;
+  gpu.state.dirty_y2 = 512;
+}
+
+static void mark_fb_dirty(int x, int y, int w, int h)
+{
+  int sx = gpu.screen.x & ~1, sy = gpu.screen.y;
+  int sw = gpu.screen.w + 2, sh = gpu.screen.h;
+
+  if (gpu.status.rgb24)
+    sw = sw * 3 / 2;
+  // wrapping around vram edges, just extend to the full size
+  if (x + w > 1024 || sx + sw > 1024)
+    x = sx = 0, w = sw = 1024;
+  if (y + h > 512 || sy + sh > 512)
+    y = sy = 0, h = sh = 512;
+
+  if (x >= sx + sw || sx >= x + w || y >= sy + sh || sy >= y + h)
+    return;
+
+  if (y < sy)
+    h -= sy - y, y = sy;
+  if (y + h > sy + sh)
+    h = sy + sh - y;
+  if (!gpu.state.fb_dirty) {
+    gpu.state.dirty_y1 = y;
+    gpu.state.dirty_y2 = y + h;
+  }
+  else {
+    if (y < gpu.state.dirty_y1)
+      gpu.state.dirty_y1 = y;
+    if (y + h > gpu.state.dirty_y2)
+      gpu.state.dirty_y2 = y + h;
+  }
+  gpu.state.fb_dirty = 1;
+}
+
+static int fb_dirty_all(void)
+{
+  return gpu.state.fb_dirty && gpu.state.dirty_y1 <= gpu.screen.y
+    && gpu.state.dirty_y2 >= gpu.screen.y + gpu.screen.h;
+}
+
+// see what a command list is about to draw to, before the renderer
+// runs it; primitives are clipped to the drawing area so that is used
+static void cmd_list_mark_dirty(const uint32_t *list, int count)
+{
+  uint32_t e3 = gpu.ex_regs[3], e4 = gpu.ex_regs[4];
+  int area_marked = 0;
+  int cmd, len, pos, v;
+
+  for (pos = 0; pos < count && !fb_dirty_all(); pos += len) {
+    const uint32_t *l = list + pos;
+    cmd = l[0] >> 24;
+    len = 1 + cmd_lengths[cmd];
+
+    switch (cmd) {
+      case 0x02:
+        if (pos + 2 < count)
+          mark_fb_dirty(l[1] & 0x3f0, (l[1] >> 16) & 0x1ff,
+            ((l[2] & 0x3ff) + 0x0f) & ~0x0f, (l[2] >> 16) & 0x1ff);
+        break;
+      case 0x20 ... 0x7f:
+        if ((cmd & 0xf8) == 0x48 || (cmd & 0xf8) == 0x58) {
+          // polyline, find the terminator
+          int step = (cmd & 0x10) ? 2 : 1;
+          for (v = (cmd & 0x10) ? 4 : 3; pos + v < count; v += step)
+            if ((l[v] & 0xf000f000) == 0x50005000)
+              break;
+          len += v - ((cmd & 0x10) ? 4 : 3);
+        }
+        if (!area_marked) {
+          int x1 = e3 & 0x3ff, y1 = (e3 >> 10) & 0x1ff;
+          int x2 = e4 & 0x3ff, y2 = (e4 >> 10) & 0x1ff;
+          if (x1 <= x2 && y1 <= y2)
+            mark_fb_dirty(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+          area_marked = 1;
+        }
+        break;
+      case 0x80 ... 0x9f:
+        if (pos + 3 < count)
+          mark_fb_dirty(l[2] & 0x3ff, (l[2] >> 16) & 0x1ff,
+            ((l[3] - 1) & 0x3ff) + 1, (((l[3] >> 16) - 1) & 0x1ff) + 1);
+        break;
+      case 0xa0 ... 0xdf:
+        return; // image i/o, do_cmd_buffer handles it
+      case 0xe3:
+        e3 = l[0];
+        area_marked = 0;
+        break;
+      case 0xe4:
+        e4 = l[0];
+        area_marked = 0;
+        break;
+    }
+  }
+}
+
+/*
+ * Adaptive frameskip: the frontend reports how long the host took for
+ * the last frame (cpu and drawing) and how full the audio output buffer
+ * is. The number of frames skipped after each drawn one goes up when the
+ * host falls behind or the audio is running low, and back down once
+ * there is headroom again. The on/off thresholds are set apart and each
+ * change is held for a while, so that it doesn't flicker between levels.
+ */
+#define FSKIP_LOAD_HIGH  (256 * 105 / 100) // of the frame time
+#define FSKIP_LOAD_LOW   (256 * 85 / 100)
+#define FSKIP_AUDIO_LOW  25 // %
+#define FSKIP_AUDIO_HIGH 50
+#define FSKIP_HOLD       15 // frames
+
+static int decide_frameskip_adaptive(void)
+{
+  int frame_us = gpu.status.video ? 20000 : 16667;
+  int host_us = *gpu.frameskip.host_us;
+  int audio = *gpu.frameskip.audio_fill;
+  int behind, ahead;
+
+  if (host_us > 0) {
+    if (host_us > frame_us * 4)
+      host_us = frame_us * 4; // loading and such, don't overreact
+    gpu.frameskip.load += (host_us * 256 / frame_us - gpu.frameskip.load) / 8;
+  }
+  behind = (host_us > 0 && gpu.frameskip.load > FSKIP_LOAD_HIGH)
+    || (audio >= 0 && audio < FSKIP_AUDIO_LOW);
+  ahead = (host_us <= 0 || gpu.frameskip.load < FSKIP_LOAD_LOW)
+    && (audio < 0 || audio >= FSKIP_AUDIO_HIGH);
+
+  if (gpu.frameskip.hold > 0)
+    gpu.frameskip.hold--;
+  else if (behind && gpu.frameskip.level < gpu.frameskip.max) {
+    gpu.frameskip.level++;
+    gpu.frameskip.hold = FSKIP_HOLD;
+  }
+  else if (ahead && gpu.frameskip.level > 0) {
+    gpu.frameskip.level--;
+    gpu.frameskip.hold = FSKIP_HOLD;
+  }
+
+  // about to run dry, skip what's allowed right away
+  if (audio >= 0 && audio < FSKIP_AUDIO_LOW / 2)
+    return gpu.frameskip.cnt < gpu.frameskip.max;
+  return gpu.frameskip.cnt < gpu.frameskip.level;
+}
+
 static noinline void decide_frameskip(void)
 {
   if (gpu.frameskip.active)
@@ -96,15 +261,25 @@ static noinline void decide_frameskip(void)
     gpu.frameskip.frame_ready = 1;
   }
 
-  if (!gpu.frameskip.active && *gpu.frameskip.advice)
+  if (gpu.frameskip.set == -2)
+    gpu.frameskip.active = decide_frameskip_adaptive();
+  else if (!gpu.frameskip.active && *gpu.frameskip.advice)
     gpu.frameskip.active = 1;
   else if (gpu.frameskip.set > 0 && gpu.frameskip.cnt < gpu.frameskip.set)
     gpu.frameskip.active = 1;
   else
     gpu.frameskip.active = 0;
 
+  if (gpu.frameskip.stats) {
+    gpu.frameskip.stats[0]++;
+    gpu.frameskip.stats[1] += gpu.frameskip.active;
+    gpu.frameskip.stats[2] = gpu.frameskip.level;
+  }
+
   if (!gpu.frameskip.active && gpu.frameskip.pending_fill[0] != 0) {
     int dummy;
+    caches_flush();
+    cmd_list_mark_dirty(gpu.frameskip.pending_fill, 3);
     do_cmd_list(gpu.frameskip.pending_fill, 3, &dummy);
     gpu.frameskip.pending_fill[0] = 0;
   }
@@ -240,10 +415,18 @@ long GPUinit(void)
   return ret;
 }
 
+static void gpu_thread_stop(void);
+static void bands_stop(void);
+static void capture_end(void);
+
 long GPUshutdown(void)
 {
   long ret;
 
+  gpu_thread_stop();
+  bands_stop();
+  capture_end();
+  memo_enable(0);
   renderer_finish();
   ret = vout_finish();
 
@@ -259,7 +442,7 @@ long GPUshutdown(void)
   return ret;
 }
 
-void GPUwriteStatus(uint32_t data)
+static void do_write_status(uint32_t data)
 {
 	//senquack TODO: Would it be wise to add cmd buffer flush here, since
 	// status settings can affect commands already in buffer?
@@ -268,14 +451,18 @@ void GPUwriteStatus(uint32_t data)
   static const short vres[4] = { 240, 480, 256, 480 };
   uint32_t cmd = data >> 24;
 
+  memo_gp1(cmd);
+
   if (cmd < ARRAY_SIZE(gpu.regs)) {
     if (cmd > 1 && cmd != 5 && gpu.regs[cmd] == data)
       return;
+    // games tend to rewrite the same display start each frame
+    if (cmd == 0 || (cmd == 5 && gpu.regs[cmd] != data)
+        || cmd == 3 || (6 <= cmd && cmd <= 8))
+      mark_fb_dirty_all();
     gpu.regs[cmd] = data;
   }
 
-  gpu.state.fb_dirty = 1;
-
   switch (cmd) {
     case 0x00:
       do_reset();
@@ -351,15 +538,47 @@ const unsigned char cmd_lengths[256] =
 
 #define VRAM_MEM_XY(x, y) &gpu.vram[(y) * 1024 + (x)]
 
+// GP0(E6) set/check mask bits apply to cpu->vram transfers too
+static noinline void vram_write_mask(uint16_t *d, const uint16_t *s, int l)
+{
+  uint16_t msb = (gpu.ex_regs[6] & 1) << 15;
+  int i;
+
+  if (gpu.ex_regs[6] & 2) {
+    for (i = 0; i < l; i++)
+      if (!(d[i] & 0x8000))
+        d[i] = s[i] | msb;
+  }
+  else {
+    for (i = 0; i < l; i++)
+      d[i] = s[i] | msb;
+  }
+}
+
 static inline void do_vram_line(int x, int y, uint16_t *mem, int l, int is_read)
 {
   uint16_t *vram = VRAM_MEM_XY(x, y);
   if (is_read)
     memcpy(mem, vram, l * 2);
+  else if (unlikely(gpu.ex_regs[6] & 3))
+    vram_write_mask(vram, mem, l);
   else
     memcpy(vram, mem, l * 2);
 }
 
+// lines can wrap around the right edge of vram
+static void do_vram_span(int x, int y, uint16_t *mem, int l, int is_read)
+{
+  x &= 1023;
+  if (unlikely(x + l > 1024)) {
+    do_vram_line(x, y, mem, 1024 - x, is_read);
+    mem += 1024 - x;
+    l -= 1024 - x;
+    x = 0;
+  }
+  do_vram_line(x, y, mem, l, is_read);
+}
+
 static int do_vram_io(uint32_t *data, int count, int is_read)
 {
   int count_initial = count;
@@ -367,7 +586,7 @@ static int do_vram_io(uint32_t *data, int count, int is_read)
   int x = gpu.dma.x, y = gpu.dma.y;
   int w = gpu.dma.w, h = gpu.dma.h;
   int o = gpu.dma.offset;
-  int l;
+  int l, n;
   count *= 2; // operate in 16bpp pixels
 
   if (gpu.dma.offset) {
@@ -375,7 +594,7 @@ static int do_vram_io(uint32_t *data, int count, int is_read)
     if (count < l)
       l = count;
 
-    do_vram_line(x + o, y, sdata, l, is_read);
+    do_vram_span(x + o, y, sdata, l, is_read);
 
     if (o + l < w)
       o += l;
@@ -388,15 +607,30 @@ static int do_vram_io(uint32_t *data, int count, int is_read)
     count -= l;
   }
 
-  for (; h > 0 && count >= w; sdata += w, count -= w, y++, h--) {
+  while (h > 0 && count >= w) {
     y &= 511;
-    do_vram_line(x, y, sdata, w, is_read);
+    n = 1;
+    if (w == 1024 && x == 0) {
+      // full width lines follow each other in vram, do them in one go
+      n = count / 1024;
+      if (n > h)
+        n = h;
+      if (n > 512 - y)
+        n = 512 - y;
+      do_vram_line(x, y, sdata, w * n, is_read);
+    }
+    else
+      do_vram_span(x, y, sdata, w, is_read);
+    sdata += w * n;
+    count -= w * n;
+    y += n;
+    h -= n;
   }
 
   if (h > 0) {
     if (count > 0) {
       y &= 511;
-      do_vram_line(x, y, sdata, count, is_read);
+      do_vram_span(x, y, sdata, count, is_read);
       o = count;
       count = 0;
     }
@@ -435,13 +669,51 @@ static void start_vram_transfer(uint32_t pos_word, uint32_t size_word, int is_re
     gpu.dma.x, gpu.dma.y, gpu.dma.w, gpu.dma.h);
 }
 
+/*
+ * Renderer caches are updated for uploads only once something is about
+ * to be drawn or displayed, so that adjoining uploads (like mdec output,
+ * sent as 16 pixel wide strips) make for a single update.
+ */
+static struct {
+  int x, y, w, h; // w == 0: nothing pending
+} caches_upd;
+
+static void caches_flush(void)
+{
+  if (caches_upd.w == 0)
+    return;
+  renderer_update_caches(caches_upd.x, caches_upd.y, caches_upd.w, caches_upd.h);
+  caches_upd.w = 0;
+}
+
+static void caches_add(int x, int y, int w, int h)
+{
+  if (caches_upd.w != 0) {
+    if (y == caches_upd.y && h == caches_upd.h
+        && x == caches_upd.x + caches_upd.w && x + w <= 1024) {
+      caches_upd.w += w;
+      return;
+    }
+    if (x == caches_upd.x && w == caches_upd.w
+        && y == caches_upd.y + caches_upd.h && y + h <= 512) {
+      caches_upd.h += h;
+      return;
+    }
+    caches_flush();
+  }
+  caches_upd.x = x;
+  caches_upd.y = y;
+  caches_upd.w = w;
+  caches_upd.h = h;
+}
+
 static void finish_vram_transfer(int is_read)
 {
   if (is_read)
     gpu.status.img = 0;
   else
-    renderer_update_caches(gpu.dma_start.x, gpu.dma_start.y,
-                           gpu.dma_start.w, gpu.dma_start.h);
+    caches_add(gpu.dma_start.x, gpu.dma_start.y,
+               gpu.dma_start.w, gpu.dma_start.h);
 }
 
 static noinline int do_cmd_list_skip(uint32_t *data, int count, int *last_cmd)
@@ -458,9 +730,11 @@ static noinline int do_cmd_list_skip(uint32_t *data, int count, int *last_cmd)
 
     switch (cmd) {
       case 0x02:
-        if ((int)(list[2] & 0x3ff) > gpu.screen.w || (int)((list[2] >> 16) & 0x1ff) > gpu.screen.h)
+        if ((int)(list[2] & 0x3ff) > gpu.screen.w || (int)((list[2] >> 16) & 0x1ff) > gpu.screen.h) {
           // clearing something large, don't skip
+          cmd_list_mark_dirty(list, 3);
           do_cmd_list(list, 3, &dummy);
+        }
         else
           memcpy(gpu.frameskip.pending_fill, list, 3 * 4);
         break;
@@ -510,17 +784,327 @@ static noinline int do_cmd_list_skip(uint32_t *data, int count, int *last_cmd)
   return pos;
 }
 
-static noinline int do_cmd_buffer(uint32_t *data, int count)
+/*
+ * Band-parallel drawing, for renderers providing gpu.band_* hooks.
+ * A command list is cut into segments that don't write to anything
+ * they read (textures, CLUTs, copy sources), tracked in 64x64 vram
+ * tiles. Each segment is then drawn by several threads at once, each
+ * running all of it but only writing its own horizontal band of lines,
+ * so primitives still land in submission order within every band and
+ * semi-transparency/mask behave as when drawn serially. With enhancement
+ * the renderer may instead draw the scaled copy alongside the native one.
+ */
+#ifdef GPULIB_THREAD
+
+#define BANDS_MIN_WORDS 16 // smaller segments aren't worth waking threads for
+#define BANDS_MIN_LINES 16
+
+static struct {
+  int count;        // threads running + 1, or 0
+  int lines;        // bands to split by lines, may be less than count
+  uint32_t exit;
+  // current segment
+  uint32_t *list;
+  int len;
+  int y[GPU_BANDS_MAX + 1];
+  uint32_t ecmds[8];
+  pthread_t thread[GPU_BANDS_MAX];
+  sem_t sem_start[GPU_BANDS_MAX];
+  sem_t sem_done;
+} bands;
+
+static void *gpu_band_thread(void *arg)
+{
+  int band = (int)(intptr_t)arg;
+
+  for (;;) {
+    sem_wait(&bands.sem_start[band]);
+    if (__atomic_load_n(&bands.exit, __ATOMIC_ACQUIRE))
+      break;
+    gpu.band_draw(band, bands.list, bands.len, bands.ecmds,
+      bands.y[band], bands.y[band + 1]);
+    sem_post(&bands.sem_done);
+  }
+  return NULL;
+}
+
+// 8 rows of 16 tiles, 4 rows per word; anything past the vram edges wraps
+static void tiles_add(uint64_t *m, int x, int y, int w, int h)
+{
+  int x2 = x + w - 1, y2 = y + h - 1, ty;
+  uint64_t row;
+
+  if (w <= 0 || h <= 0)
+    return;
+  if (x2 >= 1024) {
+    tiles_add(m, 0, y, x2 - 1023, h);
+    x2 = 1023;
+  }
+  if (y2 >= 512) {
+    tiles_add(m, x, 0, x2 - x + 1, y2 - 511);
+    y2 = 511;
+  }
+  row = (2u << (x2 >> 6)) - (1u << (x >> 6));
+  for (ty = y >> 6; ty <= y2 >> 6; ty++)
+    m[ty >> 2] |= row << ((ty & 3) * 16);
+}
+
+static int tiles_overlap(const uint64_t *a, const uint64_t *b)
+{
+  return ((a[0] & b[0]) | (a[1] & b[1])) != 0;
+}
+
+// texture page and CLUT a textured primitive may read
+static void tiles_add_texture(uint64_t *m, uint32_t tpage, uint32_t clut)
+{
+  static const int page_w[4] = { 64, 128, 256, 256 };
+  int depth = (tpage >> 7) & 3;
+  int x = (tpage & 0x0f) * 64, y = (tpage & 0x10) * 16;
+
+  if (x + page_w[depth] > 1024)
+    tiles_add(m, 0, y, 1024, 257); // may also be read past the line end
+  else
+    tiles_add(m, x, y, page_w[depth], 256);
+  if (depth < 2) {
+    x = (clut & 0x3f) * 16;
+    y = (clut >> 6) & 0x1ff;
+    if (x + (depth ? 256 : 16) > 1024)
+      tiles_add(m, 0, y, 1024, 2); // read past the end of the line
+    else
+      tiles_add(m, x, y, depth ? 256 : 16, 1);
+  }
+}
+
+static void bands_flush(uint32_t *list, int len, int y1, int y2)
+{
+  int n = bands.count, dummy, i;
+
+  if (len <= 0)
+    return;
+  if (!gpu.state.enhancement_active) {
+    n = bands.lines;
+    while (n > 1 && y2 - y1 < n * BANDS_MIN_LINES)
+      n--;
+  }
+  if (n < 2 || len < BANDS_MIN_WORDS || (n = gpu.band_begin(n)) < 2) {
+    do_cmd_list(list, len, &dummy);
+    return;
+  }
+
+  // the edge bands extend to the vram edges, so that whatever
+  // the segment draws is covered
+  bands.y[0] = 0;
+  for (i = 1; i < n; i++)
+    bands.y[i] = (y1 + (y2 - y1) * i / n) & ~7;
+  bands.y[n] = 512;
+  bands.list = list;
+  bands.len = len;
+  memcpy(bands.ecmds, gpu.ex_regs, sizeof(bands.ecmds));
+
+  for (i = 1; i < n; i++)
+    sem_post(&bands.sem_start[i]);
+  gpu.band_draw(0, list, len, bands.ecmds, bands.y[0], bands.y[1]);
+  for (i = 1; i < n; i++)
+    sem_wait(&bands.sem_done);
+
+  gpu.band_end(n);
+}
+
+// do_cmd_list() drawing in bands where possible
+static noinline int bands_do_cmd_list(uint32_t *list, int count, int *last_cmd)
+{
+  uint32_t e1 = gpu.ex_regs[1], e3 = gpu.ex_regs[3], e4 = gpu.ex_regs[4];
+  uint64_t rd[2] = { 0, 0 }, wr[2] = { 0, 0 }, r[2], w[2];
+  int cmd = 0, pos = 0, start = 0, len, v, dummy;
+  int y1 = 512, y2 = 0; // lines written by the segment
+  int wy, wh, serial;
+
+  while (pos < count) {
+    const uint32_t *l = list + pos;
+    cmd = l[0] >> 24;
+    len = 1 + cmd_lengths[cmd];
+
+    if (0xa0 <= cmd && cmd <= 0xdf)
+      break;
+    if ((cmd & 0xf8) == 0x48 || (cmd & 0xf8) == 0x58) {
+      int step = (cmd & 0x10) ? 2 : 1;
+      for (v = (cmd & 0x10) ? 4 : 3; pos + v < count; v += step)
+        if ((l[v] & 0xf000f000) == 0x50005000)
+          break;
+      len += v - ((cmd & 0x10) ? 4 : 3);
+    }
+    if (pos + len > count)
+      break;
+
+    r[0] = r[1] = w[0] = w[1] = 0;
+    wy = wh = serial = 0;
+    switch (cmd) {
+      case 0x02: {
+        int x = l[1] & 0x3f0, fw = ((l[2] & 0x3ff) + 0x0f) & ~0x0f;
+        wy = (l[1] >> 16) & 0x1ff;
+        wh = (l[2] >> 16) & 0x1ff;
+        if (x + fw > 1024 || wy + wh > 512)
+          serial = 1;
+        tiles_add(w, x, wy, fw, wh);
+        break;
+      }
+      case 0x20 ... 0x7f: {
+        int x = e3 & 0x3ff, x2 = e4 & 0x3ff;
+        if ((cmd & 0x04) && (cmd & 0x60) != 0x40) {
+          uint32_t tpage = e1;
+          if (cmd < 0x40) {
+            tpage = l[4 + ((cmd >> 4) & 1)] >> 16;
+            e1 = (e1 & ~0x1ff) | (tpage & 0x1ff);
+          }
+          tiles_add_texture(r, tpage, l[2] >> 16);
+        }
+        wy = (e3 >> 10) & 0x1ff;
+        wh = ((e4 >> 10) & 0x1ff) - wy + 1;
+        tiles_add(w, x, wy, x2 - x + 1, wh);
+        break;
+      }
+      case 0x80 ... 0x9f: {
+        int sx = l[1] & 0x3ff, sy = (l[1] >> 16) & 0x1ff;
+        int dx = l[2] & 0x3ff, cw = ((l[3] - 1) & 0x3ff) + 1;
+        wy = (l[2] >> 16) & 0x1ff;
+        wh = (((l[3] >> 16) - 1) & 0x1ff) + 1;
+        if (sx + cw > 1024 || sy + wh > 512 || dx + cw > 1024 || wy + wh > 512)
+          serial = 1;
+        tiles_add(r, sx, sy, cw, wh);
+        tiles_add(w, dx, wy, cw, wh);
+        break;
+      }
+      case 0xe1:
+        e1 = l[0];
+        break;
+      case 0xe3:
+        e3 = l[0];
+        break;
+      case 0xe4:
+        e4 = l[0];
+        break;
+    }
+
+    if (serial || tiles_overlap(r, w)) {
+      // reads what it draws, or wraps around; has to be done alone
+      bands_flush(list + start, pos - start, y1, y2);
+      do_cmd_list(list + pos, len, &dummy);
+      pos += len;
+      start = pos;
+      rd[0] = rd[1] = wr[0] = wr[1] = 0;
+      y1 = 512, y2 = 0;
+      continue;
+    }
+    if (tiles_overlap(r, wr) || tiles_overlap(w, rd)) {
+      bands_flush(list + start, pos - start, y1, y2);
+      start = pos;
+      rd[0] = rd[1] = wr[0] = wr[1] = 0;
+      y1 = 512, y2 = 0;
+    }
+    rd[0] |= r[0]; rd[1] |= r[1];
+    wr[0] |= w[0]; wr[1] |= w[1];
+    if (wh > 0) {
+      if (wy < y1)
+        y1 = wy;
+      if (wy + wh > y2)
+        y2 = wy + wh;
+    }
+    pos += len;
+  }
+  bands_flush(list + start, pos - start, y1, y2);
+
+  // image i/o or an incomplete command, leave it to the renderer
+  // so that last_cmd comes out the same
+  *last_cmd = cmd;
+  if (pos < count)
+    pos += do_cmd_list(list + pos, count - pos, last_cmd);
+  return pos;
+}
+
+static void bands_stop(void)
+{
+  int i;
+
+  if (bands.count == 0)
+    return;
+  __atomic_store_n(&bands.exit, 1, __ATOMIC_RELEASE);
+  for (i = 1; i < bands.count; i++) {
+    sem_post(&bands.sem_start[i]);
+    pthread_join(bands.thread[i], NULL);
+    sem_destroy(&bands.sem_start[i]);
+  }
+  sem_destroy(&bands.sem_done);
+  bands.count = 0;
+}
+
+static void bands_start(int count)
+{
+  int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int i;
+
+  if (count < 0)
+    count = cpus;
+  if (count > GPU_BANDS_MAX)
+    count = GPU_BANDS_MAX;
+  bands.lines = count;
+  // the renderer may draw its enhanced pass on another thread
+  if (count < 2 && gpu.state.enhancement_enable && cpus > 1)
+    count = 2;
+  if (count < 2 || gpu.band_draw == NULL) {
+    bands_stop();
+    return;
+  }
+  if (count == bands.count)
+    return;
+  bands_stop();
+
+  bands.exit = 0;
+  if (sem_init(&bands.sem_done, 0, 0) != 0)
+    goto fail;
+  for (i = 1; i < count; i++) {
+    if (sem_init(&bands.sem_start[i], 0, 0) != 0)
+      break;
+    if (pthread_create(&bands.thread[i], NULL, gpu_band_thread,
+        (void *)(intptr_t)i) != 0) {
+      sem_destroy(&bands.sem_start[i]);
+      break;
+    }
+  }
+  bands.count = i;
+  if (i < count) {
+    bands_stop();
+    goto fail;
+  }
+  return;
+
+fail:
+  fprintf(stderr, "could not start gpu band threads\n");
+}
+
+#define bands_active() \
+  (bands.count > 1 && (bands.lines > 1 || gpu.state.enhancement_active))
+
+#else // !GPULIB_THREAD
+
+#define bands_active() 0
+#define bands_do_cmd_list do_cmd_list
+static void bands_start(int count) {}
+static void bands_stop(void) {}
+
+#endif
+
+static noinline int run_cmd_buffer(uint32_t *data, int count)
 {
   int cmd, pos;
   uint32_t old_e3 = gpu.ex_regs[3];
-  int vram_dirty = 0;
 
   // process buffer
   for (pos = 0; pos < count; )
   {
     if (gpu.dma.h && !gpu.dma_start.is_read) { // XXX: need to verify
-      vram_dirty = 1;
+      if (!fb_dirty_all())
+        mark_fb_dirty(gpu.dma_start.x, gpu.dma_start.y,
+                      gpu.dma_start.w, gpu.dma_start.h);
       pos += do_vram_io(data + pos, count - pos, 0);
       if (pos == count)
         break;
@@ -540,12 +1124,18 @@ static noinline int do_cmd_buffer(uint32_t *data, int count)
       continue;
     }
 
+    caches_flush();
+
     // 0xex cmds might affect frameskip.allow, so pass to do_cmd_list_skip
     if (gpu.frameskip.active && (gpu.frameskip.allow || ((data[pos] >> 24) & 0xf0) == 0xe0))
       pos += do_cmd_list_skip(data + pos, count - pos, &cmd);
     else {
-      pos += do_cmd_list(data + pos, count - pos, &cmd);
-      vram_dirty = 1;
+      if (!fb_dirty_all())
+        cmd_list_mark_dirty(data + pos, count - pos);
+      if (bands_active())
+        pos += bands_do_cmd_list(data + pos, count - pos, &cmd);
+      else
+        pos += do_cmd_list(data + pos, count - pos, &cmd);
     }
 
     if (cmd == -1)
@@ -557,130 +1147,1125 @@ static noinline int do_cmd_buffer(uint32_t *data, int count)
   gpu.status.reg |= gpu.ex_regs[1] & 0x7ff;
   gpu.status.reg |= (gpu.ex_regs[6] & 3) << 11;
 
-  gpu.state.fb_dirty |= vram_dirty;
-
   if (old_e3 != gpu.ex_regs[3])
     decide_frameskip_allow(gpu.ex_regs[3]);
 
   return count - pos;
 }
 
-static void flush_cmd_buffer(void)
-{
-  int left = do_cmd_buffer(gpu.cmd_buffer, gpu.cmd_len);
-  if (left > 0)
-    memmove(gpu.cmd_buffer, gpu.cmd_buffer + gpu.cmd_len - left, left * 4);
-  gpu.cmd_len = left;
-}
-
-void GPUwriteDataMem(uint32_t *mem, int count)
-{
-  int left;
+/*
+ * Optional cache for static scenes. The GP0 stream of each frame is
+ * recorded, as do_cmd_buffer calls. When a frame repeats one of the
+ * last two (period 2 for double buffering), a vram hash tells if it
+ * was a no-op: nothing it reads or writes changed, so running it again
+ * would change nothing either. Once the last frame (or the one before,
+ * for double buffering) is known to be a no-op, the next frame is only
+ * compared against it instead of being drawn. On the first difference,
+ * or anything that needs the real state mid-frame (vram reads, GP1
+ * resets/info), the matched part is run and drawing continues normally.
+ * Status bits from E1/E6 aren't updated mid-frame while skipping.
+ */
+#define MEMO_BUF_LEN (256 * 1024) // in words, per frame
 
-  log_io("gpu_dma_write %p %d\n", mem, count);
+// frames with a vram transfer open at either end aren't cached,
+// so E-regs are all the state that has to match
+struct memo_state {
+  uint32_t ex_regs[8];
+};
 
-  if (unlikely(gpu.cmd_len > 0))
-    flush_cmd_buffer();
+struct memo_frame {
+  uint32_t *buf;          // count, left, count words; for each call
+  int len;                // words used in buf, -1 if not cacheable
+  int noop;               // didn't change vram, nor did anything since
+  struct memo_state start, end;
+};
 
-  left = do_cmd_buffer(mem, count);
-  if (left)
-    log_anomaly("GPUwriteDataMem: discarded %d/%d words\n", left, count);
+static struct {
+  int enabled;
+  int skipping;           // matching input against f[pred]
+  int pos;                // position in f[pred].buf
+  int cur, last, prev;    // slots for this and the previous two frames
+  int pred;
+  int vram_hash_valid;
+  uint64_t vram_hash;     // at the end of the last frame
+  struct memo_frame f[3];
+  unsigned int *stats;
+} memo;
+
+static void memo_get_state(struct memo_state *st)
+{
+  memcpy(st->ex_regs, gpu.ex_regs, sizeof(st->ex_regs));
 }
 
-void GPUwriteData(uint32_t data)
+// what running the skipped frame would have left behind
+static void memo_set_state(const struct memo_state *st)
 {
-  log_io("gpu_write %08x\n", data);
-  gpu.cmd_buffer[gpu.cmd_len++] = data;
-  if (gpu.cmd_len >= CMD_BUFFER_LEN)
-    flush_cmd_buffer();
+  memcpy(gpu.ex_regs, st->ex_regs, sizeof(gpu.ex_regs));
+  gpu.status.reg &= ~0x1fff;
+  gpu.status.reg |= gpu.ex_regs[1] & 0x7ff;
+  gpu.status.reg |= (gpu.ex_regs[6] & 3) << 11;
+  renderer_sync_ecmds(gpu.ex_regs);
 }
 
-long GPUdmaChain(uint32_t *rambase, uint32_t start_addr)
+static uint64_t memo_vram_hash(void)
 {
-  uint32_t addr, *list, ld_addr = 0;
-  int len, left, count;
-  long cpu_cycles = 0;
+  const uint64_t *p = (const uint64_t *)gpu.vram;
+  uint64_t h0 = 0, h1 = 0, h2 = 0, h3 = 0;
+  int i;
 
-  preload(rambase + (start_addr & 0x1fffff) / 4);
+  // 4 independent chains so that the multiplies overlap
+  for (i = 0; i < 1024 * 512 * 2 / 8; i += 4) {
+    h0 = (h0 ^ p[i + 0]) * 0x100000001b3ull;
+    h1 = (h1 ^ p[i + 1]) * 0x100000001b3ull;
+    h2 = (h2 ^ p[i + 2]) * 0x100000001b3ull;
+    h3 = (h3 ^ p[i + 3]) * 0x100000001b3ull;
+  }
+  return h0 ^ (h1 << 1) ^ (h2 << 2) ^ (h3 << 3) ^ (h1 >> 63) ^ (h2 >> 62) ^ (h3 >> 61);
+}
 
-  if (unlikely(gpu.cmd_len > 0))
-    flush_cmd_buffer();
+static int memo_same(const struct memo_frame *a, const struct memo_frame *b)
+{
+  return a->len >= 0 && a->len == b->len
+    && memcmp(&a->start, &b->start, sizeof(a->start)) == 0
+    && memcmp(a->buf, b->buf, a->len * 4) == 0;
+}
 
-  log_io("gpu_dma_chain\n");
-  addr = start_addr & 0xffffff;
-  for (count = 0; (addr & 0x800000) == 0; count++)
-  {
-    list = rambase + (addr & 0x1fffff) / 4;
-    len = list[0] >> 24;
-    addr = list[0] & 0xffffff;
-    preload(rambase + (addr & 0x1fffff) / 4);
+static void memo_record(uint32_t *data, int count, int left)
+{
+  struct memo_frame *f = &memo.f[memo.cur];
 
-    cpu_cycles += 10;
-    if (len > 0)
-      cpu_cycles += 5 + len;
+  if (f->len < 0)
+    return;
+  if (f->len + 2 + count > MEMO_BUF_LEN) {
+    f->len = -1;
+    return;
+  }
+  f->buf[f->len] = count;
+  f->buf[f->len + 1] = left;
+  memcpy(f->buf + f->len + 2, data, count * 4);
+  f->len += 2 + count;
+}
 
-    log_io(".chain %08x #%d\n", (list - rambase) * 4, len);
+// returns what do_cmd_buffer would, or -1 on a mismatch
+static int memo_match(const uint32_t *data, int count)
+{
+  const struct memo_frame *f = &memo.f[memo.pred];
+  const uint32_t *p = f->buf + memo.pos;
 
-    if (len) {
-      left = do_cmd_buffer(list + 1, len);
-      if (left)
-        log_anomaly("GPUdmaChain: discarded %d/%d words\n", left, len);
-    }
+  if (memo.pos + 2 + count > f->len || p[0] != (uint32_t)count
+      || memcmp(p + 2, data, count * 4) != 0)
+    return -1;
+  memo.pos += 2 + count;
+  return p[1];
+}
 
-    #define LD_THRESHOLD (8*1024)
-    if (count >= LD_THRESHOLD) {
-      if (count == LD_THRESHOLD) {
-        ld_addr = addr;
-        continue;
-      }
+// run (and record) whatever was skipped so far in this frame
+static void memo_flush(void)
+{
+  uint32_t *p, *end;
+  int left;
 
-      // loop detection marker
-      // (bit23 set causes DMA error on real machine, so
-      //  unlikely to be ever set by the game)
-      list[0] |= 0x800000;
-    }
+  if (!memo.skipping)
+    return;
+  memo.skipping = 0;
+  p = memo.f[memo.pred].buf;
+  end = p + memo.pos;
+  for (; p < end; p += 2 + p[0]) {
+    left = run_cmd_buffer(p + 2, p[0]);
+    memo_record(p + 2, p[0], left);
   }
+}
 
-  if (ld_addr != 0) {
-    // remove loop detection markers
-    count -= LD_THRESHOLD + 2;
-    addr = ld_addr & 0x1fffff;
-    while (count-- > 0) {
-      list = rambase + addr / 4;
-      addr = list[0] & 0x1fffff;
-      list[0] &= ~0x800000;
-    }
+static void memo_reset(void)
+{
+  int i;
+
+  memo.skipping = 0;
+  memo.vram_hash_valid = 0;
+  for (i = 0; i < 3; i++) {
+    memo.f[i].len = -1;
+    memo.f[i].noop = 0;
   }
+  memo.cur = 0;
+  memo.last = 1;
+  memo.prev = 2;
+  memo.f[memo.cur].len = 0;
+  memo_get_state(&memo.f[memo.cur].start);
+}
 
-  gpu.state.last_list.frame = *gpu.state.frame_count;
-  gpu.state.last_list.hcnt = *gpu.state.hcnt;
-  gpu.state.last_list.cycles = cpu_cycles;
-  gpu.state.last_list.addr = start_addr;
+static void memo_free(void)
+{
+  int i;
 
-  return cpu_cycles;
+  for (i = 0; i < 3; i++) {
+    free(memo.f[i].buf);
+    memo.f[i].buf = NULL;
+  }
 }
 
-void GPUreadDataMem(uint32_t *mem, int count)
+static void memo_enable(int enable)
+{
+  int i;
+
+  enable = !!enable;
+  if (enable == memo.enabled)
+    return;
+  memo.enabled = 0;
+  memo_free();
+  if (!enable)
+    return;
+
+  for (i = 0; i < 3; i++) {
+    memo.f[i].buf = (uint32_t *)malloc(MEMO_BUF_LEN * 4);
+    if (memo.f[i].buf == NULL) {
+      fprintf(stderr, "gpu: no memory for the frame cache\n");
+      memo_free();
+      return;
+    }
+  }
+  memo_reset();
+  memo.enabled = 1;
+}
+
+static void memo_frame_end(void)
+{
+  struct memo_frame *f, *last, *prev;
+  struct memo_state now;
+  int t;
+
+  if (!memo.enabled)
+    return;
+  if (memo.stats)
+    memo.stats[0]++;
+
+  memo_get_state(&now);
+  if (memo.skipping) {
+    if (memo.pos == memo.f[memo.pred].len) {
+      // the whole frame matched, vram is as it was
+      if (memo.stats)
+        memo.stats[1]++;
+      memo_set_state(&memo.f[memo.pred].end);
+      memo_get_state(&now);
+      if (memo.pred == memo.prev) {
+        memo.prev = memo.last;
+        memo.last = memo.pred;
+      }
+      memo.skipping = 0;
+      goto next_frame;
+    }
+    memo_flush(); // it was shorter
+  }
+
+  f = &memo.f[memo.cur];
+  f->end = now;
+  f->noop = 0;
+  if (gpu.state.old_interlace || gpu.state.enhancement_active
+      || gpu.frameskip.set || gpu.dma.h)
+    f->len = -1; // these draw differently from frame to frame
+  if (memo_same(f, &memo.f[memo.last]) || memo_same(f, &memo.f[memo.prev])) {
+    uint64_t h = memo_vram_hash();
+    f->noop = memo.vram_hash_valid && h == memo.vram_hash;
+    memo.vram_hash = h;
+    memo.vram_hash_valid = 1;
+  }
+  else
+    memo.vram_hash_valid = 0;
+  if (!f->noop)
+    // vram changed, older frames could do something now
+    memo.f[memo.last].noop = memo.f[memo.prev].noop = 0;
+
+  t = memo.prev;
+  memo.prev = memo.last;
+  memo.last = memo.cur;
+  memo.cur = t;
+
+next_frame:
+  f = &memo.f[memo.cur];
+  f->len = gpu.dma.h ? -1 : 0;
+  f->noop = 0;
+  f->start = now;
+
+  // predict the next frame, alternating ones first
+  last = &memo.f[memo.last];
+  prev = &memo.f[memo.prev];
+  memo.pred = -1;
+  if (prev->noop && !memo_same(prev, last))
+    memo.pred = memo.prev;
+  else if (last->noop)
+    memo.pred = memo.last;
+  if (memo.pred >= 0 && f->len == 0
+      && memcmp(&now, &memo.f[memo.pred].start, sizeof(now)) == 0)
+  {
+    memo.skipping = 1;
+    memo.pos = 0;
+  }
+}
+
+static void memo_gp1(uint32_t cmd)
+{
+  // only display settings can change without ending a skip
+  if (!memo.enabled || (2 <= cmd && cmd <= 8))
+    return;
+  memo_flush();
+  if (cmd < 2)
+    memo.f[memo.cur].len = -1; // reset, don't cache this frame
+}
+
+static int memo_cmd_buffer(uint32_t *data, int count)
+{
+  int left;
+
+  if (memo.skipping) {
+    left = memo_match(data, count);
+    if (left >= 0)
+      return left;
+    memo_flush();
+  }
+  left = run_cmd_buffer(data, count);
+  memo_record(data, count, left);
+  return left;
+}
+
+static noinline int do_cmd_buffer(uint32_t *data, int count)
+{
+  if (unlikely(memo.enabled))
+    return memo_cmd_buffer(data, count);
+  return run_cmd_buffer(data, count);
+}
+
+static void flush_cmd_buffer(void)
+{
+  int left = do_cmd_buffer(gpu.cmd_buffer, gpu.cmd_len);
+  if (left > 0)
+    memmove(gpu.cmd_buffer, gpu.cmd_buffer + gpu.cmd_len - left, left * 4);
+  gpu.cmd_len = left;
+}
+
+static void do_write_data_mem(uint32_t *mem, int count)
+{
+  int left;
+
+  if (unlikely(gpu.cmd_len > 0))
+    flush_cmd_buffer();
+
+  left = do_cmd_buffer(mem, count);
+  if (left)
+    log_anomaly("GPUwriteDataMem: discarded %d/%d words\n", left, count);
+}
+
+static void do_dma_list(uint32_t *list, int len)
+{
+  int left = do_cmd_buffer(list, len);
+  if (left)
+    log_anomaly("GPUdmaChain: discarded %d/%d words\n", left, len);
+}
+
+static void do_vblank(int lcf)
+{
+  int interlace = gpu.state.allow_interlace
+    && gpu.status.interlace && gpu.status.dheight;
+  // interlace doesn't look nice on progressive displays,
+  // so we have this "auto" mode here for games that don't read vram
+  if (gpu.state.allow_interlace == 2
+      && *gpu.state.frame_count - gpu.state.last_vram_read_frame > 1)
+  {
+    interlace = 0;
+  }
+  if (interlace || interlace != gpu.state.old_interlace) {
+    gpu.state.old_interlace = interlace;
+
+    memo_flush();
+
+    if (gpu.cmd_len > 0)
+      flush_cmd_buffer();
+    renderer_flush_queues();
+    renderer_set_interlace(interlace, !lcf);
+  }
+}
+
+/*
+ * Optional worker thread. GP0/GP1 writes are copied into a
+ * single-producer/single-consumer ring and processed there, the emu
+ * thread only waits for it when it needs the results
+ * (vram/status reads, vblank, savestates).
+ * Packets are a header word (type << 24 | len) followed by len words,
+ * never wrapping around the end of the ring.
+ *
+ * In pipelined mode the worker also stops at the end of each frame
+ * (PKT_FRAME) until the emu thread has presented the previous one,
+ * so frame N is drawn while N+1 is emulated, at one frame of latency.
+ *
+ * With rearmed_cbs.gpu_thread_check there is no worker, the packets are
+ * run as soon as they are published and the status the emu thread
+ * tracked is compared with the real one (replay -checkstatus).
+ */
+#define RING_SIZE (1 << 20) // in words
+#define RING_MASK (RING_SIZE - 1)
+
+enum {
+  PKT_PAD = 0, // rest of the ring is unused, continue from the start
+  PKT_CMDBUF,  // GPUwriteData words
+  PKT_DMA,     // GPUwriteDataMem
+  PKT_LIST,    // GPUdmaChain node
+  PKT_GP1,     // GPUwriteStatus
+  PKT_VBLANK,  // GPUvBlank
+  PKT_FRAME,   // GPUupdateLace in pipelined mode, payload is the frame seq
+};
+
+#ifdef GPULIB_THREAD
+
+static struct {
+  // emu thread only
+  uint32_t *ring;
+  uint32_t wpos;
+  int wbuf_len;
+  int active;
+  int pipelined;
+  unsigned int *check;    // no worker, see thread_check()
+  uint32_t frame_seq;
+  uint32_t frame_pos[2];  // ring pos of the last PKT_FRAME headers
+  uint32_t status;        // status once the worker catches up, see thread_track_*
+  uint32_t trk_cmd[12];   // start of a GP0 cmd split between writes
+  int trk_len;            // words of it in trk_cmd
+  int trk_poly;           // in polyline vertices: 1 flat, 2/3 gouraud color/vertex
+  uint32_t trk_skip;      // vram write data words left
+  uint32_t wbuf[CMD_BUFFER_LEN];
+  pthread_t thread;
+  sem_t sem_work;
+  sem_t sem_idle;
+  // shared
+  uint32_t wpos_pub __attribute__((aligned(64)));
+  uint32_t want_idle;
+  uint32_t exit;
+  uint32_t released;      // last PKT_FRAME the worker may pass
+  uint32_t status_pub;    // gpu.status after the last processed packet
+  // advanced only after the packet is processed, so rpos == wpos_pub
+  // means the worker is not touching any gpu state
+  uint32_t rpos __attribute__((aligned(64)));
+} thr;
+
+static void thread_do_cmdbuf(const uint32_t *data, int count)
+{
+  while (count > 0) {
+    int n = CMD_BUFFER_LEN - gpu.cmd_len;
+    if (n > count)
+      n = count;
+    memcpy(gpu.cmd_buffer + gpu.cmd_len, data, n * 4);
+    gpu.cmd_len += n;
+    data += n;
+    count -= n;
+    if (gpu.cmd_len >= CMD_BUFFER_LEN)
+      flush_cmd_buffer();
+  }
+  // the emu thread only sends these where sync code would flush
+  if (gpu.cmd_len > 0)
+    flush_cmd_buffer();
+}
+
+// process the published packets, up to a PKT_FRAME not yet released
+static void thread_run_packets(void)
+{
+  uint32_t rpos, hdr, len, *data;
+
+  rpos = thr.rpos;
+  while (rpos != __atomic_load_n(&thr.wpos_pub, __ATOMIC_ACQUIRE)) {
+    hdr = thr.ring[rpos & RING_MASK];
+    len = hdr & 0xffffff;
+    data = &thr.ring[(rpos + 1) & RING_MASK];
+    if ((hdr >> 24) == PKT_FRAME
+        && (int32_t)(data[0] - __atomic_load_n(&thr.released, __ATOMIC_ACQUIRE)) > 0)
+      break; // wait here until this frame is presented
+    switch (hdr >> 24) {
+      case PKT_PAD:
+        len = RING_SIZE - (rpos & RING_MASK) - 1;
+        break;
+      case PKT_CMDBUF:
+        thread_do_cmdbuf(data, len);
+        break;
+      case PKT_DMA:
+        do_write_data_mem(data, len);
+        break;
+      case PKT_LIST:
+        do_dma_list(data, len);
+        break;
+      case PKT_GP1:
+        do_write_status(data[0]);
+        break;
+      case PKT_VBLANK:
+        do_vblank(data[0]);
+        break;
+    }
+    rpos += 1 + len;
+    __atomic_store_n(&thr.status_pub, gpu.status.reg, __ATOMIC_RELAXED);
+    __atomic_store_n(&thr.rpos, rpos, __ATOMIC_SEQ_CST);
+  }
+}
+
+static void *gpu_worker_thread(void *unused)
+{
+  while (1) {
+    sem_wait(&thr.sem_work);
+    if (__atomic_load_n(&thr.exit, __ATOMIC_ACQUIRE))
+      break;
+
+    thread_run_packets();
+
+    if (__atomic_load_n(&thr.want_idle, __ATOMIC_SEQ_CST))
+      sem_post(&thr.sem_idle);
+  }
+
+  return NULL;
+}
+
+static void thread_check(void);
+
+static void thread_publish(void)
+{
+  if (thr.wpos_pub == thr.wpos)
+    return;
+  __atomic_store_n(&thr.wpos_pub, thr.wpos, __ATOMIC_RELEASE);
+  if (unlikely(thr.check != NULL)) {
+    thread_check();
+    return;
+  }
+  sem_post(&thr.sem_work);
+}
+
+// wait for the worker to get to pos, it must be idle or stopped there
+static void thread_wait_pos(uint32_t pos)
+{
+  thread_publish();
+  if (__atomic_load_n(&thr.rpos, __ATOMIC_SEQ_CST) == pos)
+    return;
+
+  __atomic_store_n(&thr.want_idle, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&thr.rpos, __ATOMIC_SEQ_CST) != pos)
+    sem_wait(&thr.sem_idle);
+  __atomic_store_n(&thr.want_idle, 0, __ATOMIC_RELAXED);
+}
+
+static void thread_release_frame(uint32_t seq)
+{
+  if (thr.released == seq)
+    return;
+  __atomic_store_n(&thr.released, seq, __ATOMIC_RELEASE);
+  sem_post(&thr.sem_work);
+}
+
+static void thread_wait_idle(void)
+{
+  thread_release_frame(thr.frame_seq);
+  thread_wait_pos(thr.wpos);
+}
+
+/*
+ * The status bits that commands change are followed on the emu thread,
+ * so that status reads don't have to wait for the worker. GP0 data is
+ * split into commands as the renderers' do_cmd_list() does it, which is
+ * enough for the bits; it is taken back from gpu state on each sync for
+ * odd streams gpulib splits differently (0xa1-0xdf at the start of a list
+ * are vram i/o too, and a cmd left waiting by GP0 writes becomes upload
+ * data if a dma starts an upload).
+ */
+static void thread_track_cmd(const uint32_t *list)
+{
+  int cmd = list[0] >> 24, w, h;
+
+  switch (cmd) {
+    case 0x24 ... 0x27:
+    case 0x2c ... 0x2f:
+    case 0x34 ... 0x37:
+    case 0x3c ... 0x3f:
+      thr.status = (thr.status & ~0x1ff) | ((list[4 + ((cmd >> 4) & 1)] >> 16) & 0x1ff);
+      break;
+    case 0x48 ... 0x4f:
+      if ((list[3] & 0xf000f000) != 0x50005000)
+        thr.trk_poly = 1;
+      break;
+    case 0x58 ... 0x5f:
+      if ((list[4] & 0xf000f000) != 0x50005000)
+        thr.trk_poly = 3;
+      break;
+    case 0xa0:
+      w = ((list[2] - 1) & 0x3ff) + 1;
+      h = (((list[2] >> 16) - 1) & 0x1ff) + 1;
+      thr.trk_skip = (w * h + 1) / 2;
+      break;
+    case 0xc0:
+      thr.status |= 0x08000000;
+      break;
+    case 0xe1:
+      thr.status = (thr.status & ~0x7ff) | (list[0] & 0x7ff);
+      break;
+    case 0xe6:
+      thr.status = (thr.status & ~0x1800) | ((list[0] & 3) << 11);
+      break;
+  }
+}
+
+static void thread_track_gp0(const uint32_t *data, int count)
+{
+  int cmd, len, n;
+
+  while (count > 0) {
+    if (thr.trk_skip > 0) {
+      n = thr.trk_skip < (uint32_t)count ? (int)thr.trk_skip : count;
+      thr.trk_skip -= n;
+      data += n;
+      count -= n;
+      continue;
+    }
+    if (thr.trk_poly) {
+      if (thr.trk_poly != 3 && (data[0] & 0xf000f000) == 0x50005000)
+        thr.trk_poly = 0;
+      else if (thr.trk_poly > 1)
+        thr.trk_poly ^= 1;
+      data++;
+      count--;
+      continue;
+    }
+
+    cmd = (thr.trk_len ? thr.trk_cmd[0] : data[0]) >> 24;
+    len = 1 + cmd_lengths[cmd];
+    if (thr.trk_len == 0 && len <= count) {
+      thread_track_cmd(data);
+      data += len;
+      count -= len;
+      continue;
+    }
+    n = len - thr.trk_len;
+    if (n > count)
+      n = count;
+    memcpy(thr.trk_cmd + thr.trk_len, data, n * 4);
+    thr.trk_len += n;
+    data += n;
+    count -= n;
+    if (thr.trk_len == len) {
+      thr.trk_len = 0;
+      thread_track_cmd(thr.trk_cmd);
+    }
+  }
+}
+
+// dma blocks and lists start at a cmd boundary and drop a cmd left
+// incomplete at their end, while one from GP0 writes waits for more
+static void thread_track_dma(const uint32_t *data, int count)
+{
+  uint32_t cmd[ARRAY_SIZE(thr.trk_cmd)];
+  int len = thr.trk_len, poly = thr.trk_poly;
+
+  memcpy(cmd, thr.trk_cmd, len * 4);
+  thr.trk_len = thr.trk_poly = 0;
+  thread_track_gp0(data, count);
+  memcpy(thr.trk_cmd, cmd, len * 4);
+  thr.trk_len = len;
+  thr.trk_poly = poly;
+}
+
+// worker idle (or stopped): take the status from gpu and continue
+// following the GP0 stream from where the gpu is in it
+static void thread_track_reset(void)
+{
+  thr.status = thr.status_pub = gpu.status.reg;
+  thr.trk_len = thr.trk_poly = 0;
+  thr.trk_skip = 0;
+  if (gpu.dma.h && !gpu.dma_start.is_read)
+    thr.trk_skip = (gpu.dma.h * gpu.dma.w - gpu.dma.offset + 1) / 2;
+  thread_track_gp0(gpu.cmd_buffer, gpu.cmd_len);
+}
+
+// returns space for len words, valid until the next thread_publish()
+static uint32_t *thread_alloc(int type, uint32_t len)
+{
+  uint32_t idx = thr.wpos & RING_MASK, pad = 0;
+  uint32_t *p;
+
+  if (idx + 1 + len > RING_SIZE)
+    pad = RING_SIZE - idx;
+  if (thr.wpos + pad + 1 + len - __atomic_load_n(&thr.rpos, __ATOMIC_ACQUIRE) > RING_SIZE)
+    thread_wait_idle(); // full
+
+  if (pad) {
+    thr.ring[idx] = PKT_PAD << 24;
+    thr.wpos += pad;
+    idx = 0;
+  }
+  p = &thr.ring[idx];
+  p[0] = (type << 24) | len;
+  thr.wpos += 1 + len;
+  return p + 1;
+}
+
+static void thread_push_wbuf(void)
+{
+  if (thr.wbuf_len == 0)
+    return;
+  thread_track_gp0(thr.wbuf, thr.wbuf_len);
+  memcpy(thread_alloc(PKT_CMDBUF, thr.wbuf_len), thr.wbuf, thr.wbuf_len * 4);
+  thr.wbuf_len = 0;
+}
+
+static void thread_push(int type, uint32_t *data, int count)
+{
+  if (unlikely(count > RING_SIZE / 2)) {
+    // too large to queue, do it here
+    thread_wait_idle();
+    if (type == PKT_DMA)
+      do_write_data_mem(data, count);
+    else
+      do_dma_list(data, count);
+    thread_track_reset();
+    return;
+  }
+  thread_track_dma(data, count);
+  memcpy(thread_alloc(type, count), data, count * 4);
+}
+
+static void gpu_thread_sync(void)
+{
+  if (!thr.active)
+    return;
+  thread_push_wbuf();
+  thread_wait_idle();
+  thread_track_reset();
+}
+
+// pipelined mode: queue the end of this frame, then wait for the worker
+// to stop at the end of the previous one (or at this one if a sync let
+// it past that already), so that gpu state is stable for presenting
+static void thread_frame_end(void)
+{
+  uint32_t seq;
+
+  thread_push_wbuf();
+  seq = ++thr.frame_seq;
+  *thread_alloc(PKT_FRAME, 1) = seq;
+  thr.frame_pos[seq & 1] = thr.wpos - 2;
+
+  thread_wait_pos(thr.frame_pos[(thr.released + 1) & 1]);
+}
+
+// status as seen by the emu thread, without waiting for the worker
+static uint32_t thread_read_status(void)
+{
+  const uint32_t trk_bits = 0x68ff1fff; // texpage, mask, mode, blanking, img, dma
+  uint32_t st = __atomic_load_n(&thr.status_pub, __ATOMIC_RELAXED);
+  return (st & ~trk_bits) | (thr.status & trk_bits);
+}
+
+// everything published was just run, so what a status read would return
+// now must match gpu state. A mismatch is reported once, then tracking
+// restarts from gpu state as after a sync.
+static void thread_check(void)
+{
+  uint32_t st;
+
+  thread_run_packets();
+  st = thread_read_status();
+  thr.check[0]++;
+  if (st != gpu.status.reg) {
+    thr.check[1]++;
+    fprintf(stderr, "gpu: tracked status %08x, gpu has %08x\n",
+      st, gpu.status.reg);
+    thread_track_reset();
+  }
+}
+
+static void thread_track_status(uint32_t data)
+{
+  switch (data >> 24) {
+    case 0x00:
+      thr.status = 0x14802000;
+      thr.trk_len = thr.trk_poly = 0;
+      thr.trk_skip = 0;
+      break;
+    case 0x01:
+      thr.status &= ~0x08000000;
+      thr.trk_len = thr.trk_poly = 0;
+      thr.trk_skip = 0;
+      break;
+    case 0x03:
+      thr.status = (thr.status & ~0x800000) | ((data & 1) << 23);
+      break;
+    case 0x04:
+      thr.status = (thr.status & ~0x60000000) | ((data & 3) << 29);
+      break;
+    case 0x08:
+      thr.status = (thr.status & ~0x7f0000) | ((data & 0x3F) << 17) | ((data & 0x40) << 10);
+      break;
+  }
+}
+
+static void gpu_thread_start(int pipelined, unsigned int *check)
+{
+  int ret;
+
+  if (thr.active && !thr.check == !check) {
+    gpu_thread_sync();
+    thr.pipelined = pipelined;
+    return;
+  }
+  gpu_thread_stop();
+  if (!check && sysconf(_SC_NPROCESSORS_ONLN) <= 1)
+    return;
+
+  thr.ring = (uint32_t *)malloc(RING_SIZE * 4);
+  if (thr.ring == NULL)
+    return;
+  thr.wpos = thr.wpos_pub = thr.rpos = 0;
+  thr.wbuf_len = 0;
+  thr.want_idle = thr.exit = 0;
+  thr.frame_seq = thr.released = 0;
+  thr.pipelined = pipelined;
+  thread_track_reset();
+  if (check) {
+    // nothing runs in parallel, so a frame can't be held back
+    thr.pipelined = 0;
+    thr.check = check;
+    thr.active = 1;
+    return;
+  }
+  ret = sem_init(&thr.sem_work, 0, 0);
+  if (ret != 0)
+    goto fail_sem_work;
+  ret = sem_init(&thr.sem_idle, 0, 0);
+  if (ret != 0)
+    goto fail_sem_idle;
+
+  ret = pthread_create(&thr.thread, NULL, gpu_worker_thread, NULL);
+  if (ret != 0)
+    goto fail_thread;
+
+  thr.active = 1;
+  return;
+
+fail_thread:
+  sem_destroy(&thr.sem_idle);
+fail_sem_idle:
+  sem_destroy(&thr.sem_work);
+fail_sem_work:
+  free(thr.ring);
+  thr.ring = NULL;
+  thr.pipelined = 0;
+  fprintf(stderr, "could not start gpu thread\n");
+}
+
+static void gpu_thread_stop(void)
+{
+  if (!thr.active)
+    return;
+  gpu_thread_sync();
+  thr.active = 0;
+  thr.pipelined = 0;
+  if (thr.check) {
+    thr.check = NULL;
+    goto out;
+  }
+
+  __atomic_store_n(&thr.exit, 1, __ATOMIC_RELEASE);
+  sem_post(&thr.sem_work);
+  pthread_join(thr.thread, NULL);
+  sem_destroy(&thr.sem_idle);
+  sem_destroy(&thr.sem_work);
+out:
+  free(thr.ring);
+  thr.ring = NULL;
+}
+
+#define gpu_thread_active() thr.active
+
+#else // !GPULIB_THREAD
+
+#define gpu_thread_active() 0
+static void thread_push_wbuf(void) {}
+static void thread_push(int type, uint32_t *data, int count) {}
+static void thread_publish(void) {}
+static void gpu_thread_sync(void) {}
+static void thread_track_reset(void) {}
+static void gpu_thread_start(int pipelined, unsigned int *check) {}
+static void gpu_thread_stop(void) {}
+
+#endif // GPULIB_THREAD
+
+/* command capture for replay/benchmarking, see capture.h */
+#define CAP_RUN_LEN 1024
+
+static struct {
+  FILE *f;
+  const char *armed_name; // starts at the next frame end
+  const char *last_name;
+  int frames_left;        // 0 - until stopped
+  int run_len;            // pending CAP_GP0 words
+  uint32_t run[CAP_RUN_LEN];
+} cap;
+
+static void capture_flush_run(void)
+{
+  uint32_t hdr;
+
+  if (cap.run_len == 0)
+    return;
+  hdr = (CAP_GP0 << 24) | cap.run_len;
+  fwrite(&hdr, 4, 1, cap.f);
+  fwrite(cap.run, 4, cap.run_len, cap.f);
+  cap.run_len = 0;
+}
+
+static void capture_end(void)
+{
+  if (cap.f == NULL)
+    return;
+  capture_flush_run();
+  fclose(cap.f);
+  cap.f = NULL;
+}
+
+static void capture_write(int type, const uint32_t *data, int len)
+{
+  uint32_t hdr = (type << 24) | len;
+
+  capture_flush_run();
+  fwrite(&hdr, 4, 1, cap.f);
+  if (len > 0)
+    fwrite(data, 4, len, cap.f);
+
+  if (type == CAP_FRAME && cap.frames_left > 0 && --cap.frames_left == 0)
+    capture_end();
+}
+
+static void capture_gp0(uint32_t data)
+{
+  cap.run[cap.run_len++] = data;
+  if (cap.run_len >= CAP_RUN_LEN)
+    capture_flush_run();
+}
+
+static void capture_begin(void)
+{
+  struct capture_header hdr;
+  int i;
+
+  gpu_thread_sync();
+  if (gpu.cmd_len > 0)
+    flush_cmd_buffer();
+  if (gpu.dma.h)
+    return; // mid vram transfer, try next frame
+
+  cap.f = fopen(cap.armed_name, "wb");
+  if (cap.f == NULL) {
+    fprintf(stderr, "could not open %s for gpu capture\n", cap.armed_name);
+    cap.armed_name = NULL;
+    return;
+  }
+  cap.armed_name = NULL;
+  setvbuf(cap.f, NULL, _IOFBF, 1024 * 1024);
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = CAPTURE_MAGIC;
+  hdr.version = CAPTURE_VERSION;
+  hdr.status = gpu.status.reg;
+  memcpy(hdr.regs, gpu.regs, sizeof(hdr.regs));
+  memcpy(hdr.ex_regs, gpu.ex_regs, sizeof(hdr.ex_regs));
+  fwrite(&hdr, sizeof(hdr), 1, cap.f);
+  fwrite(gpu.vram, 2, 1024 * 512, cap.f);
+
+  // incomplete command left in the buffer
+  cap.run_len = 0;
+  for (i = 0; i < gpu.cmd_len; i++)
+    capture_gp0(gpu.cmd_buffer[i]);
+}
+
+void GPUwriteStatus(uint32_t data)
+{
+  if (unlikely(cap.f != NULL))
+    capture_write(CAP_GP1, &data, 1);
+
+#ifdef GPULIB_THREAD
+  if (thr.active) {
+    // reset cmds process what's buffered, so send it first
+    if ((data >> 24) < 2)
+      thread_push_wbuf();
+    *thread_alloc(PKT_GP1, 1) = data;
+    thread_track_status(data);
+    thread_publish();
+    return;
+  }
+#endif
+
+  do_write_status(data);
+}
+
+void GPUwriteDataMem(uint32_t *mem, int count)
+{
+  log_io("gpu_dma_write %p %d\n", mem, count);
+
+  if (unlikely(cap.f != NULL))
+    capture_write(CAP_DMA, mem, count);
+
+  if (gpu_thread_active()) {
+    thread_push_wbuf();
+    thread_push(PKT_DMA, mem, count);
+    thread_publish();
+    return;
+  }
+
+  do_write_data_mem(mem, count);
+}
+
+void GPUwriteData(uint32_t data)
+{
+  log_io("gpu_write %08x\n", data);
+
+  if (unlikely(cap.f != NULL))
+    capture_gp0(data);
+
+#ifdef GPULIB_THREAD
+  if (thr.active) {
+    thr.wbuf[thr.wbuf_len++] = data;
+    if (thr.wbuf_len >= CMD_BUFFER_LEN) {
+      thread_push_wbuf();
+      thread_publish();
+    }
+    return;
+  }
+#endif
+
+  gpu.cmd_buffer[gpu.cmd_len++] = data;
+  if (gpu.cmd_len >= CMD_BUFFER_LEN)
+    flush_cmd_buffer();
+}
+
+/*
+ * The chain is walked once, gathering the non-empty nodes into a scratch
+ * buffer that is handed to the renderer whenever it fills up (always at
+ * a node boundary), and adding up the transfer time on the way.
+ * Games sometimes leave a loop in the list, so past LD_THRESHOLD nodes
+ * visited nodes are tracked in a bitmap and the walk stops at the first
+ * one seen twice.
+ */
+#define CHAIN_BUF_LEN (16 * 1024)
+#define LD_THRESHOLD (8 * 1024)
+
+static struct {
+  uint32_t buf[CHAIN_BUF_LEN];
+  uint32_t visited[0x200000 / 4 / 32]; // a bit per ram word
+} chain;
+
+static void chain_flush(int len, int threaded)
+{
+  if (threaded)
+    thread_push(PKT_LIST, chain.buf, len);
+  else
+    do_dma_list(chain.buf, len);
+}
+
+long GPUdmaChain(uint32_t *rambase, uint32_t start_addr)
+{
+  uint32_t addr, word, bit, *list;
+  int len, count, buf_len = 0;
+  long cpu_cycles = 0;
+  int threaded = gpu_thread_active();
+  int capture = cap.f != NULL;
+
+  preload(rambase + (start_addr & 0x1fffff) / 4);
+
+  if (unlikely(capture))
+    capture_write(CAP_CHAIN, NULL, 0);
+
+  if (threaded)
+    thread_push_wbuf();
+  else if (unlikely(gpu.cmd_len > 0))
+    flush_cmd_buffer();
+
+  log_io("gpu_dma_chain\n");
+  addr = start_addr & 0xffffff;
+  for (count = 0; (addr & 0x800000) == 0; count++)
+  {
+    word = (addr & 0x1fffff) / 4;
+    if (unlikely(count >= LD_THRESHOLD)) {
+      if (count == LD_THRESHOLD)
+        memset(chain.visited, 0, sizeof(chain.visited));
+      bit = 1u << (word & 31);
+      if (chain.visited[word / 32] & bit) {
+        log_anomaly("GPUdmaChain: loop at %06x after %d nodes\n", addr, count);
+        break;
+      }
+      chain.visited[word / 32] |= bit;
+    }
+
+    list = rambase + word;
+    len = list[0] >> 24;
+    addr = list[0] & 0xffffff;
+    preload(rambase + (addr & 0x1fffff) / 4);
+
+    cpu_cycles += 10;
+    if (len == 0)
+      continue;
+    cpu_cycles += 5 + len;
+
+    log_io(".chain %08x #%d\n", word * 4, len);
+
+    if (unlikely(capture))
+      capture_write(CAP_LIST, list + 1, len);
+
+    if (buf_len + len > CHAIN_BUF_LEN) {
+      chain_flush(buf_len, threaded);
+      buf_len = 0;
+    }
+    memcpy(chain.buf + buf_len, list + 1, len * 4);
+    buf_len += len;
+  }
+  if (buf_len > 0)
+    chain_flush(buf_len, threaded);
+
+  if (threaded)
+    thread_publish();
+
+  gpu.state.last_list.frame = *gpu.state.frame_count;
+  gpu.state.last_list.hcnt = *gpu.state.hcnt;
+  gpu.state.last_list.cycles = cpu_cycles;
+  gpu.state.last_list.addr = start_addr;
+
+  return cpu_cycles;
+}
+
+void GPUreadDataMem(uint32_t *mem, int count)
 {
   log_io("gpu_dma_read  %p %d\n", mem, count);
 
+  if (unlikely(cap.f != NULL)) {
+    uint32_t c = count;
+    capture_write(CAP_READ_MEM, &c, 1);
+  }
+
+  gpu_thread_sync();
+  memo_flush();
   if (unlikely(gpu.cmd_len > 0))
     flush_cmd_buffer();
 
   if (gpu.dma.h)
     do_vram_io(mem, count, 1);
+  if (gpu_thread_active())
+    thread_track_reset();
 }
 
 uint32_t GPUreadData(void)
 {
   uint32_t ret;
 
+  if (unlikely(cap.f != NULL))
+    capture_write(CAP_READ, NULL, 0);
+
+  gpu_thread_sync();
+  memo_flush();
   if (unlikely(gpu.cmd_len > 0))
     flush_cmd_buffer();
 
   ret = gpu.gp0;
   if (gpu.dma.h)
     do_vram_io(&ret, 1, 1);
+  if (gpu_thread_active())
+    thread_track_reset();
 
   log_io("gpu_read %08x\n", ret);
   return ret;
@@ -690,6 +2275,19 @@ uint32_t GPUreadStatus(void)
 {
   uint32_t ret;
 
+  // only matters as a flush point
+  if (unlikely(cap.f != NULL && cap.run_len > 0))
+    capture_write(CAP_STATUS, NULL, 0);
+
+#ifdef GPULIB_THREAD
+  // games poll this all the time, so don't wait for the worker,
+  // the bits commands change are tracked on this thread
+  if (thr.active) {
+    thread_push_wbuf();
+    thread_publish();
+    return thread_read_status();
+  }
+#endif
   if (unlikely(gpu.cmd_len > 0))
     flush_cmd_buffer();
 
@@ -710,8 +2308,11 @@ long GPUfreeze(uint32_t type, struct GPUFreeze *freeze)
 {
   int i;
 
+  gpu_thread_sync();
+
   switch (type) {
     case 1: // save
+      memo_flush();
       if (gpu.cmd_len > 0)
         flush_cmd_buffer();
       memcpy(freeze->psxVRam, gpu.vram, 1024 * 512 * 2);
@@ -720,6 +2321,9 @@ long GPUfreeze(uint32_t type, struct GPUFreeze *freeze)
       freeze->ulStatus = gpu.status.reg;
       break;
     case 0: // load
+      capture_end(); // can't follow a state change
+      if (memo.enabled)
+        memo_reset();
       memcpy(gpu.vram, freeze->psxVRam, 1024 * 512 * 2);
       memcpy(gpu.regs, freeze->ulControl, sizeof(gpu.regs));
       memcpy(gpu.ex_regs, freeze->ulControl + 0xe0, sizeof(gpu.ex_regs));
@@ -727,27 +2331,35 @@ long GPUfreeze(uint32_t type, struct GPUFreeze *freeze)
       gpu.cmd_len = 0;
       for (i = 8; i > 0; i--) {
         gpu.regs[i] ^= 1; // avoid reg change detection
-        GPUwriteStatus((i << 24) | (gpu.regs[i] ^ 1));
+        do_write_status((i << 24) | (gpu.regs[i] ^ 1));
       }
       renderer_sync_ecmds(gpu.ex_regs);
+      caches_upd.w = 0;
       renderer_update_caches(0, 0, 1024, 512);
+      mark_fb_dirty_all();
+      if (gpu_thread_active())
+        thread_track_reset();
       break;
   }
 
   return 1;
 }
 
-void GPUupdateLace(void)
+static void update_lace(void)
 {
   if (gpu.cmd_len > 0)
     flush_cmd_buffer();
+  caches_flush();
   renderer_flush_queues();
+  memo_frame_end();
+  if (gpu.frame_end)
+    gpu.frame_end();
 
   if (gpu.status.blanking) {
     if (!gpu.state.blanked) {
       vout_blank();
       gpu.state.blanked = 1;
-      gpu.state.fb_dirty = 1;
+      mark_fb_dirty_all();
     }
     return;
   }
@@ -769,33 +2381,69 @@ void GPUupdateLace(void)
   gpu.state.blanked = 0;
 }
 
-void GPUvBlank(int is_vblank, int lcf)
+void GPUupdateLace(void)
 {
-  int interlace = gpu.state.allow_interlace
-    && gpu.status.interlace && gpu.status.dheight;
-  // interlace doesn't look nice on progressive displays,
-  // so we have this "auto" mode here for games that don't read vram
-  if (gpu.state.allow_interlace == 2
-      && *gpu.state.frame_count - gpu.state.last_vram_read_frame > 1)
+  if (unlikely(cap.f != NULL))
+    capture_write(CAP_FRAME, NULL, 0);
+
+#ifdef GPULIB_THREAD
+  if (thr.active && thr.pipelined) {
+    thread_frame_end();
+    update_lace();
+    // let the worker continue with the frame just emulated
+    thread_release_frame(thr.frame_seq - 1);
+  }
+  else
+#endif
   {
-    interlace = 0;
+    gpu_thread_sync();
+    update_lace();
   }
-  if (interlace || interlace != gpu.state.old_interlace) {
-    gpu.state.old_interlace = interlace;
 
-    if (gpu.cmd_len > 0)
-      flush_cmd_buffer();
-    renderer_flush_queues();
-    renderer_set_interlace(interlace, !lcf);
+  if (unlikely(cap.armed_name != NULL))
+    capture_begin();
+}
+
+void GPUvBlank(int is_vblank, int lcf)
+{
+  if (unlikely(cap.f != NULL)) {
+    uint32_t l = lcf;
+    capture_write(CAP_VBLANK, &l, 1);
+  }
+
+#ifdef GPULIB_THREAD
+  if (thr.active) {
+    // no need to wait, just keep it in order with the commands
+    thread_push_wbuf();
+    *thread_alloc(PKT_VBLANK, 1) = lcf;
+    thread_publish();
+    return;
   }
+#endif
+
+  do_vblank(lcf);
 }
 
 #include "../../frontend/plugin_lib.h"
 
 void GPUrearmedCallbacks(const struct rearmed_cbs *cbs)
 {
+  gpu_thread_sync();
+  caches_flush();
+
+  if (cbs->frameskip == -2 && gpu.frameskip.set != -2) {
+    gpu.frameskip.load = 0;
+    gpu.frameskip.level = 0;
+    gpu.frameskip.hold = 0;
+  }
   gpu.frameskip.set = cbs->frameskip;
   gpu.frameskip.advice = &cbs->fskip_advice;
+  gpu.frameskip.host_us = &cbs->fskip_host_us;
+  gpu.frameskip.audio_fill = &cbs->fskip_audio_fill;
+  gpu.frameskip.stats = cbs->fskip_stats;
+  gpu.frameskip.max = cbs->fskip_max;
+  if (gpu.frameskip.max < 1 || gpu.frameskip.max > 3)
+    gpu.frameskip.max = 3;
   gpu.frameskip.active = 0;
   gpu.frameskip.frame_ready = 1;
   gpu.state.hcnt = cbs->gpu_hcnt;
@@ -815,6 +2463,23 @@ void GPUrearmedCallbacks(const struct rearmed_cbs *cbs)
     cbs->pl_vout_set_raw_vram(gpu.vram);
   renderer_set_config(cbs);
   vout_set_config(cbs);
+
+  if (cbs->gpu_capture != cap.last_name) {
+    cap.last_name = cbs->gpu_capture;
+    capture_end();
+    cap.armed_name = cbs->gpu_capture;
+    cap.frames_left = cbs->gpu_capture_frames;
+  }
+
+  memo_enable(cbs->gpu_memo);
+  memo.stats = cbs->gpu_memo_stats;
+
+  bands_start(cbs->gpu_bands);
+
+  if (cbs->gpu_thread)
+    gpu_thread_start(cbs->gpu_thread == 2, cbs->gpu_thread_check);
+  else
+    gpu_thread_stop();
 }
 
 // vim:shiftwidth=2:expandtab
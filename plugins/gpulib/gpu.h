@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 #define CMD_BUFFER_LEN          1024
+#define GPU_BANDS_MAX           8
 
 struct psx_gpu {
   uint32_t cmd_buffer[CMD_BUFFER_LEN];
@@ -82,9 +83,10 @@ struct psx_gpu {
       uint32_t hcnt;
     } last_list;
     uint32_t last_vram_read_frame;
+    int dirty_y1, dirty_y2; /* vram lines changed in the display area */
   } state;
   struct {
-    int32_t set:3; /* -1 auto, 0 off, 1-3 fixed */
+    int32_t set:3; /* -2 adaptive, -1 auto, 0 off, 1-3 fixed */
     int32_t cnt:3; /* amount skipped in a row */
     uint32_t active:1;
     uint32_t allow:1;
@@ -92,6 +94,14 @@ struct psx_gpu {
     const int *advice;
     uint32_t last_flip_frame;
     uint32_t pending_fill[3];
+    /* adaptive */
+    const int *host_us;    /* host time taken by the last frame, 0 unknown */
+    const int *audio_fill; /* audio output buffer fill %, -1 unknown */
+    unsigned int *stats;
+    int load;              /* filtered host_us / frame time, .8 fixed point */
+    int level;             /* frames to skip after each drawn one */
+    int max;
+    int hold;
   } frameskip;
   int useDithering:1; /* 0 - off , 1 - on */
   uint16_t *(*get_enhancement_bufer)
@@ -100,6 +110,20 @@ struct psx_gpu {
     (int *x, int *y, int *w, int *h, int *vram_h);
   void *(*mmap)(unsigned int size);
   void  (*munmap)(void *ptr, unsigned int size);
+  /* optional, for drawing a command list in horizontal bands on several
+   * threads: band_begin() returns how many of count bands it will draw
+   * (less than 2 refuses), then band_draw() runs for each band at once,
+   * band 0 on the calling thread which must end up in the state
+   * do_cmd_list() would leave, the others starting from ecmds;
+   * band_end() is called after all of them are done. While enhancement
+   * is active count isn't limited by the lines drawn, the renderer may
+   * split the work some other way and ignore y0/y1 */
+  int  (*band_begin)(int count);
+  void (*band_draw)(int band, uint32_t *list, int count,
+                    const uint32_t *ecmds, int y0, int y1);
+  void (*band_end)(int count);
+  /* optional, called after each frame once everything is drawn */
+  void (*frame_end)(void);
 };
 
 extern struct psx_gpu gpu;
@@ -0,0 +1,607 @@
+/*
+ * gpulib capture replay, for renderer benchmarking and regression checks
+ *
+ * Feeds a capture made with rearmed_cbs.gpu_capture (pcsx_bench -capture)
+ * through the normal GPU* interface and reports the time spent on each
+ * frame and a VRAM checksum after it. Build with Makefile.test.
+ *
+ * With -checkmemo the capture is played twice, without and with the
+ * gpulib frame cache (rearmed_cbs.gpu_memo), and VRAM and status are
+ * compared after every frame, as a skipped frame that shouldn't have
+ * been would go unnoticed otherwise. -checkstatus does the same for the
+ * status bits the gpu thread mode follows on the emu thread, checking
+ * them against the gpu each time work is handed over.
+ *
+ * This work is licensed under the terms of any of these licenses
+ * (at your option):
+ *  - GNU GPL, version 2 or later.
+ *  - GNU LGPL, version 2.1 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpu.h"
+#include "capture.h"
+#include "../../frontend/plugin_lib.h"
+#ifdef REPLAY_GLES
+#include <EGL/egl.h>
+#include <GLES/gl.h>
+#endif
+
+// as in gpu.c
+struct GPUFreeze
+{
+  uint32_t ulFreezeVersion;
+  uint32_t ulStatus;
+  uint32_t ulControl[256];
+  unsigned char psxVRam[1024*1024*2];
+};
+
+static uint32_t frame_counter, hcnt;
+static unsigned int flips;
+static int enhance;
+static uint32_t enh_sum;
+static struct gpu_neon_stats stats_sum;
+static struct gpu_unai_stats unai_stats_sum;
+static int unai_stats_seen;
+static struct gpu_peopsgl_stats gles_stats_sum;
+static int gles_stats_seen;
+
+// what vout_pl.c would show with enhancement, folded into enh_sum
+static void enh_update(void)
+{
+  int x = gpu.screen.x & ~1, y = gpu.screen.y;
+  int w = gpu.screen.w, h = gpu.screen.h, vram_h, i;
+  const uint32_t *p;
+
+  gpu.state.enhancement_active = gpu.get_enhancement_bufer != NULL
+    && gpu.screen.hres <= 512 && h <= 256 && !gpu.status.rgb24;
+  if (!gpu.state.enhancement_active || w <= 0 || h <= 0)
+    return;
+
+  p = (const uint32_t *)gpu.get_enhancement_bufer(&x, &y, &w, &h, &vram_h);
+  p += y * 512 + x / 2;
+  for (; h > 0; h--, p += 512)
+    for (i = 0; i < w / 2; i++)
+      enh_sum = (enh_sum ^ p[i]) * 16777619u;
+}
+
+// gpu-gles owns the display and has its own vout_*
+#ifndef REPLAY_GLES
+
+int vout_init(void)
+{
+  return 0;
+}
+
+int vout_finish(void)
+{
+  return 0;
+}
+
+void vout_update(void)
+{
+  flips++;
+  if (enhance)
+    enh_update();
+}
+
+void vout_blank(void)
+{
+}
+
+void vout_set_config(const struct rearmed_cbs *cbs)
+{
+}
+
+#else
+
+#define GLES_W 640
+#define GLES_H 480
+
+// gpu-gles draws into the frontend's EGL surface, give it an offscreen one.
+// With Mesa this runs on llvmpipe, no display or gpu needed.
+static int gles_open(struct rearmed_cbs *cbs)
+{
+  static const EGLint cfg_attr[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES_BIT,
+    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_NONE };
+  static const EGLint pb_attr[] = { EGL_WIDTH, GLES_W, EGL_HEIGHT, GLES_H, EGL_NONE };
+  static const EGLint ctx_attr[] = { EGL_CONTEXT_CLIENT_VERSION, 1, EGL_NONE };
+  EGLDisplay dpy;
+  EGLSurface surface;
+  EGLContext ctx;
+  EGLConfig cfg;
+  EGLint n = 0;
+
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+  dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, NULL, NULL)
+      || !eglBindAPI(EGL_OPENGL_ES_API)
+      || !eglChooseConfig(dpy, cfg_attr, &cfg, 1, &n) || n == 0) {
+    fprintf(stderr, "no EGL pbuffer config (%x)\n", eglGetError());
+    return -1;
+  }
+  surface = eglCreatePbufferSurface(dpy, cfg, pb_attr);
+  ctx = eglCreateContext(dpy, cfg, EGL_NO_CONTEXT, ctx_attr);
+  if (surface == EGL_NO_SURFACE || ctx == EGL_NO_CONTEXT
+      || !eglMakeCurrent(dpy, surface, surface, ctx)) {
+    fprintf(stderr, "could not set up GLES (%x)\n", eglGetError());
+    return -1;
+  }
+
+  cbs->screen_w = GLES_W;
+  cbs->screen_h = GLES_H;
+  cbs->gles_display = dpy;
+  cbs->gles_surface = surface;
+  return 0;
+}
+
+// what ended up on screen, as vram isn't drawn to
+static uint32_t fb_checksum(void)
+{
+  static uint32_t fb[GLES_W * GLES_H];
+  uint32_t sum = 2166136261u;
+  int i;
+
+  glReadPixels(0, 0, GLES_W, GLES_H, GL_RGBA, GL_UNSIGNED_BYTE, fb);
+  for (i = 0; i < GLES_W * GLES_H; i++)
+    sum = (sum ^ fb[i]) * 16777619u;
+  return sum;
+}
+
+#endif // REPLAY_GLES
+
+// gpu_neon only, totals over the whole replay
+static void stats_add(const struct gpu_neon_stats *s)
+{
+  const unsigned int *src = (const unsigned int *)s;
+  unsigned int *dst = (unsigned int *)&stats_sum;
+  size_t i;
+
+  for (i = 0; i < sizeof(*s) / sizeof(*src); i++)
+    dst[i] += src[i];
+}
+
+// gpu_unai only, totals over the whole replay
+static void unai_stats_add(const struct gpu_unai_stats *s)
+{
+  const unsigned int *src = (const unsigned int *)s;
+  unsigned int *dst = (unsigned int *)&unai_stats_sum;
+  size_t i;
+
+  for (i = 0; i < sizeof(*s) / sizeof(*src); i++)
+    dst[i] += src[i];
+  unai_stats_seen = 1;
+}
+
+// gpu-gles only, totals over the whole replay
+static void gles_stats_add(const struct gpu_peopsgl_stats *s)
+{
+  const unsigned int *src = (const unsigned int *)s;
+  unsigned int *dst = (unsigned int *)&gles_stats_sum;
+  size_t i;
+
+  for (i = 0; i < sizeof(*s) / sizeof(*src); i++)
+    dst[i] += src[i];
+  gles_stats_seen = 1;
+}
+
+static void gles_stats_print(int frames)
+{
+  const struct gpu_peopsgl_stats *s = &gles_stats_sum;
+
+  printf("texture cache per frame: %u hits (%u by hash), %u decodes, "
+    "%u uploads (%u bytes)\n", s->cache_hits / frames, s->hash_hits / frames,
+    s->decodes / frames, s->uploads / frames, s->upload_bytes / frames);
+}
+
+static void unai_stats_print(int frames)
+{
+  const struct gpu_unai_stats *s = &unai_stats_sum;
+
+  printf("renderer per frame: %u polys, %u sprites, %u lines, %u fills, "
+    "%u moves\n", s->polys / frames, s->sprites / frames, s->lines / frames,
+    s->fills / frames, s->image_moves / frames);
+  printf("  pixels: %u polys, %u sprites, %u lines, %u fills, %u moves\n",
+    s->px_polys / frames, s->px_sprites / frames, s->px_lines / frames,
+    s->px_fills / frames, s->px_image_moves / frames);
+  printf("  us: %u polys, %u sprites, %u lines, %u fills, %u moves, "
+    "%u other\n", s->us_polys / frames, s->us_sprites / frames,
+    s->us_lines / frames, s->us_fills / frames, s->us_image_moves / frames,
+    s->us_other / frames);
+}
+
+static void stats_print(int frames)
+{
+  const struct gpu_neon_stats *s = &stats_sum;
+
+  if (unai_stats_seen) {
+    unai_stats_print(frames);
+    return;
+  }
+  if (gles_stats_seen) {
+    gles_stats_print(frames);
+    return;
+  }
+
+  printf("renderer per frame: %u triangles (%u rejected), %u sprites, "
+    "%u lines, %u pixels\n", s->triangles / frames,
+    s->trivial_rejects / frames, s->sprites / frames, s->lines / frames,
+    s->span_pixels / frames);
+  printf("  %u flushes, %u state changes, %u texture cache loads "
+    "(%u bytes)\n", s->render_buffer_flushes / frames,
+    s->state_changes / frames, s->texture_cache_loads / frames,
+    s->texture_cache_bytes / frames);
+  printf("  us: %u triangles, %u sprites, %u lines, %u fill/copy, "
+    "%u texture cache\n", s->us_triangles / frames, s->us_sprites / frames,
+    s->us_lines / frames, s->us_fill_copy / frames,
+    s->us_texture_cache / frames);
+}
+
+static void *enh_mmap(unsigned int size)
+{
+  return calloc(1, size);
+}
+
+static void enh_munmap(void *ptr, unsigned int size)
+{
+  free(ptr);
+}
+
+static double get_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static uint32_t vram_checksum(void)
+{
+  const uint32_t *p = (const uint32_t *)gpu.vram;
+  uint32_t sum = 2166136261u;
+  int i;
+
+  for (i = 0; i < 1024 * 512 / 2; i++)
+    sum = (sum ^ p[i]) * 16777619u;
+  return sum;
+}
+
+static uint32_t *load_file(const char *name, long *size)
+{
+  uint32_t *buf;
+  FILE *f;
+
+  f = fopen(name, "rb");
+  if (f == NULL) {
+    perror(name);
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = (uint32_t *)malloc(*size);
+  if (buf == NULL || fread(buf, 1, *size, f) != (size_t)*size) {
+    fprintf(stderr, "could not read %s\n", name);
+    free(buf);
+    buf = NULL;
+  }
+  fclose(f);
+  return buf;
+}
+
+static void load_state(const struct capture_header *hdr, const void *vram)
+{
+  struct GPUFreeze *freeze;
+
+  freeze = (struct GPUFreeze *)calloc(1, sizeof(*freeze));
+  if (freeze == NULL)
+    exit(1);
+  freeze->ulFreezeVersion = 1;
+  freeze->ulStatus = hdr->status;
+  memcpy(freeze->ulControl, hdr->regs, sizeof(hdr->regs));
+  memcpy(freeze->ulControl + 0xe0, hdr->ex_regs, sizeof(hdr->ex_regs));
+  memcpy(freeze->psxVRam, vram, 1024 * 512 * 2);
+  GPUfreeze(0, freeze);
+  free(freeze);
+}
+
+// wait for the gpu thread, if any, a status read doesn't anymore
+static void sync_state(void)
+{
+  struct GPUFreeze *freeze;
+
+  freeze = (struct GPUFreeze *)malloc(sizeof(*freeze));
+  if (freeze == NULL)
+    exit(1);
+  GPUfreeze(1, freeze);
+  free(freeze);
+}
+
+// rebuild a dma chain from the CAP_LIST records following CAP_CHAIN
+static const uint32_t *do_chain(uint32_t *ram, const uint32_t *p, const uint32_t *end)
+{
+  uint32_t addr = 0, prev = 0;
+  int first = 1;
+
+  while (p < end && (*p >> 24) == CAP_LIST) {
+    uint32_t len = *p & 0xffffff;
+    if (addr + (len + 1) * 4 > 0x200000)
+      break; // doesn't fit, do the rest as another chain
+    if (!first)
+      ram[prev / 4] = (ram[prev / 4] & 0xff000000) | addr;
+    ram[addr / 4] = (len << 24) | 0xffffff;
+    memcpy(&ram[addr / 4 + 1], p + 1, len * 4);
+    prev = addr;
+    addr += (len + 1) * 4;
+    p += 1 + len;
+    first = 0;
+  }
+  if (first)
+    ram[0] = 0xffffff;
+
+  GPUdmaChain(ram, 0);
+  return p;
+}
+
+static void usage(const char *argv0)
+{
+  printf("usage:\n%s [options] <capture>\n"
+    "\t-q\t\tonly print the summary\n"
+    "\t-fskip N\tframeskip setting (default 0, -2 adaptive)\n"
+    "\t-bands N\tdraw on N threads if the renderer can (-1 one per cpu)\n"
+    "\t-enh\t\tdraw the 2x enhanced copy too, if the renderer can\n"
+    "\t-stats\t\tprint renderer stats, if the renderer has them\n"
+    "\t-jit\t\tuse compiled span functions, if the renderer has them\n"
+    "\t-checkmemo\tcompare each frame with and without the frame cache\n"
+    "\t-checkstatus\tcheck the status tracked for the gpu thread mode\n"
+    "\t-o FILE\t\tsave the final VRAM to FILE\n", argv0);
+}
+
+int main(int argc, char *argv[])
+{
+  static struct rearmed_cbs cbs;
+  const struct capture_header *hdr;
+  const uint32_t *p, *start, *end;
+  const char *name = NULL, *vram_out = NULL;
+  uint32_t *buf, *ram, tmp[64];
+  uint32_t *check = NULL; // vram checksum and status for each frame
+  unsigned int fskip_stats[3] = { 0, 0, 0 };
+  unsigned int memo_stats[2] = { 0, 0 };
+  unsigned int thread_check[2] = { 0, 0 };
+  double t, frame_start, total = 0, min = 1e9, max = 0;
+  int quiet = 0, stats = 0, frames = 0, i;
+  int check_memo = 0, check_frames = 0, bad = 0, pass;
+  long size;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-q"))
+      quiet = 1;
+    else if (!strcmp(argv[i], "-fskip") && i + 1 < argc)
+      cbs.frameskip = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-bands") && i + 1 < argc)
+      cbs.gpu_bands = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-enh"))
+      enhance = 1;
+    else if (!strcmp(argv[i], "-stats"))
+      stats = 1;
+    else if (!strcmp(argv[i], "-jit"))
+      cbs.gpu_unai.jit = 1;
+    else if (!strcmp(argv[i], "-checkmemo"))
+      check_memo = 1;
+    else if (!strcmp(argv[i], "-checkstatus")) {
+      cbs.gpu_thread = 1;
+      cbs.gpu_thread_check = thread_check;
+    }
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      vram_out = argv[++i];
+    else if (argv[i][0] != '-')
+      name = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (name == NULL) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  buf = load_file(name, &size);
+  if (buf == NULL)
+    return 1;
+  hdr = (const struct capture_header *)buf;
+  if (size < (long)sizeof(*hdr) + 1024 * 512 * 2 || hdr->magic != CAPTURE_MAGIC
+      || hdr->version != CAPTURE_VERSION) {
+    fprintf(stderr, "%s: not a supported capture\n", name);
+    return 1;
+  }
+  start = (const uint32_t *)((const char *)buf + sizeof(*hdr) + 1024 * 512 * 2);
+  end = buf + size / 4;
+
+  ram = (uint32_t *)malloc(0x200000);
+  if (ram == NULL)
+    return 1;
+
+  cbs.gpu_frame_count = &frame_counter;
+  cbs.gpu_hcnt = &hcnt;
+  cbs.fskip_audio_fill = -1;
+  cbs.fskip_stats = fskip_stats;
+  // gpu_unai defaults as in the frontend
+  cbs.gpu_unai.lighting = 1;
+  cbs.gpu_unai.fast_lighting = 1;
+  cbs.gpu_unai.blending = 1;
+  if (enhance) {
+    cbs.gpu_neon.enhancement_enable = 1;
+    cbs.mmap = enh_mmap;
+    cbs.munmap = enh_munmap;
+  }
+  if (stats) {
+    cbs.gpu_neon.stats = stats_add;
+    cbs.gpu_unai.stats = unai_stats_add;
+    cbs.gpu_peopsgl.stats = gles_stats_add;
+  }
+#ifdef REPLAY_GLES
+  cbs.gpu_peopsgl.iTexGarbageCollection = 1;
+  if (gles_open(&cbs) != 0)
+    return 1;
+#endif
+  GPUinit();
+  GPUrearmedCallbacks(&cbs);
+#ifdef REPLAY_GLES
+  GPUopen(NULL);
+#endif
+  if (enhance)
+    enh_update(); // so that loading the state fills the enhanced buffers
+
+  for (pass = 0; pass <= check_memo; pass++) {
+    if (pass > 0) {
+      // again from the start, with the frame cache
+      check_frames = frames;
+      GPUwriteStatus(0x01000000); // drop anything left half done
+      cbs.gpu_memo = 1;
+      cbs.gpu_memo_stats = memo_stats;
+      GPUrearmedCallbacks(&cbs);
+      frame_counter = hcnt = flips = 0;
+      enh_sum = 0;
+      memset(&stats_sum, 0, sizeof(stats_sum));
+      memset(&unai_stats_sum, 0, sizeof(unai_stats_sum));
+      memset(&gles_stats_sum, 0, sizeof(gles_stats_sum));
+      memset(fskip_stats, 0, sizeof(fskip_stats));
+      frames = 0;
+      total = max = 0;
+      min = 1e9;
+    }
+    load_state(hdr, hdr + 1);
+    if (enhance)
+      enh_update();
+
+    p = start;
+    frame_start = get_time();
+    while (p < end) {
+      uint32_t type = *p >> 24;
+      uint32_t len = *p & 0xffffff;
+      const uint32_t *data = p + 1;
+
+      if (data + len > end)
+        break;
+      p = data + len;
+
+      switch (type) {
+        case CAP_GP0:
+          for (i = 0; i < (int)len; i++)
+            GPUwriteData(data[i]);
+          break;
+        case CAP_DMA:
+          // GPUwriteDataMem takes non-const, just like it would from psx ram
+          GPUwriteDataMem((uint32_t *)data, len);
+          break;
+        case CAP_CHAIN:
+          p = do_chain(ram, p, end);
+          break;
+        case CAP_LIST: // leftover from a chain too large for ram
+          p = do_chain(ram, data - 1, end);
+          break;
+        case CAP_GP1:
+          GPUwriteStatus(data[0]);
+          break;
+        case CAP_READ:
+          GPUreadData();
+          break;
+        case CAP_READ_MEM:
+          for (i = data[0]; i > 0; i -= 64)
+            GPUreadDataMem(tmp, i < 64 ? i : 64);
+          break;
+        case CAP_STATUS:
+          GPUreadStatus();
+          break;
+        case CAP_VBLANK:
+          GPUvBlank(1, data[0]);
+          break;
+        case CAP_FRAME:
+          GPUupdateLace();
+          t = get_time() - frame_start;
+          total += t;
+          if (t < min)
+            min = t;
+          if (t > max)
+            max = t;
+          if (check_memo) {
+            uint32_t sum = vram_checksum(), st = gpu.status.reg;
+            if (pass == 0) {
+              if ((frames & 255) == 0)
+                check = (uint32_t *)realloc(check, (frames + 256) * 2 * sizeof(check[0]));
+              check[frames * 2] = sum;
+              check[frames * 2 + 1] = st;
+            }
+            else if (frames < check_frames && (sum != check[frames * 2]
+                     || st != check[frames * 2 + 1])) {
+              printf("frame %5d: vram %08x status %08x with the frame cache, "
+                "%08x %08x without\n", frames, sum, st, check[frames * 2],
+                check[frames * 2 + 1]);
+              bad++;
+            }
+          }
+          if (!quiet && !check_memo)
+#ifdef REPLAY_GLES
+            printf("frame %5d: %8.3f ms  vram %08x  fb %08x\n", frames,
+              t * 1000.0, vram_checksum(), fb_checksum());
+#else
+            printf("frame %5d: %8.3f ms  vram %08x\n", frames, t * 1000.0,
+              vram_checksum());
+#endif
+          frames++;
+          frame_counter++;
+          cbs.fskip_host_us = (int)(t * 1000000.0);
+          frame_start = get_time();
+          break;
+        default:
+          fprintf(stderr, "bad record %08x, stopping\n", p[-1 - len]);
+          p = end;
+          break;
+      }
+    }
+    // make sure nothing is left queued before looking at vram
+    sync_state();
+  }
+
+  if (frames > 0)
+    printf("%d frames (%u flips), %.3f ms total, per frame %.3f avg "
+      "%.3f min %.3f max, vram %08x\n", frames, flips, total * 1000.0,
+      total * 1000.0 / frames, min * 1000.0, max * 1000.0, vram_checksum());
+  else
+    printf("no frames in %s\n", name);
+  if (enhance)
+    printf("enhanced output %08x\n", enh_sum);
+  if (stats && frames > 0)
+    stats_print(frames);
+  if (cbs.frameskip != 0 && fskip_stats[0] != 0)
+    printf("frameskip: %u of %u frames skipped\n", fskip_stats[1], fskip_stats[0]);
+  if (check_memo)
+    printf("frame cache: %u of %u frames not drawn, %d frames differ\n",
+      memo_stats[1], memo_stats[0], bad);
+  if (cbs.gpu_thread_check) {
+    printf("status tracking: %u checks, %u mismatches\n", thread_check[0],
+      thread_check[1]);
+    bad += thread_check[1];
+  }
+
+  if (vram_out != NULL) {
+    FILE *f = fopen(vram_out, "wb");
+    if (f != NULL) {
+      fwrite(gpu.vram, 2, 1024 * 512, f);
+      fclose(f);
+    }
+  }
+
+  GPUshutdown();
+  free(check);
+  free(ram);
+  free(buf);
+  return bad ? 1 : 0;
+}
@@ -14,6 +14,7 @@
 #include "../../frontend/plugin_lib.h"
 
 static const struct rearmed_cbs *cbs;
+static int full_flip_needed;
 
 int vout_init(void)
 {
@@ -57,6 +58,7 @@ static void check_mode_change(int force)
   {
     old_status = gpu.status.reg;
     old_h = h;
+    full_flip_needed = 1;
 
     cbs->pl_vout_set_mode(w_out, h_out, w, h, gpu.status.rgb24 ? 24 : 16);
   }
@@ -70,6 +72,7 @@ void vout_update(void)
   int h = gpu.screen.h;
   uint16_t *vram = gpu.vram;
   int vram_h = 512;
+  int y1 = 0, y2 = h;
 
   if (w == 0 || h == 0)
     return;
@@ -81,6 +84,20 @@ void vout_update(void)
   if (gpu.state.downscale_active)
     vram = gpu.get_downscale_buffer(&x, &y, &w, &h, &vram_h);
 
+  // can the frontend convert just the lines that changed?
+  if (cbs->pl_vout_flip_part != NULL && !full_flip_needed
+      && !gpu.state.enhancement_active && !gpu.state.downscale_active
+      && y + h <= vram_h)
+  {
+    y1 = gpu.state.dirty_y1 - y;
+    y2 = gpu.state.dirty_y2 - y;
+    if (y1 < 0)
+      y1 = 0;
+    if (y2 > h)
+      y2 = h;
+  }
+  full_flip_needed = 0;
+
   if (y + h > vram_h) {
     if (y + h - vram_h > h / 2) {
       // wrap
@@ -94,7 +111,10 @@ void vout_update(void)
 
   vram += y * 1024 + x;
 
-  cbs->pl_vout_flip(vram, 1024, gpu.status.rgb24, w, h);
+  if (y1 > 0 || y2 < h)
+    cbs->pl_vout_flip_part(vram, 1024, gpu.status.rgb24, w, h, y1, y2);
+  else
+    cbs->pl_vout_flip(vram, 1024, gpu.status.rgb24, w, h);
 }
 
 void vout_blank(void)
@@ -107,6 +127,7 @@ void vout_blank(void)
     w *= 2;
     h *= 2;
   }
+  full_flip_needed = 1;
   cbs->pl_vout_flip(NULL, 1024, gpu.status.rgb24, w, h);
 }
 
@@ -117,6 +138,7 @@ long GPUopen(void **unused)
 
   cbs->pl_vout_open();
   check_mode_change(1);
+  full_flip_needed = 1;
   vout_update();
   return 0;
 }